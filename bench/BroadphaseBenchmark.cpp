@@ -0,0 +1,277 @@
+// Scene-wide queries over object bounds: a linear pass testing every box
+// (what picking and rendering did before, one object at a time) against
+// the dynamic AabbTree, plus the cost of keeping the tree current as
+// objects move a little (inside their fat box) or a lot (reinserted).
+// Then frustum culling of a flat draw list: one box at a time vs the SoA
+// kernels in math/Culling.h at each SIMD level, and split over threads.
+// Last, the SpatialHash's point queries (radius, nearest neighbours, cell
+// counts) against the tree, in queries per second.
+#include "JobSystem.h"
+#include "math/AabbTree.h"
+#include "math/Culling.h"
+#include "math/Simd.h"
+#include "math/SpatialHash.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+namespace {
+    constexpr size_t OBJECTS = 50000;
+    constexpr float WORLD = 500.0f; // Objects spread over [-WORLD, WORLD] in x and z
+    constexpr size_t QUERIES = 256;
+    constexpr int REPEATS = 5;
+
+    template<typename F>
+    double bestOf(F&& f) {
+        double best = 1e30;
+        for (int r = 0; r < REPEATS; ++r) {
+            auto start = std::chrono::high_resolution_clock::now();
+            f();
+            auto end = std::chrono::high_resolution_clock::now();
+            best = std::min(best, std::chrono::duration<double, std::milli>(end - start).count());
+        }
+        return best;
+    }
+
+    float randomFloat() {
+        return (float)std::rand() / (float)RAND_MAX * 2.0f - 1.0f;
+    }
+
+    Aabb boxAt(const Vec3& center, float size) {
+        Vec3 half(size, size, size);
+        return { center - half, center + half };
+    }
+
+    void report(const char* name, double linearMs, double treeMs, size_t linearHits, size_t treeHits) {
+        printf("  %-16s linear %9.3f ms, tree %8.3f ms (%5.1fx), %zu results (%zu exact)\n",
+               name, linearMs, treeMs, linearMs / treeMs, treeHits, linearHits);
+    }
+}
+
+int main() {
+    // Objects on a wide, shallow band like a level layout
+    std::vector<Vec3> centers(OBJECTS);
+    std::vector<Aabb> boxes(OBJECTS);
+    for (size_t i = 0; i < OBJECTS; ++i) {
+        centers[i] = Vec3(randomFloat() * WORLD, randomFloat() * 20.0f, randomFloat() * WORLD);
+        boxes[i] = boxAt(centers[i], 0.5f + (randomFloat() + 1.0f));
+    }
+
+    AabbTree tree;
+    std::vector<int32_t> proxies(OBJECTS);
+    double buildMs = bestOf([&] {
+        tree.clear();
+        for (size_t i = 0; i < OBJECTS; ++i) proxies[i] = tree.createProxy(boxes[i], (uint32_t)i);
+    });
+    printf("%zu objects, best of %d; tree built in %.2f ms, height %d\n\n", OBJECTS, REPEATS, buildMs, tree.getHeight());
+
+    printf("Queries (%zu each)\n", QUERIES);
+
+    // A camera on the band looking along it: 60 degree frustum, 200 units deep
+    std::vector<Frustum> frustums(QUERIES);
+    for (Frustum& frustum : frustums) {
+        Vec3 eye(randomFloat() * WORLD, 10.0f, randomFloat() * WORLD);
+        Vec3 target = eye + Vec3(randomFloat(), -0.1f, randomFloat());
+        frustum = Frustum(Mat4::perspective(1.047f, 16.0f / 9.0f, 0.1f, 200.0f) * Mat4::lookAt(eye, target, Vec3(0.0f, 1.0f, 0.0f)));
+    }
+    size_t linearHits = 0, treeHits = 0;
+    double linearMs = bestOf([&] {
+        linearHits = 0;
+        for (const Frustum& frustum : frustums) {
+            for (const Aabb& box : boxes) linearHits += frustum.intersects(box) ? 1 : 0;
+        }
+    });
+    double treeMs = bestOf([&] {
+        treeHits = 0;
+        for (const Frustum& frustum : frustums) tree.queryFrustum(frustum, [&](int32_t) { ++treeHits; });
+    });
+    report("frustum", linearMs, treeMs, linearHits, treeHits);
+
+    // Picking rays from above, nearest box only
+    std::vector<Ray> rays(QUERIES);
+    for (Ray& ray : rays) {
+        Vec3 from(randomFloat() * WORLD, 100.0f, randomFloat() * WORLD);
+        ray = Ray{ from, normalize(Vec3(randomFloat() * 0.3f, -1.0f, randomFloat() * 0.3f)) };
+    }
+    linearMs = bestOf([&] {
+        linearHits = 0;
+        for (const Ray& ray : rays) {
+            Vec3 invDir(1.0f / ray.direction.x, 1.0f / ray.direction.y, 1.0f / ray.direction.z);
+            float nearest = INFINITY;
+            for (const Aabb& box : boxes) nearest = std::min(nearest, rayEntry(box, ray.origin, invDir));
+            linearHits += nearest < INFINITY ? 1 : 0;
+        }
+    });
+    treeMs = bestOf([&] {
+        treeHits = 0;
+        for (const Ray& ray : rays) {
+            Vec3 invDir(1.0f / ray.direction.x, 1.0f / ray.direction.y, 1.0f / ray.direction.z);
+            float nearest = INFINITY;
+            tree.raycast(ray, INFINITY, [&](int32_t proxy) {
+                nearest = std::min(nearest, rayEntry(tree.getFatAabb(proxy), ray.origin, invDir));
+                return nearest;
+            });
+            treeHits += nearest < INFINITY ? 1 : 0;
+        }
+    });
+    report("ray (nearest)", linearMs, treeMs, linearHits, treeHits);
+
+    // Neighbourhoods of 10 units around random objects
+    linearMs = bestOf([&] {
+        linearHits = 0;
+        for (size_t q = 0; q < QUERIES; ++q) {
+            const Vec3& center = centers[q * 97 % OBJECTS];
+            for (const Aabb& box : boxes) linearHits += box.distanceSquared(center) <= 100.0f ? 1 : 0;
+        }
+    });
+    treeMs = bestOf([&] {
+        treeHits = 0;
+        for (size_t q = 0; q < QUERIES; ++q) tree.querySphere(centers[q * 97 % OBJECTS], 10.0f, [&](int32_t) { ++treeHits; });
+    });
+    report("sphere r=10", linearMs, treeMs, linearHits, treeHits);
+
+    // Fat boxes make the tree's results a superset of the exact ones
+    printf("  (tree results use fat boxes, margin %.2f)\n", tree.getMargin());
+
+    printf("\nMoving every object\n");
+    for (float step : { 0.02f, 1.0f }) {
+        size_t reinserted = 0;
+        double ms = bestOf([&] {
+            reinserted = 0;
+            for (size_t i = 0; i < OBJECTS; ++i) {
+                centers[i] += Vec3(randomFloat(), randomFloat(), randomFloat()) * step;
+                boxes[i] = boxAt(centers[i], boxes[i].extents().x);
+                reinserted += tree.moveProxy(proxies[i], boxes[i]) ? 1 : 0;
+            }
+        });
+        printf("  step %-5.2f %9.3f ms, %zu reinserted, height %d\n", step, ms, reinserted, tree.getHeight());
+    }
+
+    // The viewport's case: the whole draw list against one camera, with a
+    // few percent of it in view
+    BoundsSoA bounds;
+    for (const Aabb& box : boxes) bounds.add(box, length(box.extents()));
+    Frustum camera = frustums[0];
+    std::vector<uint32_t> visible(OBJECTS);
+    printf("\nCulling %zu objects against one frustum\n", OBJECTS);
+    size_t count = 0;
+    double ms = bestOf([&] {
+        count = 0;
+        for (size_t i = 0; i < OBJECTS; ++i) {
+            if (camera.intersects(boxes[i])) visible[count++] = (uint32_t)i;
+        }
+    });
+    printf("  %-16s %8.3f ms, %zu visible\n", "one at a time", ms, count);
+    for (int level = 0; level <= (int)getSupportedSimdLevel(); ++level) {
+        setSimdLevel((SimdLevel)level);
+        double sphereMs = bestOf([&] { count = cullSpheres(camera, bounds, 0, OBJECTS, visible.data()); });
+        size_t sphereCount = count;
+        ms = bestOf([&] { count = cullBoxes(camera, bounds, 0, OBJECTS, visible.data()); });
+        printf("  %-16s %8.3f ms, %zu visible (spheres %.3f ms, %zu visible)\n",
+               getSimdLevelName(getSimdLevel()), ms, count, sphereMs, sphereCount);
+    }
+
+    // Same chunking as RenderListSystem::cull
+    const size_t chunk = 4096, chunks = (OBJECTS + chunk - 1) / chunk;
+    std::vector<size_t> chunkVisible(chunks);
+    JobSystem jobs;
+    ms = bestOf([&] {
+        jobs.parallelFor(chunks, [&](size_t begin, size_t end) {
+            for (size_t c = begin; c < end; ++c) {
+                chunkVisible[c] = cullBoxes(camera, bounds, c * chunk, std::min((c + 1) * chunk, OBJECTS), visible.data() + c * chunk);
+            }
+        });
+    });
+    count = 0;
+    for (size_t c : chunkVisible) count += c;
+    printf("  %-16s %8.3f ms, %zu visible (%u threads, chunks of %zu)\n", "parallel", ms, count, jobs.getThreadCount(), chunk);
+
+    // Point queries as gameplay and light assignment make them, around
+    // random objects; boxes moved above are back on their band
+    for (size_t i = 0; i < OBJECTS; ++i) {
+        centers[i] = Vec3(randomFloat() * WORLD, randomFloat() * 20.0f, randomFloat() * WORLD);
+        boxes[i] = boxAt(centers[i], boxes[i].extents().x);
+        tree.moveProxy(proxies[i], boxes[i]);
+    }
+    SpatialHash grid(16.0f);
+    std::vector<uint32_t> items(OBJECTS);
+    buildMs = bestOf([&] {
+        grid.clear();
+        for (size_t i = 0; i < OBJECTS; ++i) items[i] = grid.insert(boxes[i], (uint32_t)i);
+    });
+    printf("\nSpatial hash, cells of %.0f: built in %.2f ms, %zu cells occupied\n", grid.getCellSize(), buildMs,
+           grid.getOccupiedCellCount());
+
+    const size_t POINT_QUERIES = 100000;
+    std::vector<Vec3> points(POINT_QUERIES);
+    for (size_t q = 0; q < POINT_QUERIES; ++q) points[q] = centers[(q * 7919) % OBJECTS];
+    auto perSecond = [&](double ms) { return POINT_QUERIES / ms * 1000.0; };
+    for (float radius : { 4.0f, 10.0f }) {
+        double hashMs = bestOf([&] {
+            treeHits = 0;
+            for (const Vec3& p : points) grid.queryRadius(p, radius, [&](uint32_t) { ++treeHits; });
+        });
+        size_t hashHits = treeHits;
+        treeMs = bestOf([&] {
+            treeHits = 0;
+            for (const Vec3& p : points) tree.querySphere(p, radius, [&](int32_t) { ++treeHits; });
+        });
+        printf("  radius %-9.0f %6.2f M/s (tree %5.2f M/s), %.1f results each (tree %.1f, fat boxes)\n", radius,
+               perSecond(hashMs) / 1e6, perSecond(treeMs) / 1e6, (double)hashHits / POINT_QUERIES,
+               (double)treeHits / POINT_QUERIES);
+    }
+    SpatialHash::Neighbor nearest[8];
+    ms = bestOf([&] {
+        count = 0;
+        for (const Vec3& p : points) count += grid.queryNearest(p, 8, 50.0f, nearest);
+    });
+    printf("  %-16s %6.2f M/s, %.1f found each\n", "8 nearest", perSecond(ms) / 1e6, (double)count / POINT_QUERIES);
+
+    // The same points handed over at once, run in cell order
+    for (float radius : { 4.0f, 10.0f }) {
+        ms = bestOf([&] {
+            count = 0;
+            grid.queryRadius(points.data(), POINT_QUERIES, radius, [&](size_t, uint32_t) { ++count; });
+        });
+        printf("  batch radius %-3.0f %6.2f M/s, %.1f results each\n", radius, perSecond(ms) / 1e6,
+               (double)count / POINT_QUERIES);
+    }
+    std::vector<SpatialHash::Neighbor> batchNearest(POINT_QUERIES * 8);
+    std::vector<uint32_t> batchFound(POINT_QUERIES);
+    ms = bestOf([&] { grid.queryNearest(points.data(), POINT_QUERIES, 8, 50.0f, batchNearest.data(), batchFound.data()); });
+    count = 0;
+    for (uint32_t found : batchFound) count += found;
+    printf("  %-16s %6.2f M/s, %.1f found each\n", "batch 8 nearest", perSecond(ms) / 1e6, (double)count / POINT_QUERIES);
+    ms = bestOf([&] {
+        count = 0;
+        for (const Vec3& p : points) count += grid.countInCell(p);
+    });
+    printf("  %-16s %6.2f M/s, %.1f per cell\n", "cell count", perSecond(ms) / 1e6, (double)count / POINT_QUERIES);
+
+    // Queries are const, so threads can share the grid
+    ms = bestOf([&] {
+        jobs.parallelFor(POINT_QUERIES, [&](size_t begin, size_t end) {
+            size_t hits = 0;
+            for (size_t q = begin; q < end; ++q) grid.queryRadius(points[q], 4.0f, [&](uint32_t) { ++hits; });
+            visible[begin % OBJECTS] = (uint32_t)hits; // Keep the work observable
+        }, 1024);
+    });
+    printf("  %-16s %6.2f M/s (%u threads)\n", "radius 4, parallel", perSecond(ms) / 1e6, jobs.getThreadCount());
+
+    for (float step : { 0.02f, 1.0f }) {
+        size_t moved = 0;
+        ms = bestOf([&] {
+            moved = 0;
+            for (size_t i = 0; i < OBJECTS; ++i) {
+                centers[i] += Vec3(randomFloat(), randomFloat(), randomFloat()) * step;
+                boxes[i] = boxAt(centers[i], boxes[i].extents().x);
+                moved += grid.move(items[i], boxes[i]) ? 1 : 0;
+            }
+        });
+        printf("  move step %-5.2f %8.3f ms, %zu changed cell\n", step, ms, moved);
+    }
+    return 0;
+}
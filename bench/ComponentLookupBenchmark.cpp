@@ -0,0 +1,98 @@
+// Compares component lookups through the old per-object typeid/unordered_map
+// storage with the registry's dense type IDs and per-entity bitmasks.
+#include "GameObject.h"
+#include "components/TransformComponent.h"
+#include "components/LightComponent.h"
+#include "components/MaterialComponent.h"
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <typeindex>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+    // Replica of the previous GameObject storage layout
+    class LegacyGameObject {
+    public:
+        template<typename T>
+        T* addComponent() {
+            auto component = std::make_unique<T>();
+            T* ptr = component.get();
+            componentMap_[std::type_index(typeid(T))] = ptr;
+            components_.push_back(std::move(component));
+            return ptr;
+        }
+
+        template<typename T>
+        T* getComponent() {
+            auto it = componentMap_.find(std::type_index(typeid(T)));
+            return it != componentMap_.end() ? static_cast<T*>(it->second) : nullptr;
+        }
+
+        template<typename T>
+        bool hasComponent() {
+            return componentMap_.find(std::type_index(typeid(T))) != componentMap_.end();
+        }
+
+    private:
+        std::vector<std::unique_ptr<Component>> components_;
+        std::unordered_map<std::type_index, Component*> componentMap_;
+    };
+
+    constexpr int ITERATIONS = 20;
+
+    // Same access pattern as the render loop: transform, optional light, material test
+    template<typename Object>
+    double runLookups(std::vector<std::unique_ptr<Object>>& objects, float& sink) {
+        auto start = std::chrono::high_resolution_clock::now();
+        for (int iter = 0; iter < ITERATIONS; ++iter) {
+            for (auto& go : objects) {
+                sink += (float)go->template getComponent<TransformComponent>()->getSlot();
+                if (auto* light = go->template getComponent<LightComponent>()) sink += light->range;
+                if (go->template hasComponent<MaterialComponent>()) sink += 1.0f;
+            }
+        }
+        auto end = std::chrono::high_resolution_clock::now();
+        double lookups = (double)objects.size() * ITERATIONS * 3;
+        return std::chrono::duration<double, std::nano>(end - start).count() / lookups;
+    }
+}
+
+int main() {
+    const size_t counts[] = { 1000, 10000, 100000 };
+    float sink = 0.0f;
+
+    printf("%10s %16s %16s %10s\n", "objects", "typeid ns/op", "dense ns/op", "speedup");
+    for (size_t count : counts) {
+        std::vector<std::unique_ptr<LegacyGameObject>> legacy;
+        TransformStore transforms;
+        EntityRegistry registry;
+        std::vector<std::unique_ptr<GameObject>> objects;
+        legacy.reserve(count);
+        objects.reserve(count);
+
+        for (size_t i = 0; i < count; ++i) {
+            auto old = std::make_unique<LegacyGameObject>();
+            old->addComponent<TransformComponent>();
+            auto go = std::make_unique<GameObject>(registry, transforms);
+            if (i % 4 == 0) {
+                old->addComponent<LightComponent>();
+                go->addComponent<LightComponent>();
+            }
+            if (i % 2 == 0) {
+                old->addComponent<MaterialComponent>();
+                go->addComponent<MaterialComponent>();
+            }
+            legacy.push_back(std::move(old));
+            objects.push_back(std::move(go));
+        }
+
+        double legacyNs = runLookups(legacy, sink);
+        double denseNs = runLookups(objects, sink);
+        printf("%10zu %16.2f %16.2f %9.2fx\n", count, legacyNs, denseNs, legacyNs / denseNs);
+    }
+
+    // Keep the optimizer from discarding the loops
+    return sink == 12345.0f ? 1 : 0;
+}
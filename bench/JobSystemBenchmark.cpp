@@ -0,0 +1,98 @@
+// Scaling of the work-stealing job system from one thread up to every core:
+// a compute-bound parallelFor, many tiny dependent jobs, and a full
+// TransformStore update of a large hierarchy.
+#include "JobSystem.h"
+#include "TransformStore.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+namespace {
+    constexpr size_t KERNEL_ITEMS = 1 << 22;
+    constexpr size_t TINY_JOBS = 100000;
+    constexpr uint32_t ROOTS = 1000;
+    constexpr uint32_t CHILDREN_PER_ROOT = 199;
+    constexpr int REPEATS = 5;
+
+    template<typename F>
+    double bestOf(F&& f) {
+        double best = 1e30;
+        for (int r = 0; r < REPEATS; ++r) {
+            auto start = std::chrono::high_resolution_clock::now();
+            f();
+            auto end = std::chrono::high_resolution_clock::now();
+            best = std::min(best, std::chrono::duration<double, std::milli>(end - start).count());
+        }
+        return best;
+    }
+}
+
+// Usage: JobSystemBenchmark [max threads] (defaults to the hardware thread count)
+int main(int argc, char** argv) {
+    unsigned maxThreads = std::max(1u, std::thread::hardware_concurrency());
+    if (argc > 1) maxThreads = (unsigned)std::max(1, std::atoi(argv[1]));
+
+    std::vector<float> data(KERNEL_ITEMS);
+    for (size_t i = 0; i < data.size(); ++i) data[i] = (float)i * 0.001f;
+
+    // 200k transforms: 1000 roots with 199 children each
+    TransformStore transforms;
+    transforms.reserve(ROOTS * (CHILDREN_PER_ROOT + 1));
+    std::vector<uint32_t> slots;
+    for (uint32_t r = 0; r < ROOTS; ++r) {
+        uint32_t root = transforms.allocate(r);
+        slots.push_back(root);
+        for (uint32_t c = 0; c < CHILDREN_PER_ROOT; ++c) {
+            uint32_t child = transforms.allocate(r);
+            transforms.setParent(child, root);
+            transforms.posX[child] = (float)c;
+            slots.push_back(child);
+        }
+    }
+    transforms.updateWorldMatrices();
+
+    printf("%8s %14s %8s %14s %8s %16s %8s\n",
+           "threads", "parallelFor ms", "speedup", "tiny jobs ms", "speedup", "transforms ms", "speedup");
+    double base[3] = { 0.0, 0.0, 0.0 };
+    for (unsigned threads = 1; threads <= maxThreads; ++threads) {
+        JobSystem jobs((int)threads - 1);
+        transforms.setJobSystem(&jobs);
+
+        double kernel = bestOf([&]() {
+            jobs.parallelFor(data.size(), [&](size_t begin, size_t end) {
+                for (size_t i = begin; i < end; ++i) data[i] = std::sqrt(std::sin(data[i]) * std::sin(data[i]) + 1.0f);
+            });
+        });
+
+        // Two waves of tiny jobs, the second depending on the first
+        double tiny = bestOf([&]() {
+            JobCounter first, second;
+            for (size_t i = 0; i < TINY_JOBS / 2; ++i) {
+                jobs.run([&data, i]() { data[i] += 1.0f; }, &first);
+            }
+            jobs.runAfter(first, [&]() {
+                for (size_t i = TINY_JOBS / 2; i < TINY_JOBS; ++i) {
+                    jobs.run([&data, i]() { data[i] += 1.0f; }, &second);
+                }
+            }, &second);
+            jobs.wait(second);
+        });
+
+        double update = bestOf([&]() {
+            for (uint32_t slot : slots) transforms.markDirty(slot);
+            transforms.updateWorldMatrices();
+        });
+
+        if (threads == 1) {
+            base[0] = kernel; base[1] = tiny; base[2] = update;
+        }
+        printf("%8u %14.2f %7.2fx %14.2f %7.2fx %16.2f %7.2fx\n", threads,
+               kernel, base[0] / kernel, tiny, base[1] / tiny, update, base[2] / update);
+        transforms.setJobSystem(nullptr);
+    }
+    return 0;
+}
@@ -0,0 +1,297 @@
+// Throughput of the math library's matrix kernels at each SIMD level against
+// the float* helpers they replaced (copied below as they were): batch matrix
+// multiply, 4x4 inverse (general, affine and rigid paths) and transforming
+// points by one matrix. Also local matrix rebuilds on one core from Euler
+// angles (the previous TransformStore path) vs quaternions, and Euler to
+// quaternion conversion.
+#include "math/Mat4.h"
+#include "TransformStore.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+namespace {
+    constexpr size_t MATRICES = 4096;
+    constexpr size_t POINTS = 1 << 16;
+    constexpr uint32_t TRANSFORMS = 100000;
+    constexpr int PASSES = 200;
+    constexpr int REPEATS = 5;
+
+    // --- Previous helpers (MathUtils.h / TransformStore.cpp) ---
+
+    void legacyMultiply(const float* a, const float* b, float* out) {
+        for (int c = 0; c < 4; ++c) {
+            for (int r = 0; r < 4; ++r) {
+                out[c * 4 + r] = a[r] * b[c * 4] + a[4 + r] * b[c * 4 + 1]
+                               + a[8 + r] * b[c * 4 + 2] + a[12 + r] * b[c * 4 + 3];
+            }
+        }
+    }
+
+    bool legacyInvert(const float* m, float* out) {
+        float inv[16];
+        inv[0] = m[5]*m[10]*m[15] - m[5]*m[11]*m[14] - m[9]*m[6]*m[15] +
+                 m[9]*m[7]*m[14] + m[13]*m[6]*m[11] - m[13]*m[7]*m[10];
+        inv[4] = -m[4]*m[10]*m[15] + m[4]*m[11]*m[14] + m[8]*m[6]*m[15] -
+                 m[8]*m[7]*m[14] - m[12]*m[6]*m[11] + m[12]*m[7]*m[10];
+        inv[8] = m[4]*m[9]*m[15] - m[4]*m[11]*m[13] - m[8]*m[5]*m[15] +
+                 m[8]*m[7]*m[13] + m[12]*m[5]*m[11] - m[12]*m[7]*m[9];
+        inv[12] = -m[4]*m[9]*m[14] + m[4]*m[10]*m[13] + m[8]*m[5]*m[14] -
+                  m[8]*m[6]*m[13] - m[12]*m[5]*m[10] + m[12]*m[6]*m[9];
+        inv[1] = -m[1]*m[10]*m[15] + m[1]*m[11]*m[14] + m[9]*m[2]*m[15] -
+                 m[9]*m[3]*m[14] - m[13]*m[2]*m[11] + m[13]*m[3]*m[10];
+        inv[5] = m[0]*m[10]*m[15] - m[0]*m[11]*m[14] - m[8]*m[2]*m[15] +
+                 m[8]*m[3]*m[14] + m[12]*m[2]*m[11] - m[12]*m[3]*m[10];
+        inv[9] = -m[0]*m[9]*m[15] + m[0]*m[11]*m[13] + m[8]*m[1]*m[15] -
+                 m[8]*m[3]*m[13] - m[12]*m[1]*m[11] + m[12]*m[3]*m[9];
+        inv[13] = m[0]*m[9]*m[14] - m[0]*m[10]*m[13] - m[8]*m[1]*m[14] +
+                  m[8]*m[2]*m[13] + m[12]*m[1]*m[10] - m[12]*m[2]*m[9];
+        inv[2] = m[1]*m[6]*m[15] - m[1]*m[7]*m[14] - m[5]*m[2]*m[15] +
+                 m[5]*m[3]*m[14] + m[13]*m[2]*m[7] - m[13]*m[3]*m[6];
+        inv[6] = -m[0]*m[6]*m[15] + m[0]*m[7]*m[14] + m[4]*m[2]*m[15] -
+                 m[4]*m[3]*m[14] - m[12]*m[2]*m[7] + m[12]*m[3]*m[6];
+        inv[10] = m[0]*m[5]*m[15] - m[0]*m[7]*m[13] - m[4]*m[1]*m[15] +
+                  m[4]*m[3]*m[13] + m[12]*m[1]*m[7] - m[12]*m[3]*m[5];
+        inv[14] = -m[0]*m[5]*m[14] + m[0]*m[6]*m[13] + m[4]*m[1]*m[14] -
+                  m[4]*m[2]*m[13] - m[12]*m[1]*m[6] + m[12]*m[2]*m[5];
+        inv[3] = -m[1]*m[6]*m[11] + m[1]*m[7]*m[10] + m[5]*m[2]*m[11] -
+                 m[5]*m[3]*m[10] - m[9]*m[2]*m[7] + m[9]*m[3]*m[6];
+        inv[7] = m[0]*m[6]*m[11] - m[0]*m[7]*m[10] - m[4]*m[2]*m[11] +
+                 m[4]*m[3]*m[10] + m[8]*m[2]*m[7] - m[8]*m[3]*m[6];
+        inv[11] = -m[0]*m[5]*m[11] + m[0]*m[7]*m[9] + m[4]*m[1]*m[11] -
+                  m[4]*m[3]*m[9] - m[8]*m[1]*m[7] + m[8]*m[3]*m[5];
+        inv[15] = m[0]*m[5]*m[10] - m[0]*m[6]*m[9] - m[4]*m[1]*m[10] +
+                  m[4]*m[2]*m[9] + m[8]*m[1]*m[6] - m[8]*m[2]*m[5];
+
+        float det = m[0]*inv[0] + m[1]*inv[4] + m[2]*inv[8] + m[3]*inv[12];
+        if (fabs(det) < 1e-6f) return false;
+
+        det = 1.0f / det;
+        for (int i = 0; i < 16; i++) out[i] = inv[i] * det;
+        return true;
+    }
+
+    // Per-vertex loop the picking code used
+    void legacyTransformPoints(const float* model, const float* in, float* out, size_t count) {
+        for (size_t i = 0; i < count; ++i) {
+            const float* p = in + i * 3;
+            float* o = out + i * 3;
+            o[0] = model[0]*p[0] + model[4]*p[1] + model[8]*p[2] + model[12];
+            o[1] = model[1]*p[0] + model[5]*p[1] + model[9]*p[2] + model[13];
+            o[2] = model[2]*p[0] + model[6]*p[1] + model[10]*p[2] + model[14];
+        }
+    }
+
+    // Previous TransformStore local matrix build: Euler degrees and six
+    // sinf/cosf per object, four objects at a time. The original then did the
+    // matrix entries in SSE; they are scalar here, as the trig dominates.
+    void legacyEulerBuild4(const float* const soa[9], const uint32_t* s, Mat4* out) {
+        constexpr float DEG_TO_RAD = 3.14159265358979323846f / 180.0f;
+        alignas(16) float cosX[4], sinX[4], cosY[4], sinY[4], cosZ[4], sinZ[4];
+        for (int l = 0; l < 4; ++l) {
+            float rx = soa[3][s[l]] * DEG_TO_RAD;
+            float ry = soa[4][s[l]] * DEG_TO_RAD;
+            float rz = soa[5][s[l]] * DEG_TO_RAD;
+            cosX[l] = cosf(rx); sinX[l] = sinf(rx);
+            cosY[l] = cosf(ry); sinY[l] = sinf(ry);
+            cosZ[l] = cosf(rz); sinZ[l] = sinf(rz);
+        }
+        Mat4 lanes[4];
+        for (int l = 0; l < 4; ++l) {
+            float sx = soa[6][s[l]], sy = soa[7][s[l]], sz = soa[8][s[l]];
+            float* m = lanes[l].m;
+            m[0] = cosY[l] * cosZ[l] * sx;
+            m[1] = (sinX[l] * sinY[l] * cosZ[l] - cosX[l] * sinZ[l]) * sx;
+            m[2] = (cosX[l] * sinY[l] * cosZ[l] + sinX[l] * sinZ[l]) * sx;
+            m[4] = cosY[l] * sinZ[l] * sy;
+            m[5] = (sinX[l] * sinY[l] * sinZ[l] + cosX[l] * cosZ[l]) * sy;
+            m[6] = (cosX[l] * sinY[l] * sinZ[l] - sinX[l] * cosZ[l]) * sy;
+            m[8] = -sinY[l] * sz;
+            m[9] = sinX[l] * cosY[l] * sz;
+            m[10] = cosX[l] * cosY[l] * sz;
+            m[12] = soa[0][s[l]]; m[13] = soa[1][s[l]]; m[14] = soa[2][s[l]]; m[15] = 1.0f;
+            out[s[l]] = lanes[l];
+        }
+    }
+
+    // ---
+
+    template<typename F>
+    double bestOf(F&& f) {
+        double best = 1e30;
+        for (int r = 0; r < REPEATS; ++r) {
+            auto start = std::chrono::high_resolution_clock::now();
+            f();
+            auto end = std::chrono::high_resolution_clock::now();
+            best = std::min(best, std::chrono::duration<double, std::milli>(end - start).count());
+        }
+        return best;
+    }
+
+    float randomFloat() {
+        return (float)std::rand() / (float)RAND_MAX * 2.0f - 1.0f;
+    }
+
+    // Keeps results observable so the loops aren't optimized away
+    volatile float sink;
+
+    void report(const char* name, size_t items, double ms) {
+        printf("  %-16s %10.3f ms %10.1f M/s\n", name, ms, (double)items / (ms * 1000.0));
+    }
+}
+
+int main() {
+    // Well-conditioned TRS matrices, as the engine produces
+    std::vector<Mat4> a(MATRICES), b(MATRICES), rigid(MATRICES), out(MATRICES);
+    for (size_t i = 0; i < MATRICES; ++i) {
+        Vec3 t(randomFloat() * 10.0f, randomFloat() * 10.0f, randomFloat() * 10.0f);
+        Vec3 r(randomFloat() * 3.0f, randomFloat() * 3.0f, randomFloat() * 3.0f);
+        Vec3 s(randomFloat() + 1.5f, randomFloat() + 1.5f, randomFloat() + 1.5f);
+        a[i] = Mat4::fromEulerTRS(t, r, s);
+        b[i] = Mat4::fromEulerTRS(s, t * 0.1f, Vec3(1.0f, 1.0f, 1.0f));
+        rigid[i] = Mat4::fromEulerTRS(t, r, Vec3(1.0f, 1.0f, 1.0f));
+    }
+    std::vector<Vec3> points(POINTS), transformed(POINTS);
+    for (Vec3& p : points) p = Vec3(randomFloat(), randomFloat(), randomFloat());
+    const Mat4& model = a[0];
+
+    const size_t multiplies = MATRICES * PASSES;
+    const size_t inverses = MATRICES * PASSES;
+    const size_t pointCount = POINTS * PASSES;
+
+    printf("Supported SIMD level: %s\n", getSimdLevelName(getSupportedSimdLevel()));
+    printf("%zu matrices / %zu points, %d passes, best of %d\n\n", MATRICES, POINTS, PASSES, REPEATS);
+
+    printf("Matrix multiply\n");
+    report("legacy", multiplies, bestOf([&] {
+        for (int p = 0; p < PASSES; ++p) {
+            for (size_t i = 0; i < MATRICES; ++i) legacyMultiply(a[i].m, b[i].m, out[i].m);
+        }
+        sink = out[MATRICES - 1].m[0];
+    }));
+    report("operator*", multiplies, bestOf([&] {
+        for (int p = 0; p < PASSES; ++p) {
+            for (size_t i = 0; i < MATRICES; ++i) out[i] = a[i] * b[i];
+        }
+        sink = out[MATRICES - 1].m[0];
+    }));
+    for (int level = 0; level <= (int)getSupportedSimdLevel(); ++level) {
+        setSimdLevel((SimdLevel)level);
+        report(getSimdLevelName(getSimdLevel()), multiplies, bestOf([&] {
+            for (int p = 0; p < PASSES; ++p) Mat4::multiply(a.data(), b.data(), out.data(), MATRICES);
+            sink = out[MATRICES - 1].m[0];
+        }));
+    }
+
+    // Inverse has no AVX2 path; AVX2 runs the SSE2 code. The general path on
+    // the TRS matrices, then the affine and rigid paths on the same matrices
+    // (rigid ones without scale), and the untagged call that classifies first.
+    printf("\nInverse\n");
+    report("legacy", inverses, bestOf([&] {
+        for (int p = 0; p < PASSES; ++p) {
+            for (size_t i = 0; i < MATRICES; ++i) legacyInvert(a[i].m, out[i].m);
+        }
+        sink = out[MATRICES - 1].m[0];
+    }));
+    struct InverseCase { const char* name; const std::vector<Mat4>* input; MatrixKind kind; bool tagged; };
+    const InverseCase inverseCases[] = {
+        { "general", &a, MatrixKind::General, true },
+        { "affine", &a, MatrixKind::Affine, true },
+        { "rigid", &rigid, MatrixKind::Rigid, true },
+        { "untagged", &a, MatrixKind::General, false },
+    };
+    for (int level = 0; level <= (int)std::min(getSupportedSimdLevel(), SimdLevel::SSE2); ++level) {
+        setSimdLevel((SimdLevel)level);
+        for (const InverseCase& c : inverseCases) {
+            char name[32];
+            snprintf(name, sizeof(name), "%s %s", getSimdLevelName(getSimdLevel()), c.name);
+            const std::vector<Mat4>& input = *c.input;
+            report(name, inverses, bestOf([&] {
+                for (int p = 0; p < PASSES; ++p) {
+                    if (c.tagged) {
+                        for (size_t i = 0; i < MATRICES; ++i) input[i].inverse(out[i], c.kind);
+                    } else {
+                        for (size_t i = 0; i < MATRICES; ++i) input[i].inverse(out[i]);
+                    }
+                }
+                sink = out[MATRICES - 1].m[0];
+            }));
+        }
+    }
+
+    printf("\nTransform points\n");
+    report("legacy", pointCount, bestOf([&] {
+        for (int p = 0; p < PASSES; ++p) {
+            legacyTransformPoints(model.m, &points[0].x, &transformed[0].x, POINTS);
+        }
+        sink = transformed[POINTS - 1].x;
+    }));
+    for (int level = 0; level <= (int)getSupportedSimdLevel(); ++level) {
+        setSimdLevel((SimdLevel)level);
+        report(getSimdLevelName(getSimdLevel()), pointCount, bestOf([&] {
+            for (int p = 0; p < PASSES; ++p) model.transformPoints(points.data(), transformed.data(), POINTS);
+            sink = transformed[POINTS - 1].x;
+        }));
+    }
+    setSimdLevel(getSupportedSimdLevel());
+
+    // Root transforms only, so the world pass is a copy and the build dominates
+    printf("\nLocal matrix rebuild, one thread (%u transforms)\n", TRANSFORMS);
+    TransformStore store;
+    store.reserve(TRANSFORMS);
+    std::vector<uint32_t> slots(TRANSFORMS);
+    std::vector<float> soa[9];
+    for (auto& v : soa) v.resize(TRANSFORMS);
+    for (uint32_t i = 0; i < TRANSFORMS; ++i) {
+        uint32_t s = store.allocate(i);
+        slots[i] = s;
+        Vec3 degrees(randomFloat() * 180.0f, randomFloat() * 180.0f, randomFloat() * 180.0f);
+        Quat q = Quat::fromEuler(degrees * (3.14159265f / 180.0f));
+        store.posX[s] = soa[0][s] = randomFloat() * 100.0f;
+        store.posY[s] = soa[1][s] = randomFloat() * 100.0f;
+        store.posZ[s] = soa[2][s] = randomFloat() * 100.0f;
+        soa[3][s] = degrees.x; soa[4][s] = degrees.y; soa[5][s] = degrees.z;
+        store.rotX[s] = q.x; store.rotY[s] = q.y; store.rotZ[s] = q.z; store.rotW[s] = q.w;
+        store.scaleX[s] = soa[6][s] = 1.0f;
+        store.scaleY[s] = soa[7][s] = 1.0f;
+        store.scaleZ[s] = soa[8][s] = 1.0f;
+    }
+    store.updateWorldMatrices();
+    const size_t rebuilds = (size_t)TRANSFORMS * 10;
+    std::vector<Mat4> legacyLocal(TRANSFORMS), legacyWorld(TRANSFORMS);
+    const float* const columns[9] = { soa[0].data(), soa[1].data(), soa[2].data(), soa[3].data(), soa[4].data(),
+                                      soa[5].data(), soa[6].data(), soa[7].data(), soa[8].data() };
+    report("Euler", rebuilds, bestOf([&] {
+        for (int p = 0; p < 10; ++p) {
+            for (uint32_t i = 0; i + 4 <= TRANSFORMS; i += 4) legacyEulerBuild4(columns, slots.data() + i, legacyLocal.data());
+            for (uint32_t i = 0; i < TRANSFORMS; ++i) legacyWorld[i] = legacyLocal[i];
+        }
+        sink = legacyWorld[TRANSFORMS - 1].m[0];
+    }));
+    report("Quat", rebuilds, bestOf([&] {
+        for (int p = 0; p < 10; ++p) {
+            for (uint32_t s : slots) store.markDirty(s);
+            store.updateWorldMatrices();
+        }
+        sink = store.getWorldMatrix(slots[TRANSFORMS - 1]).m[0];
+    }));
+
+    printf("\nEuler to quaternion (%u rotations)\n", TRANSFORMS);
+    std::vector<Vec3> radians(TRANSFORMS);
+    std::vector<Quat> quats(TRANSFORMS);
+    for (Vec3& r : radians) r = Vec3(randomFloat() * 3.0f, randomFloat() * 3.0f, randomFloat() * 3.0f);
+    report("sinf/cosf", rebuilds, bestOf([&] {
+        for (int p = 0; p < 10; ++p) {
+            for (uint32_t i = 0; i < TRANSFORMS; ++i) quats[i] = Quat::fromEuler(radians[i]);
+        }
+        sink = quats[TRANSFORMS - 1].x;
+    }));
+    report("sinCos4", rebuilds, bestOf([&] {
+        for (int p = 0; p < 10; ++p) Quat::fromEuler(radians.data(), quats.data(), TRANSFORMS);
+        sink = quats[TRANSFORMS - 1].x;
+    }));
+    return 0;
+}
@@ -0,0 +1,193 @@
+// Ray-triangle throughput on one core: the per-triangle Möller–Trumbore the
+// picking code used (copied below as it was, over AoS vertices) against the
+// SoA kernels in math/Raycast.h at each SIMD level, one ray against many
+// triangles and packets of 8 coherent rays against one triangle at a time.
+// Then picking rays against UV spheres of growing detail, brute force vs a BVH.
+#include "math/Bvh.h"
+#include "math/Raycast.h"
+#include "math/Simd.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+namespace {
+    constexpr size_t TRIANGLES = 1 << 14;
+    constexpr size_t RAYS = 256; // A 16x16 pixel tile
+    constexpr int REPEATS = 5;
+
+    // --- Previous helper (MathUtils.h) ---
+
+    bool legacyRayTriangleIntersect(const Vec3& rayOrigin, const Vec3& rayDir,
+                                    const Vec3& v0, const Vec3& v1, const Vec3& v2, float& t) {
+        const float EPSILON = 0.0000001f;
+        Vec3 edge1 = v1 - v0;
+        Vec3 edge2 = v2 - v0;
+        Vec3 h = cross(rayDir, edge2);
+        float a = dot(edge1, h);
+        if (a > -EPSILON && a < EPSILON) return false;
+        float f = 1.0f / a;
+        Vec3 s = rayOrigin - v0;
+        float u = f * dot(s, h);
+        if (u < 0.0f || u > 1.0f) return false;
+        Vec3 q = cross(s, edge1);
+        float v = f * dot(rayDir, q);
+        if (v < 0.0f || u + v > 1.0f) return false;
+        t = f * dot(edge2, q);
+        return t > EPSILON;
+    }
+
+    // ---
+
+    template<typename F>
+    double bestOf(F&& f) {
+        double best = 1e30;
+        for (int r = 0; r < REPEATS; ++r) {
+            auto start = std::chrono::high_resolution_clock::now();
+            f();
+            auto end = std::chrono::high_resolution_clock::now();
+            best = std::min(best, std::chrono::duration<double, std::milli>(end - start).count());
+        }
+        return best;
+    }
+
+    float randomFloat() {
+        return (float)std::rand() / (float)RAND_MAX * 2.0f - 1.0f;
+    }
+
+    // Keeps results observable so the loops aren't optimized away
+    volatile float sink;
+
+    // Triangle list of a UV sphere of radius 1, like the editor's sphere mesh
+    std::vector<Vec3> sphereTriangles(int segments) {
+        const float pi = 3.14159265358979323846f;
+        auto point = [&](int ring, int segment) {
+            float theta = pi * (float)ring / (float)segments, phi = 2.0f * pi * (float)segment / (float)segments;
+            return Vec3(std::sin(theta) * std::cos(phi), std::cos(theta), std::sin(theta) * std::sin(phi));
+        };
+        std::vector<Vec3> vertices;
+        for (int r = 0; r < segments; ++r) {
+            for (int s = 0; s < segments; ++s) {
+                Vec3 a = point(r, s), b = point(r + 1, s), c = point(r + 1, s + 1), d = point(r, s + 1);
+                vertices.insert(vertices.end(), { a, b, c, a, c, d });
+            }
+        }
+        return vertices;
+    }
+
+    void report(const char* name, size_t tests, double ms, size_t hits) {
+        printf("  %-12s %10.3f ms %10.1f M tests/s  (%zu hits)\n", name, ms, (double)tests / (ms * 1000.0), hits);
+    }
+}
+
+int main() {
+    // Small triangles scattered through a 20-unit box, as a dense mesh would be
+    std::vector<Vec3> vertices(TRIANGLES * 3);
+    for (size_t i = 0; i < TRIANGLES; ++i) {
+        Vec3 center(randomFloat() * 10.0f, randomFloat() * 10.0f, randomFloat() * 10.0f);
+        for (int k = 0; k < 3; ++k) {
+            vertices[i * 3 + k] = center + Vec3(randomFloat(), randomFloat(), randomFloat()) * 0.5f;
+        }
+    }
+    TriangleSoA triangles;
+    triangles.assign(vertices.data(), vertices.size());
+
+    // A tile of neighbouring camera rays looking into the box
+    std::vector<Ray> rays(RAYS);
+    for (size_t i = 0; i < RAYS; ++i) {
+        float x = ((float)(i % 16) - 7.5f) * 0.02f;
+        float y = ((float)(i / 16) - 7.5f) * 0.02f;
+        rays[i] = Ray{ Vec3(0.0f, 0.0f, 25.0f), normalize(Vec3(x, y, -1.0f)) };
+    }
+    std::vector<RayPacket> packets(RAYS / RayPacket::MAX_RAYS);
+    for (size_t i = 0; i < RAYS; ++i) packets[i / RayPacket::MAX_RAYS].add(rays[i]);
+
+    const size_t tests = TRIANGLES * RAYS;
+    std::vector<RayHit> hits(RAYS);
+    auto countHits = [&] {
+        size_t count = 0;
+        for (const RayHit& hit : hits) count += hit.hit() ? 1 : 0;
+        sink = hits[0].t;
+        return count;
+    };
+
+    printf("Supported SIMD level: %s\n", getSimdLevelName(getSupportedSimdLevel()));
+    printf("%zu triangles x %zu rays, best of %d\n\n", TRIANGLES, RAYS, REPEATS);
+
+    printf("One ray, many triangles\n");
+    double ms = bestOf([&] {
+        for (size_t r = 0; r < RAYS; ++r) {
+            RayHit hit;
+            for (size_t i = 0; i < TRIANGLES; ++i) {
+                float t;
+                if (legacyRayTriangleIntersect(rays[r].origin, rays[r].direction,
+                                               vertices[i * 3], vertices[i * 3 + 1], vertices[i * 3 + 2], t) && t < hit.t) {
+                    hit.t = t;
+                    hit.triangle = (uint32_t)i;
+                }
+            }
+            hits[r] = hit;
+        }
+    });
+    report("legacy", tests, ms, countHits());
+    for (int level = 0; level <= (int)getSupportedSimdLevel(); ++level) {
+        setSimdLevel((SimdLevel)level);
+        ms = bestOf([&] {
+            for (size_t r = 0; r < RAYS; ++r) {
+                hits[r] = RayHit();
+                raycast(rays[r], triangles, 0, triangles.size(), hits[r]);
+            }
+        });
+        report(getSimdLevelName(getSimdLevel()), tests, ms, countHits());
+    }
+
+    printf("\nPackets of %zu rays, one triangle at a time\n", RayPacket::MAX_RAYS);
+    for (int level = 0; level <= (int)getSupportedSimdLevel(); ++level) {
+        setSimdLevel((SimdLevel)level);
+        ms = bestOf([&] {
+            for (size_t p = 0; p < packets.size(); ++p) {
+                RayHit* packetHits = hits.data() + p * RayPacket::MAX_RAYS;
+                for (size_t r = 0; r < RayPacket::MAX_RAYS; ++r) packetHits[r] = RayHit();
+                raycast(packets[p], triangles, 0, triangles.size(), packetHits);
+            }
+        });
+        report(getSimdLevelName(getSimdLevel()), tests, ms, countHits());
+    }
+    setSimdLevel(getSupportedSimdLevel());
+
+    // Rays from around the sphere aimed near its centre, most of them hitting
+    std::vector<Ray> pickRays(RAYS);
+    for (Ray& ray : pickRays) {
+        Vec3 from = normalize(Vec3(randomFloat(), randomFloat(), randomFloat())) * 5.0f;
+        Vec3 to(randomFloat() * 0.8f, randomFloat() * 0.8f, randomFloat() * 0.8f);
+        ray = Ray{ from, normalize(to - from) };
+    }
+    printf("\nPicking a UV sphere, %zu rays (%s)\n", RAYS, getSimdLevelName(getSimdLevel()));
+    for (int segments : { 48, 128, 512 }) {
+        std::vector<Vec3> sphere = sphereTriangles(segments);
+        TriangleSoA sphereSoA;
+        sphereSoA.assign(sphere.data(), sphere.size());
+        Bvh bvh;
+        double buildMs = bestOf([&] { bvh.build(sphere.data(), sphere.size()); });
+
+        double bruteMs = bestOf([&] {
+            for (size_t r = 0; r < RAYS; ++r) {
+                hits[r] = RayHit();
+                raycast(pickRays[r], sphereSoA, 0, sphereSoA.size(), hits[r]);
+            }
+        });
+        size_t bruteHits = countHits();
+        double bvhMs = bestOf([&] {
+            for (size_t r = 0; r < RAYS; ++r) {
+                hits[r] = RayHit();
+                bvh.raycast(pickRays[r], hits[r]);
+            }
+        });
+        printf("  %7zu triangles: brute force %8.2f us/ray, BVH %6.2f us/ray (%zu nodes, built in %.2f ms), %zu/%zu hits\n",
+               bvh.getTriangleCount(), bruteMs * 1000.0 / RAYS, bvhMs * 1000.0 / RAYS,
+               bvh.getNodeCount(), buildMs, countHits(), bruteHits);
+    }
+    return 0;
+}
@@ -0,0 +1,185 @@
+// Spawns empty objects through Scene and counts heap allocations, to check
+// that GameObjects and components come out of slabs/chunks rather than one
+// malloc each. Also times entering and leaving play mode, and command
+// buffer playback, checking that folded changes come out right.
+#include "Scene.h"
+#include "GameObject.h"
+#include "components/LightComponent.h"
+#include "components/MaterialComponent.h"
+#include "components/TransformComponent.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <vector>
+
+namespace {
+    std::atomic<size_t> heapAllocations{ 0 };
+}
+
+// Count every global allocation made while the benchmark runs
+void* operator new(size_t size) {
+    heapAllocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+
+// Over-allocate and stash the malloc pointer just before the aligned block
+// (aligned_alloc isn't available everywhere, e.g. MinGW)
+void* operator new(size_t size, std::align_val_t align) {
+    heapAllocations.fetch_add(1, std::memory_order_relaxed);
+    size_t alignment = (size_t)align;
+    void* raw = std::malloc(size + alignment + sizeof(void*));
+    if (!raw) throw std::bad_alloc();
+    uintptr_t aligned = ((uintptr_t)raw + sizeof(void*) + alignment - 1) & ~(uintptr_t)(alignment - 1);
+    reinterpret_cast<void**>(aligned)[-1] = raw;
+    return reinterpret_cast<void*>(aligned);
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+void operator delete(void* p, std::align_val_t) noexcept {
+    if (p) std::free(reinterpret_cast<void**>(p)[-1]);
+}
+void operator delete(void* p, size_t, std::align_val_t) noexcept {
+    if (p) std::free(reinterpret_cast<void**>(p)[-1]);
+}
+
+int main() {
+    const size_t counts[] = { 1000, 10000, 100000 };
+
+    printf("%10s %10s %14s %12s %14s %12s\n",
+           "objects", "ms", "mallocs/obj", "pool slabs", "chunk mallocs", "live chunks");
+    for (size_t count : counts) {
+        Scene scene;
+        size_t before = heapAllocations.load();
+        auto start = std::chrono::high_resolution_clock::now();
+
+        for (size_t i = 0; i < count; ++i) {
+            GameObject* go = scene.addEmptyGameObject("GameObject", (float)i, 0.0f, 0.0f);
+            // Every fourth object changes archetype, exercising chunk reuse
+            if (i % 4 == 0) go->addComponent<LightComponent>();
+        }
+        scene.updateTransforms();
+
+        auto end = std::chrono::high_resolution_clock::now();
+        size_t mallocs = heapAllocations.load() - before;
+        Scene::AllocationStats stats = scene.getAllocationStats();
+        printf("%10zu %10.2f %14.2f %12zu %14zu %12zu\n", count,
+               std::chrono::duration<double, std::milli>(end - start).count(),
+               (double)mallocs / count, stats.gameObjectSlabAllocations,
+               stats.componentChunkAllocations, stats.liveComponentChunks);
+    }
+
+    // Batch paths: reserve once, one archetype placement per entity
+    printf("\n%10s %14s %14s %14s\n", "objects", "spawnBatch ms", "instantiate ms", "mallocs/obj");
+    for (size_t count : counts) {
+        std::vector<Scene::SpawnTransform> placements(count);
+        for (size_t i = 0; i < count; ++i) placements[i].position[0] = (float)i;
+
+        Scene scene;
+        auto start = std::chrono::high_resolution_clock::now();
+        scene.spawnBatch("GameObject", count, placements.data());
+        scene.updateTransforms();
+        auto mid = std::chrono::high_resolution_clock::now();
+
+        GameObject* prototype = scene.addEmptyGameObject("Lamp");
+        prototype->addComponent<LightComponent>();
+        prototype->addComponent<MaterialComponent>();
+        size_t before = heapAllocations.load();
+        auto instStart = std::chrono::high_resolution_clock::now();
+        scene.instantiate(prototype->getHandle(), count, placements.data());
+        scene.updateTransforms();
+        auto end = std::chrono::high_resolution_clock::now();
+        size_t mallocs = heapAllocations.load() - before;
+
+        printf("%10zu %14.2f %14.2f %14.2f\n", count,
+               std::chrono::duration<double, std::milli>(mid - start).count(),
+               std::chrono::duration<double, std::milli>(end - instStart).count(),
+               (double)mallocs / count);
+    }
+
+    // Play mode round trip. The second round reuses the snapshot buffers and
+    // restores in place; the third destroys an object during play, so exit
+    // takes the rebuild path (recreating that one GameObject).
+    printf("\n%10s %8s %12s %12s %16s\n", "objects", "round", "enter ms", "exit ms", "restored objects");
+    for (size_t count : counts) {
+        Scene scene;
+        std::vector<EntityHandle> handles = scene.spawnBatch("GameObject", count, nullptr);
+        for (size_t i = 0; i < count; i += 4) scene.getGameObject(handles[i])->addComponent<LightComponent>();
+        for (size_t i = 0; i < count; i += 8) scene.getGameObject(handles[i])->addComponent<MaterialComponent>();
+        scene.updateTransforms();
+
+        for (int round = 0; round < 3; ++round) {
+            auto start = std::chrono::high_resolution_clock::now();
+            scene.enterPlayMode();
+            auto mid = std::chrono::high_resolution_clock::now();
+
+            for (size_t i = 0; i < count; i += 2) {
+                scene.getGameObject(handles[i])->getTransform()->setPosition(1.0f, 2.0f, 3.0f);
+            }
+            if (round == 2) scene.destroyGameObject(handles[1]);
+            scene.updateTransforms();
+
+            auto exitStart = std::chrono::high_resolution_clock::now();
+            scene.exitPlayMode();
+            auto end = std::chrono::high_resolution_clock::now();
+            printf("%10zu %8d %12.2f %12.2f %16zu\n", count, round,
+                   std::chrono::duration<double, std::milli>(mid - start).count(),
+                   std::chrono::duration<double, std::milli>(end - exitStart).count(),
+                   scene.getGameObjects().size());
+        }
+    }
+
+    // Command buffer playback. New objects get the same type added twice (the
+    // last value wins); live objects remove and re-add a material that shares
+    // one copy of data, alongside a light, so they change archetype. Once the
+    // old materials are destroyed, only `shared` holds that copy.
+    printf("\n%10s %14s %10s\n", "objects", "playback ms", "check");
+    bool allPassed = true;
+    for (size_t count : counts) {
+        Scene scene;
+        std::vector<EntityHandle> handles = scene.spawnBatch("GameObject", count, nullptr);
+        CopyOnWrite<MaterialData> shared;
+        shared.edit().metallic = 1.0f;
+        for (EntityHandle handle : handles) {
+            scene.getGameObject(handle)->addComponent<MaterialComponent>()->data = shared;
+        }
+
+        CommandBuffer& commands = scene.getCommands();
+        LightComponent first, last;
+        last.intensity = 2.0f;
+        for (size_t i = 0; i < count; ++i) {
+            CommandBuffer::PendingEntity pending = commands.create("Spawned", (float)i);
+            commands.add<LightComponent>(pending, first);
+            commands.add<LightComponent>(pending, last);
+            commands.add<MaterialComponent>(pending);
+
+            commands.remove<MaterialComponent>(handles[i]);
+            commands.add<MaterialComponent>(handles[i]);
+            commands.add<LightComponent>(handles[i]);
+        }
+
+        std::vector<EntityHandle> created;
+        auto start = std::chrono::high_resolution_clock::now();
+        scene.applyCommands(&created);
+        auto end = std::chrono::high_resolution_clock::now();
+
+        bool passed = !shared.isShared();
+        for (size_t i = 0; i < count && passed; ++i) {
+            GameObject* spawned = scene.getGameObject(created[i]);
+            GameObject* changed = scene.getGameObject(handles[i]);
+            passed = spawned && spawned->hasComponent<MaterialComponent>() &&
+                     spawned->getComponent<LightComponent>() &&
+                     spawned->getComponent<LightComponent>()->intensity == 2.0f &&
+                     changed->hasComponent<LightComponent>() &&
+                     changed->getComponent<MaterialComponent>()->data.get().metallic == 0.0f;
+        }
+        allPassed = allPassed && passed;
+        printf("%10zu %14.2f %10s\n", count, std::chrono::duration<double, std::milli>(end - start).count(),
+               passed ? "ok" : "FAILED");
+    }
+    return allPassed ? 0 : 1;
+}
@@ -1,6 +1,8 @@
 #ifndef CAMERA_H
 #define CAMERA_H
 
+#include "math/Mat4.h"
+
 class Camera {
 public:
     Camera();
@@ -12,11 +14,11 @@ public:
     // Move target relative to camera orientation (forward/right) and world up
     void moveRelative(float forward, float right, float up);
     // Get computed camera world position (eye)
-    void getEyePosition(float& x, float& y, float& z) const;
+    Vec3 getEyePosition() const;
     
     // Getters
-    void getViewMatrix(float* out16) const;
-    void getProjectionMatrix(float* out16, float aspect) const;
+    Mat4 getViewMatrix() const;
+    Mat4 getProjectionMatrix(float aspect) const;
     
     // Configuration
     void setFov(float fovDegrees) { fovDegrees_ = fovDegrees; }
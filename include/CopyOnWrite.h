@@ -0,0 +1,45 @@
+#ifndef COPY_ON_WRITE_H
+#define COPY_ON_WRITE_H
+
+#include <memory>
+
+// Shared, immutable value that is copied on the first write.
+// Copying a CopyOnWrite is a reference-count bump, so thousands of objects
+// made from the same prefab share one copy of the data until one of them is
+// edited. Default-constructed handles all share a single default T.
+// The data is always allocated non-const (edit() writes it in place once it
+// is no longer shared), so construct from std::make_shared<T>.
+template<typename T>
+class CopyOnWrite {
+public:
+    CopyOnWrite() : data_(defaultValue()) {}
+    explicit CopyOnWrite(std::shared_ptr<T> data) : data_(std::move(data)) {}
+
+    const T& get() const { return *data_; }
+    const T* operator->() const { return data_.get(); }
+
+    // Mutable access; detaches from the shared copy first if needed
+    T& edit() {
+        if (data_.use_count() > 1) {
+            data_ = std::make_shared<T>(*data_);
+        }
+        return *data_;
+    }
+
+    // True if this handle points at exactly the same data as other
+    bool sharesWith(const CopyOnWrite& other) const { return data_ == other.data_; }
+    // True if other handles point at the same data (the next edit() copies)
+    bool isShared() const { return data_.use_count() > 1; }
+    std::shared_ptr<const T> getShared() const { return data_; }
+
+private:
+    // The static reference keeps the default shared, so it is never edited in place
+    static const std::shared_ptr<T>& defaultValue() {
+        static const std::shared_ptr<T> value = std::make_shared<T>();
+        return value;
+    }
+
+    std::shared_ptr<T> data_;
+};
+
+#endif
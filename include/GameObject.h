@@ -3,23 +3,40 @@
 
 #include <string>
 #include <vector>
-#include <memory>
-#include <typeindex>
-#include <unordered_map>
+#include <type_traits>
+#include "ecs/EntityRegistry.h"
 
 class Component;
 class TransformComponent;
+class TransformStore;
 
+// Thin handle over an entity in the scene's EntityRegistry.
+// Components themselves live in archetype chunks owned by the registry.
 class GameObject {
 public:
-    GameObject(const std::string& name = "GameObject");
+    GameObject(EntityRegistry& registry, TransformStore& transforms, const std::string& name = "GameObject");
+    // Adopt an entity created by EntityRegistry::createBatch/cloneBatch.
+    // Its TransformComponent must still be attached by the caller.
+    GameObject(EntityRegistry& registry, EntityId entity, const std::string& name);
     ~GameObject();
+
+    GameObject(const GameObject&) = delete;
+    GameObject& operator=(const GameObject&) = delete;
     
-    // Name
-    std::string getName() const { return name_; }
+    // Name. Objects owned by a Scene should be renamed through
+    // Scene::renameGameObject so its name registry stays in sync.
+    const std::string& getName() const { return name_; }
     void setName(const std::string& name) { name_ = name; }
+
+    EntityId getEntity() const { return entity_; }
+    // Forget the entity without destroying it. Used when a scene snapshot
+    // restore replaces the registry contents wholesale.
+    void releaseEntity() { entity_ = INVALID_ENTITY; }
+    EntityHandle getHandle() const { return registry_->getHandle(entity_); }
     
     // Component management
+    // Adding or removing a component moves the entity to another archetype,
+    // which invalidates previously returned component pointers.
     template<typename T>
     T* addComponent();
     
@@ -31,59 +48,41 @@ public:
     
     void removeComponent(Component* component);
     
-    std::vector<std::unique_ptr<Component>>& getComponents() { return components_; }
-    const std::vector<std::unique_ptr<Component>>& getComponents() const { return components_; }
+    // Report an edit to a component's values to caches that track it
+    // (e.g. LightComponent and the light array)
+    template<typename T>
+    void markChanged() { registry_->markChanged(entity_, getComponentTypeId<T>()); }
+    
+    std::vector<Component*> getComponents() const;
     
     // Quick access to transform (always present)
-    TransformComponent* getTransform() { return transform_; }
-    const TransformComponent* getTransform() const { return transform_; }
+    TransformComponent* getTransform();
+    const TransformComponent* getTransform() const;
     
 private:
     std::string name_;
-    std::vector<std::unique_ptr<Component>> components_;
-    std::unordered_map<std::type_index, Component*> componentMap_;
-    TransformComponent* transform_; // Cached pointer to transform
+    EntityRegistry* registry_;
+    EntityId entity_;
 };
 
 // Template implementations
 template<typename T>
 T* GameObject::addComponent() {
     static_assert(std::is_base_of<Component, T>::value, "T must derive from Component");
-    
-    // Check if component already exists (one per type)
-    std::type_index typeIdx(typeid(T));
-    if (componentMap_.find(typeIdx) != componentMap_.end()) {
-        return static_cast<T*>(componentMap_[typeIdx]);
-    }
-    
-    auto component = std::make_unique<T>();
-    T* ptr = component.get();
-    ptr->gameObject = this;
-    
-    componentMap_[typeIdx] = ptr;
-    components_.push_back(std::move(component));
-    
-    return ptr;
+    // One component per type; returns the existing one if present
+    return registry_->add<T>(entity_);
 }
 
 template<typename T>
 T* GameObject::getComponent() {
     static_assert(std::is_base_of<Component, T>::value, "T must derive from Component");
-    
-    std::type_index typeIdx(typeid(T));
-    auto it = componentMap_.find(typeIdx);
-    if (it != componentMap_.end()) {
-        return static_cast<T*>(it->second);
-    }
-    return nullptr;
+    return registry_->get<T>(entity_);
 }
 
 template<typename T>
 bool GameObject::hasComponent() {
     static_assert(std::is_base_of<Component, T>::value, "T must derive from Component");
-    
-    std::type_index typeIdx(typeid(T));
-    return componentMap_.find(typeIdx) != componentMap_.end();
+    return registry_->has<T>(entity_);
 }
 
 #endif
@@ -0,0 +1,110 @@
+#ifndef JOB_SYSTEM_H
+#define JOB_SYSTEM_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class JobSystem;
+
+// Counts unfinished jobs. Pass one to JobSystem::run() and wait on it, or
+// make other jobs depend on it with runAfter(). A counter must outlive the
+// jobs signalling it and any continuations queued on it.
+class JobCounter {
+public:
+    JobCounter() = default;
+    JobCounter(const JobCounter&) = delete;
+    JobCounter& operator=(const JobCounter&) = delete;
+
+    bool isDone() const;
+
+private:
+    friend class JobSystem;
+    struct Job;
+
+    std::atomic<uint32_t> value_{ 0 };
+    mutable std::mutex mutex_;       // Guards the transition to zero and continuations_
+    std::vector<Job*> continuations_;
+};
+
+// Work-stealing thread pool.
+// Every thread (the main thread included) owns a Chase-Lev deque: it pushes
+// and pops jobs at the bottom, and idle threads steal from the top of other
+// threads' deques. Threads that wait on a counter run jobs while they wait,
+// so jobs may schedule and wait on nested jobs.
+// GL calls must stay on the main thread: queue them with runOnMainThread().
+class JobSystem {
+public:
+    using JobFunction = std::function<void()>;
+    using RangeFunction = std::function<void(size_t begin, size_t end)>;
+
+    // Spawns workerThreads threads in addition to the calling thread, which
+    // becomes the main thread. -1 uses one worker per remaining hardware thread.
+    explicit JobSystem(int workerThreads = -1);
+    // Runs any jobs still queued, then joins the workers
+    ~JobSystem();
+
+    JobSystem(const JobSystem&) = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+
+    // Worker threads plus the main thread
+    unsigned getThreadCount() const { return (unsigned)queues_.size(); }
+    bool isMainThread() const;
+
+    // Queue fn. If counter is given it is incremented now and decremented
+    // when fn returns.
+    void run(JobFunction fn, JobCounter* counter = nullptr);
+
+    // Queue fn once dependency reaches zero
+    void runAfter(JobCounter& dependency, JobFunction fn, JobCounter* counter = nullptr);
+
+    // Block until counter reaches zero, running queued jobs meanwhile
+    void wait(JobCounter& counter);
+
+    // Call fn over [0, count) split into ranges of at least minGrain items and
+    // wait for all of them. Ranges are split in half on demand, so idle threads
+    // steal big halves and busy threads keep small ones.
+    void parallelFor(size_t count, const RangeFunction& fn, size_t minGrain = 1);
+
+    // Queue fn for the main thread. Safe from any thread. The main thread
+    // runs these in runMainThreadJobs() and while it waits on a counter.
+    void runOnMainThread(JobFunction fn, JobCounter* counter = nullptr);
+    // Run the main-thread queue (main thread only). Returns how many ran.
+    size_t runMainThreadJobs();
+
+private:
+    class WorkQueue;
+
+    void push(JobCounter::Job* job);
+    JobCounter::Job* findJob(int self); // self is the caller's queue, -1 if it has none
+    void execute(JobCounter::Job* job);
+    void finish(JobCounter* counter);
+    void workerLoop(unsigned index);
+
+    std::vector<std::unique_ptr<WorkQueue>> queues_; // queues_[0] belongs to the main thread
+    std::vector<std::thread> workers_;
+    std::thread::id mainThread_;
+
+    // Jobs queued from threads that don't belong to this system, or that
+    // didn't fit in a full deque
+    std::mutex overflowMutex_;
+    std::vector<JobCounter::Job*> overflow_;
+
+    std::mutex mainThreadMutex_;
+    std::vector<JobCounter::Job*> mainThreadJobs_;
+
+    // Idle workers sleep until a job is pushed
+    std::mutex sleepMutex_;
+    std::condition_variable wake_;
+    std::atomic<int64_t> queuedJobs_{ 0 };
+    std::atomic<uint32_t> sleepers_{ 0 };
+    std::atomic<bool> stopping_{ false };
+};
+
+#endif
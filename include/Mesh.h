@@ -1,9 +1,15 @@
 #ifndef MESH_H
 #define MESH_H
 
+#include "JobSystem.h"
+#include "math/Bounds.h"
+#include <atomic>
+#include <memory>
 #include <vector>
 #include <GL/glew.h>
 
+class Bvh;
+
 struct Vertex {
     float x, y, z;
 };
@@ -25,10 +31,31 @@ public:
     // Get vertex data for ray intersection
     const std::vector<Vertex>& getVertices() const { return vertices_; }
 
+    // Object-space bounds, computed once from the vertices
+    const Aabb& getBounds() const { return bounds_; }
+    const BoundingSphere& getBoundingSphere() const { return boundingSphere_; }
+
+    // BVH over the triangles in object space, for picking. Built on first
+    // request as a job on jobs (or right away without one); the mesh must be
+    // destroyed on the main thread, which waits for a build still running.
+    void buildBvhAsync(JobSystem* jobs);
+    // nullptr until the build has finished
+    const Bvh* getBvh() const { return bvhReady_.load(std::memory_order_acquire) ? bvh_.get() : nullptr; }
+    // Starts the build if needed and waits for it, running other jobs meanwhile
+    const Bvh& waitForBvh(JobSystem* jobs);
+
 private:
     unsigned int VAO, VBO;
     unsigned int vertexCount;
     std::vector<Vertex> vertices_; // Store for ray-casting
+    Aabb bounds_;
+    BoundingSphere boundingSphere_; // Centred on bounds_
+
+    std::unique_ptr<Bvh> bvh_;
+    std::atomic<bool> bvhStarted_{ false };
+    std::atomic<bool> bvhReady_{ false };
+    JobSystem* bvhJobs_ = nullptr; // System running the build, if any
+    JobCounter bvhBuilt_;
 
     // Setup mesh buffers
     void setupMesh(const std::vector<Vertex>& vertices);
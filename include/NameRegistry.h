@@ -0,0 +1,41 @@
+#ifndef NAME_REGISTRY_H
+#define NAME_REGISTRY_H
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Tracks the names in use in a scene so unique names can be generated in
+// O(1) on average instead of scanning every object.
+// Each base name remembers the next " (N)" suffix to try; suffixes only go
+// up, so a burst of spawns never re-tests the same candidates.
+class NameRegistry {
+public:
+    // Return baseName if it's free, otherwise "baseName (N)" with the
+    // lowest untried N that is free. The result is registered as used.
+    std::string acquire(const std::string& baseName);
+
+    // Acquire count unique names for the same base name at once
+    void acquire(const std::string& baseName, size_t count, std::vector<std::string>& out);
+
+    // Register/unregister an exact name. Names may be used more than once
+    // (e.g. after a rename), so each name keeps a use count.
+    void add(const std::string& name);
+    void release(const std::string& name);
+    void rename(const std::string& oldName, const std::string& newName);
+
+    // Size the table ahead of adding this many names
+    void reserve(size_t names) { useCount_.reserve(names); }
+
+    bool isUsed(const std::string& name) const { return useCount_.count(name) != 0; }
+    void clear();
+
+private:
+    std::string nextFree(const std::string& baseName, uint32_t& next) const;
+
+    std::unordered_map<std::string, uint32_t> useCount_;
+    std::unordered_map<std::string, uint32_t> nextSuffix_;
+};
+
+#endif
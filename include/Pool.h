@@ -0,0 +1,87 @@
+#ifndef POOL_H
+#define POOL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <utility>
+#include <vector>
+
+// Fixed-size object pool. Objects are carved out of slabs of SlabObjects
+// entries, so spawning N objects costs N / SlabObjects heap allocations.
+// Addresses are stable for the object's lifetime; freed slots are reused
+// before a new slab is allocated. Destroying or clearing the pool destroys
+// every live object and releases all slabs in one go.
+template<typename T, size_t SlabObjects = 256>
+class Pool {
+public:
+    Pool() = default;
+    ~Pool() { clear(); }
+
+    Pool(const Pool&) = delete;
+    Pool& operator=(const Pool&) = delete;
+
+    template<typename... Args>
+    T* create(Args&&... args) {
+        if (freeList_.empty()) allocateSlab();
+        Slot* slot = freeList_.back();
+        T* object = new (slot->storage) T(std::forward<Args>(args)...);
+        freeList_.pop_back();
+        slot->live = true;
+        ++liveCount_;
+        return object;
+    }
+
+    void destroy(T* object) {
+        if (!object) return;
+        // storage is the first member, so the object address is the slot address
+        Slot* slot = reinterpret_cast<Slot*>(object);
+        object->~T();
+        slot->live = false;
+        freeList_.push_back(slot);
+        --liveCount_;
+    }
+
+    // Destroy every live object and release all slabs
+    void clear() {
+        for (Slot* slab : slabs_) {
+            for (size_t i = 0; i < SlabObjects; ++i) {
+                if (slab[i].live) reinterpret_cast<T*>(slab[i].storage)->~T();
+            }
+            ::operator delete(slab, std::align_val_t(alignof(Slot)));
+        }
+        slabs_.clear();
+        freeList_.clear();
+        liveCount_ = 0;
+    }
+
+    size_t size() const { return liveCount_; }
+    size_t getSlabCount() const { return slabs_.size(); }
+
+    // Heap allocations made for slabs over the pool's lifetime
+    size_t getSlabAllocations() const { return slabAllocations_; }
+
+private:
+    struct Slot {
+        alignas(T) unsigned char storage[sizeof(T)];
+        bool live;
+    };
+
+    void allocateSlab() {
+        Slot* slab = static_cast<Slot*>(::operator new(sizeof(Slot) * SlabObjects, std::align_val_t(alignof(Slot))));
+        for (size_t i = 0; i < SlabObjects; ++i) slab[i].live = false;
+        slabs_.push_back(slab);
+        ++slabAllocations_;
+
+        // Reversed so slots are handed out in address order
+        freeList_.reserve(freeList_.size() + SlabObjects);
+        for (size_t i = SlabObjects; i-- > 0;) freeList_.push_back(&slab[i]);
+    }
+
+    std::vector<Slot*> slabs_;
+    std::vector<Slot*> freeList_;
+    size_t liveCount_ = 0;
+    size_t slabAllocations_ = 0;
+};
+
+#endif
@@ -0,0 +1,37 @@
+#ifndef PREFAB_H
+#define PREFAB_H
+
+#include "components/MeshRendererComponent.h"
+#include "components/MaterialComponent.h"
+#include "components/LightComponent.h"
+#include "CopyOnWrite.h"
+#include <memory>
+#include <string>
+
+class Mesh;
+
+// Reusable object template loaded from GameProject/Prefabs/<name>.prefab.
+// Instances reference the prefab's data instead of owning copies: they
+// share its mesh and its material until an instance edits the material,
+// which copies just that component's data (see CopyOnWrite).
+struct Prefab {
+    std::string name;
+    std::string path;
+
+    MeshRendererComponent::Preset meshPreset = MeshRendererComponent::Preset::None;
+
+    bool hasMaterial = false;
+    CopyOnWrite<MaterialData> material;
+
+    bool hasLight = false;
+    LightComponent light;
+
+    // Mesh shared by every instance, built from meshPreset on first use
+    // (needs a GL context)
+    std::shared_ptr<Mesh> getMesh();
+
+private:
+    std::shared_ptr<Mesh> mesh_;
+};
+
+#endif
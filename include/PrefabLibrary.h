@@ -0,0 +1,35 @@
+#ifndef PREFAB_LIBRARY_H
+#define PREFAB_LIBRARY_H
+
+#include "Prefab.h"
+#include <memory>
+#include <string>
+#include <vector>
+
+class GameObject;
+
+// Loads and saves the .prefab assets of a project folder.
+// Prefabs are handed out as shared pointers, so instances keep the data
+// alive even if the library reloads.
+class PrefabLibrary {
+public:
+    // Point at a folder (created if missing) and load every .prefab in it
+    void setDirectory(const std::string& directory);
+    const std::string& getDirectory() const { return directory_; }
+
+    std::shared_ptr<Prefab> find(const std::string& name) const;
+    const std::vector<std::shared_ptr<Prefab>>& getPrefabs() const { return prefabs_; }
+
+    // Capture an object's mesh preset, material and light as a prefab asset
+    // named after the object. Replaces an existing prefab of the same name.
+    std::shared_ptr<Prefab> createFromObject(GameObject& go);
+
+private:
+    std::shared_ptr<Prefab> load(const std::string& path) const;
+    bool save(const Prefab& prefab) const;
+
+    std::string directory_;
+    std::vector<std::shared_ptr<Prefab>> prefabs_;
+};
+
+#endif
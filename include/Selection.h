@@ -0,0 +1,51 @@
+#ifndef SELECTION_H
+#define SELECTION_H
+
+#include "ecs/Entity.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class EntityRegistry;
+
+// The set of selected objects: one bit per entity index, so membership
+// tests (render list, hierarchy rows) are O(1), plus a dense list of handles
+// in the order they were selected for iteration and batch operations.
+// The last handle added is the primary selection, the one panels that show
+// a single object edit.
+//
+// Bits are keyed by index only; Scene drops destroyed objects after every
+// destroy batch, so a reused index never inherits a stale bit.
+class Selection {
+public:
+    bool contains(EntityId entity) const {
+        return entity < bits_.size() * 64 && (bits_[entity >> 6] >> (entity & 63) & 1) != 0;
+    }
+    bool contains(EntityHandle handle) const { return !handle.isNull() && contains(handle.index); }
+
+    // Adding an object already selected is a no-op; null handles are ignored
+    void add(EntityHandle handle);
+    void remove(EntityHandle handle);
+    void toggle(EntityHandle handle);
+    // Replace the selection with a single object (or nothing for a null handle)
+    void set(EntityHandle handle);
+    void assign(const std::vector<EntityHandle>& handles);
+    void clear();
+
+    // Remove objects that are no longer alive; returns how many were dropped
+    size_t removeStale(const EntityRegistry& registry);
+
+    const std::vector<EntityHandle>& getHandles() const { return handles_; }
+    EntityHandle getPrimary() const { return handles_.empty() ? EntityHandle() : handles_.back(); }
+    size_t size() const { return handles_.size(); }
+    bool empty() const { return handles_.empty(); }
+
+private:
+    void setBit(EntityId entity);
+    void clearBit(EntityId entity) { bits_[entity >> 6] &= ~(uint64_t(1) << (entity & 63)); }
+
+    std::vector<uint64_t> bits_;
+    std::vector<EntityHandle> handles_;
+};
+
+#endif
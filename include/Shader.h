@@ -1,6 +1,7 @@
 #ifndef SHADER_H
 #define SHADER_H
 
+#include "math/Mat4.h"
 #include <string>
 #include <GL/glew.h>
 
@@ -20,11 +21,15 @@ public:
     // Utility uniform functions
     void setBool(const std::string& name, bool value) const;
     void setInt(const std::string& name, int value) const;
+    void setUVec2(const std::string& name, unsigned int x, unsigned int y) const;
+    void setIntArray(const std::string& name, const int* values, int count) const;
     void setFloat(const std::string& name, float value) const;
     void setVec2(const std::string& name, float x, float y) const;
     void setVec3(const std::string& name, float x, float y, float z) const;
+    void setVec3(const std::string& name, const Vec3& value) const { setVec3(name, value.x, value.y, value.z); }
     void setVec4(const std::string& name, float x, float y, float z, float w) const;
     void setMat4(const std::string& name, const float* value) const;
+    void setMat4(const std::string& name, const Mat4& value) const { setMat4(name, value.data()); }
 
 private:
     // Utility function for loading shader source
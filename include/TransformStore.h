@@ -0,0 +1,142 @@
+#ifndef TRANSFORM_STORE_H
+#define TRANSFORM_STORE_H
+
+#include "math/Mat4.h"
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+class JobSystem;
+
+// Structure-of-arrays storage for every transform in a scene.
+// TransformComponent is a thin proxy holding a slot in here. Edits mark the
+// slot dirty, and updateWorldMatrices() rebuilds only the dirty slots' local
+// matrices, four at a time with SSE, then propagates them down the hierarchy
+// into one contiguous world matrix array that the renderer and picking read.
+//
+// The parent/child hierarchy is kept as a flattened depth-first array of
+// nodes, so a node's subtree is the contiguous range
+// [position, position + subtreeSize). Propagation only walks the subtrees
+// under dirty nodes, and disjoint subtrees are processed in parallel on the
+// job system (serially if none is set).
+class TransformStore {
+public:
+    static constexpr uint32_t INVALID_SLOT = 0xFFFFFFFFu;
+
+    // One entry of the depth-first hierarchy array
+    struct Node {
+        uint32_t slot;
+        int32_t parent;       // Position of the parent node, -1 for roots
+        uint32_t subtreeSize; // This node plus all descendants
+    };
+
+    TransformStore() = default;
+    TransformStore(const TransformStore&) = delete;
+    TransformStore& operator=(const TransformStore&) = delete;
+
+    // Allocate a root slot initialized to the identity transform (marked dirty).
+    // owner is an opaque tag (the entity index) returned by getOwner().
+    uint32_t allocate(uint32_t owner);
+    void release(uint32_t slot);
+
+    // Grow every per-slot array once ahead of a batch of allocations
+    void reserve(size_t slots);
+
+    // Make this store an exact copy of other (used for scene snapshots).
+    // Arrays are plain data, so this is a bulk copy into existing capacity.
+    void copyFrom(const TransformStore& other);
+
+    // Jobs used to split large updates across threads (may be null)
+    void setJobSystem(JobSystem* jobs) { jobs_ = jobs; }
+
+    uint32_t getOwner(uint32_t slot) const { return owner_[slot]; }
+
+    // Flag a slot whose position/rotation/scale changed
+    void markDirty(uint32_t slot) {
+        if (!dirty_[slot]) {
+            dirty_[slot] = 1;
+            dirtyList_.push_back(slot);
+        }
+    }
+
+    // Hierarchy. Local values are kept when reparenting.
+    // Returns false if parent is the slot itself or one of its descendants.
+    bool setParent(uint32_t slot, uint32_t parent);
+    uint32_t getParent(uint32_t slot) const { return parent_[slot]; }
+
+    // Depth-first node array (rebuilt lazily after reparenting or removals)
+    const std::vector<Node>& getNodes() { updateOrder(); return nodes_; }
+    uint32_t getNodePosition(uint32_t slot) { updateOrder(); return position_[slot]; }
+
+    // Rebuild world matrices of all dirty slots and their descendants.
+    // Returns how many world matrices were rebuilt.
+    size_t updateWorldMatrices();
+
+    // Watched slots report when their world matrix is rebuilt, so caches of
+    // world-space data only revisit what moved. Each cache has its own list,
+    // so they can watch and take moves independently (and concurrently).
+    enum WatchList : uint32_t { LIGHT_WATCH, BOUNDS_WATCH, WATCH_LIST_COUNT };
+    void setWatched(WatchList list, uint32_t slot, bool watched);
+    void clearWatched(WatchList list);
+    // Move the slots of list rebuilt since the last call into out
+    void takeMovedWatched(WatchList list, std::vector<uint32_t>& out);
+
+    size_t getDirtyCount() const { return dirtyList_.size(); }
+    size_t getSlotCount() const { return posX.size(); }
+
+    // Column-major 4x4 world matrix for a slot (valid after updateWorldMatrices)
+    const Mat4& getWorldMatrix(uint32_t slot) const { return world_[slot]; }
+    const Mat4* getWorldMatrices() const { return world_.data(); }
+
+    // Local transform data, one entry per slot. Rotation is a unit
+    // quaternion (rotX/Y/Z imaginary, rotW real).
+    std::vector<float> posX, posY, posZ;
+    std::vector<float> rotX, rotY, rotZ, rotW;
+    std::vector<float> scaleX, scaleY, scaleZ;
+
+    // Euler degrees last given for each slot's rotation, for the inspector
+    // only: matrices are built from the quaternion, and the angles are
+    // re-derived when they no longer match it (see TransformComponent)
+    std::vector<Vec3> eulerHint;
+
+private:
+    void buildScalar(const uint32_t* slots, size_t count);
+    void buildBatch4(const uint32_t* slots);
+
+    // Recompute world matrices for the node range [begin, end) in DFS order
+    void propagateRange(uint32_t begin, uint32_t end);
+
+    // Rebuild the depth-first node array from parent links if it is stale
+    void updateOrder();
+
+    // Record watched slots inside the sorted, disjoint node ranges, which
+    // cover rebuilt nodes in total
+    void collectMovedWatched(const std::vector<std::pair<uint32_t, uint32_t>>& ranges, size_t rebuilt);
+
+    std::vector<Mat4> local_;
+    std::vector<Mat4> world_;
+    std::vector<uint32_t> owner_;
+    std::vector<uint32_t> parent_;   // Parent slot or INVALID_SLOT
+    std::vector<uint32_t> position_; // Slot -> index in nodes_
+    std::vector<uint8_t> alive_;
+    std::vector<uint8_t> dirty_;
+    std::vector<uint32_t> dirtyList_;
+    std::vector<uint32_t> freeList_;
+    std::vector<uint32_t> pendingFree_; // Released, recycled at the next order rebuild
+
+    enum : uint8_t { WATCHED = 1, WATCH_LISTED = 2, MOVED = 4 };
+    struct Watch {
+        std::vector<uint8_t> state;  // Per slot
+        std::vector<uint32_t> slots; // May hold unwatched slots until the next collect
+        std::vector<uint32_t> moved;
+    };
+    Watch watches_[WATCH_LIST_COUNT];
+
+    std::vector<Node> nodes_;
+    bool orderDirty_ = false;
+
+    JobSystem* jobs_ = nullptr;
+};
+
+#endif
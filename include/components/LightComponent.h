@@ -13,7 +13,8 @@ public:
     void renderInspectorGUI() override;
     bool canBeRemoved() const override { return true; }
     
-    // Light properties
+    // Light properties. After editing them from code, call
+    // gameObject->markChanged<LightComponent>() so the light array sees it.
     float color[3] = { 1.0f, 1.0f, 1.0f }; // RGB
     float intensity = 1.0f;
     float range = 10.0f;
@@ -2,6 +2,14 @@
 #define MATERIAL_COMPONENT_H
 
 #include "components/Component.h"
+#include "CopyOnWrite.h"
+
+// PBR-like parameters, shared between objects until one is edited
+struct MaterialData {
+    float albedo[3] = {0.8f, 0.5f, 0.2f};
+    float metallic = 0.0f;   // 0 = dielectric, 1 = metal
+    float roughness = 0.8f;  // 0 = smooth, 1 = rough
+};
 
 class MaterialComponent : public Component {
 public:
@@ -10,10 +18,10 @@ public:
     std::string getTypeName() const override { return "Material"; }
     void renderInspectorGUI() override;
 
-    // PBR-like parameters
-    float albedo[3] = {0.8f, 0.5f, 0.2f};
-    float metallic = 0.0f;   // 0 = dielectric, 1 = metal
-    float roughness = 0.8f;  // 0 = smooth, 1 = rough
+    // Read with data.get(); data.edit() copies shared (e.g. prefab) data
+    // first. After changing it from code, call
+    // gameObject->markChanged<MaterialComponent>() so the draw list sees it.
+    CopyOnWrite<MaterialData> data;
 };
 
 #endif
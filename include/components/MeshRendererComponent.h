@@ -3,24 +3,30 @@
 #define MESH_RENDERER_COMPONENT_H
 
 #include "components/Component.h"
+#include <memory>
 
 class Mesh;
 
 class MeshRendererComponent : public Component {
 public:
     MeshRendererComponent();
-    ~MeshRendererComponent();
     
     std::string getTypeName() const override { return "Mesh Renderer"; }
     void renderInspectorGUI() override;
     bool canBeRemoved() const override { return true; }
     
-    Mesh* mesh = nullptr;
+    // Shared so batch-spawned copies of an object draw the same GL buffers.
+    // Code swapping the mesh of a live object calls
+    // gameObject->markChanged<MeshRendererComponent>() so cached bounds follow.
+    std::shared_ptr<Mesh> mesh;
     
     // Preset selection for quick assignment of built-in meshes
     enum class Preset { None = 0, Cube, Pyramid, Sphere };
     Preset preset = Preset::None;
     
+    // New mesh for a preset with default dimensions (nullptr for None)
+    static Mesh* createPresetMesh(Preset preset);
+    
 private:
     void rebuildMesh();
     
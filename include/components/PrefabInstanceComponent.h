@@ -0,0 +1,22 @@
+#ifndef PREFAB_INSTANCE_COMPONENT_H
+#define PREFAB_INSTANCE_COMPONENT_H
+
+#include "components/Component.h"
+#include <memory>
+
+struct Prefab;
+
+// Marks an object as an instance of a prefab. Removing it unpacks the
+// object: it keeps its current data but no longer tracks the prefab.
+class PrefabInstanceComponent : public Component {
+public:
+    PrefabInstanceComponent() {}
+
+    std::string getTypeName() const override { return "Prefab"; }
+    void renderInspectorGUI() override;
+    bool canBeRemoved() const override { return true; }
+
+    std::shared_ptr<Prefab> prefab;
+};
+
+#endif
@@ -3,23 +3,74 @@
 #define TRANSFORM_COMPONENT_H
 
 #include "components/Component.h"
+#include "TransformStore.h"
+#include <cstdint>
 
+// Proxy into the scene's TransformStore. Position/rotation/scale live in the
+// store's SoA arrays; setters mark the slot dirty so its world matrix is
+// rebuilt on the next TransformStore::updateWorldMatrices().
+// Position/rotation/scale are local, i.e. relative to the parent if any
+// (see Scene::setParent).
 class TransformComponent : public Component {
 public:
     TransformComponent();
+    ~TransformComponent();
+    
+    // The store slot is owned, so only moves are allowed
+    TransformComponent(TransformComponent&& other) noexcept;
+    TransformComponent(const TransformComponent&) = delete;
+    TransformComponent& operator=(const TransformComponent&) = delete;
     
     std::string getTypeName() const override { return "Transform"; }
     void renderInspectorGUI() override;
     bool canBeRemoved() const override { return false; } // Transform cannot be removed
     
+    // Scene snapshots copy the whole TransformStore, so a snapshot only
+    // needs which slot this component owns. Restoring takes ownership of the
+    // slot again.
+    struct SnapshotData {
+        GameObject* gameObject;
+        TransformStore* store;
+        uint32_t slot;
+        bool enabled;
+    };
+    void saveSnapshot(SnapshotData& out) const;
+    void restoreSnapshot(const SnapshotData& saved);
+    
+    // Allocate this transform's slot in the store (done once by GameObject)
+    void attach(TransformStore& store, uint32_t owner);
+    uint32_t getSlot() const { return slot_; }
+    
     // Position
-    float x = 0.0f, y = 0.0f, z = 0.0f;
+    void setPosition(float x, float y, float z);
+    void getPosition(float out[3]) const;
+    
+    // Rotation, stored as a quaternion
+    void setRotation(const Quat& rotation); // Normalized on the way in
+    Quat getRotation() const;
     
-    // Rotation (Euler angles in degrees)
-    float rotX = 0.0f, rotY = 0.0f, rotZ = 0.0f;
+    // Euler angles in degrees (the inspector's view of the rotation). Getting
+    // returns the angles last set if they still describe the rotation,
+    // otherwise an equivalent set derived from the quaternion.
+    void setRotation(float x, float y, float z);
+    void getEulerRotation(float out[3]) const;
     
     // Scale
-    float scaleX = 1.0f, scaleY = 1.0f, scaleZ = 1.0f;
+    void setScale(float x, float y, float z);
+    void getScale(float out[3]) const;
+    
+    // Cached world matrix, rebuilt once per frame when dirty
+    const Mat4& getWorldMatrix() const { return store_->getWorldMatrix(slot_); }
+    // World to local space. World matrices are always affine, so this skips
+    // the general 4x4 inverse. Returns false if a scale is zero.
+    bool getInverseWorldMatrix(Mat4& out) const { return getWorldMatrix().inverse(out, MatrixKind::Affine); }
+    
+    // Translation of the cached world matrix
+    void getWorldPosition(float out[3]) const;
+    
+private:
+    TransformStore* store_ = nullptr;
+    uint32_t slot_ = TransformStore::INVALID_SLOT;
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,87 @@
+#ifndef ARCHETYPE_H
+#define ARCHETYPE_H
+
+#include "ecs/ChunkAllocator.h"
+#include "ecs/ComponentInfo.h"
+#include "ecs/ComponentType.h"
+#include "ecs/Entity.h"
+#include <cstdint>
+#include <vector>
+
+// An archetype stores every entity that has exactly the same set of component
+// types. Entities live in fixed-size chunks; inside a chunk each component type
+// has its own contiguous column (structure of arrays), so systems can sweep a
+// column linearly instead of chasing per-object pointers.
+class Archetype {
+public:
+    // Size of one chunk allocation in bytes
+    static constexpr size_t CHUNK_SIZE = ChunkAllocator::CHUNK_SIZE;
+
+    // Types must be sorted by ID and unique. Chunk memory comes from the
+    // allocator, which must outlive the archetype.
+    Archetype(const std::vector<const ComponentInfo*>& types, ChunkAllocator& allocator);
+    ~Archetype();
+
+    Archetype(const Archetype&) = delete;
+    Archetype& operator=(const Archetype&) = delete;
+
+    const std::vector<const ComponentInfo*>& getTypes() const { return types_; }
+    ComponentMask getMask() const { return mask_; }
+
+    // Column index of a component type, or -1 if this archetype lacks it
+    int getColumn(ComponentTypeId id) const { return columnOfType_[id]; }
+    bool hasType(ComponentTypeId id) const { return (mask_ & componentBit(id)) != 0; }
+
+    // Number of entities stored
+    uint32_t size() const { return count_; }
+
+    // Append a row for the entity. Component memory is left unconstructed;
+    // the caller must construct every column at the returned row.
+    uint32_t allocateRow(EntityId entity);
+
+    // Allocate chunks up front so the next rows up to this count don't allocate
+    void reserve(uint32_t rows);
+
+    // Snapshot restore: destroy every component and empty the archetype
+    void discardRows();
+    // Set the row count without constructing anything; the caller fills every row
+    void setRowCount(uint32_t rows);
+
+    // Destroy the row's components and fill the hole with the last row.
+    // Returns the entity that was moved into the hole, or INVALID_ENTITY.
+    EntityId removeRow(uint32_t row);
+
+    void* getComponent(int column, uint32_t row);
+    EntityId getEntity(uint32_t row) const;
+
+    // Chunk-level access for linear sweeps
+    size_t getChunkCount() const { return chunks_.size(); }
+    uint32_t getChunkCapacity() const { return chunkCapacity_; }
+    uint32_t getChunkRowCount(size_t chunk) const;
+    void* getChunkColumn(size_t chunk, int column) { return chunks_[chunk] + columnOffsets_[column]; }
+    const EntityId* getChunkEntities(size_t chunk) const {
+        return reinterpret_cast<const EntityId*>(chunks_[chunk]);
+    }
+    EntityId* getChunkEntities(size_t chunk) {
+        return reinterpret_cast<EntityId*>(chunks_[chunk]);
+    }
+
+    // Cached transitions to the archetype with one component added/removed
+    Archetype* addEdges[MAX_COMPONENT_TYPES] = {};
+    Archetype* removeEdges[MAX_COMPONENT_TYPES] = {};
+
+private:
+    unsigned char* allocateChunk();
+    size_t getChunkBytes() const;
+
+    ChunkAllocator* allocator_;
+    std::vector<const ComponentInfo*> types_;
+    ComponentMask mask_ = 0;
+    int8_t columnOfType_[MAX_COMPONENT_TYPES]; // Dense type ID -> column, -1 if absent
+    std::vector<size_t> columnOffsets_; // Byte offset of each column inside a chunk
+    std::vector<unsigned char*> chunks_;
+    uint32_t chunkCapacity_ = 0;
+    uint32_t count_ = 0;
+};
+
+#endif
@@ -0,0 +1,37 @@
+#ifndef CHUNK_ALLOCATOR_H
+#define CHUNK_ALLOCATOR_H
+
+#include <cstddef>
+#include <vector>
+
+// Recycles archetype chunk memory across all archetypes of a registry.
+// Chunks released when an archetype shrinks go to a free list and are handed
+// to whichever archetype grows next, so moving entities between archetypes
+// doesn't hit the heap. Everything is released when the allocator is destroyed.
+class ChunkAllocator {
+public:
+    // Standard chunk size; larger requests bypass the free list
+    static constexpr size_t CHUNK_SIZE = 16 * 1024;
+    static constexpr size_t CHUNK_ALIGN = 64;
+
+    ChunkAllocator() = default;
+    ~ChunkAllocator();
+
+    ChunkAllocator(const ChunkAllocator&) = delete;
+    ChunkAllocator& operator=(const ChunkAllocator&) = delete;
+
+    unsigned char* allocate(size_t bytes);
+    void free(unsigned char* chunk, size_t bytes);
+
+    // Heap allocations made so far (free list hits are not counted)
+    size_t getHeapAllocations() const { return heapAllocations_; }
+    size_t getLiveChunks() const { return liveChunks_; }
+    size_t getFreeChunks() const { return freeChunks_.size(); }
+
+private:
+    std::vector<unsigned char*> freeChunks_;
+    size_t heapAllocations_ = 0;
+    size_t liveChunks_ = 0;
+};
+
+#endif
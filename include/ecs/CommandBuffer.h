@@ -0,0 +1,111 @@
+#ifndef COMMAND_BUFFER_H
+#define COMMAND_BUFFER_H
+
+#include "ecs/ComponentInfo.h"
+#include "ecs/ComponentType.h"
+#include "ecs/Entity.h"
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Records structural changes (create/destroy objects, add/remove components)
+// so they can be made while iterating components or from worker threads.
+// Nothing changes until the owner plays the buffer back at a sync point
+// (Scene::applyCommands, run at the start and end of Scene::update), where
+// commands are sorted by entity and applied in batches: each entity moves
+// archetype at most once, new objects are created per archetype, and
+// destroyed objects are removed together.
+// Recording is thread-safe; playback must not overlap recording.
+class CommandBuffer {
+public:
+    // Object created by create(), usable as a target until playback
+    struct PendingEntity {
+        uint32_t index;
+    };
+
+    enum class Kind : uint8_t { Create, Destroy, Add, Remove };
+
+    struct Command {
+        Kind kind;
+        EntityHandle target;            // Live target (Destroy/Add/Remove)
+        uint32_t pending;               // PendingEntity index, or NO_PENDING
+        const ComponentInfo* info;      // Add
+        ComponentTypeId type;           // Add/Remove
+        void* value;                    // Add: component to move in, owned by the buffer
+    };
+
+    struct Creation {
+        std::string baseName;
+        float position[3];
+    };
+
+    static constexpr uint32_t NO_PENDING = 0xFFFFFFFFu;
+
+    CommandBuffer() = default;
+    ~CommandBuffer() { clear(); }
+
+    CommandBuffer(const CommandBuffer&) = delete;
+    CommandBuffer& operator=(const CommandBuffer&) = delete;
+
+    PendingEntity create(const std::string& baseName, float x = 0.0f, float y = 0.0f, float z = 0.0f);
+    void destroy(EntityHandle target);
+
+    // Adding a type the object already has keeps the existing component
+    template<typename T>
+    void add(EntityHandle target, T value = T()) { addValue(target, NO_PENDING, std::move(value)); }
+    template<typename T>
+    void add(PendingEntity target, T value = T()) { addValue(EntityHandle(), target.index, std::move(value)); }
+
+    template<typename T>
+    void remove(EntityHandle target) { remove(target, getComponentTypeId<T>()); }
+    void remove(EntityHandle target, ComponentTypeId type);
+
+    bool isEmpty() const;
+
+    // Playback access (single-threaded). Commands are in record order.
+    const std::vector<Command>& getCommands() const { return commands_; }
+    const std::vector<Creation>& getCreations() const { return creations_; }
+
+    // Destroy recorded component values and forget every command
+    void clear();
+
+private:
+    template<typename T>
+    void addValue(EntityHandle target, uint32_t pending, T&& value);
+
+    // Stable storage for recorded component values (never relocated)
+    void* allocateValue(size_t size, size_t align);
+
+    mutable std::mutex mutex_;
+    std::vector<Command> commands_;
+    std::vector<Creation> creations_;
+
+    static constexpr size_t BLOCK_SIZE = 16 * 1024;
+    static constexpr size_t VALUE_ALIGN = 64;
+    struct BlockDeleter {
+        void operator()(unsigned char* block) const { ::operator delete(block, std::align_val_t(VALUE_ALIGN)); }
+    };
+    using Block = std::unique_ptr<unsigned char, BlockDeleter>;
+    std::vector<Block> blocks_;
+    std::vector<Block> largeValues_; // Values bigger than a block
+    size_t currentBlock_ = 0;
+    size_t blockUsed_ = 0;
+};
+
+template<typename T>
+void CommandBuffer::addValue(EntityHandle target, uint32_t pending, T&& value) {
+    using Type = typename std::decay<T>::type;
+    const ComponentInfo& info = getComponentInfo<Type>();
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    void* memory = allocateValue(sizeof(Type), alignof(Type));
+    Type* component = new (memory) Type(std::move(value));
+    component->gameObject = nullptr;
+    commands_.push_back({ Kind::Add, target, pending, &info, info.id, component });
+}
+
+#endif
@@ -0,0 +1,110 @@
+#ifndef COMPONENT_INFO_H
+#define COMPONENT_INFO_H
+
+#include "ecs/ComponentType.h"
+#include <cassert>
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+class Component;
+
+// Type-erased description of a component type. Archetype chunks store
+// components as raw bytes and use these hooks to construct, move and destroy them.
+struct ComponentInfo {
+    ComponentTypeId id;
+    size_t size;
+    size_t align;
+    void (*defaultConstruct)(void* dst);
+    void (*copyConstruct)(void* dst, const void* src); // nullptr if T isn't copyable
+    void (*moveConstruct)(void* dst, void* src);
+    void (*destroy)(void* ptr);
+    Component* (*asComponent)(void* ptr);
+    // Scene snapshots save types with a SnapshotData payload as that plain
+    // struct (snapshotSize bytes per row) instead of a copy of the component;
+    // restoring default-constructs the component and loads the payload back.
+    // Null/0 for the rest, which are copy-constructed.
+    size_t snapshotSize;
+    size_t snapshotAlign;
+    void (*saveSnapshot)(void* dst, const void* component);
+    void (*restoreSnapshot)(void* dst, const void* saved); // Constructs the component at dst
+};
+
+namespace detail {
+    // Components that can't (or shouldn't) be copied for snapshots declare a
+    // `SnapshotData` struct with `void saveSnapshot(SnapshotData&) const` and
+    // `void restoreSnapshot(const SnapshotData&)`. Components themselves are
+    // polymorphic, so only this payload is ever treated as raw bytes.
+    template<typename T, typename = void>
+    struct HasSnapshotData : std::false_type {};
+    template<typename T>
+    struct HasSnapshotData<T, std::void_t<typename T::SnapshotData>> : std::true_type {};
+
+    template<typename T>
+    auto snapshotSaver() -> void (*)(void*, const void*) {
+        if constexpr (HasSnapshotData<T>::value) {
+            static_assert(std::is_trivially_copyable<typename T::SnapshotData>::value,
+                          "SnapshotData is kept as raw bytes, so it must be trivially copyable");
+            return [](void* dst, const void* src) {
+                static_cast<const T*>(src)->saveSnapshot(*new (dst) typename T::SnapshotData());
+            };
+        } else {
+            return nullptr;
+        }
+    }
+
+    template<typename T>
+    auto snapshotRestorer() -> void (*)(void*, const void*) {
+        if constexpr (HasSnapshotData<T>::value) {
+            return [](void* dst, const void* saved) {
+                (new (dst) T())->restoreSnapshot(*static_cast<const typename T::SnapshotData*>(saved));
+            };
+        } else {
+            return nullptr;
+        }
+    }
+
+    template<typename T>
+    constexpr size_t snapshotSize() {
+        if constexpr (HasSnapshotData<T>::value) return sizeof(typename T::SnapshotData);
+        else return 0;
+    }
+
+    template<typename T>
+    constexpr size_t snapshotAlign() {
+        if constexpr (HasSnapshotData<T>::value) return alignof(typename T::SnapshotData);
+        else return 1;
+    }
+
+    template<typename T>
+    auto copyConstructor() -> void (*)(void*, const void*) {
+        if constexpr (std::is_copy_constructible<T>::value) {
+            return [](void* dst, const void* src) { new (dst) T(*static_cast<const T*>(src)); };
+        } else {
+            return nullptr;
+        }
+    }
+}
+
+template<typename T>
+const ComponentInfo& getComponentInfo() {
+    static const ComponentInfo info = {
+        getComponentTypeId<T>(),
+        sizeof(T),
+        alignof(T),
+        [](void* dst) { new (dst) T(); },
+        detail::copyConstructor<T>(),
+        [](void* dst, void* src) { new (dst) T(std::move(*static_cast<T*>(src))); },
+        [](void* ptr) { static_cast<T*>(ptr)->~T(); },
+        [](void* ptr) -> Component* { return static_cast<T*>(ptr); },
+        detail::snapshotSize<T>(),
+        detail::snapshotAlign<T>(),
+        detail::snapshotSaver<T>(),
+        detail::snapshotRestorer<T>()
+    };
+    assert(info.id < MAX_COMPONENT_TYPES && "Too many component types, raise MAX_COMPONENT_TYPES");
+    return info;
+}
+
+#endif
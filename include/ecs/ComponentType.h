@@ -0,0 +1,38 @@
+#ifndef COMPONENT_TYPE_H
+#define COMPONENT_TYPE_H
+
+#include <atomic>
+#include <cstdint>
+
+// Dense per-type component IDs. Each component type gets the next free index
+// the first time it is used, so IDs can index plain arrays and bitmasks
+// instead of hashing std::type_index.
+using ComponentTypeId = uint32_t;
+using ComponentMask = uint64_t;
+
+constexpr ComponentTypeId MAX_COMPONENT_TYPES = 64;
+
+namespace detail {
+    inline ComponentTypeId nextComponentTypeId() {
+        static std::atomic<ComponentTypeId> next{0};
+        return next.fetch_add(1);
+    }
+}
+
+template<typename T>
+ComponentTypeId getComponentTypeId() {
+    static const ComponentTypeId id = detail::nextComponentTypeId();
+    return id;
+}
+
+inline ComponentMask componentBit(ComponentTypeId id) {
+    return ComponentMask(1) << id;
+}
+
+// Mask with one bit set for each of Ts
+template<typename... Ts>
+ComponentMask componentMask() {
+    return (ComponentMask(0) | ... | componentBit(getComponentTypeId<Ts>()));
+}
+
+#endif
@@ -0,0 +1,23 @@
+#ifndef ENTITY_H
+#define ENTITY_H
+
+#include <cstdint>
+
+// Entities are plain indices into the EntityRegistry's record table.
+// Indices are recycled, so anything stored across frames should use an
+// EntityHandle, which also carries the generation of the slot.
+using EntityId = uint32_t;
+constexpr EntityId INVALID_ENTITY = 0xFFFFFFFFu;
+
+struct EntityHandle {
+    EntityId index = INVALID_ENTITY;
+    uint32_t generation = 0;
+
+    bool isNull() const { return index == INVALID_ENTITY; }
+    bool operator==(const EntityHandle& other) const {
+        return index == other.index && generation == other.generation;
+    }
+    bool operator!=(const EntityHandle& other) const { return !(*this == other); }
+};
+
+#endif
@@ -0,0 +1,252 @@
+#ifndef ENTITY_REGISTRY_H
+#define ENTITY_REGISTRY_H
+
+#include "ecs/Archetype.h"
+#include "ecs/ComponentInfo.h"
+#include "ecs/ComponentType.h"
+#include "ecs/Entity.h"
+#include <array>
+#include <memory>
+#include <mutex>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+class Component;
+class GameObject;
+
+template<typename... Ts>
+class View;
+
+// Owns all component storage for a scene. Components are grouped by archetype
+// (the exact set of component types an entity has), and adding or removing a
+// component moves the entity's row to the matching archetype.
+class EntityRegistry {
+public:
+    EntityRegistry();
+    ~EntityRegistry();
+
+    EntityRegistry(const EntityRegistry&) = delete;
+    EntityRegistry& operator=(const EntityRegistry&) = delete;
+
+    // Create an entity with no components, owned by the given GameObject
+    EntityId create(GameObject* owner);
+    void destroy(EntityId entity);
+
+    GameObject* getOwner(EntityId entity) const { return records_[entity].owner; }
+    // Attach an owner to an entity created by a batch call (also updates its components)
+    void setOwner(EntityId entity, GameObject* owner);
+
+    // Batch creation: entities go straight into their final archetype, with
+    // chunks reserved once, instead of moving once per added component.
+    // Components are default-constructed; owners are attached with setOwner.
+    template<typename... Ts>
+    void createBatch(size_t count, std::vector<EntityId>& out);
+    // Runtime component set (any order, duplicates ignored)
+    void createBatch(std::vector<const ComponentInfo*> types, size_t count, std::vector<EntityId>& out);
+
+    // Same, with the prototype's component set. Copyable components are copied
+    // from the prototype; the rest (e.g. TransformComponent, which owns a
+    // store slot) are default-constructed.
+    void cloneBatch(EntityId prototype, size_t count, std::vector<EntityId>& out);
+
+    // Generational handles: stay detectable as stale after the entity is destroyed
+    EntityHandle getHandle(EntityId entity) const { return { entity, records_[entity].generation }; }
+    bool isAlive(EntityHandle handle) const {
+        return handle.index < records_.size() &&
+               records_[handle.index].generation == handle.generation &&
+               records_[handle.index].archetype != nullptr;
+    }
+    // Owner of a live handle, or nullptr if the handle is stale
+    GameObject* getOwner(EntityHandle handle) const {
+        return isAlive(handle) ? records_[handle.index].owner : nullptr;
+    }
+
+    // Upper bound on entity indices handed out so far
+    size_t getCapacity() const { return records_.size(); }
+
+    template<typename T>
+    T* add(EntityId entity);
+
+    template<typename T>
+    T* get(EntityId entity);
+
+    template<typename T>
+    bool has(EntityId entity) const;
+
+    // Bitmask of the component types the entity currently has
+    ComponentMask getMask(EntityId entity) const { return records_[entity].mask; }
+
+    // Remove a specific component instance from the entity
+    void remove(EntityId entity, Component* component);
+
+    // Add and remove several components with a single archetype move.
+    // added[i] is move-constructed from values[i], or default-constructed if
+    // that is null; types the entity already has are left as they are.
+    void changeComponents(EntityId entity, const std::vector<const ComponentInfo*>& added,
+                          void* const* values, ComponentMask removed);
+
+    // Replace an existing component with one moved from value (keeps the owner)
+    void replaceComponent(EntityId entity, const ComponentInfo& info, void* value);
+
+    // Component of the given type, or nullptr
+    Component* getComponent(EntityId entity, ComponentTypeId type);
+
+    // Type of one of the entity's components, MAX_COMPONENT_TYPES if it has no such instance
+    ComponentTypeId findComponentType(EntityId entity, const Component* component) const;
+
+    // Collect pointers to all components of an entity (invalidated by structural changes)
+    void getComponents(EntityId entity, std::vector<Component*>& out);
+
+    // Query entities that have all of Ts (defined in ecs/View.h)
+    template<typename... Ts>
+    View<Ts...> view();
+
+    // Archetypes containing every type in the mask. Cached per mask and kept
+    // up to date as new archetypes appear. Safe to call from concurrent
+    // systems as long as none of them changes the registry's structure.
+    const std::vector<Archetype*>& getMatchingArchetypes(ComponentMask required);
+
+    size_t getArchetypeCount() const { return archetypes_.size(); }
+
+    // Change tracking, for caches that mirror component data (e.g. the light
+    // array). The structure version of a type is bumped whenever an entity
+    // gains or loses that type, including creation, destruction and snapshot
+    // restores.
+    uint32_t getStructureVersion(ComponentTypeId type) const { return structureVersions_[type]; }
+    // Value edits aren't visible to the registry, so code that modifies a
+    // component reports it here (GameObject::markChanged). Reports are only
+    // kept for types whose consumer turned tracking on, and takeChanged hands
+    // them over (an entity may be listed more than once). One consumer per type.
+    void setChangeTracking(ComponentTypeId type, bool enabled);
+    void markChanged(EntityId entity, ComponentTypeId type);
+    void takeChanged(ComponentTypeId type, std::vector<EntityId>& out);
+
+    // Chunk memory shared by every archetype (allocation counters live here)
+    const ChunkAllocator& getChunkAllocator() const { return chunkAllocator_; }
+
+    class Snapshot;
+
+    // Copy all component data and entity records into the snapshot. Types
+    // with a SnapshotData payload save just that (see ComponentInfo.h); other
+    // components are copy-constructed. The snapshot's buffer is reused
+    // between saves.
+    void saveSnapshot(Snapshot& snapshot) const;
+    // Replace all entities and components with the snapshot's contents.
+    // Handles to entities left alone since the save are valid again
+    // afterwards. Entities destroyed, created or recreated in between come
+    // back with a new generation, so every handle to those slots is stale;
+    // look them up again with getHandle().
+    void restoreSnapshot(const Snapshot& snapshot);
+
+private:
+    struct EntityRecord {
+        Archetype* archetype = nullptr;
+        uint32_t row = 0;
+        ComponentMask mask = 0; // Mirrors archetype->getMask() so has() is one bit test
+        uint32_t generation = 0; // Bumped on destroy to invalidate old handles
+        GameObject* owner = nullptr;
+    };
+
+    EntityId allocateId();
+    void createBatchIn(Archetype* archetype, size_t count, std::vector<EntityId>& out, EntityId prototype);
+
+    Archetype* findOrCreateArchetype(const std::vector<const ComponentInfo*>& types);
+    Archetype* getAddTarget(Archetype* from, const ComponentInfo& info);
+    Archetype* getRemoveTarget(Archetype* from, ComponentTypeId id);
+
+    // Move an entity into another archetype, relocating the columns both share.
+    // Columns only present in the target are left unconstructed.
+    void moveEntity(EntityId entity, Archetype* to);
+
+    void bumpStructureVersions(ComponentMask types);
+
+    // Declared first so it outlives the archetypes that hand chunks back to it
+    ChunkAllocator chunkAllocator_;
+    std::vector<EntityRecord> records_;
+    std::vector<EntityId> freeList_;
+    std::vector<std::unique_ptr<Archetype>> archetypes_;
+    std::unordered_map<ComponentMask, Archetype*> archetypeLookup_;
+    std::unordered_map<ComponentMask, std::vector<Archetype*>> queryCache_;
+    std::mutex queryCacheMutex_; // Systems may look up queries concurrently
+    Archetype* emptyArchetype_ = nullptr;
+
+    std::array<uint32_t, MAX_COMPONENT_TYPES> structureVersions_{};
+    std::array<std::vector<EntityId>, MAX_COMPONENT_TYPES> changed_;
+    ComponentMask changeTracking_ = 0;
+    std::mutex changedMutex_; // Systems may report changes concurrently
+};
+
+// Saved registry state. Must not outlive the registry it was taken from.
+class EntityRegistry::Snapshot {
+public:
+    Snapshot() = default;
+    ~Snapshot();
+
+    Snapshot(const Snapshot&) = delete;
+    Snapshot& operator=(const Snapshot&) = delete;
+
+    bool isEmpty() const { return records_.empty(); }
+    size_t getByteSize() const { return used_; }
+
+private:
+    friend class EntityRegistry;
+
+    struct ArchetypeState {
+        Archetype* archetype;
+        uint32_t count;
+        size_t entityOffset;
+        std::vector<size_t> columnOffsets; // Byte offsets into buffer_
+    };
+
+    // Destroy the copy-constructed components held in the buffer
+    void releaseCopies();
+    void reserve(size_t bytes);
+
+    std::vector<ArchetypeState> archetypes_;
+    unsigned char* buffer_ = nullptr;
+    size_t capacity_ = 0;
+    size_t used_ = 0;
+    std::vector<EntityRecord> records_;
+    std::vector<EntityId> freeList_;
+};
+
+// Template implementations
+template<typename... Ts>
+void EntityRegistry::createBatch(size_t count, std::vector<EntityId>& out) {
+    createBatch({ &getComponentInfo<Ts>()... }, count, out);
+}
+
+template<typename T>
+T* EntityRegistry::add(EntityId entity) {
+    const ComponentInfo& info = getComponentInfo<T>();
+    Archetype* current = records_[entity].archetype;
+    int column = current->getColumn(info.id);
+    if (column >= 0) {
+        return static_cast<T*>(current->getComponent(column, records_[entity].row));
+    }
+
+    Archetype* target = getAddTarget(current, info);
+    moveEntity(entity, target);
+
+    void* memory = target->getComponent(target->getColumn(info.id), records_[entity].row);
+    T* component = new (memory) T();
+    component->gameObject = records_[entity].owner;
+    return component;
+}
+
+template<typename T>
+T* EntityRegistry::get(EntityId entity) {
+    const EntityRecord& record = records_[entity];
+    int column = record.archetype->getColumn(getComponentTypeId<T>());
+    if (column < 0) return nullptr;
+    return static_cast<T*>(record.archetype->getComponent(column, record.row));
+}
+
+template<typename T>
+bool EntityRegistry::has(EntityId entity) const {
+    return (records_[entity].mask & componentBit(getComponentTypeId<T>())) != 0;
+}
+
+#endif
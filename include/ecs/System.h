@@ -0,0 +1,69 @@
+#ifndef SYSTEM_H
+#define SYSTEM_H
+
+#include "ecs/ComponentType.h"
+
+class Scene;
+
+// Per-frame logic over components. Each system declares the component types
+// it reads and writes in its constructor, along with any scene data outside
+// the component columns it touches (Resource); the SystemScheduler runs
+// systems whose access doesn't conflict at the same time on worker threads.
+// update() may read and modify component values but must not add or remove
+// components or objects directly; record those in Scene::getCommands().
+class System {
+public:
+    // Scene-owned data shared between systems outside the component columns
+    enum Resource : uint32_t {
+        BOUNDS_TREE,       // Scene::getBoundsTree()
+        SPATIAL_INDEX,     // Scene::getSpatialIndex()
+        BOUNDS_WATCH_LIST, // TransformStore::BOUNDS_WATCH
+        LIGHT_WATCH_LIST,  // TransformStore::LIGHT_WATCH
+        RESOURCE_COUNT
+    };
+    using ResourceMask = uint32_t;
+
+    virtual ~System() = default;
+
+    virtual const char* getName() const = 0;
+    virtual void update(Scene& scene, float deltaTime) = 0;
+
+    ComponentMask getReads() const { return reads_; }
+    ComponentMask getWrites() const { return writes_; }
+    ResourceMask getResourceReads() const { return resourceReads_; }
+    ResourceMask getResourceWrites() const { return resourceWrites_; }
+    bool isMainThreadOnly() const { return mainThreadOnly_; }
+
+    // Two systems conflict if either writes a type or resource the other
+    // reads or writes
+    bool conflictsWith(const System& other) const {
+        return (writes_ & (other.reads_ | other.writes_)) != 0 || (other.writes_ & reads_) != 0 ||
+               (resourceWrites_ & (other.resourceReads_ | other.resourceWrites_)) != 0 ||
+               (other.resourceWrites_ & resourceReads_) != 0;
+    }
+
+    // Disabled systems are skipped by the scheduler
+    bool enabled = true;
+
+protected:
+    template<typename... Ts>
+    void reads() { reads_ |= componentMask<Ts...>(); }
+
+    template<typename... Ts>
+    void writes() { writes_ |= componentMask<Ts...>(); }
+
+    void readsResource(Resource resource) { resourceReads_ |= ResourceMask(1) << resource; }
+    void writesResource(Resource resource) { resourceWrites_ |= ResourceMask(1) << resource; }
+
+    // For systems that make GL calls
+    void runsOnMainThread() { mainThreadOnly_ = true; }
+
+private:
+    ComponentMask reads_ = 0;
+    ComponentMask writes_ = 0;
+    ResourceMask resourceReads_ = 0;
+    ResourceMask resourceWrites_ = 0;
+    bool mainThreadOnly_ = false;
+};
+
+#endif
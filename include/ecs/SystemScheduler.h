@@ -0,0 +1,75 @@
+#ifndef SYSTEM_SCHEDULER_H
+#define SYSTEM_SCHEDULER_H
+
+#include "ecs/System.h"
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <utility>
+#include <vector>
+
+class JobCounter;
+class JobSystem;
+class Scene;
+
+// Runs registered systems once per frame.
+// Every frame the scheduler builds a dependency graph from the systems'
+// read/write sets (component types and resources): a system depends on each
+// earlier-registered system it
+// conflicts with, and everything else may run concurrently on the job system.
+// Registration order is therefore the order conflicting systems run in.
+class SystemScheduler {
+public:
+    struct Timing {
+        const char* name;
+        double startMs;       // Relative to the start of run()
+        double durationMs;
+        bool onCriticalPath;  // Part of the longest dependency chain this frame
+    };
+
+    template<typename T, typename... Args>
+    T* add(Args&&... args) {
+        systems_.push_back(std::make_unique<T>(std::forward<Args>(args)...));
+        return static_cast<T*>(systems_.back().get());
+    }
+
+    // First registered system of type T, or nullptr
+    template<typename T>
+    T* get() const {
+        for (const auto& system : systems_) {
+            if (T* match = dynamic_cast<T*>(system.get())) return match;
+        }
+        return nullptr;
+    }
+
+    // Run every enabled system and wait for all of them. Without a job
+    // system (or with a single thread) they run in registration order.
+    void run(Scene& scene, float deltaTime, JobSystem* jobs);
+
+    // Timings of the last run, in registration order (disabled systems omitted)
+    const std::vector<Timing>& getTimings() const { return timings_; }
+    double getFrameMs() const { return frameMs_; }
+    double getCriticalPathMs() const { return criticalPathMs_; }
+
+private:
+    void buildGraph();
+    void launch(size_t node, Scene& scene, float deltaTime, JobSystem& jobs, JobCounter& frame);
+    void runNode(size_t node, Scene& scene, float deltaTime);
+    void findCriticalPath();
+
+    std::vector<std::unique_ptr<System>> systems_;
+
+    // Rebuilt every frame over the enabled systems
+    std::vector<System*> nodes_;
+    std::vector<std::vector<size_t>> successors_;
+    std::vector<std::vector<size_t>> predecessors_;
+    std::unique_ptr<std::atomic<uint32_t>[]> pending_; // Unfinished predecessors
+    size_t pendingCapacity_ = 0;
+
+    std::vector<Timing> timings_;
+    std::chrono::steady_clock::time_point frameStart_;
+    double frameMs_ = 0.0;
+    double criticalPathMs_ = 0.0;
+};
+
+#endif
@@ -0,0 +1,60 @@
+#ifndef VIEW_H
+#define VIEW_H
+
+#include "ecs/EntityRegistry.h"
+#include <tuple>
+#include <utility>
+#include <vector>
+
+// Query over every entity that has all of Ts. Only archetypes matching the
+// query are visited (the registry caches the match list per component mask),
+// so cost scales with the matching entities, not the whole scene.
+template<typename... Ts>
+class View {
+public:
+    View(EntityRegistry& registry, const std::vector<Archetype*>& archetypes)
+        : registry_(registry), archetypes_(archetypes) {}
+
+    // Call fn(GameObject*, Ts&...) for each match whose queried components are
+    // all enabled. fn must not add or remove components or entities.
+    template<typename Fn>
+    void each(Fn&& fn) {
+        // Index loop: the match list may grow if an archetype is created meanwhile
+        for (size_t a = 0; a < archetypes_.size(); ++a) {
+            eachInArchetype(archetypes_[a], fn, std::index_sequence_for<Ts...>{});
+        }
+    }
+
+    // Number of matching entities, including ones with disabled components
+    size_t size() const {
+        size_t count = 0;
+        for (Archetype* archetype : archetypes_) count += archetype->size();
+        return count;
+    }
+
+private:
+    template<typename Fn, size_t... I>
+    void eachInArchetype(Archetype* archetype, Fn& fn, std::index_sequence<I...>) {
+        if (archetype->size() == 0) return;
+        const int columns[] = { archetype->getColumn(getComponentTypeId<Ts>())... };
+        for (size_t c = 0; c < archetype->getChunkCount(); ++c) {
+            uint32_t rows = archetype->getChunkRowCount(c);
+            const EntityId* entities = archetype->getChunkEntities(c);
+            std::tuple<Ts*...> arrays(static_cast<Ts*>(archetype->getChunkColumn(c, columns[I]))...);
+            for (uint32_t r = 0; r < rows; ++r) {
+                if (!(std::get<I>(arrays)[r].enabled && ...)) continue;
+                fn(registry_.getOwner(entities[r]), std::get<I>(arrays)[r]...);
+            }
+        }
+    }
+
+    EntityRegistry& registry_;
+    const std::vector<Archetype*>& archetypes_;
+};
+
+template<typename... Ts>
+View<Ts...> EntityRegistry::view() {
+    return View<Ts...>(*this, getMatchingArchetypes(componentMask<Ts...>()));
+}
+
+#endif
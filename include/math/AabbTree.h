@@ -0,0 +1,190 @@
+#ifndef MATH_AABB_TREE_H
+#define MATH_AABB_TREE_H
+
+#include "math/Bounds.h"
+#include "math/Frustum.h"
+#include "math/Raycast.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Dynamic bounding volume tree over moving boxes (a broadphase). Each proxy
+// is a leaf holding a "fat" box enlarged by a margin, so small moves that
+// stay inside it leave the tree untouched; larger ones reinsert the leaf,
+// choosing a sibling by the surface area heuristic and rebalancing the
+// ancestors with AVL-style rotations on the way up.
+//
+// Proxy ids are leaf node indices, which rotations never change, and stay
+// valid until destroyProxy(). Queries are const and may run concurrently
+// with each other, but not with createProxy/destroyProxy/moveProxy.
+class AabbTree {
+public:
+    static constexpr int32_t NULL_NODE = -1;
+    // Traversal stack size: rotations keep the height near 1.44 log2(n)
+    static constexpr int STACK_SIZE = 256;
+
+    explicit AabbTree(float margin = 0.1f) : margin_(margin) {}
+
+    // Add a proxy for box; userData is handed back by queries
+    int32_t createProxy(const Aabb& box, uint32_t userData);
+    void destroyProxy(int32_t proxy);
+    // Update a proxy's box. Returns true if the leaf had to be reinserted,
+    // false if the fat box still covered it.
+    bool moveProxy(int32_t proxy, const Aabb& box);
+    void clear();
+
+    uint32_t getUserData(int32_t proxy) const { return nodes_[proxy].userData; }
+    const Aabb& getFatAabb(int32_t proxy) const { return nodes_[proxy].box; }
+    size_t getProxyCount() const { return proxyCount_; }
+    int getHeight() const { return root_ == NULL_NODE ? 0 : nodes_[root_].height; }
+    float getMargin() const { return margin_; }
+
+    // Calls f(proxy) for every proxy whose fat box overlaps box
+    template<typename F> void queryAabb(const Aabb& box, F&& f) const;
+    // Calls f(proxy) for every proxy whose fat box is within radius of center
+    template<typename F> void querySphere(const Vec3& center, float radius, F&& f) const;
+    // Calls f(proxy) for every proxy whose fat box is not outside the
+    // frustum. Subtrees fully inside are reported without further tests.
+    template<typename F> void queryFrustum(const Frustum& frustum, F&& f) const;
+    // Visits proxies whose fat box the ray enters before maxT, nearest box
+    // first, calling f(proxy) -> float. f returns the new maxT (a hit
+    // distance, or maxT unchanged to keep going); boxes entered past it are
+    // skipped, and returning 0 stops the query.
+    template<typename F> void raycast(const Ray& ray, float maxT, F&& f) const;
+
+private:
+    struct Node {
+        Aabb box;               // Fat for leaves, the union of the children otherwise
+        int32_t parent;         // Next free node while on the free list
+        int32_t child1, child2; // NULL_NODE for leaves
+        int32_t height;         // 0 for leaves, -1 while free
+        uint32_t userData;
+
+        bool isLeaf() const { return child1 == NULL_NODE; }
+    };
+
+    int32_t allocateNode();
+    void freeNode(int32_t node);
+    void insertLeaf(int32_t leaf);
+    void removeLeaf(int32_t leaf);
+    // Refit and rebalance from index up to the root
+    void refitUp(int32_t index);
+    // Rotate the taller grandchild up if a's subtrees differ in height by
+    // more than one; returns the node now in a's place
+    int32_t balance(int32_t a);
+
+    std::vector<Node> nodes_;
+    int32_t root_ = NULL_NODE;
+    int32_t freeList_ = NULL_NODE;
+    size_t proxyCount_ = 0;
+    float margin_;
+};
+
+template<typename F>
+void AabbTree::queryAabb(const Aabb& box, F&& f) const {
+    if (root_ == NULL_NODE) return;
+    int32_t stack[STACK_SIZE];
+    int top = 0;
+    stack[top++] = root_;
+    while (top > 0) {
+        const Node& node = nodes_[stack[--top]];
+        if (!node.box.overlaps(box)) continue;
+        if (node.isLeaf()) {
+            f((int32_t)(&node - nodes_.data()));
+        } else {
+            stack[top++] = node.child1;
+            stack[top++] = node.child2;
+        }
+    }
+}
+
+template<typename F>
+void AabbTree::querySphere(const Vec3& center, float radius, F&& f) const {
+    if (root_ == NULL_NODE) return;
+    float radiusSquared = radius * radius;
+    int32_t stack[STACK_SIZE];
+    int top = 0;
+    stack[top++] = root_;
+    while (top > 0) {
+        const Node& node = nodes_[stack[--top]];
+        if (node.box.distanceSquared(center) > radiusSquared) continue;
+        if (node.isLeaf()) {
+            f((int32_t)(&node - nodes_.data()));
+        } else {
+            stack[top++] = node.child1;
+            stack[top++] = node.child2;
+        }
+    }
+}
+
+template<typename F>
+void AabbTree::queryFrustum(const Frustum& frustum, F&& f) const {
+    if (root_ == NULL_NODE) return;
+    int32_t stack[STACK_SIZE];
+    bool inside[STACK_SIZE]; // Set once an ancestor tested fully inside
+    int top = 0;
+    stack[top] = root_;
+    inside[top++] = false;
+    while (top > 0) {
+        --top;
+        int32_t index = stack[top];
+        bool contained = inside[top];
+        const Node& node = nodes_[index];
+        if (!contained) {
+            Containment c = frustum.test(node.box);
+            if (c == Containment::Outside) continue;
+            contained = c == Containment::Inside;
+        }
+        if (node.isLeaf()) {
+            f(index);
+        } else {
+            stack[top] = node.child1;
+            inside[top++] = contained;
+            stack[top] = node.child2;
+            inside[top++] = contained;
+        }
+    }
+}
+
+template<typename F>
+void AabbTree::raycast(const Ray& ray, float maxT, F&& f) const {
+    if (root_ == NULL_NODE) return;
+    Vec3 invDir(1.0f / ray.direction.x, 1.0f / ray.direction.y, 1.0f / ray.direction.z);
+    if (!(rayEntry(nodes_[root_].box, ray.origin, invDir) < maxT)) return;
+
+    // Far children wait here with their entry distance, dropped once a
+    // nearer hit clips maxT below it
+    int32_t stack[STACK_SIZE];
+    float stackEntry[STACK_SIZE];
+    int top = 0;
+    int32_t index = root_;
+    for (;;) {
+        const Node& node = nodes_[index];
+        if (node.isLeaf()) {
+            maxT = f(index);
+            if (maxT <= 0.0f) return;
+        } else {
+            int32_t nearChild = node.child1, farChild = node.child2;
+            float nearT = rayEntry(nodes_[nearChild].box, ray.origin, invDir);
+            float farT = rayEntry(nodes_[farChild].box, ray.origin, invDir);
+            if (farT < nearT) {
+                std::swap(nearChild, farChild);
+                std::swap(nearT, farT);
+            }
+            if (nearT < maxT) {
+                if (farT < maxT) {
+                    stack[top] = farChild;
+                    stackEntry[top++] = farT;
+                }
+                index = nearChild;
+                continue;
+            }
+        }
+
+        while (top > 0 && !(stackEntry[top - 1] < maxT)) --top;
+        if (top == 0) break;
+        index = stack[--top];
+    }
+}
+
+#endif
@@ -0,0 +1,91 @@
+#ifndef MATH_BOUNDS_H
+#define MATH_BOUNDS_H
+
+#include "math/Mat4.h"
+#include "math/Vec3.h"
+#include <algorithm>
+#include <cmath>
+
+// Axis-aligned box. Default-constructed boxes are empty (min > max), so
+// growing one from nothing needs no special case.
+struct Aabb {
+    Vec3 min{ 1e30f, 1e30f, 1e30f };
+    Vec3 max{ -1e30f, -1e30f, -1e30f };
+
+    Aabb() = default;
+    Aabb(const Vec3& min, const Vec3& max) : min(min), max(max) {}
+
+    bool empty() const { return max.x < min.x; }
+    Vec3 center() const { return (min + max) * 0.5f; }
+    Vec3 extents() const { return (max - min) * 0.5f; }
+
+    void grow(const Vec3& p) { min = componentMin(min, p); max = componentMax(max, p); }
+    void grow(const Aabb& b) { min = componentMin(min, b.min); max = componentMax(max, b.max); }
+    Aabb expanded(float margin) const {
+        Vec3 m(margin, margin, margin);
+        return { min - m, max + m };
+    }
+
+    // Half the surface area (enough for SAH comparisons); 0 when empty
+    float area() const {
+        Vec3 e = max - min;
+        return e.x < 0.0f ? 0.0f : e.x * e.y + e.y * e.z + e.z * e.x;
+    }
+
+    bool contains(const Aabb& b) const {
+        return min.x <= b.min.x && min.y <= b.min.y && min.z <= b.min.z
+            && b.max.x <= max.x && b.max.y <= max.y && b.max.z <= max.z;
+    }
+    bool overlaps(const Aabb& b) const {
+        return min.x <= b.max.x && b.min.x <= max.x
+            && min.y <= b.max.y && b.min.y <= max.y
+            && min.z <= b.max.z && b.min.z <= max.z;
+    }
+    // Squared distance from p to the box, 0 inside
+    float distanceSquared(const Vec3& p) const {
+        Vec3 d = componentMax(componentMax(min - p, p - max), Vec3());
+        return dot(d, d);
+    }
+
+    // Box around this one after an affine transform: the centre is
+    // transformed and the extents go through the absolute 3x3 (Arvo)
+    Aabb transformed(const Mat4& m) const {
+        Vec3 c = m.transformPoint(center()), e = extents();
+        Vec3 r(std::fabs(m.m[0]) * e.x + std::fabs(m.m[4]) * e.y + std::fabs(m.m[8]) * e.z,
+               std::fabs(m.m[1]) * e.x + std::fabs(m.m[5]) * e.y + std::fabs(m.m[9]) * e.z,
+               std::fabs(m.m[2]) * e.x + std::fabs(m.m[6]) * e.y + std::fabs(m.m[10]) * e.z);
+        return { c - r, c + r };
+    }
+};
+
+inline Aabb merge(const Aabb& a, const Aabb& b) {
+    return { componentMin(a.min, b.min), componentMax(a.max, b.max) };
+}
+
+// Distance along the ray to where it enters the box (0 if it starts inside),
+// or INFINITY if it misses. invDir is 1 / ray.direction per component.
+inline float rayEntry(const Aabb& box, const Vec3& origin, const Vec3& invDir) {
+    float t1 = (box.min.x - origin.x) * invDir.x, t2 = (box.max.x - origin.x) * invDir.x;
+    float tmin = std::min(t1, t2), tmax = std::max(t1, t2);
+    t1 = (box.min.y - origin.y) * invDir.y; t2 = (box.max.y - origin.y) * invDir.y;
+    tmin = std::max(tmin, std::min(t1, t2)); tmax = std::min(tmax, std::max(t1, t2));
+    t1 = (box.min.z - origin.z) * invDir.z; t2 = (box.max.z - origin.z) * invDir.z;
+    tmin = std::max(tmin, std::min(t1, t2)); tmax = std::min(tmax, std::max(t1, t2));
+    return tmax >= tmin && tmax >= 0.0f ? std::max(tmin, 0.0f) : INFINITY;
+}
+
+struct BoundingSphere {
+    Vec3 center;
+    float radius = 0.0f;
+
+    // Sphere around this one after an affine transform, scaled by the
+    // longest basis column so non-uniform scale stays conservative
+    BoundingSphere transformed(const Mat4& m) const {
+        float sx = m.m[0] * m.m[0] + m.m[1] * m.m[1] + m.m[2] * m.m[2];
+        float sy = m.m[4] * m.m[4] + m.m[5] * m.m[5] + m.m[6] * m.m[6];
+        float sz = m.m[8] * m.m[8] + m.m[9] * m.m[9] + m.m[10] * m.m[10];
+        return { m.transformPoint(center), radius * std::sqrt(std::max(sx, std::max(sy, sz))) };
+    }
+};
+
+#endif
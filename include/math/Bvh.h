@@ -0,0 +1,46 @@
+#ifndef MATH_BVH_H
+#define MATH_BVH_H
+
+#include "math/Raycast.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Bounding volume hierarchy over a triangle list for closest-hit ray
+// queries. Built top-down, splitting each node where the surface area
+// heuristic over BINS centroid bins along each axis is cheapest. Leaves
+// reference a contiguous range of triangles, stored in leaf order in a
+// TriangleSoA and tested with the SIMD raycast() kernel.
+class Bvh {
+public:
+    static constexpr int BINS = 12;
+    static constexpr uint32_t MAX_LEAF_TRIANGLES = 8; // One AVX2 step
+
+    // 32 bytes. Leaves have count > 0 and cover triangles [first, first + count);
+    // inner nodes have count == 0 and children first and first + 1.
+    struct Node {
+        float boundsMin[3];
+        uint32_t first;
+        float boundsMax[3];
+        uint32_t count;
+    };
+
+    // Replace the hierarchy with one over a triangle list (every three vertices form one)
+    void build(const Vec3* vertices, size_t vertexCount);
+
+    // Closest hit nearer than hit.t, like raycast() in Raycast.h. hit.triangle
+    // is the triangle's index in the list given to build().
+    bool raycast(const Ray& ray, RayHit& hit) const;
+
+    bool empty() const { return nodes_.empty(); }
+    size_t getNodeCount() const { return nodes_.size(); }
+    size_t getTriangleCount() const { return triangles_.size(); }
+    const Node* getNodes() const { return nodes_.data(); }
+
+private:
+    std::vector<Node> nodes_; // nodes_[0] is the root
+    TriangleSoA triangles_;   // In leaf order
+    std::vector<uint32_t> triangleIds_; // Leaf order -> index given to build()
+};
+
+#endif
@@ -0,0 +1,36 @@
+#ifndef MATH_CULLING_H
+#define MATH_CULLING_H
+
+#include "math/Bounds.h"
+#include "math/Frustum.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// World bounds of many objects, one array per component, so the culling
+// kernels test 4 (SSE2) or 8 (AVX2) objects per instruction. Each object has
+// a box (centre and half extents) and a sphere around the same centre.
+struct BoundsSoA {
+    std::vector<float> centerX, centerY, centerZ;
+    std::vector<float> extentX, extentY, extentZ;
+    std::vector<float> radius;
+
+    void clear();
+    void reserve(size_t count);
+    // Empty boxes get negative extents and radius, which every test culls
+    void add(const Aabb& box, float sphereRadius);
+    void set(size_t index, const Aabb& box, float sphereRadius);
+    // Moves the last entry into index's place
+    void remove(size_t index);
+    size_t size() const { return centerX.size(); }
+};
+
+// Write the indices of objects [begin, end) not outside the frustum to
+// visible, in order, and return how many there are. visible needs room for
+// end - begin entries. Dispatched at run time (see math/Simd.h).
+size_t cullSpheres(const Frustum& frustum, const BoundsSoA& bounds, size_t begin, size_t end, uint32_t* visible);
+// Same against the boxes: tighter than spheres for flat or long objects,
+// for one more multiply-add per plane
+size_t cullBoxes(const Frustum& frustum, const BoundsSoA& bounds, size_t begin, size_t end, uint32_t* visible);
+
+#endif
@@ -0,0 +1,67 @@
+#ifndef MATH_FRUSTUM_H
+#define MATH_FRUSTUM_H
+
+#include "math/Bounds.h"
+#include "math/Mat4.h"
+#include "math/Vec3.h"
+#include <cmath>
+
+enum class Containment { Outside, Intersects, Inside };
+
+// Points p with dot(normal, p) + distance >= 0 are on the inner side
+struct Plane {
+    Vec3 normal;
+    float distance = 0.0f;
+
+    float signedDistance(const Vec3& p) const { return dot(normal, p) + distance; }
+};
+
+// The six clip planes of a view-projection matrix (Gribb & Hartmann),
+// normalized and facing inwards, in world space if given projection * view
+struct Frustum {
+    enum { LEFT_PLANE, RIGHT_PLANE, BOTTOM_PLANE, TOP_PLANE, NEAR_PLANE, FAR_PLANE, PLANE_COUNT };
+    Plane planes[PLANE_COUNT];
+
+    Frustum() = default;
+    explicit Frustum(const Mat4& viewProjection) {
+        // Clip space keeps -w <= x, y, z <= w; each bound is row 3 +- row k
+        const Mat4& m = viewProjection;
+        for (int k = 0; k < 3; ++k) {
+            for (int side = 0; side < 2; ++side) {
+                float sign = side == 0 ? 1.0f : -1.0f;
+                Vec3 n(m(3, 0) + sign * m(k, 0), m(3, 1) + sign * m(k, 1), m(3, 2) + sign * m(k, 2));
+                float d = m(3, 3) + sign * m(k, 3);
+                float inv = 1.0f / length(n);
+                planes[k * 2 + side] = Plane{ n * inv, d * inv };
+            }
+        }
+    }
+
+    Containment test(const BoundingSphere& sphere) const {
+        Containment result = Containment::Inside;
+        for (const Plane& plane : planes) {
+            float d = plane.signedDistance(sphere.center);
+            if (d < -sphere.radius) return Containment::Outside;
+            if (d < sphere.radius) result = Containment::Intersects;
+        }
+        return result;
+    }
+
+    // Per plane, the box's projected radius against the centre's distance
+    Containment test(const Aabb& box) const {
+        Vec3 c = box.center(), e = box.extents();
+        Containment result = Containment::Inside;
+        for (const Plane& plane : planes) {
+            float d = plane.signedDistance(c);
+            float r = std::fabs(plane.normal.x) * e.x + std::fabs(plane.normal.y) * e.y + std::fabs(plane.normal.z) * e.z;
+            if (d < -r) return Containment::Outside;
+            if (d < r) result = Containment::Intersects;
+        }
+        return result;
+    }
+
+    bool intersects(const Aabb& box) const { return test(box) != Containment::Outside; }
+    bool intersects(const BoundingSphere& sphere) const { return test(sphere) != Containment::Outside; }
+};
+
+#endif
@@ -0,0 +1,250 @@
+#ifndef MATH_MAT4_H
+#define MATH_MAT4_H
+
+#include "math/Quat.h"
+#include "math/Simd.h"
+#include "math/Vec3.h"
+#include "math/Vec4.h"
+#include <cmath>
+#include <cstddef>
+
+// What a matrix is known to be, so inverse() can take a cheaper path.
+// Affine: bottom row is (0, 0, 0, 1), e.g. any TRS model matrix.
+// Rigid: affine with an orthonormal 3x3 (rotation and translation only),
+// e.g. a lookAt view matrix.
+enum class MatrixKind { General, Affine, Rigid };
+
+// Column-major 4x4 matrix (OpenGL layout: m[12..14] is the translation),
+// 16-byte aligned so each column is one SSE load. data() can be passed
+// straight to glUniformMatrix4fv.
+struct alignas(16) Mat4 {
+    float m[16];
+
+    // Zero-filled; use identity() for the identity
+    Mat4() : m() {}
+
+    const float* data() const { return m; }
+    float* data() { return m; }
+    float& operator()(int row, int column) { return m[column * 4 + row]; }
+    float operator()(int row, int column) const { return m[column * 4 + row]; }
+
+    Vec4 getColumn(int c) const { return { m[c * 4], m[c * 4 + 1], m[c * 4 + 2], m[c * 4 + 3] }; }
+    void setColumn(int c, const Vec4& v) { m[c * 4] = v.x; m[c * 4 + 1] = v.y; m[c * 4 + 2] = v.z; m[c * 4 + 3] = v.w; }
+    Vec3 getTranslation() const { return { m[12], m[13], m[14] }; }
+
+    static Mat4 identity();
+    static Mat4 translation(const Vec3& t);
+    static Mat4 scale(const Vec3& s);
+    static Mat4 rotation(const Quat& q);
+
+    // Translation * rotation * scale from Euler angles in radians (ZYX order,
+    // the convention TransformComponent's rotation uses)
+    static Mat4 fromEulerTRS(const Vec3& t, const Vec3& radians, const Vec3& s);
+    static Mat4 fromTRS(const Vec3& t, const Quat& r, const Vec3& s);
+
+    // Right-handed view and projection matrices (OpenGL clip space)
+    static Mat4 lookAt(const Vec3& eye, const Vec3& target, const Vec3& up);
+    static Mat4 perspective(float fovyRadians, float aspect, float zNear, float zFar);
+    static Mat4 ortho(float left, float right, float bottom, float top, float zNear, float zFar);
+
+    Mat4 operator*(const Mat4& o) const;
+    Vec4 operator*(const Vec4& v) const;
+
+    Vec3 transformPoint(const Vec3& p) const;   // w = 1, no perspective divide
+    Vec3 transformVector(const Vec3& v) const;  // w = 0
+
+    Mat4 transposed() const;
+
+    // Most specific kind that fits this matrix (rigid within a small tolerance)
+    MatrixKind classify() const;
+
+    // Inverse, taking the rigid (transpose), affine (3x3 inverse) or general
+    // path. Without a kind, affine matrices are detected from the bottom row;
+    // pass MatrixKind::Rigid when it is known. Returns false (leaving out
+    // untouched) if singular; rigid inverses always succeed.
+    bool inverse(Mat4& out) const;
+    bool inverse(Mat4& out, MatrixKind kind) const;
+
+    // Batch kernels, dispatched at run time (see math/Simd.h).
+    // out[i] = a[i] * b[i]; out may alias a or b.
+    static void multiply(const Mat4* a, const Mat4* b, Mat4* out, size_t count);
+    // out[i] = this * (in[i], 1); out may alias in
+    void transformPoints(const Vec3* in, Vec3* out, size_t count) const;
+};
+
+inline Mat4 Mat4::identity() {
+    Mat4 r;
+    r.m[0] = r.m[5] = r.m[10] = r.m[15] = 1.0f;
+    return r;
+}
+
+inline Mat4 Mat4::translation(const Vec3& t) {
+    Mat4 r = identity();
+    r.m[12] = t.x; r.m[13] = t.y; r.m[14] = t.z;
+    return r;
+}
+
+inline Mat4 Mat4::scale(const Vec3& s) {
+    Mat4 r;
+    r.m[0] = s.x; r.m[5] = s.y; r.m[10] = s.z; r.m[15] = 1.0f;
+    return r;
+}
+
+inline Mat4 Mat4::rotation(const Quat& q) {
+    return fromTRS(Vec3(), q, Vec3(1.0f, 1.0f, 1.0f));
+}
+
+inline Mat4 Mat4::fromEulerTRS(const Vec3& t, const Vec3& radians, const Vec3& s) {
+    float cosx = std::cos(radians.x), sinx = std::sin(radians.x);
+    float cosy = std::cos(radians.y), siny = std::sin(radians.y);
+    float cosz = std::cos(radians.z), sinz = std::sin(radians.z);
+
+    Mat4 r;
+    r.m[0] = cosy * cosz * s.x;
+    r.m[1] = (sinx * siny * cosz - cosx * sinz) * s.x;
+    r.m[2] = (cosx * siny * cosz + sinx * sinz) * s.x;
+
+    r.m[4] = cosy * sinz * s.y;
+    r.m[5] = (sinx * siny * sinz + cosx * cosz) * s.y;
+    r.m[6] = (cosx * siny * sinz - sinx * cosz) * s.y;
+
+    r.m[8] = -siny * s.z;
+    r.m[9] = sinx * cosy * s.z;
+    r.m[10] = cosx * cosy * s.z;
+
+    r.m[12] = t.x; r.m[13] = t.y; r.m[14] = t.z; r.m[15] = 1.0f;
+    return r;
+}
+
+inline Mat4 Mat4::fromTRS(const Vec3& t, const Quat& q, const Vec3& s) {
+    float xx = q.x * q.x, yy = q.y * q.y, zz = q.z * q.z;
+    float xy = q.x * q.y, xz = q.x * q.z, yz = q.y * q.z;
+    float wx = q.w * q.x, wy = q.w * q.y, wz = q.w * q.z;
+
+    Mat4 r;
+    r.m[0] = (1.0f - 2.0f * (yy + zz)) * s.x;
+    r.m[1] = 2.0f * (xy + wz) * s.x;
+    r.m[2] = 2.0f * (xz - wy) * s.x;
+
+    r.m[4] = 2.0f * (xy - wz) * s.y;
+    r.m[5] = (1.0f - 2.0f * (xx + zz)) * s.y;
+    r.m[6] = 2.0f * (yz + wx) * s.y;
+
+    r.m[8] = 2.0f * (xz + wy) * s.z;
+    r.m[9] = 2.0f * (yz - wx) * s.z;
+    r.m[10] = (1.0f - 2.0f * (xx + yy)) * s.z;
+
+    r.m[12] = t.x; r.m[13] = t.y; r.m[14] = t.z; r.m[15] = 1.0f;
+    return r;
+}
+
+inline Mat4 Mat4::lookAt(const Vec3& eye, const Vec3& target, const Vec3& up) {
+    Vec3 f = normalize(target - eye);
+    Vec3 s = normalize(cross(f, up));
+    Vec3 u = cross(s, f);
+
+    Mat4 r;
+    r.m[0] = s.x; r.m[1] = u.x; r.m[2] = -f.x;
+    r.m[4] = s.y; r.m[5] = u.y; r.m[6] = -f.y;
+    r.m[8] = s.z; r.m[9] = u.z; r.m[10] = -f.z;
+    r.m[12] = -dot(s, eye);
+    r.m[13] = -dot(u, eye);
+    r.m[14] = dot(f, eye);
+    r.m[15] = 1.0f;
+    return r;
+}
+
+inline Mat4 Mat4::perspective(float fovyRadians, float aspect, float zNear, float zFar) {
+    float f = 1.0f / std::tan(fovyRadians * 0.5f);
+    Mat4 r;
+    r.m[0] = f / aspect;
+    r.m[5] = f;
+    r.m[10] = (zFar + zNear) / (zNear - zFar);
+    r.m[11] = -1.0f;
+    r.m[14] = (2.0f * zFar * zNear) / (zNear - zFar);
+    return r;
+}
+
+inline Mat4 Mat4::ortho(float left, float right, float bottom, float top, float zNear, float zFar) {
+    Mat4 r;
+    r.m[0] = 2.0f / (right - left);
+    r.m[5] = 2.0f / (top - bottom);
+    r.m[10] = -2.0f / (zFar - zNear);
+    r.m[12] = -(right + left) / (right - left);
+    r.m[13] = -(top + bottom) / (top - bottom);
+    r.m[14] = -(zFar + zNear) / (zFar - zNear);
+    r.m[15] = 1.0f;
+    return r;
+}
+
+inline Mat4 Mat4::operator*(const Mat4& o) const {
+    Mat4 r;
+#ifdef MATH_SSE2
+    __m128 a0 = _mm_load_ps(m + 0), a1 = _mm_load_ps(m + 4);
+    __m128 a2 = _mm_load_ps(m + 8), a3 = _mm_load_ps(m + 12);
+    for (int c = 0; c < 4; ++c) {
+        const float* bc = o.m + c * 4;
+        __m128 col = _mm_mul_ps(a0, _mm_set1_ps(bc[0]));
+        col = _mm_add_ps(col, _mm_mul_ps(a1, _mm_set1_ps(bc[1])));
+        col = _mm_add_ps(col, _mm_mul_ps(a2, _mm_set1_ps(bc[2])));
+        col = _mm_add_ps(col, _mm_mul_ps(a3, _mm_set1_ps(bc[3])));
+        _mm_store_ps(r.m + c * 4, col);
+    }
+#else
+    for (int c = 0; c < 4; ++c) {
+        for (int row = 0; row < 4; ++row) {
+            r.m[c * 4 + row] = m[row] * o.m[c * 4] + m[4 + row] * o.m[c * 4 + 1]
+                             + m[8 + row] * o.m[c * 4 + 2] + m[12 + row] * o.m[c * 4 + 3];
+        }
+    }
+#endif
+    return r;
+}
+
+inline Vec4 Mat4::operator*(const Vec4& v) const {
+#ifdef MATH_SSE2
+    __m128 r = _mm_mul_ps(_mm_load_ps(m + 0), _mm_set1_ps(v.x));
+    r = _mm_add_ps(r, _mm_mul_ps(_mm_load_ps(m + 4), _mm_set1_ps(v.y)));
+    r = _mm_add_ps(r, _mm_mul_ps(_mm_load_ps(m + 8), _mm_set1_ps(v.z)));
+    r = _mm_add_ps(r, _mm_mul_ps(_mm_load_ps(m + 12), _mm_set1_ps(v.w)));
+    return Vec4(r);
+#else
+    return {
+        m[0] * v.x + m[4] * v.y + m[8] * v.z + m[12] * v.w,
+        m[1] * v.x + m[5] * v.y + m[9] * v.z + m[13] * v.w,
+        m[2] * v.x + m[6] * v.y + m[10] * v.z + m[14] * v.w,
+        m[3] * v.x + m[7] * v.y + m[11] * v.z + m[15] * v.w };
+#endif
+}
+
+inline Vec3 Mat4::transformPoint(const Vec3& p) const {
+    return {
+        m[0] * p.x + m[4] * p.y + m[8] * p.z + m[12],
+        m[1] * p.x + m[5] * p.y + m[9] * p.z + m[13],
+        m[2] * p.x + m[6] * p.y + m[10] * p.z + m[14] };
+}
+
+inline Vec3 Mat4::transformVector(const Vec3& v) const {
+    return {
+        m[0] * v.x + m[4] * v.y + m[8] * v.z,
+        m[1] * v.x + m[5] * v.y + m[9] * v.z,
+        m[2] * v.x + m[6] * v.y + m[10] * v.z };
+}
+
+inline Mat4 Mat4::transposed() const {
+    Mat4 r;
+#ifdef MATH_SSE2
+    __m128 c0 = _mm_load_ps(m + 0), c1 = _mm_load_ps(m + 4);
+    __m128 c2 = _mm_load_ps(m + 8), c3 = _mm_load_ps(m + 12);
+    _MM_TRANSPOSE4_PS(c0, c1, c2, c3);
+    _mm_store_ps(r.m + 0, c0); _mm_store_ps(r.m + 4, c1);
+    _mm_store_ps(r.m + 8, c2); _mm_store_ps(r.m + 12, c3);
+#else
+    for (int c = 0; c < 4; ++c) {
+        for (int row = 0; row < 4; ++row) r.m[row * 4 + c] = m[c * 4 + row];
+    }
+#endif
+    return r;
+}
+
+#endif
@@ -0,0 +1,123 @@
+#ifndef MATH_QUAT_H
+#define MATH_QUAT_H
+
+#include "math/Simd.h"
+#include "math/Vec3.h"
+#include "math/Vec4.h"
+#include <cmath>
+#include <cstddef>
+
+// Unit quaternion rotation (x, y, z imaginary, w real), 16-byte aligned
+struct alignas(16) Quat {
+    float x = 0.0f, y = 0.0f, z = 0.0f, w = 1.0f;
+
+    Quat() = default;
+    constexpr Quat(float x, float y, float z, float w) : x(x), y(y), z(z), w(w) {}
+
+#ifdef MATH_SSE2
+    explicit Quat(__m128 v) { _mm_store_ps(&x, v); }
+    __m128 simd() const { return _mm_load_ps(&x); }
+#endif
+
+    static Quat identity() { return Quat(); }
+
+    // Rotation of radians around a unit axis
+    static Quat fromAxisAngle(const Vec3& axis, float radians) {
+        float s = std::sin(radians * 0.5f);
+        return { axis.x * s, axis.y * s, axis.z * s, std::cos(radians * 0.5f) };
+    }
+
+    // Same rotation as Mat4::fromEulerTRS for Euler angles in radians
+    static Quat fromEuler(const Vec3& radians) {
+        // That matrix is Rx(-x) * Ry(-y) * Rz(-z)
+        float cx = std::cos(radians.x * 0.5f), sx = -std::sin(radians.x * 0.5f);
+        float cy = std::cos(radians.y * 0.5f), sy = -std::sin(radians.y * 0.5f);
+        float cz = std::cos(radians.z * 0.5f), sz = -std::sin(radians.z * 0.5f);
+        return {
+            sx * cy * cz + cx * sy * sz,
+            cx * sy * cz - sx * cy * sz,
+            cx * cy * sz + sx * sy * cz,
+            cx * cy * cz - sx * sy * sz };
+    }
+
+    // fromEuler over arrays, four at a time with a polynomial sincos
+    // (see math/SinCos.h). out may not alias radians.
+    static void fromEuler(const Vec3* radians, Quat* out, size_t count);
+
+    // Euler angles in radians that fromEuler maps back to this rotation.
+    // At y = +-90 degrees x and z are ambiguous; z is returned as 0.
+    Vec3 toEuler() const {
+        // Entries of the rotation matrix (see Mat4::fromTRS)
+        float m0 = 1.0f - 2.0f * (y * y + z * z);
+        float m4 = 2.0f * (x * y - w * z);
+        float m5 = 1.0f - 2.0f * (x * x + z * z);
+        float m6 = 2.0f * (y * z + w * x);
+        float m8 = 2.0f * (x * z + w * y);
+        float m9 = 2.0f * (y * z - w * x);
+        float m10 = 1.0f - 2.0f * (x * x + y * y);
+
+        float cosY = std::sqrt(m0 * m0 + m4 * m4);
+        float angleY = std::atan2(-m8, cosY);
+        if (cosY < 1e-4f) {
+            return { std::atan2(-m6, m5), angleY, 0.0f };
+        }
+        return { std::atan2(m9, m10), angleY, std::atan2(m4, m0) };
+    }
+
+    // Hamilton product: applies o first, then this
+    Quat operator*(const Quat& o) const {
+#ifdef MATH_SSE2
+        __m128 b = o.simd();
+        __m128 r = _mm_mul_ps(_mm_set1_ps(w), b);
+        r = _mm_add_ps(r, _mm_mul_ps(_mm_mul_ps(_mm_set1_ps(x), _mm_shuffle_ps(b, b, _MM_SHUFFLE(0, 1, 2, 3))),
+                                     _mm_setr_ps(1.0f, -1.0f, 1.0f, -1.0f)));
+        r = _mm_add_ps(r, _mm_mul_ps(_mm_mul_ps(_mm_set1_ps(y), _mm_shuffle_ps(b, b, _MM_SHUFFLE(1, 0, 3, 2))),
+                                     _mm_setr_ps(1.0f, 1.0f, -1.0f, -1.0f)));
+        r = _mm_add_ps(r, _mm_mul_ps(_mm_mul_ps(_mm_set1_ps(z), _mm_shuffle_ps(b, b, _MM_SHUFFLE(2, 3, 0, 1))),
+                                     _mm_setr_ps(-1.0f, 1.0f, 1.0f, -1.0f)));
+        return Quat(r);
+#else
+        return {
+            w * o.x + x * o.w + y * o.z - z * o.y,
+            w * o.y - x * o.z + y * o.w + z * o.x,
+            w * o.z + x * o.y - y * o.x + z * o.w,
+            w * o.w - x * o.x - y * o.y - z * o.z };
+#endif
+    }
+
+    Quat conjugate() const { return { -x, -y, -z, w }; }
+
+    Quat normalized() const {
+        Vec4 v(x, y, z, w);
+        v = v * (1.0f / length(v));
+        return { v.x, v.y, v.z, v.w };
+    }
+
+    Vec3 rotate(const Vec3& v) const {
+        // v + 2w(u x v) + 2u x (u x v)
+        Vec3 u(x, y, z);
+        Vec3 t = cross(u, v) * 2.0f;
+        return v + t * w + cross(u, t);
+    }
+
+    // Shortest-path spherical interpolation
+    static Quat slerp(const Quat& a, const Quat& b, float t) {
+        Vec4 va(a.x, a.y, a.z, a.w), vb(b.x, b.y, b.z, b.w);
+        float cosTheta = dot(va, vb);
+        if (cosTheta < 0.0f) {
+            vb = -vb;
+            cosTheta = -cosTheta;
+        }
+        Vec4 r;
+        if (cosTheta > 0.9995f) {
+            r = normalize(va + (vb - va) * t); // Nearly parallel: lerp
+        } else {
+            float theta = std::acos(cosTheta);
+            float s = 1.0f / std::sin(theta);
+            r = va * (std::sin((1.0f - t) * theta) * s) + vb * (std::sin(t * theta) * s);
+        }
+        return { r.x, r.y, r.z, r.w };
+    }
+};
+
+#endif
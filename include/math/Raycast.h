@@ -0,0 +1,78 @@
+#ifndef MATH_RAYCAST_H
+#define MATH_RAYCAST_H
+
+#include "math/Vec3.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+struct Ray {
+    Vec3 origin;
+    Vec3 direction; // Hit distances t are in units of its length
+};
+
+struct RayHit {
+    static constexpr uint32_t NO_TRIANGLE = 0xFFFFFFFFu;
+
+    float t = 1e30f; // Only hits nearer than this are accepted
+    uint32_t triangle = NO_TRIANGLE;
+
+    bool hit() const { return triangle != NO_TRIANGLE; }
+};
+
+// Up to MAX_RAYS coherent rays (e.g. neighbouring pixels) in SoA form, so
+// one triangle can be tested against all of them at once
+struct RayPacket {
+    static constexpr size_t MAX_RAYS = 8;
+
+    alignas(32) float originX[MAX_RAYS] = {}, originY[MAX_RAYS] = {}, originZ[MAX_RAYS] = {};
+    alignas(32) float directionX[MAX_RAYS] = {}, directionY[MAX_RAYS] = {}, directionZ[MAX_RAYS] = {};
+    size_t count = 0;
+
+    void add(const Ray& ray) {
+        originX[count] = ray.origin.x; originY[count] = ray.origin.y; originZ[count] = ray.origin.z;
+        directionX[count] = ray.direction.x; directionY[count] = ray.direction.y; directionZ[count] = ray.direction.z;
+        ++count;
+    }
+};
+
+// Triangles precomputed for Möller–Trumbore: first vertex and the two edges
+// from it, one array per component. Storage is padded with degenerate
+// triangles (never hit) to a multiple of LANES so SIMD loads stay in bounds.
+class TriangleSoA {
+public:
+    static constexpr size_t LANES = 8;
+
+    void clear();
+    void reserve(size_t triangles);
+    void add(const Vec3& a, const Vec3& b, const Vec3& c);
+    // Replace the contents with a triangle list (every three vertices form one)
+    void assign(const Vec3* vertices, size_t vertexCount);
+
+    size_t size() const { return count_; }
+    bool empty() const { return count_ == 0; }
+
+    std::vector<float> v0x, v0y, v0z;
+    std::vector<float> e1x, e1y, e1z;
+    std::vector<float> e2x, e2y, e2z;
+
+private:
+    size_t count_ = 0;
+};
+
+// Möller–Trumbore for a single triangle. Returns true and t for hits in
+// front of the origin.
+bool intersectTriangle(const Ray& ray, const Vec3& v0, const Vec3& v1, const Vec3& v2, float& t);
+
+// Closest hit of one ray against triangles [begin, end), 4 (SSE2) or 8
+// (AVX2) triangles per step, dispatched at run time (see math/Simd.h).
+// Only hits nearer than hit.t are taken, so calls can be chained over
+// several ranges. Returns true if hit was updated.
+bool raycast(const Ray& ray, const TriangleSoA& triangles, size_t begin, size_t end, RayHit& hit);
+
+// Closest hit per ray of a packet against triangles [begin, end), each
+// triangle tested against 4 (SSE2) or 8 (AVX2) rays at once. hits holds
+// rays.count entries and is updated like the single-ray version.
+void raycast(const RayPacket& rays, const TriangleSoA& triangles, size_t begin, size_t end, RayHit* hits);
+
+#endif
@@ -0,0 +1,40 @@
+#ifndef MATH_SIMD_H
+#define MATH_SIMD_H
+
+// Instruction set selection for the math library (Vec3/Vec4/Quat/Mat4).
+//
+// Compile time: inline operations use SSE2 whenever the target has it (every
+// x86-64 build), and plain scalar code otherwise or when MATH_FORCE_SCALAR is
+// defined (CMake option of the same name).
+//
+// Run time: Mat4::inverse and the batch kernels (Mat4::multiply over arrays,
+// Mat4::transformPoints, raycast in math/Raycast.h) pick a path from the
+// CPU's features, detected once: AVX2+FMA, SSE2 or scalar.
+// setSimdLevel() can lower the level, e.g. to compare paths in benchmarks.
+
+#if !defined(MATH_FORCE_SCALAR) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define MATH_SSE2 1
+#include <emmintrin.h>
+#endif
+
+// AVX2 kernels are compiled per function, so the rest of the build doesn't need -mavx2
+#if defined(MATH_SSE2) && (defined(__GNUC__) || defined(__clang__) || defined(_MSC_VER))
+#define MATH_AVX2 1
+#if defined(__GNUC__) || defined(__clang__)
+#define MATH_TARGET_AVX2 __attribute__((target("avx2,fma")))
+#else
+#define MATH_TARGET_AVX2
+#endif
+#endif
+
+enum class SimdLevel { Scalar, SSE2, AVX2 };
+
+// Best level supported by both the build and this CPU
+SimdLevel getSupportedSimdLevel();
+// Level the batch kernels currently use
+SimdLevel getSimdLevel();
+// Use a lower level than supported (requests above it are clamped)
+void setSimdLevel(SimdLevel level);
+const char* getSimdLevelName(SimdLevel level);
+
+#endif
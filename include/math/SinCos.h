@@ -0,0 +1,97 @@
+#ifndef MATH_SINCOS_H
+#define MATH_SINCOS_H
+
+#include "math/Simd.h"
+#include <cmath>
+
+// Sine and cosine together from one range reduction, using the Cephes
+// single-precision polynomials (max error ~1 ulp for |x| < 8192).
+// Faster than separate sinf/cosf calls, and sinCos4 does four angles at once
+// for batch conversions such as Quat::fromEuler over arrays.
+namespace MathSinCos {
+    constexpr float FOUR_OVER_PI = 1.27323954473516f;
+    // pi/4 split into three parts so x - j*pi/4 stays exact
+    constexpr float DP1 = 0.78515625f;
+    constexpr float DP2 = 2.4187564849853515625e-4f;
+    constexpr float DP3 = 3.77489497744594108e-8f;
+
+    constexpr float COS_P0 = 2.443315711809948e-5f;
+    constexpr float COS_P1 = -1.388731625493765e-3f;
+    constexpr float COS_P2 = 4.166664568298827e-2f;
+    constexpr float SIN_P0 = -1.9515295891e-4f;
+    constexpr float SIN_P1 = 8.3321608736e-3f;
+    constexpr float SIN_P2 = -1.6666654611e-1f;
+}
+
+inline void sinCos(float x, float& s, float& c) {
+    using namespace MathSinCos;
+    float sign = x < 0.0f ? -1.0f : 1.0f;
+    x = std::fabs(x);
+
+    // Octant, rounded up to even so the remainder is in [-pi/4, pi/4]
+    int j = ((int)(x * FOUR_OVER_PI) + 1) & ~1;
+    float y = (float)j;
+    x = ((x - y * DP1) - y * DP2) - y * DP3;
+
+    float z = x * x;
+    float polyCos = ((COS_P0 * z + COS_P1) * z + COS_P2) * z * z - 0.5f * z + 1.0f;
+    float polySin = ((SIN_P0 * z + SIN_P1) * z + SIN_P2) * z * x + x;
+
+    // Octants 2 and 6 swap the polynomials; the sign flips every other quadrant
+    if (j & 2) {
+        s = polyCos;
+        c = -polySin;
+    } else {
+        s = polySin;
+        c = polyCos;
+    }
+    if (j & 4) {
+        s = -s;
+        c = -c;
+    }
+    s *= sign;
+}
+
+#ifdef MATH_SSE2
+inline void sinCos4(__m128 x, __m128& s, __m128& c) {
+    using namespace MathSinCos;
+    const __m128 signMask = _mm_castsi128_ps(_mm_set1_epi32((int)0x80000000));
+
+    __m128 signSin = _mm_and_ps(x, signMask);
+    x = _mm_andnot_ps(signMask, x);
+
+    __m128i j = _mm_cvttps_epi32(_mm_mul_ps(x, _mm_set1_ps(FOUR_OVER_PI)));
+    j = _mm_and_si128(_mm_add_epi32(j, _mm_set1_epi32(1)), _mm_set1_epi32(~1));
+    __m128 y = _mm_cvtepi32_ps(j);
+
+    // Bit 2 of j flips sin; bit 2 of (j - 2) clear flips cos
+    __m128 flipSin = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(j, _mm_set1_epi32(4)), 29));
+    __m128 signCos = _mm_castsi128_ps(_mm_slli_epi32(
+        _mm_andnot_si128(_mm_sub_epi32(j, _mm_set1_epi32(2)), _mm_set1_epi32(4)), 29));
+    signSin = _mm_xor_ps(signSin, flipSin);
+    // Lanes where the sin polynomial gives sin (bit 1 of j clear)
+    __m128 useSinPoly = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(j, _mm_set1_epi32(2)), _mm_setzero_si128()));
+
+    x = _mm_sub_ps(x, _mm_mul_ps(y, _mm_set1_ps(DP1)));
+    x = _mm_sub_ps(x, _mm_mul_ps(y, _mm_set1_ps(DP2)));
+    x = _mm_sub_ps(x, _mm_mul_ps(y, _mm_set1_ps(DP3)));
+
+    __m128 z = _mm_mul_ps(x, x);
+    __m128 polyCos = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(COS_P0), z), _mm_set1_ps(COS_P1));
+    polyCos = _mm_add_ps(_mm_mul_ps(polyCos, z), _mm_set1_ps(COS_P2));
+    polyCos = _mm_mul_ps(_mm_mul_ps(polyCos, z), z);
+    polyCos = _mm_sub_ps(polyCos, _mm_mul_ps(z, _mm_set1_ps(0.5f)));
+    polyCos = _mm_add_ps(polyCos, _mm_set1_ps(1.0f));
+
+    __m128 polySin = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(SIN_P0), z), _mm_set1_ps(SIN_P1));
+    polySin = _mm_add_ps(_mm_mul_ps(polySin, z), _mm_set1_ps(SIN_P2));
+    polySin = _mm_add_ps(_mm_mul_ps(_mm_mul_ps(polySin, z), x), x);
+
+    __m128 sinValue = _mm_or_ps(_mm_and_ps(useSinPoly, polySin), _mm_andnot_ps(useSinPoly, polyCos));
+    __m128 cosValue = _mm_or_ps(_mm_and_ps(useSinPoly, polyCos), _mm_andnot_ps(useSinPoly, polySin));
+    s = _mm_xor_ps(sinValue, signSin);
+    c = _mm_xor_ps(cosValue, signCos);
+}
+#endif
+
+#endif
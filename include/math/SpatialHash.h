@@ -0,0 +1,418 @@
+#ifndef MATH_SPATIAL_HASH_H
+#define MATH_SPATIAL_HASH_H
+
+#include "math/Bounds.h"
+#include "math/Simd.h"
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Hashed uniform grid over boxes, for "what is near this point" queries
+// (lights reaching an object, proximity checks, spawn density). Each item
+// lives in the one cell holding its box centre ("loose" cells), so a move
+// only touches the grid when the centre crosses into another cell; queries
+// widen their cell range by the largest half extent stored. Items bigger
+// than a cell are kept in a separate list that every query scans.
+//
+// Only occupied cells take memory: they live in an open-addressing table
+// keyed by integer cell coordinates, so a probe lands on the cell itself.
+// Table slots only hold the cell's coordinates and where its boxes are, so
+// the table stays small enough to remain cached. The boxes are copied into
+// blocks of four, structure-of-arrays and contiguous per cell, so a query
+// reads one or two cache lines per cell and tests four boxes per
+// instruction (eight with AVX2). Pick a cell size of one to two typical
+// query radii: smaller cells mean more table probes per query, larger ones
+// more boxes tested per cell.
+//
+// Item ids stay valid until remove(). Queries are const and may run
+// concurrently with each other, but not with insert/move/remove.
+class SpatialHash {
+public:
+    static constexpr uint32_t NULL_ITEM = 0xFFFFFFFFu;
+
+    explicit SpatialHash(float cellSize = 16.0f);
+
+    // Add an item for box; userData is handed back by getUserData()
+    uint32_t insert(const Aabb& box, uint32_t userData);
+    // Update an item's box. Returns true if it changed cell.
+    bool move(uint32_t item, const Aabb& box);
+    void remove(uint32_t item);
+    void clear();
+
+    uint32_t getUserData(uint32_t item) const { return userData_[item]; }
+    Aabb getBounds(uint32_t item) const;
+    size_t getItemCount() const { return itemCount_; }
+    size_t getOccupiedCellCount() const { return occupiedCells_; }
+    size_t getLargeItemCount() const { return largeCount_; }
+    float getCellSize() const { return cellSize_; }
+    // Changes with every insert/move/remove/clear, so derived data (e.g.
+    // per-object light lists) can tell when it is stale
+    uint32_t getVersion() const { return version_; }
+
+    // Calls f(item) for every item whose box is within radius of center
+    template<typename F> void queryRadius(const Vec3& center, float radius, F&& f) const;
+    // Calls f(item) for every item whose box overlaps box
+    template<typename F> void queryAabb(const Aabb& box, F&& f) const;
+
+    // The k items whose boxes are nearest to point, no farther than
+    // maxDistance, nearest first. out needs room for k entries; returns how
+    // many were found. Cells are searched in rings around the point, nearest
+    // cell first, skipping cells that can't hold anything nearer than the
+    // k-th found so far, so the cost follows the distance to the k-th item
+    // rather than the item count.
+    struct Neighbor {
+        uint32_t item;
+        float distanceSquared; // 0 when point is inside the box
+    };
+    size_t queryNearest(const Vec3& point, size_t k, float maxDistance, Neighbor* out) const;
+
+    // Batched forms for many points in no particular order (e.g. every
+    // object's light query): the points are run in cell order, so points in
+    // the same cell share one lookup of the cells around them and find their
+    // blocks already cached. Use these when there are many points; they are
+    // several times the single queries' rate. The radius form calls
+    // f(pointIndex, item); the nearest form writes point i's neighbours to
+    // out[i * k..] and their count to found[i].
+    template<typename F> void queryRadius(const Vec3* centers, size_t count, float radius, F&& f) const;
+    void queryNearest(const Vec3* points, size_t count, size_t k, float maxDistance, Neighbor* out,
+                      uint32_t* found) const;
+
+    // Calls f(cellBounds, itemCount) for every occupied cell (large items
+    // are not in any cell), e.g. to find crowded areas
+    template<typename F> void forEachCell(F&& f) const;
+    // Items whose centre is in the cell containing point
+    size_t countInCell(const Vec3& point) const;
+
+private:
+    static constexpr uint32_t NULL_CELL = 0xFFFFFFFFu;
+    static constexpr uint32_t LARGE_CELL = 0xFFFFFFFEu; // cellOf_ of items in large_
+    // Cell coordinates are clamped so ring and range arithmetic can't overflow
+    static constexpr int32_t MAX_COORD = 1 << 28;
+
+    static constexpr uint32_t LANES = 4;
+    static constexpr uint32_t RUN_CLASSES = 32; // Block runs are powers of two
+
+    // Up to four items' boxes as structure-of-arrays, so one SSE test covers
+    // them all. Unused lanes hold an inverted box that no test accepts.
+    struct alignas(64) Block {
+        uint32_t count; // Items in the cell, kept in the first block of its run
+        uint32_t padding[3];
+        float minX[LANES], minY[LANES], minZ[LANES];
+        float maxX[LANES], maxY[LANES], maxZ[LANES];
+        uint32_t item[LANES];
+
+        void set(uint32_t lane, const Aabb& box, uint32_t id);
+        void clear(uint32_t lane);
+        void copyLane(uint32_t lane, const Block& from, uint32_t fromLane);
+        float halfExtent(uint32_t lane) const;
+    };
+    // A cell's items fill the first lanes of a run of 1 << runClass blocks
+    // in blocks_. Four cells share a cache line.
+    static constexpr uint32_t FREE_SLOT = (1u << 27) - 1;
+    struct Cell {
+        int32_t x, y, z;
+        uint32_t firstBlock : 27; // FREE_SLOT for a free table slot
+        uint32_t runClass : 5;
+        Cell() : x(0), y(0), z(0), firstBlock(FREE_SLOT), runClass(0) {}
+        bool isFree() const { return firstBlock == FREE_SLOT; }
+        uint32_t blockCount() const { return 1u << runClass; }
+    };
+
+    // Writes the items of the count blocks whose box is within sqrt(limit)
+    // of p to hits, and their squared distances to distances; returns how
+    // many. Hits are compacted without branches, writing every lane, so both
+    // need room for (count + 1) * LANES entries. Runs at the level
+    // getSimdLevel() picks; AVX2 tests two blocks at once.
+    static uint32_t collectWithin(const Block* const* blocks, size_t count, const Vec3& p, float limit, uint32_t* hits,
+                                  float* distances);
+    static constexpr size_t COLLECT_BLOCKS = 32; // Blocks per collectWithin call
+    // Calls f(item, distanceSquared) for each of the count items in blocks
+    // whose box is within sqrt(limit) of p
+    template<typename F>
+    static void forEachWithin(const Block* blocks, uint32_t count, const Vec3& p, float limit, F&& f);
+    // Calls f(item) for each of the count items in blocks whose box overlaps box
+    template<typename F>
+    static void forEachOverlapping(const Block* blocks, uint32_t count, const Aabb& box, F&& f);
+
+    static uint32_t hashCell(int32_t x, int32_t y, int32_t z) {
+        // Runs of four cells along x hash to four neighbouring slots, so a
+        // query's row of cells shares cache lines. The runs differ in few low
+        // bits, so mix fully or linear probing runs into their clusters.
+        uint32_t h = (uint32_t)(x >> 2) * 0x8DA6B343u ^ (uint32_t)y * 0xD8163841u ^ (uint32_t)z * 0xCB1AB31Fu;
+        h = (h ^ (h >> 16)) * 0x7FEB352Du;
+        h = (h ^ (h >> 15)) * 0x846CA68Bu;
+        return ((h ^ (h >> 16)) << 2) | ((uint32_t)x & 3);
+    }
+    uint32_t cellCount(const Cell& cell) const { return blocks_[cell.firstBlock].count; }
+    int32_t coord(float v) const {
+        // Truncate and step down for negatives: std::floor is a library call
+        // without SSE4.1, and queries take several coordinates per point
+        float c = v * invCellSize_;
+        if (c >= (float)MAX_COORD) return MAX_COORD;
+        if (c <= (float)-MAX_COORD) return -MAX_COORD;
+        int32_t i = (int32_t)c;
+        return c < (float)i ? i - 1 : i;
+    }
+    uint32_t findCell(int32_t x, int32_t y, int32_t z) const;
+    uint32_t findOrAddCell(int32_t x, int32_t y, int32_t z);
+    // Rebuild the table with size slots and the block pool, dropping empty
+    // cells if asked. Blocks are laid out in cell order (z, then y, then x),
+    // so neighbouring cells in a query's range are near in memory too; items'
+    // cellOf_ follow their cell.
+    void rehash(size_t size, bool dropEmpty);
+    // Drop empty cells once they outnumber the occupied ones
+    void compact();
+    // Runs of 1 << runClass blocks, cleared on allocation
+    uint32_t allocateBlocks(uint32_t runClass);
+    void freeBlocks(uint32_t first, uint32_t runClass);
+    void place(uint32_t item, const Aabb& box, const Vec3& center, float halfExtent);
+    void unplace(uint32_t item);
+    // Cells within [min, max] widened by the largest half extent, clipped to
+    // the occupied range; false if that's empty
+    bool cellRange(const Vec3& min, const Vec3& max, int32_t lo[3], int32_t hi[3]) const;
+    void prefetchBlocks(const Cell& cell) const {
+#ifdef MATH_SSE2
+        const char* first = (const char*)&blocks_[cell.firstBlock];
+        const char* last = (const char*)&blocks_[cell.firstBlock + std::min(cell.blockCount(), 4u)];
+        for (const char* line = first; line < last; line += 64) _mm_prefetch(line, _MM_HINT_T0);
+#else
+        (void)cell;
+#endif
+    }
+    // Indices of the count points sorted by the cell (z, then y, then x)
+    // holding them, and the points in that order
+    void sortByCell(const Vec3* points, size_t count, std::vector<uint32_t>& order, std::vector<Vec3>& sorted) const;
+    // Splits sorted points into runs of at most MAX_GROUP in the same cell
+    // and calls f(first, size) for each
+    static constexpr size_t MAX_GROUP = 64;
+    template<typename F> void forEachGroup(const std::vector<Vec3>& sorted, F&& f) const;
+    // Blocks of each cell in a range, looked up once so a group's points
+    // can each walk their part of it without probing. Missing cells are
+    // empty spans.
+    struct CellSpan {
+        const Block* begin;
+        const Block* end;
+    };
+    static constexpr size_t GROUP_CELLS = 512; // Largest range gathered
+    void gatherCells(const int32_t lo[3], const int32_t hi[3], CellSpan* cells) const;
+    // Calls f(item, distanceSquared) for the items within sqrt(limit) of p in
+    // cells [lo, hi] of the cells gathered over [gridLo, gridHi]
+    template<typename F>
+    static void forEachInCells(const CellSpan* cells, const int32_t gridLo[3], const int32_t gridHi[3],
+                               const int32_t lo[3], const int32_t hi[3], const Vec3& p, float limit, F&& f);
+    // Calls f(j, item, distanceSquared) for each item within radius of each
+    // points[j] of a group, probing every cell once for the group
+    template<typename F> void visitGroup(const Vec3* points, size_t size, float radius, F&& f) const;
+    // Calls f(cell, blocks, count) for every occupied cell in the range
+    template<typename F> void visitRange(const int32_t lo[3], const int32_t hi[3], F&& f) const;
+
+    float cellSize_;
+    float invCellSize_;
+    float maxHalfExtent_ = 0.0f; // Largest half extent of an item in a cell since the last clear/compact
+
+    std::vector<Cell> table_; // Power-of-two size, at most half full
+    size_t cellCount_ = 0;     // Used slots, including cells emptied since the last compact
+    size_t occupiedCells_ = 0;
+    int32_t occupiedMin_[3] = { 0, 0, 0 }; // Range of cells ever occupied since the last clear/compact
+    int32_t occupiedMax_[3] = { -1, -1, -1 };
+
+    std::vector<Block> blocks_;
+    std::vector<uint32_t> freeRuns_[RUN_CLASSES]; // First block of free runs, by log2 of their length
+
+    std::vector<Block> large_; // Items in lanes 0..largeCount_-1
+    uint32_t largeCount_ = 0;
+    std::vector<uint32_t> cellOf_; // Item -> table slot, LARGE_CELL or NULL_CELL (free)
+    std::vector<uint32_t> slotOf_; // Item -> lane in its cell's blocks (or large_), counting across blocks
+    std::vector<uint32_t> userData_;
+    std::vector<uint32_t> freeItems_;
+    size_t itemCount_ = 0;
+    uint32_t version_ = 0;
+};
+
+template<typename F>
+void SpatialHash::forEachWithin(const Block* blocks, uint32_t count, const Vec3& p, float limit, F&& f) {
+    const Block* list[COLLECT_BLOCKS];
+    uint32_t hits[(COLLECT_BLOCKS + 1) * LANES];
+    float distances[(COLLECT_BLOCKS + 1) * LANES];
+    const Block* end = blocks + (count + LANES - 1) / LANES;
+    while (blocks != end) {
+        size_t listed = 0;
+        for (; blocks != end && listed < COLLECT_BLOCKS; ++blocks) list[listed++] = blocks;
+        uint32_t n = collectWithin(list, listed, p, limit, hits, distances);
+        for (uint32_t i = 0; i < n; ++i) f(hits[i], distances[i]);
+    }
+}
+
+template<typename F>
+void SpatialHash::forEachOverlapping(const Block* blocks, uint32_t count, const Aabb& box, F&& f) {
+    const Block* end = blocks + (count + LANES - 1) / LANES;
+    for (const Block* block = blocks; block != end; ++block) {
+        for (uint32_t l = 0; l < LANES; ++l) {
+            if (block->minX[l] <= box.max.x && block->maxX[l] >= box.min.x && block->minY[l] <= box.max.y &&
+                block->maxY[l] >= box.min.y && block->minZ[l] <= box.max.z && block->maxZ[l] >= box.min.z) {
+                f(block->item[l]);
+            }
+        }
+    }
+}
+
+template<typename F>
+void SpatialHash::visitRange(const int32_t lo[3], const int32_t hi[3], F&& f) const {
+    // Look the cells up first (the table is small and stays cached) and
+    // prefetch their blocks, so the block misses overlap instead of each
+    // stalling its own test
+    constexpr int BATCH = 32;
+    const Cell* cells[BATCH];
+    int batchSize = 0;
+    auto flush = [&]() {
+        for (int i = 0; i < batchSize; ++i) {
+            const Block* blocks = &blocks_[cells[i]->firstBlock];
+            if (blocks->count) f(*cells[i], blocks, blocks->count);
+        }
+        batchSize = 0;
+    };
+    for (int32_t z = lo[2]; z <= hi[2]; ++z) {
+        for (int32_t y = lo[1]; y <= hi[1]; ++y) {
+            for (int32_t x = lo[0]; x <= hi[0]; ++x) {
+                uint32_t slot = findCell(x, y, z);
+                if (slot == NULL_CELL) continue;
+                const Cell& cell = table_[slot];
+                prefetchBlocks(cell);
+                cells[batchSize++] = &cell;
+                if (batchSize == BATCH) flush();
+            }
+        }
+    }
+    flush();
+}
+
+template<typename F>
+void SpatialHash::queryRadius(const Vec3& center, float radius, F&& f) const {
+    float radiusSquared = radius * radius;
+    auto visit = [&](const Block* blocks, uint32_t count) {
+        forEachWithin(blocks, count, center, radiusSquared, [&](uint32_t item, float) { f(item); });
+    };
+    if (largeCount_) visit(large_.data(), largeCount_);
+
+    Vec3 reach(radius, radius, radius);
+    int32_t lo[3], hi[3];
+    if (cellRange(center - reach, center + reach, lo, hi)) {
+        visitRange(lo, hi, [&](const Cell&, const Block* blocks, uint32_t count) { visit(blocks, count); });
+    }
+}
+
+template<typename F>
+void SpatialHash::forEachGroup(const std::vector<Vec3>& sorted, F&& f) const {
+    for (size_t begin = 0; begin < sorted.size();) {
+        int32_t x = coord(sorted[begin].x), y = coord(sorted[begin].y), z = coord(sorted[begin].z);
+        size_t end = begin + 1;
+        while (end < sorted.size() && end - begin < MAX_GROUP && coord(sorted[end].x) == x &&
+               coord(sorted[end].y) == y && coord(sorted[end].z) == z) {
+            ++end;
+        }
+        f(begin, end - begin);
+        begin = end;
+    }
+}
+
+template<typename F>
+void SpatialHash::forEachInCells(const CellSpan* cells, const int32_t gridLo[3], const int32_t gridHi[3],
+                                 const int32_t lo[3], const int32_t hi[3], const Vec3& p, float limit, F&& f) {
+    const Block* list[COLLECT_BLOCKS];
+    uint32_t hits[(COLLECT_BLOCKS + 1) * LANES];
+    float distances[(COLLECT_BLOCKS + 1) * LANES];
+    size_t listed = 0;
+    auto flush = [&]() {
+        uint32_t n = collectWithin(list, listed, p, limit, hits, distances);
+        for (uint32_t i = 0; i < n; ++i) f(hits[i], distances[i]);
+        listed = 0;
+    };
+    int32_t sizeX = gridHi[0] - gridLo[0] + 1, sizeY = gridHi[1] - gridLo[1] + 1;
+    for (int32_t z = lo[2]; z <= hi[2]; ++z) {
+        for (int32_t y = lo[1]; y <= hi[1]; ++y) {
+            const CellSpan* row = cells + ((z - gridLo[2]) * sizeY + (y - gridLo[1])) * sizeX;
+            for (int32_t x = lo[0]; x <= hi[0]; ++x) {
+                const CellSpan& cell = row[x - gridLo[0]];
+                for (const Block* block = cell.begin; block != cell.end; ++block) {
+                    list[listed++] = block;
+                    if (listed == COLLECT_BLOCKS) flush();
+                }
+            }
+        }
+    }
+    if (listed) flush();
+}
+
+template<typename F>
+void SpatialHash::visitGroup(const Vec3* points, size_t size, float radius, F&& f) const {
+    float radiusSquared = radius * radius;
+    Vec3 reach(radius, radius, radius);
+    int32_t lo[MAX_GROUP][3], hi[MAX_GROUP][3];
+    bool any[MAX_GROUP];
+    int32_t groupLo[3] = { MAX_COORD, MAX_COORD, MAX_COORD }, groupHi[3] = { -MAX_COORD, -MAX_COORD, -MAX_COORD };
+    for (size_t j = 0; j < size; ++j) {
+        const Vec3& p = points[j];
+        forEachWithin(large_.data(), largeCount_, p, radiusSquared, [&](uint32_t item, float d) { f(j, item, d); });
+        any[j] = cellRange(p - reach, p + reach, lo[j], hi[j]);
+        for (int a = 0; any[j] && a < 3; ++a) {
+            groupLo[a] = std::min(groupLo[a], lo[j][a]);
+            groupHi[a] = std::max(groupHi[a], hi[j][a]);
+        }
+    }
+    if (groupLo[0] > groupHi[0]) return;
+
+    size_t volume = 1;
+    for (int a = 0; a < 3; ++a) volume *= (size_t)(groupHi[a] - groupLo[a] + 1);
+    if (volume > GROUP_CELLS) {
+        // Too wide to gather: each point probes its own range
+        for (size_t j = 0; j < size; ++j) {
+            if (!any[j]) continue;
+            visitRange(lo[j], hi[j], [&](const Cell&, const Block* blocks, uint32_t count) {
+                forEachWithin(blocks, count, points[j], radiusSquared, [&](uint32_t item, float d) { f(j, item, d); });
+            });
+        }
+        return;
+    }
+    CellSpan cells[GROUP_CELLS];
+    gatherCells(groupLo, groupHi, cells);
+    for (size_t j = 0; j < size; ++j) {
+        if (!any[j]) continue;
+        forEachInCells(cells, groupLo, groupHi, lo[j], hi[j], points[j], radiusSquared,
+                       [&](uint32_t item, float d) { f(j, item, d); });
+    }
+}
+
+template<typename F>
+void SpatialHash::queryRadius(const Vec3* centers, size_t count, float radius, F&& f) const {
+    std::vector<uint32_t> order;
+    std::vector<Vec3> sorted;
+    sortByCell(centers, count, order, sorted);
+    forEachGroup(sorted, [&](size_t first, size_t size) {
+        visitGroup(&sorted[first], size, radius, [&](size_t j, uint32_t item, float) { f((size_t)order[first + j], item); });
+    });
+}
+
+template<typename F>
+void SpatialHash::queryAabb(const Aabb& box, F&& f) const {
+    if (largeCount_) forEachOverlapping(large_.data(), largeCount_, box, f);
+
+    int32_t lo[3], hi[3];
+    if (cellRange(box.min, box.max, lo, hi)) {
+        visitRange(lo, hi, [&](const Cell&, const Block* blocks, uint32_t count) {
+            forEachOverlapping(blocks, count, box, f);
+        });
+    }
+}
+
+template<typename F>
+void SpatialHash::forEachCell(F&& f) const {
+    for (const Cell& cell : table_) {
+        if (cell.isFree() || cellCount(cell) == 0) continue;
+        Vec3 min(cell.x * cellSize_, cell.y * cellSize_, cell.z * cellSize_);
+        f(Aabb{ min, min + Vec3(cellSize_, cellSize_, cellSize_) }, (size_t)cellCount(cell));
+    }
+}
+
+#endif
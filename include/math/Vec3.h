@@ -0,0 +1,46 @@
+#ifndef MATH_VEC3_H
+#define MATH_VEC3_H
+
+#include <cmath>
+
+// Three floats, tightly packed (12 bytes) so arrays of them match vertex and
+// SoA-gathered data. Operations are scalar: a 3-wide value only fills part of
+// a SIMD register, so Vec4/Mat4 carry the vectorized paths.
+struct Vec3 {
+    float x = 0.0f, y = 0.0f, z = 0.0f;
+
+    Vec3() = default;
+    constexpr Vec3(float x, float y, float z) : x(x), y(y), z(z) {}
+    explicit Vec3(const float* v) : x(v[0]), y(v[1]), z(v[2]) {}
+
+    float& operator[](int i) { return (&x)[i]; }
+    float operator[](int i) const { return (&x)[i]; }
+    const float* data() const { return &x; }
+
+    Vec3 operator+(const Vec3& o) const { return { x + o.x, y + o.y, z + o.z }; }
+    Vec3 operator-(const Vec3& o) const { return { x - o.x, y - o.y, z - o.z }; }
+    Vec3 operator*(const Vec3& o) const { return { x * o.x, y * o.y, z * o.z }; }
+    Vec3 operator*(float s) const { return { x * s, y * s, z * s }; }
+    Vec3 operator/(float s) const { float r = 1.0f / s; return { x * r, y * r, z * r }; }
+    Vec3 operator-() const { return { -x, -y, -z }; }
+    Vec3& operator+=(const Vec3& o) { x += o.x; y += o.y; z += o.z; return *this; }
+    Vec3& operator-=(const Vec3& o) { x -= o.x; y -= o.y; z -= o.z; return *this; }
+    Vec3& operator*=(float s) { x *= s; y *= s; z *= s; return *this; }
+};
+
+inline Vec3 operator*(float s, const Vec3& v) { return v * s; }
+
+inline float dot(const Vec3& a, const Vec3& b) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+inline Vec3 cross(const Vec3& a, const Vec3& b) {
+    return { a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x };
+}
+inline float length(const Vec3& v) { return std::sqrt(dot(v, v)); }
+inline Vec3 normalize(const Vec3& v) { return v / length(v); }
+inline Vec3 componentMin(const Vec3& a, const Vec3& b) {
+    return { a.x < b.x ? a.x : b.x, a.y < b.y ? a.y : b.y, a.z < b.z ? a.z : b.z };
+}
+inline Vec3 componentMax(const Vec3& a, const Vec3& b) {
+    return { a.x > b.x ? a.x : b.x, a.y > b.y ? a.y : b.y, a.z > b.z ? a.z : b.z };
+}
+
+#endif
@@ -0,0 +1,59 @@
+#ifndef MATH_VEC4_H
+#define MATH_VEC4_H
+
+#include "math/Simd.h"
+#include "math/Vec3.h"
+#include <cmath>
+
+// Four floats, 16-byte aligned so one SSE register loads the whole value
+struct alignas(16) Vec4 {
+    float x = 0.0f, y = 0.0f, z = 0.0f, w = 0.0f;
+
+    Vec4() = default;
+    constexpr Vec4(float x, float y, float z, float w) : x(x), y(y), z(z), w(w) {}
+    Vec4(const Vec3& v, float w) : x(v.x), y(v.y), z(v.z), w(w) {}
+
+#ifdef MATH_SSE2
+    explicit Vec4(__m128 v) { _mm_store_ps(&x, v); }
+    __m128 simd() const { return _mm_load_ps(&x); }
+#endif
+
+    float& operator[](int i) { return (&x)[i]; }
+    float operator[](int i) const { return (&x)[i]; }
+    const float* data() const { return &x; }
+    Vec3 xyz() const { return { x, y, z }; }
+
+#ifdef MATH_SSE2
+    Vec4 operator+(const Vec4& o) const { return Vec4(_mm_add_ps(simd(), o.simd())); }
+    Vec4 operator-(const Vec4& o) const { return Vec4(_mm_sub_ps(simd(), o.simd())); }
+    Vec4 operator*(const Vec4& o) const { return Vec4(_mm_mul_ps(simd(), o.simd())); }
+    Vec4 operator*(float s) const { return Vec4(_mm_mul_ps(simd(), _mm_set1_ps(s))); }
+#else
+    Vec4 operator+(const Vec4& o) const { return { x + o.x, y + o.y, z + o.z, w + o.w }; }
+    Vec4 operator-(const Vec4& o) const { return { x - o.x, y - o.y, z - o.z, w - o.w }; }
+    Vec4 operator*(const Vec4& o) const { return { x * o.x, y * o.y, z * o.z, w * o.w }; }
+    Vec4 operator*(float s) const { return { x * s, y * s, z * s, w * s }; }
+#endif
+    Vec4 operator-() const { return *this * -1.0f; }
+    Vec4& operator+=(const Vec4& o) { return *this = *this + o; }
+    Vec4& operator-=(const Vec4& o) { return *this = *this - o; }
+    Vec4& operator*=(float s) { return *this = *this * s; }
+};
+
+inline Vec4 operator*(float s, const Vec4& v) { return v * s; }
+
+inline float dot(const Vec4& a, const Vec4& b) {
+#ifdef MATH_SSE2
+    // Horizontal add with SSE2 shuffles (no SSE3/SSE4.1 needed)
+    __m128 p = _mm_mul_ps(a.simd(), b.simd());
+    p = _mm_add_ps(p, _mm_shuffle_ps(p, p, _MM_SHUFFLE(2, 3, 0, 1)));
+    p = _mm_add_ps(p, _mm_shuffle_ps(p, p, _MM_SHUFFLE(1, 0, 3, 2)));
+    return _mm_cvtss_f32(p);
+#else
+    return a.x * b.x + a.y * b.y + a.z * b.z + a.w * b.w;
+#endif
+}
+inline float length(const Vec4& v) { return std::sqrt(dot(v, v)); }
+inline Vec4 normalize(const Vec4& v) { return v * (1.0f / length(v)); }
+
+#endif
@@ -0,0 +1,59 @@
+#ifndef BOUNDS_SYSTEM_H
+#define BOUNDS_SYSTEM_H
+
+#include "ecs/Entity.h"
+#include "ecs/System.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Keeps the scene's AabbTree (Scene::getBoundsTree()) and SpatialHash
+// (Scene::getSpatialIndex()) holding the world bounds of every enabled mesh
+// renderer, keyed by entity index. Like the
+// LightGatherSystem it follows changes rather than scanning: a structure
+// change of MeshRendererComponent rescans, renderers reported through
+// GameObject::markChanged<MeshRendererComponent>() (mesh swapped, enabled
+// toggled) are refreshed, and transforms are watched so only objects that
+// moved get new bounds. Most moves stay inside their fat box and cell and
+// leave both structures' layout untouched.
+class BoundsSystem : public System {
+public:
+    BoundsSystem();
+
+    const char* getName() const override { return "Bounds"; }
+    void update(Scene& scene, float deltaTime) override;
+
+    // Objects whose world bounds the last update recomputed, and how many of
+    // them left their fat box and were reinserted (for profiling)
+    size_t getRefreshedCount() const { return refreshed_; }
+    size_t getReinsertedCount() const { return reinserted_; }
+
+    // Entities the last update refreshed (new bounds, or renderer added,
+    // disabled or emptied), for caches that follow the tree rather than
+    // scanning (RenderListSystem). Incomplete when the update rescanned: the
+    // rescan count changes then, and every entity may have changed.
+    // Read from systems that declare readsResource(BOUNDS_TREE).
+    const std::vector<EntityId>& getUpdated() const { return updated_; }
+    uint32_t getRescanCount() const { return rescans_; }
+
+private:
+    void rescan(Scene& scene);
+    void refresh(Scene& scene, EntityId entity);
+
+    std::vector<int32_t> proxyOf_; // Entity index -> tree proxy, or AabbTree::NULL_NODE
+    std::vector<uint32_t> itemOf_; // Entity index -> spatial hash item (valid while it has a proxy)
+    std::vector<uint32_t> seen_;   // Entity index -> scan that last found it
+    uint32_t scan_ = 0;
+
+    uint32_t structureVersion_ = 0;
+    bool built_ = false;
+    std::vector<EntityId> changed_;
+    std::vector<uint32_t> moved_;
+    std::vector<EntityId> updated_;
+    uint32_t rescans_ = 0;
+
+    size_t refreshed_ = 0;
+    size_t reinserted_ = 0;
+};
+
+#endif
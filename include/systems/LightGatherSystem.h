@@ -0,0 +1,123 @@
+#ifndef LIGHT_GATHER_SYSTEM_H
+#define LIGHT_GATHER_SYSTEM_H
+
+#include "ecs/Entity.h"
+#include "ecs/System.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class SpatialHash;
+
+// Keeps a packed, GPU-ready array of the scene's enabled lights up to date.
+// Instead of scanning the scene every frame it listens for changes: the
+// registry's structure version for LightComponent (lights added, removed,
+// objects destroyed, snapshots restored) triggers a rebuild, lights reported
+// through GameObject::markChanged<LightComponent>() are refreshed, and light
+// transforms are watched in the TransformStore so only lights that moved are
+// rewritten. A frame without light changes does no light work.
+class LightGatherSystem : public System {
+public:
+    // One light as two RGBA32F texels of the shader's light buffer
+    struct GpuLight {
+        float position[4]; // xyz: world position (point) or direction to the light (directional); w: type
+        float color[4];    // rgb: color premultiplied by intensity; a: range
+    };
+    static constexpr float TYPE_DIRECTIONAL = 0.0f;
+    static constexpr float TYPE_POINT = 1.0f;
+
+    LightGatherSystem();
+
+    const char* getName() const override { return "Light gather"; }
+    void update(Scene& scene, float deltaTime) override;
+
+    // Directional lights first (getDirectionalCount() of them), then point
+    // lights; in no particular order within each group
+    const std::vector<GpuLight>& getLights() const { return lights_; }
+    size_t getDirectionalCount() const { return directionalCount_; }
+    const float* getAmbient() const { return ambient_; } // Base ambient plus ambient lights
+
+    // Range of getLights() rewritten since the last call, for partial
+    // uploads. Returns false if nothing changed. Meant for a single consumer.
+    bool takeDirtyRange(size_t& begin, size_t& end);
+
+    // Lights rewritten by the last update (for profiling)
+    size_t getRefreshedCount() const { return refreshed_; }
+
+    // Point lights shading one object, as indices into getLights(): those
+    // whose range reaches the object's world bounds. When more reach it than
+    // fit, the brightest at the object win. Directional lights shade every
+    // object and aren't listed.
+    static constexpr int MAX_OBJECT_LIGHTS = 8; // Matches the lit shader
+    struct ObjectLights {
+        int count = 0;
+        int lights[MAX_OBJECT_LIGHTS];
+    };
+
+    // Rebuild the per-object lists with one radius query per point light
+    // against objects (Scene::getSpatialIndex(), keyed by entity index).
+    // Does nothing unless the lights or objects changed since the last call.
+    // Call after update(), between scene updates.
+    void assignLights(const SpatialHash& objects);
+    const ObjectLights& getObjectLights(EntityId entity) const {
+        return entity < listStamp_.size() && listStamp_[entity] == assignStamp_ ? objectLights_[listOf_[entity]] : unlit_;
+    }
+    // Objects reached by at least one point light in the last assignLights()
+    size_t getLitObjectCount() const { return objectLights_.size(); }
+
+private:
+    static constexpr uint32_t NO_INDEX = 0xFFFFFFFFu;
+
+    enum class Kind : uint8_t { None, Directional, Point, Ambient };
+
+    // Every object with a LightComponent, enabled or not
+    struct Tracked {
+        EntityId entity;
+        uint32_t transformSlot;
+        uint32_t lightIndex;  // Into lights_, or NO_INDEX
+        Kind kind;
+        float ambient[3];     // Contribution when kind is Ambient
+    };
+
+    void rebuild(Scene& scene);
+    void refresh(Scene& scene, uint32_t trackedIndex);
+    void addLight(uint32_t trackedIndex, bool directional);
+    void removeLight(uint32_t trackedIndex);
+    void moveLight(uint32_t from, uint32_t to);
+    void markDirty(size_t index);
+    void addObjectLight(EntityId entity, int light, float weight);
+
+    std::vector<Tracked> tracked_;
+    std::vector<uint32_t> trackedOf_;     // Entity index -> tracked_ index, or NO_INDEX
+    std::vector<uint32_t> trackedOfSlot_; // Transform slot -> tracked_ index, or NO_INDEX
+    std::vector<GpuLight> lights_;
+    std::vector<uint32_t> lightOwner_;    // lights_ index -> tracked_ index
+    size_t directionalCount_ = 0;
+    uint32_t lightsVersion_ = 0;          // Bumped whenever lights_ changes
+    float ambient_[3] = { 0.0f, 0.0f, 0.0f };
+    bool ambientDirty_ = true;
+
+    uint32_t structureVersion_ = 0;
+    bool built_ = false;
+    std::vector<EntityId> changed_;
+    std::vector<uint32_t> moved_;
+
+    // Per-object lists of the last assignLights(). Entities whose stamp is
+    // older have no point lights.
+    ObjectLights unlit_;
+    std::vector<ObjectLights> objectLights_;
+    std::vector<float> objectWeights_;  // MAX_OBJECT_LIGHTS per list: brightness at the object
+    std::vector<uint32_t> listOf_;      // Entity index -> objectLights_ index
+    std::vector<uint32_t> listStamp_;   // Entity index -> assignStamp_ when its list was made
+    uint32_t assignStamp_ = 0;
+    // What the lists were built from
+    const SpatialHash* assignedObjects_ = nullptr;
+    uint32_t assignedObjectsVersion_ = 0;
+    uint32_t assignedLightsVersion_ = 0;
+
+    size_t dirtyBegin_ = 0;
+    size_t dirtyEnd_ = 0;
+    size_t refreshed_ = 0;
+};
+
+#endif
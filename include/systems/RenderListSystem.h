@@ -0,0 +1,73 @@
+#ifndef RENDER_LIST_SYSTEM_H
+#define RENDER_LIST_SYSTEM_H
+
+#include "ecs/Entity.h"
+#include "ecs/System.h"
+#include "math/Culling.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class EntityRegistry;
+class JobSystem;
+class Mesh;
+
+// Keeps the list of meshes to draw with their transform slot, material
+// values and world bounds, so the render pass only culls and issues GL
+// calls. Like the BoundsSystem it follows changes: structure changes of
+// MeshRendererComponent or MaterialComponent rebuild the list, entities the
+// BoundsSystem refreshed (moved, renderer changed) get new bounds, and
+// materials reported through GameObject::markChanged<MaterialComponent>()
+// are reloaded. A frame where nothing moved or changed does no work.
+class RenderListSystem : public System {
+public:
+    struct DrawItem {
+        EntityId entity;
+        Mesh* mesh;
+        uint32_t transformSlot; // World matrix is in the scene's TransformStore
+        float albedo[3];
+        float metallic;
+        float roughness;
+    };
+
+    RenderListSystem();
+
+    const char* getName() const override { return "Render list"; }
+    void update(Scene& scene, float deltaTime) override;
+
+    // Write the indices of items whose world box touches the frustum to
+    // visible, in order. Tests 4-8 boxes per instruction and splits large
+    // lists into chunks run in parallel on jobs (if given). Returns the count.
+    size_t cull(const Frustum& frustum, JobSystem* jobs, std::vector<uint32_t>& visible);
+
+    // Valid until the next update. Order is not stable: removing an item
+    // moves the last one into its place.
+    std::vector<DrawItem> items;
+    // World bounds of items, same order
+    BoundsSoA bounds;
+
+    // Items whose bounds the last update recomputed (for profiling)
+    size_t getRefreshedCount() const { return refreshed_; }
+
+private:
+    static constexpr uint32_t NO_ITEM = 0xFFFFFFFFu;
+
+    void rebuild(Scene& scene);
+    // Add, update or drop entity's item to match its renderer
+    void refresh(Scene& scene, EntityId entity);
+    void loadMaterial(EntityRegistry& registry, DrawItem& item);
+    void removeItem(uint32_t index);
+
+    std::vector<uint32_t> itemOf_; // Entity index -> index into items, or NO_ITEM
+
+    uint32_t rendererVersion_ = 0;
+    uint32_t materialVersion_ = 0;
+    uint32_t boundsRescans_ = 0;
+    bool built_ = false;
+    std::vector<EntityId> changed_;
+    size_t refreshed_ = 0;
+
+    std::vector<size_t> chunkVisible_;
+};
+
+#endif
@@ -0,0 +1,23 @@
+#ifndef TRANSFORM_SYSTEM_H
+#define TRANSFORM_SYSTEM_H
+
+#include "ecs/System.h"
+#include <cstddef>
+
+// Rebuilds world matrices of transforms changed since the last frame.
+// Registered first, so every system reading transforms sees this frame's matrices.
+class TransformSystem : public System {
+public:
+    TransformSystem();
+
+    const char* getName() const override { return "Transforms"; }
+    void update(Scene& scene, float deltaTime) override;
+
+    // World matrices rebuilt in the last update
+    size_t getUpdatedCount() const { return updated_; }
+
+private:
+    size_t updated_ = 0;
+};
+
+#endif
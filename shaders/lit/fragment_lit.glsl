@@ -1,5 +1,8 @@
 #version 330 core
-out vec4 FragColor;
+layout(location = 0) out vec4 FragColor;
+layout(location = 1) out uvec2 ObjectId; // Viewport ID buffer for picking
+
+uniform uvec2 uObjectId; // Entity index + 1 and generation; index 0 for things that can't be picked
 
 uniform vec3 uAlbedo;
 uniform float uMetallic;
@@ -7,17 +10,17 @@ uniform float uRoughness;
 uniform vec3 uViewPos;     // Camera position in world
 uniform vec4 uSelectionTint; // Additive tint for selection
 
-// Lights
-const int MAX_DIR_LIGHTS = 4;
-const int MAX_POINT_LIGHTS = 16;
-uniform int uDirLightCount;
-uniform vec3 uDirLightDirs[MAX_DIR_LIGHTS]; // direction TO light (i.e., -lightDir)
-uniform vec3 uDirLightColors[MAX_DIR_LIGHTS];
-
-uniform int uPointLightCount;
-uniform vec3 uPointLightPos[MAX_POINT_LIGHTS];
-uniform vec3 uPointLightColors[MAX_POINT_LIGHTS];
-uniform float uPointLightRange[MAX_POINT_LIGHTS];
+// Lights: packed directional lights, then point lights, two texels each
+//   texel 0: xyz = direction to the light (directional) or world position (point), w = type (0 dir, 1 point)
+//   texel 1: rgb = color * intensity, a = range
+uniform samplerBuffer uLights;
+uniform int uLightCount;
+uniform int uDirectionalCount; // Lights [0, uDirectionalCount) are directional and shade everything
+// Point lights reaching this draw, as indices into uLights
+// (LightGatherSystem::assignLights); a count of -1 shades with every point light instead
+#define MAX_OBJECT_LIGHTS 8
+uniform int uObjectLights[MAX_OBJECT_LIGHTS];
+uniform int uObjectLightCount;
 // Ambient lights
 uniform vec3 uAmbientColor;  // accumulated ambient color from Ambient lights
 uniform float uAmbientStrength; // per-draw multiplier (0 for grid)
@@ -43,34 +46,39 @@ void main()
     vec3 ambient = baseColor * (uAmbientColor * uAmbientStrength);
     vec3 lighting = ambient;
 
-    // Directional lights
-    for (int i = 0; i < uDirLightCount; ++i) {
-        vec3 L = normalize(uDirLightDirs[i]);
-        vec3 H = normalize(L + V);
-        float NdotL = max(dot(N, L), 0.0);
-        float spec = pow(max(dot(N, H), 0.0), shininess);
-        vec3 diffuse = baseColor * NdotL;
-        vec3 specular = F0 * spec;
-        lighting += (diffuse + specular) * uDirLightColors[i];
-    }
-
-    // Point lights
-    for (int i = 0; i < uPointLightCount; ++i) {
-        vec3 Lvec = uPointLightPos[i] - vWorldPos;
-        float dist2 = dot(Lvec, Lvec);
-        float range = max(uPointLightRange[i], 0.001);
-        float att = 1.0 / (1.0 + dist2 / (range * range));
-        vec3 L = normalize(Lvec);
+    int pointCount = uObjectLightCount < 0 ? uLightCount - uDirectionalCount : uObjectLightCount;
+    for (int k = 0; k < uDirectionalCount + pointCount; ++k) {
+        int i = k < uDirectionalCount || uObjectLightCount < 0 ? k : uObjectLights[k - uDirectionalCount];
+        vec4 posType = texelFetch(uLights, i * 2);
+        vec4 colorRange = texelFetch(uLights, i * 2 + 1);
+        vec3 L;
+        float att = 1.0;
+        if (posType.w < 0.5) {
+            // Directional
+            L = normalize(posType.xyz);
+        } else {
+            // Point
+            vec3 Lvec = posType.xyz - vWorldPos;
+            float dist2 = dot(Lvec, Lvec);
+            float range = max(colorRange.a, 0.001);
+            // Windowed to reach zero at the range, so lights can be assigned
+            // only to the objects within it
+            float x = dist2 / (range * range);
+            float window = clamp(1.0 - x * x, 0.0, 1.0);
+            att = window * window / (1.0 + x);
+            L = normalize(Lvec);
+        }
         vec3 H = normalize(L + V);
         float NdotL = max(dot(N, L), 0.0);
         float spec = pow(max(dot(N, H), 0.0), shininess);
         vec3 diffuse = baseColor * NdotL;
         vec3 specular = F0 * spec;
-        lighting += (diffuse + specular) * uPointLightColors[i] * att;
+        lighting += (diffuse + specular) * colorRange.rgb * att;
     }
 
     vec3 finalRgb = lighting;
     // Apply selection tint additively but subtle
     finalRgb += uSelectionTint.rgb;
     FragColor = vec4(finalRgb, 1.0);
+    ObjectId = uObjectId;
 }
@@ -7,7 +7,7 @@
 
 #include "Shader.h"
 #include "Mesh.h"
-#include "glm_ortho.h"
+#include "JobSystem.h"
 
 #include "imgui.h"
 #include "imgui_impl_glfw.h"
@@ -56,14 +56,19 @@ bool Application::init() {
     // Create shader (lit)
     shader_ = new Shader("../shaders/vertex.glsl", "../shaders/lit/fragment_lit.glsl");
 
+    // Worker threads; the GL context stays on this thread
+    jobs_ = new JobSystem();
+
     // Create scene with its meshes
     scene_ = new Scene();
+    scene_->setJobSystem(jobs_);
 
     inspector_ = new InspectorPanel();
     viewport_ = new ViewportPanel();
     project_ = new ProjectPanel();
     properties_ = new PropertiesPanel();
     project_->setProjectPath("GameProject");
+    scene_->getPrefabs().setDirectory(project_->getProjectPath() + "/Prefabs");
     return true;
 }
 
@@ -74,6 +79,7 @@ void Application::shutdown() {
     delete viewport_; viewport_ = nullptr;
     delete project_; project_ = nullptr;
     delete properties_; properties_ = nullptr;
+    delete jobs_; jobs_ = nullptr; // After everything that may still queue jobs
 
     // Shutdown ImGui backends before destroying context
     if (window_) {
@@ -93,7 +99,10 @@ void Application::frame() {
     int winW, winH;
     glfwGetFramebufferSize(window_, &winW, &winH);
 
-    // Handle keyboard input (Delete key)
+    // GL work queued by jobs since the last frame
+    jobs_->runMainThreadJobs();
+
+    // Handle keyboard input (Delete key removes the whole selection in one batch)
     if (ImGui::IsKeyPressed(ImGuiKey_Delete)) {
         scene_->deleteSelected();
     }
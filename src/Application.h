@@ -10,6 +10,7 @@ class ViewportPanel;
 class ProjectPanel;
 class PropertiesPanel;
 class Scene;
+class JobSystem;
 
 class Application {
 public:
@@ -23,6 +24,7 @@ private:
     void frame();
 
     GLFWwindow* window_ = nullptr;
+    JobSystem* jobs_ = nullptr;
     Shader* shader_ = nullptr;
     Scene* scene_ = nullptr;
     InspectorPanel* inspector_ = nullptr;
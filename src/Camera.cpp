@@ -1,4 +1,5 @@
 #include "Camera.h"
+#include "MathUtils.h"
 #include <cmath>
 #include <algorithm>
 
@@ -34,88 +35,14 @@ void Camera::zoom(float delta) {
     distance_ = std::max(0.5f, distance_);  // Minimum zoom distance
 }
 
-void Camera::getViewMatrix(float* out16) const {
-    // Calculate camera position (orbit around target with pan offset)
-    float cx = distance_ * cosf(pitch_) * sinf(yaw_);
-    float cy = distance_ * sinf(pitch_);
-    float cz = distance_ * cosf(pitch_) * cosf(yaw_);
-    
-    float targetX = panX_;
-    float targetY = panY_;
-    float targetZ = panZ_;
-    
-    float eyeX = cx + targetX;
-    float eyeY = cy + targetY;
-    float eyeZ = cz + targetZ;
-
-    // Build lookAt view matrix
-    // Forward vector (from eye to target)
-    float fx = targetX - eyeX;
-    float fy = targetY - eyeY;
-    float fz = targetZ - eyeZ;
-    float flen = sqrtf(fx*fx + fy*fy + fz*fz);
-    fx /= flen; fy /= flen; fz /= flen;
-    
-    // Up vector
-    float upX = 0.0f, upY = 1.0f, upZ = 0.0f;
-    
-    // Right = forward × up
-    float sx = fy * upZ - fz * upY;
-    float sy = fz * upX - fx * upZ;
-    float sz = fx * upY - fy * upX;
-    float slen = sqrtf(sx*sx + sy*sy + sz*sz);
-    sx /= slen; sy /= slen; sz /= slen;
-    
-    // Recompute up = right × forward
-    float ux = sy * fz - sz * fy;
-    float uy = sz * fx - sx * fz;
-    float uz = sx * fy - sy * fx;
-    
-    // Build view matrix (column-major)
-    out16[0] = sx;
-    out16[1] = ux;
-    out16[2] = -fx;
-    out16[3] = 0.0f;
-    
-    out16[4] = sy;
-    out16[5] = uy;
-    out16[6] = -fy;
-    out16[7] = 0.0f;
-    
-    out16[8] = sz;
-    out16[9] = uz;
-    out16[10] = -fz;
-    out16[11] = 0.0f;
-    
-    out16[12] = -(sx*eyeX + sy*eyeY + sz*eyeZ);
-    out16[13] = -(ux*eyeX + uy*eyeY + uz*eyeZ);
-    out16[14] = -(-fx*eyeX + -fy*eyeY + -fz*eyeZ);
-    out16[15] = 1.0f;
+Mat4 Camera::getViewMatrix() const {
+    // Orbit around the pan target
+    Vec3 target(panX_, panY_, panZ_);
+    return Mat4::lookAt(getEyePosition(), target, Vec3(0.0f, 1.0f, 0.0f));
 }
 
-void Camera::getProjectionMatrix(float* out16, float aspect) const {
-    float fovRadians = fovDegrees_ * 3.14159265f / 180.0f;
-    float f = 1.0f / std::tan(fovRadians * 0.5f);
-    
-    out16[0] = f / aspect;
-    out16[1] = 0.0f;
-    out16[2] = 0.0f;
-    out16[3] = 0.0f;
-    
-    out16[4] = 0.0f;
-    out16[5] = f;
-    out16[6] = 0.0f;
-    out16[7] = 0.0f;
-    
-    out16[8] = 0.0f;
-    out16[9] = 0.0f;
-    out16[10] = (farPlane_ + nearPlane_) / (nearPlane_ - farPlane_);
-    out16[11] = -1.0f;
-    
-    out16[12] = 0.0f;
-    out16[13] = 0.0f;
-    out16[14] = (2.0f * farPlane_ * nearPlane_) / (nearPlane_ - farPlane_);
-    out16[15] = 0.0f;
+Mat4 Camera::getProjectionMatrix(float aspect) const {
+    return Mat4::perspective(fovDegrees_ * MathUtils::DEG_TO_RAD, aspect, nearPlane_, farPlane_);
 }
 
 void Camera::moveRelative(float forward, float right, float up) {
@@ -142,13 +69,9 @@ void Camera::moveRelative(float forward, float right, float up) {
     panZ_ += (fwdZ * forward + rightZ * right) * speed;
 }
 
-void Camera::getEyePosition(float& x, float& y, float& z) const {
-    // Mirror the computation in getViewMatrix
+Vec3 Camera::getEyePosition() const {
     float cx = distance_ * cosf(pitch_) * sinf(yaw_);
     float cy = distance_ * sinf(pitch_);
     float cz = distance_ * cosf(pitch_) * cosf(yaw_);
-
-    x = cx + panX_;
-    y = cy + panY_;
-    z = cz + panZ_;
+    return Vec3(cx + panX_, cy + panY_, cz + panZ_);
 }
@@ -2,36 +2,44 @@
 #include "components/TransformComponent.h"
 #include <algorithm>
 
-GameObject::GameObject(const std::string& name)
-    : name_(name), transform_(nullptr) {
+GameObject::GameObject(EntityRegistry& registry, TransformStore& transforms, const std::string& name)
+    : name_(name), registry_(&registry) {
+    entity_ = registry_->create(this);
     // Every GameObject must have a Transform component
-    transform_ = addComponent<TransformComponent>();
+    addComponent<TransformComponent>()->attach(transforms, entity_);
+}
+
+GameObject::GameObject(EntityRegistry& registry, EntityId entity, const std::string& name)
+    : name_(name), registry_(&registry), entity_(entity) {
+    registry_->setOwner(entity_, this);
 }
 
 GameObject::~GameObject() {
-    components_.clear();
-    componentMap_.clear();
+    if (entity_ != INVALID_ENTITY) {
+        registry_->destroy(entity_);
+    }
 }
 
 void GameObject::removeComponent(Component* component) {
     if (!component || !component->canBeRemoved()) {
         return; // Can't remove Transform or null components
     }
-    
-    // Find and remove from componentMap
-    for (auto it = componentMap_.begin(); it != componentMap_.end(); ++it) {
-        if (it->second == component) {
-            componentMap_.erase(it);
-            break;
-        }
-    }
-    
-    // Find and remove from components vector
-    components_.erase(
-        std::remove_if(components_.begin(), components_.end(),
-            [component](const std::unique_ptr<Component>& c) {
-                return c.get() == component;
-            }),
-        components_.end()
-    );
+    registry_->remove(entity_, component);
+}
+
+std::vector<Component*> GameObject::getComponents() const {
+    std::vector<Component*> components;
+    registry_->getComponents(entity_, components);
+    // Archetype column order is arbitrary; keep Transform (non-removable) on top
+    std::stable_partition(components.begin(), components.end(),
+        [](Component* c) { return !c->canBeRemoved(); });
+    return components;
+}
+
+TransformComponent* GameObject::getTransform() {
+    return registry_->get<TransformComponent>(entity_);
+}
+
+const TransformComponent* GameObject::getTransform() const {
+    return registry_->get<TransformComponent>(entity_);
 }
@@ -0,0 +1,280 @@
+#include "JobSystem.h"
+#include <algorithm>
+
+struct JobCounter::Job {
+    JobSystem::JobFunction fn;
+    JobCounter* counter;
+};
+
+namespace {
+    // Which system/queue the current thread belongs to
+    thread_local const JobSystem* currentSystem = nullptr;
+    thread_local unsigned currentQueue = 0;
+    thread_local uint32_t stealSeed = 0x9E3779B9u;
+
+    // Spins before an idle worker goes to sleep
+    constexpr int IDLE_SPINS = 64;
+
+    uint32_t nextRandom() {
+        // xorshift32, only used to pick steal victims
+        stealSeed ^= stealSeed << 13;
+        stealSeed ^= stealSeed >> 17;
+        stealSeed ^= stealSeed << 5;
+        return stealSeed;
+    }
+}
+
+bool JobCounter::isDone() const {
+    if (value_.load(std::memory_order_acquire) != 0) return false;
+    // Wait for the thread that dropped the count to zero to let go of the counter
+    std::lock_guard<std::mutex> lock(mutex_);
+    return true;
+}
+
+// Chase-Lev deque with a fixed power-of-two capacity (Le et al., "Correct and
+// Efficient Work-Stealing for Weak Memory Models"). The owner pushes/pops at
+// the bottom, thieves take from the top.
+class JobSystem::WorkQueue {
+public:
+    static constexpr int64_t CAPACITY = 4096;
+
+    // Owner only. Returns false when full.
+    bool push(JobCounter::Job* job) {
+        int64_t b = bottom_.load(std::memory_order_relaxed);
+        int64_t t = top_.load(std::memory_order_acquire);
+        if (b - t >= CAPACITY) return false;
+        slots_[b & (CAPACITY - 1)].store(job, std::memory_order_relaxed);
+        bottom_.store(b + 1, std::memory_order_release); // Publishes the slot to thieves
+        return true;
+    }
+
+    // Owner only
+    JobCounter::Job* pop() {
+        int64_t b = bottom_.load(std::memory_order_relaxed) - 1;
+        bottom_.store(b, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t t = top_.load(std::memory_order_relaxed);
+        if (t > b) {
+            bottom_.store(b + 1, std::memory_order_relaxed);
+            return nullptr;
+        }
+        JobCounter::Job* job = slots_[b & (CAPACITY - 1)].load(std::memory_order_relaxed);
+        if (t == b) {
+            // Last job: race thieves for it
+            if (!top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+                job = nullptr;
+            }
+            bottom_.store(b + 1, std::memory_order_relaxed);
+        }
+        return job;
+    }
+
+    // Any thread
+    JobCounter::Job* steal() {
+        int64_t t = top_.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t b = bottom_.load(std::memory_order_acquire);
+        if (t >= b) return nullptr;
+        JobCounter::Job* job = slots_[t & (CAPACITY - 1)].load(std::memory_order_relaxed);
+        if (!top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+            return nullptr; // Lost to the owner or another thief
+        }
+        return job;
+    }
+
+private:
+    // Separate cache lines so thieves and the owner don't false-share
+    alignas(64) std::atomic<int64_t> top_{ 0 };
+    alignas(64) std::atomic<int64_t> bottom_{ 0 };
+    alignas(64) std::atomic<JobCounter::Job*> slots_[CAPACITY];
+};
+
+JobSystem::JobSystem(int workerThreads) : mainThread_(std::this_thread::get_id()) {
+    if (workerThreads < 0) {
+        unsigned hardware = std::thread::hardware_concurrency();
+        workerThreads = hardware > 1 ? (int)hardware - 1 : 0;
+    }
+
+    for (int i = 0; i <= workerThreads; ++i) {
+        queues_.push_back(std::make_unique<WorkQueue>());
+    }
+    currentSystem = this;
+    currentQueue = 0;
+
+    for (int i = 1; i <= workerThreads; ++i) {
+        workers_.emplace_back([this, i]() { workerLoop((unsigned)i); });
+    }
+}
+
+JobSystem::~JobSystem() {
+    // Drain whatever is still queued so no job (or its counter) is leaked
+    while (JobCounter::Job* job = findJob(currentSystem == this ? (int)currentQueue : -1)) execute(job);
+    runMainThreadJobs();
+
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex_);
+        stopping_.store(true);
+    }
+    wake_.notify_all();
+    for (std::thread& worker : workers_) worker.join();
+    if (currentSystem == this) currentSystem = nullptr;
+}
+
+bool JobSystem::isMainThread() const {
+    return std::this_thread::get_id() == mainThread_;
+}
+
+void JobSystem::run(JobFunction fn, JobCounter* counter) {
+    if (counter) counter->value_.fetch_add(1, std::memory_order_relaxed);
+    push(new JobCounter::Job{ std::move(fn), counter });
+}
+
+void JobSystem::runAfter(JobCounter& dependency, JobFunction fn, JobCounter* counter) {
+    if (counter) counter->value_.fetch_add(1, std::memory_order_relaxed);
+    JobCounter::Job* job = new JobCounter::Job{ std::move(fn), counter };
+    {
+        std::lock_guard<std::mutex> lock(dependency.mutex_);
+        if (dependency.value_.load(std::memory_order_acquire) != 0) {
+            dependency.continuations_.push_back(job);
+            return;
+        }
+    }
+    push(job);
+}
+
+void JobSystem::wait(JobCounter& counter) {
+    bool mainThread = isMainThread();
+    int self = currentSystem == this ? (int)currentQueue : -1;
+    while (!counter.isDone()) {
+        if (JobCounter::Job* job = findJob(self)) {
+            execute(job);
+        } else if (!mainThread || runMainThreadJobs() == 0) {
+            std::this_thread::yield();
+        }
+    }
+}
+
+void JobSystem::parallelFor(size_t count, const RangeFunction& fn, size_t minGrain) {
+    if (count == 0) return;
+    // About eight ranges per thread leaves room to rebalance by stealing
+    size_t grain = std::max<size_t>({ minGrain, 1, count / ((size_t)getThreadCount() * 8) });
+    if (count <= grain || getThreadCount() == 1) {
+        fn(0, count);
+        return;
+    }
+
+    JobCounter counter;
+    // Keep the first half, hand the second half to whoever steals it
+    std::function<void(size_t, size_t)> split = [&](size_t begin, size_t end) {
+        while (end - begin > grain) {
+            size_t mid = begin + (end - begin) / 2;
+            run([&split, mid, end]() { split(mid, end); }, &counter);
+            end = mid;
+        }
+        fn(begin, end);
+    };
+    split(0, count);
+    wait(counter);
+}
+
+void JobSystem::runOnMainThread(JobFunction fn, JobCounter* counter) {
+    if (counter) counter->value_.fetch_add(1, std::memory_order_relaxed);
+    std::lock_guard<std::mutex> lock(mainThreadMutex_);
+    mainThreadJobs_.push_back(new JobCounter::Job{ std::move(fn), counter });
+}
+
+size_t JobSystem::runMainThreadJobs() {
+    std::vector<JobCounter::Job*> jobs;
+    {
+        std::lock_guard<std::mutex> lock(mainThreadMutex_);
+        jobs.swap(mainThreadJobs_);
+    }
+    for (JobCounter::Job* job : jobs) execute(job);
+    return jobs.size();
+}
+
+void JobSystem::push(JobCounter::Job* job) {
+    bool queued = currentSystem == this && queues_[currentQueue]->push(job);
+    if (!queued) {
+        std::lock_guard<std::mutex> lock(overflowMutex_);
+        overflow_.push_back(job);
+    }
+
+    // Wake a sleeping worker. Both sides use seq_cst, so either we see the
+    // sleeper here or it sees the new job in its wait predicate.
+    queuedJobs_.fetch_add(1);
+    if (sleepers_.load() > 0) {
+        std::lock_guard<std::mutex> lock(sleepMutex_);
+        wake_.notify_one();
+    }
+}
+
+JobCounter::Job* JobSystem::findJob(int self) {
+    // Threads outside the system have no queue of their own and can only steal
+    JobCounter::Job* job = self >= 0 ? queues_[self]->pop() : nullptr;
+
+    if (!job) {
+        unsigned count = (unsigned)queues_.size();
+        unsigned start = count > 1 ? nextRandom() % count : 0;
+        for (unsigned i = 0; i < count && !job; ++i) {
+            unsigned victim = (start + i) % count;
+            if ((int)victim != self) job = queues_[victim]->steal();
+        }
+    }
+
+    if (!job) {
+        std::lock_guard<std::mutex> lock(overflowMutex_);
+        if (!overflow_.empty()) {
+            job = overflow_.back();
+            overflow_.pop_back();
+        }
+    }
+
+    if (job) queuedJobs_.fetch_sub(1);
+    return job;
+}
+
+void JobSystem::execute(JobCounter::Job* job) {
+    job->fn();
+    JobCounter* counter = job->counter;
+    delete job;
+    if (counter) finish(counter);
+}
+
+void JobSystem::finish(JobCounter* counter) {
+    std::vector<JobCounter::Job*> ready;
+    {
+        std::lock_guard<std::mutex> lock(counter->mutex_);
+        if (counter->value_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            ready.swap(counter->continuations_);
+        }
+    }
+    // The counter may be gone from here on
+    for (JobCounter::Job* job : ready) push(job);
+}
+
+void JobSystem::workerLoop(unsigned index) {
+    currentSystem = this;
+    currentQueue = index;
+    stealSeed = 0x9E3779B9u * (index + 1);
+
+    int idle = 0;
+    for (;;) {
+        if (JobCounter::Job* job = findJob((int)index)) {
+            execute(job);
+            idle = 0;
+            continue;
+        }
+        if (++idle < IDLE_SPINS) {
+            std::this_thread::yield();
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(sleepMutex_);
+        sleepers_.fetch_add(1);
+        wake_.wait(lock, [this]() { return queuedJobs_.load() > 0 || stopping_.load(); });
+        sleepers_.fetch_sub(1);
+        if (stopping_.load() && queuedJobs_.load() <= 0) return;
+        idle = 0;
+    }
+}
@@ -1,13 +1,28 @@
 #define GLEW_STATIC
 #include "Mesh.h"
+#include "math/Bvh.h"
+#include <algorithm>
+#include <cmath>
 
 Mesh::Mesh(const std::vector<Vertex>& vertices) 
     : vertexCount(vertices.size())
     , vertices_(vertices) {
+    for (const Vertex& v : vertices) bounds_.grow(Vec3(v.x, v.y, v.z));
+    if (!vertices.empty()) {
+        boundingSphere_.center = bounds_.center();
+        float radiusSquared = 0.0f;
+        for (const Vertex& v : vertices) {
+            Vec3 d = Vec3(v.x, v.y, v.z) - boundingSphere_.center;
+            radiusSquared = std::max(radiusSquared, dot(d, d));
+        }
+        boundingSphere_.radius = std::sqrt(radiusSquared);
+    }
     setupMesh(vertices);
 }
 
 Mesh::~Mesh() {
+    // The build job reads vertices_ and writes bvh_
+    if (bvhJobs_) bvhJobs_->wait(bvhBuilt_);
     glDeleteVertexArrays(1, &VAO);
     glDeleteBuffers(1, &VBO);
 }
@@ -18,6 +33,32 @@ void Mesh::draw() const {
     glBindVertexArray(0);
 }
 
+void Mesh::buildBvhAsync(JobSystem* jobs) {
+    bool expected = false;
+    if (!bvhStarted_.compare_exchange_strong(expected, true)) return;
+
+    auto build = [this]() {
+        std::vector<Vec3> positions(vertices_.size());
+        for (size_t i = 0; i < vertices_.size(); ++i) positions[i] = Vec3(vertices_[i].x, vertices_[i].y, vertices_[i].z);
+        std::unique_ptr<Bvh> bvh(new Bvh());
+        bvh->build(positions.data(), positions.size());
+        bvh_ = std::move(bvh);
+        bvhReady_.store(true, std::memory_order_release);
+    };
+    if (jobs) {
+        bvhJobs_ = jobs;
+        jobs->run(build, &bvhBuilt_);
+    } else {
+        build();
+    }
+}
+
+const Bvh& Mesh::waitForBvh(JobSystem* jobs) {
+    buildBvhAsync(jobs);
+    if (!bvhReady_.load(std::memory_order_acquire)) bvhJobs_->wait(bvhBuilt_);
+    return *bvh_;
+}
+
 void Mesh::setupMesh(const std::vector<Vertex>& vertices) {
     // Generate buffers
     glGenVertexArrays(1, &VAO);
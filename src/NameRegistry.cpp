@@ -0,0 +1,69 @@
+#include "NameRegistry.h"
+
+std::string NameRegistry::acquire(const std::string& baseName) {
+    if (!isUsed(baseName)) {
+        add(baseName);
+        return baseName;
+    }
+
+    uint32_t& next = nextSuffix_[baseName];
+    std::string name = nextFree(baseName, next);
+    add(name);
+    return name;
+}
+
+void NameRegistry::acquire(const std::string& baseName, size_t count, std::vector<std::string>& out) {
+    out.clear();
+    out.reserve(count);
+    if (count == 0) return;
+
+    size_t first = 0;
+    if (!isUsed(baseName)) {
+        add(baseName);
+        out.push_back(baseName);
+        first = 1;
+    }
+    useCount_.reserve(useCount_.size() + count);
+
+    // One suffix lookup for the whole batch
+    uint32_t& next = nextSuffix_[baseName];
+    for (size_t i = first; i < count; ++i) {
+        out.push_back(nextFree(baseName, next));
+        add(out.back());
+    }
+}
+
+std::string NameRegistry::nextFree(const std::string& baseName, uint32_t& next) const {
+    if (next == 0) next = 1;
+
+    std::string name;
+    name.reserve(baseName.size() + 8);
+    do {
+        name = baseName;
+        name += " (";
+        name += std::to_string(next++);
+        name += ')';
+    } while (isUsed(name));
+    return name;
+}
+
+void NameRegistry::add(const std::string& name) {
+    ++useCount_[name];
+}
+
+void NameRegistry::release(const std::string& name) {
+    auto it = useCount_.find(name);
+    if (it == useCount_.end()) return;
+    if (--it->second == 0) useCount_.erase(it);
+}
+
+void NameRegistry::rename(const std::string& oldName, const std::string& newName) {
+    if (oldName == newName) return;
+    release(oldName);
+    add(newName);
+}
+
+void NameRegistry::clear() {
+    useCount_.clear();
+    nextSuffix_.clear();
+}
@@ -0,0 +1,9 @@
+#include "Prefab.h"
+#include "Mesh.h"
+
+std::shared_ptr<Mesh> Prefab::getMesh() {
+    if (!mesh_ && meshPreset != MeshRendererComponent::Preset::None) {
+        mesh_.reset(MeshRendererComponent::createPresetMesh(meshPreset));
+    }
+    return mesh_;
+}
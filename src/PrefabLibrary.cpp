@@ -0,0 +1,134 @@
+#include "PrefabLibrary.h"
+#include "GameObject.h"
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+namespace fs = std::filesystem;
+
+namespace {
+    const char* presetNames[] = { "None", "Cube", "Pyramid", "Sphere" };
+    const char* lightTypeNames[] = { "Point", "Directional", "Spot", "Ambient" };
+
+    template<typename Enum, size_t N>
+    Enum parseEnum(const std::string& value, const char* (&names)[N], Enum fallback) {
+        for (size_t i = 0; i < N; ++i) {
+            if (value == names[i]) return static_cast<Enum>(i);
+        }
+        return fallback;
+    }
+}
+
+void PrefabLibrary::setDirectory(const std::string& directory) {
+    directory_ = directory;
+    prefabs_.clear();
+    try {
+        if (!fs::exists(directory_)) fs::create_directories(directory_);
+        for (const auto& entry : fs::directory_iterator(directory_)) {
+            if (entry.path().extension() != ".prefab") continue;
+            if (auto prefab = load(entry.path().string())) prefabs_.push_back(prefab);
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "PrefabLibrary error: " << e.what() << std::endl;
+    }
+}
+
+std::shared_ptr<Prefab> PrefabLibrary::find(const std::string& name) const {
+    for (const auto& prefab : prefabs_) {
+        if (prefab->name == name) return prefab;
+    }
+    return nullptr;
+}
+
+std::shared_ptr<Prefab> PrefabLibrary::createFromObject(GameObject& go) {
+    auto prefab = std::make_shared<Prefab>();
+    prefab->name = go.getName();
+    prefab->path = (fs::path(directory_) / (prefab->name + ".prefab")).string();
+
+    if (auto* renderer = go.getComponent<MeshRendererComponent>()) {
+        prefab->meshPreset = renderer->preset;
+    }
+    if (auto* material = go.getComponent<MaterialComponent>()) {
+        prefab->hasMaterial = true;
+        prefab->material = material->data;
+    }
+    if (auto* light = go.getComponent<LightComponent>()) {
+        prefab->hasLight = true;
+        prefab->light = *light;
+        prefab->light.gameObject = nullptr;
+    }
+
+    if (!save(*prefab)) return nullptr;
+
+    // Replace in place so existing instances keep their (old) prefab alive
+    auto it = std::find_if(prefabs_.begin(), prefabs_.end(),
+        [&](const std::shared_ptr<Prefab>& p) { return p->name == prefab->name; });
+    if (it != prefabs_.end()) {
+        *it = prefab;
+    } else {
+        prefabs_.push_back(prefab);
+    }
+    return prefab;
+}
+
+std::shared_ptr<Prefab> PrefabLibrary::load(const std::string& path) const {
+    std::ifstream in(path);
+    if (!in) return nullptr;
+
+    auto prefab = std::make_shared<Prefab>();
+    prefab->name = fs::path(path).stem().string();
+    prefab->path = path;
+
+    // One "key: values" line per component
+    std::string line;
+    while (std::getline(in, line)) {
+        size_t colon = line.find(':');
+        if (colon == std::string::npos) continue;
+        std::string key = line.substr(0, colon);
+        std::istringstream values(line.substr(colon + 1));
+
+        if (key == "mesh") {
+            std::string preset;
+            values >> preset;
+            prefab->meshPreset = parseEnum(preset, presetNames, MeshRendererComponent::Preset::None);
+        } else if (key == "material") {
+            MaterialData data;
+            values >> data.albedo[0] >> data.albedo[1] >> data.albedo[2] >> data.metallic >> data.roughness;
+            prefab->hasMaterial = true;
+            prefab->material = CopyOnWrite<MaterialData>(std::make_shared<MaterialData>(data));
+        } else if (key == "light") {
+            std::string type;
+            LightComponent& light = prefab->light;
+            values >> type >> light.color[0] >> light.color[1] >> light.color[2] >> light.intensity >> light.range;
+            light.type = parseEnum(type, lightTypeNames, LightComponent::Type::Point);
+            prefab->hasLight = true;
+        }
+    }
+    return prefab;
+}
+
+bool PrefabLibrary::save(const Prefab& prefab) const {
+    std::ofstream out(prefab.path, std::ios::out | std::ios::trunc);
+    if (!out) {
+        std::cerr << "Failed to write prefab: " << prefab.path << std::endl;
+        return false;
+    }
+
+    if (prefab.meshPreset != MeshRendererComponent::Preset::None) {
+        out << "mesh: " << presetNames[static_cast<int>(prefab.meshPreset)] << "\n";
+    }
+    if (prefab.hasMaterial) {
+        const MaterialData& m = prefab.material.get();
+        out << "material: " << m.albedo[0] << " " << m.albedo[1] << " " << m.albedo[2] << " "
+            << m.metallic << " " << m.roughness << "\n";
+    }
+    if (prefab.hasLight) {
+        const LightComponent& l = prefab.light;
+        out << "light: " << lightTypeNames[static_cast<int>(l.type)] << " "
+            << l.color[0] << " " << l.color[1] << " " << l.color[2] << " "
+            << l.intensity << " " << l.range << "\n";
+    }
+    return true;
+}
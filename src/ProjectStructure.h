@@ -10,6 +10,7 @@ static const std::vector<std::string> DEFAULT_PROJECT_FOLDERS = {
     "Meshes",
     "Scripts",
     "Materials",
+    "Prefabs",
     "Content"
 };
 
@@ -2,123 +2,540 @@
 #include "GameObject.h"
 #include "components/TransformComponent.h"
 #include "components/MeshRendererComponent.h"
+#include "components/MaterialComponent.h"
+#include "components/LightComponent.h"
+#include "components/PrefabInstanceComponent.h"
+#include "systems/TransformSystem.h"
+#include "systems/LightGatherSystem.h"
+#include "systems/BoundsSystem.h"
+#include "systems/RenderListSystem.h"
 #include "Mesh.h"
 #include "Meshes.h"
+#include "MathUtils.h"
+#include "math/Frustum.h"
 #include <algorithm>
 
 Scene::Scene() {
-    // Start with empty scene
+    // Start with empty scene. Transforms come first so later systems read this frame's matrices.
+    systems_.add<TransformSystem>();
+    systems_.add<LightGatherSystem>();
+    systems_.add<BoundsSystem>();
+    systems_.add<RenderListSystem>();
 }
 
 Scene::~Scene() {
+    // Bulk release: destroys every remaining object and frees the pool slabs
     gameObjects_.clear();
+    gameObjectPool_.clear();
 }
 
-GameObject* Scene::getSelectedGameObject() {
-    if (selectedIndex_ >= 0 && selectedIndex_ < (int)gameObjects_.size()) {
-        return gameObjects_[selectedIndex_].get();
-    }
-    return nullptr;
+Scene::AllocationStats Scene::getAllocationStats() const {
+    AllocationStats stats;
+    stats.gameObjects = gameObjectPool_.size();
+    stats.gameObjectSlabAllocations = gameObjectPool_.getSlabAllocations();
+    stats.componentChunkAllocations = registry_.getChunkAllocator().getHeapAllocations();
+    stats.liveComponentChunks = registry_.getChunkAllocator().getLiveChunks();
+    return stats;
 }
 
-void Scene::deleteSelected() {
-    if (selectedIndex_ >= 0 && selectedIndex_ < (int)gameObjects_.size()) {
-        gameObjects_.erase(gameObjects_.begin() + selectedIndex_);
-        selectedIndex_ = -1;
+void Scene::destroyGameObject(EntityHandle handle) {
+    destroyGameObjects({ handle });
+}
+
+void Scene::destroyGameObjects(const std::vector<EntityHandle>& handles) {
+    // Expand every handle to its whole subtree while the DFS order is still
+    // valid; destroying invalidates it, and rebuilding per object would be quadratic
+    const auto& nodes = transforms_.getNodes();
+    std::vector<EntityHandle> doomed;
+    for (const EntityHandle& handle : handles) {
+        GameObject* go = getGameObject(handle);
+        if (!go) continue;
+        uint32_t begin = transforms_.getNodePosition(go->getTransform()->getSlot());
+        uint32_t end = begin + nodes[begin].subtreeSize;
+        for (uint32_t p = begin; p < end; ++p) {
+            doomed.push_back(registry_.getHandle(transforms_.getOwner(nodes[p].slot)));
+        }
+    }
+
+    // Duplicates (a child listed alongside its parent) are stale by the time they come up
+    for (const EntityHandle& handle : doomed) {
+        removeGameObject(handle);
     }
+    if (!doomed.empty()) selection_.removeStale(registry_);
 }
 
-std::string Scene::generateUniqueName(const std::string& baseName) {
-    // Check if base name exists
-    bool exists = false;
-    for (const auto& go : gameObjects_) {
-        if (go->getName() == baseName) {
-            exists = true;
-            break;
+void Scene::update(float deltaTime) {
+    applyCommands();
+    systems_.run(*this, deltaTime, jobs_);
+    applyCommands(); // Changes recorded by the systems
+}
+
+size_t Scene::applyCommands(std::vector<EntityHandle>* created) {
+    using Command = CommandBuffer::Command;
+    using Kind = CommandBuffer::Kind;
+    const std::vector<Command>& commands = commands_.getCommands();
+    const auto& creations = commands_.getCreations();
+    if (created) created->assign(creations.size(), EntityHandle());
+    if (commands.empty()) return 0;
+
+    // Destroy first, in one batch, so later commands on doomed objects are skipped
+    std::vector<EntityHandle> doomed;
+    for (const Command& command : commands) {
+        if (command.kind == Kind::Destroy) doomed.push_back(command.target);
+    }
+    if (!doomed.empty()) destroyGameObjects(doomed);
+
+    // Group add/remove commands by target. The sort is stable, so each
+    // object's commands stay in record order and the last one per type wins.
+    std::vector<const Command*> changes;
+    for (const Command& command : commands) {
+        if (command.kind == Kind::Add || command.kind == Kind::Remove) changes.push_back(&command);
+    }
+    std::stable_sort(changes.begin(), changes.end(), [](const Command* a, const Command* b) {
+        if (a->pending != b->pending) return a->pending < b->pending; // Live targets (NO_PENDING) last
+        if (a->target.index != b->target.index) return a->target.index < b->target.index;
+        return a->target.generation < b->target.generation;
+    });
+
+    std::vector<const ComponentInfo*> added;
+    std::vector<void*> values;
+    auto dropAdded = [&](ComponentTypeId type) {
+        for (size_t k = 0; k < added.size(); ++k) {
+            if (added[k]->id != type) continue;
+            added.erase(added.begin() + k);
+            values.erase(values.begin() + k);
+            return;
         }
+    };
+
+    // Objects recorded with create(): one batch per base name and component set
+    struct CreateGroup {
+        std::string baseName;
+        std::vector<const ComponentInfo*> types;
+        ComponentMask mask;
+        std::vector<uint32_t> pending;
+        std::vector<std::vector<std::pair<const ComponentInfo*, void*>>> values;
+    };
+    std::vector<CreateGroup> groups;
+    std::vector<std::vector<std::pair<const ComponentInfo*, void*>>> pendingValues(creations.size());
+    size_t i = 0;
+    for (; i < changes.size() && changes[i]->pending != CommandBuffer::NO_PENDING; ++i) {
+        const Command& command = *changes[i];
+        auto& list = pendingValues[command.pending];
+        // Last add wins; the superseded value is destroyed with the buffer
+        list.erase(std::remove_if(list.begin(), list.end(),
+                                  [&](const std::pair<const ComponentInfo*, void*>& entry) {
+                                      return entry.first->id == command.type;
+                                  }),
+                   list.end());
+        list.push_back({ command.info, command.value });
     }
-    
-    if (!exists) return baseName;
-    
-    // Find highest number suffix
-    int maxNum = 0;
-    for (const auto& go : gameObjects_) {
-        // Check if name starts with baseName
-        if (go->getName().find(baseName) == 0) {
-            // Look for " (#)" pattern
-            size_t parenPos = go->getName().find(" (");
-            if (parenPos != std::string::npos) {
-                size_t closePos = go->getName().find(")", parenPos);
-                if (closePos != std::string::npos) {
-                    std::string numStr = go->getName().substr(parenPos + 2, closePos - parenPos - 2);
-                    try {
-                        int num = std::stoi(numStr);
-                        maxNum = std::max(maxNum, num);
-                    } catch (...) {}
-                }
+    for (uint32_t p = 0; p < creations.size(); ++p) {
+        std::vector<const ComponentInfo*> types = { &getComponentInfo<TransformComponent>() };
+        std::vector<std::pair<const ComponentInfo*, void*>> componentValues;
+        ComponentMask mask = componentMask<TransformComponent>();
+        for (const auto& entry : pendingValues[p]) {
+            if (mask & componentBit(entry.first->id)) continue;
+            types.push_back(entry.first);
+            componentValues.push_back(entry);
+            mask |= componentBit(entry.first->id);
+        }
+
+        auto group = std::find_if(groups.begin(), groups.end(), [&](const CreateGroup& g) {
+            return g.mask == mask && g.baseName == creations[p].baseName;
+        });
+        if (group == groups.end()) {
+            groups.push_back({ creations[p].baseName, types, mask, {}, {} });
+            group = groups.end() - 1;
+        }
+        group->pending.push_back(p);
+        group->values.push_back(std::move(componentValues));
+    }
+
+    std::vector<EntityId> entities;
+    std::vector<SpawnTransform> placements;
+    for (const CreateGroup& group : groups) {
+        registry_.createBatch(group.types, group.pending.size(), entities);
+        placements.assign(group.pending.size(), SpawnTransform());
+        for (size_t k = 0; k < group.pending.size(); ++k) {
+            const float* position = creations[group.pending[k]].position;
+            placements[k].position[0] = position[0];
+            placements[k].position[1] = position[1];
+            placements[k].position[2] = position[2];
+        }
+        std::vector<EntityHandle> handles = adoptBatch(entities, group.baseName, placements.data(), TransformStore::INVALID_SLOT);
+        for (size_t k = 0; k < handles.size(); ++k) {
+            for (const auto& entry : group.values[k]) {
+                registry_.replaceComponent(entities[k], *entry.first, entry.second);
             }
+            if (created) (*created)[group.pending[k]] = handles[k];
         }
     }
-    
-    return baseName + " (" + std::to_string(maxNum + 1) + ")";
+
+    // Live objects: fold each object's commands into one archetype move
+    while (i < changes.size()) {
+        EntityHandle target = changes[i]->target;
+        size_t end = i;
+        while (end < changes.size() && changes[end]->target == target) ++end;
+
+        added.clear();
+        values.clear();
+        ComponentMask removed = 0;
+        bool alive = registry_.isAlive(target); // Stale handles are skipped
+        for (size_t k = i; k < end && alive; ++k) {
+            const Command& command = *changes[k];
+            dropAdded(command.type);
+            if (command.kind == Kind::Add) {
+                added.push_back(command.info);
+                values.push_back(command.value);
+            } else {
+                Component* existing = registry_.getComponent(target.index, command.type);
+                if (existing && existing->canBeRemoved()) removed |= componentBit(command.type);
+            }
+        }
+        if (alive && (!added.empty() || removed)) {
+            registry_.changeComponents(target.index, added, values.data(), removed);
+        }
+        i = end;
+    }
+
+    // Destroys recorded component values (moved-from or unused)
+    size_t applied = commands.size();
+    commands_.clear();
+    return applied;
 }
 
-void Scene::addPyramid(float size, float x, float y, float z, const std::string& baseName) {
-    auto go = std::make_unique<GameObject>(generateUniqueName(baseName));
-    
-    // Set transform
-    auto* transform = go->getTransform();
-    transform->x = x;
-    transform->y = y;
-    transform->z = z;
+void Scene::removeGameObject(EntityHandle handle) {
+    GameObject* go = getGameObject(handle);
+    if (!go) return;
+
+    // Swap-and-pop so removal doesn't shift every later object
+    uint32_t index = denseIndex_[handle.index];
+    uint32_t last = (uint32_t)gameObjects_.size() - 1;
+    if (index != last) {
+        std::swap(gameObjects_[index], gameObjects_[last]);
+        denseIndex_[gameObjects_[index]->getEntity()] = index;
+    }
+    gameObjects_.pop_back();
+    ++objectsVersion_;
+    names_.release(go->getName());
+    gameObjectPool_.destroy(go); // Destroys the entity, bumping its generation
+}
+
+bool Scene::setParent(EntityHandle child, EntityHandle parent) {
+    GameObject* childObject = getGameObject(child);
+    if (!childObject) return false;
+
+    uint32_t parentSlot = TransformStore::INVALID_SLOT;
+    if (!parent.isNull()) {
+        GameObject* parentObject = getGameObject(parent);
+        if (!parentObject) return false;
+        parentSlot = parentObject->getTransform()->getSlot();
+    }
+    return transforms_.setParent(childObject->getTransform()->getSlot(), parentSlot);
+}
+
+EntityHandle Scene::getParent(EntityHandle child) const {
+    GameObject* childObject = getGameObject(child);
+    if (!childObject) return EntityHandle();
+
+    uint32_t parentSlot = transforms_.getParent(childObject->getTransform()->getSlot());
+    if (parentSlot == TransformStore::INVALID_SLOT) return EntityHandle();
+    return registry_.getHandle(transforms_.getOwner(parentSlot));
+}
+
+size_t Scene::selectInFrustum(const Frustum& frustum, bool add) {
+    if (!add) selection_.clear();
+
+    // The tree's fat boxes overreach a little, so hits are checked against
+    // the object's own world box
+    size_t hits = 0;
+    boundsTree_.queryFrustum(frustum, [&](int32_t proxy) {
+        EntityId entity = boundsTree_.getUserData(proxy);
+        const TransformComponent* transform = registry_.get<TransformComponent>(entity);
+        const MeshRendererComponent* meshRenderer = registry_.get<MeshRendererComponent>(entity);
+        if (!frustum.intersects(meshRenderer->mesh->getBounds().transformed(transform->getWorldMatrix()))) return;
+        selection_.add(registry_.getHandle(entity));
+        ++hits;
+    });
+    return hits;
+}
+
+void Scene::deleteSelected() {
+    // Copied first: destroying prunes the selection
+    std::vector<EntityHandle> doomed = selection_.getHandles();
+    selection_.clear();
+    destroyGameObjects(doomed);
+}
+
+void Scene::renameGameObject(EntityHandle handle, const std::string& name) {
+    GameObject* go = getGameObject(handle);
+    if (!go) return;
+    names_.rename(go->getName(), name);
+    go->setName(name);
+    ++objectsVersion_;
+}
+
+void Scene::saveSnapshot(Snapshot& snapshot) const {
+    registry_.saveSnapshot(snapshot.registry);
+    snapshot.transforms.copyFrom(transforms_);
+
+    snapshot.objects.resize(gameObjects_.size());
+    snapshot.names.resize(gameObjects_.size());
+    for (size_t i = 0; i < gameObjects_.size(); ++i) {
+        snapshot.objects[i] = gameObjects_[i]->getEntity();
+        snapshot.names[i] = gameObjects_[i]->getName();
+    }
+    snapshot.denseIndex = denseIndex_;
+    snapshot.selected = selection_.getHandles();
+    snapshot.objectsVersion = objectsVersion_;
+}
+
+void Scene::restoreSnapshot(const Snapshot& snapshot) {
+    bool sameObjects = snapshot.objectsVersion == objectsVersion_;
+
+    // Recorded commands target the entities being replaced
+    commands_.clear();
+    registry_.restoreSnapshot(snapshot.registry);
+    transforms_.copyFrom(snapshot.transforms);
+    // Entities touched during play come back with a newer generation, so the
+    // saved selection is looked up again by index
+    selection_.clear();
+    for (const EntityHandle& handle : snapshot.selected) selection_.add(registry_.getHandle(handle.index));
+    if (sameObjects) return;
+
+    // Objects whose entity index is still in use keep their GameObject;
+    // adopting repoints the restored entity's owner at it
+    std::vector<GameObject*> previous;
+    previous.swap(gameObjects_);
+    gameObjects_.resize(snapshot.objects.size(), nullptr);
+    for (size_t i = 0; i < snapshot.objects.size(); ++i) {
+        EntityId entity = snapshot.objects[i];
+        uint32_t index = entity < denseIndex_.size() ? denseIndex_[entity] : (uint32_t)previous.size();
+        if (index >= previous.size() || !previous[index] || previous[index]->getEntity() != entity) continue;
+        GameObject* go = previous[index];
+        previous[index] = nullptr;
+        if (go->getName() != snapshot.names[i]) {
+            names_.rename(go->getName(), snapshot.names[i]);
+            go->setName(snapshot.names[i]);
+        }
+        registry_.setOwner(entity, go);
+        gameObjects_[i] = go;
+    }
+
+    // The rest have entities the snapshot doesn't know (created during
+    // play), already gone with the registry restore, so they are dropped
+    // without destroying anything. One by one so the pool keeps its slabs
+    // for the objects recreated below.
+    for (GameObject* go : previous) {
+        if (!go) continue;
+        names_.release(go->getName());
+        go->releaseEntity();
+        gameObjectPool_.destroy(go);
+    }
+    for (size_t i = 0; i < snapshot.objects.size(); ++i) {
+        if (gameObjects_[i]) continue;
+        gameObjects_[i] = gameObjectPool_.create(registry_, snapshot.objects[i], snapshot.names[i]);
+        names_.add(snapshot.names[i]);
+    }
+    denseIndex_ = snapshot.denseIndex;
+
+    // Saved owner pointers are stale now, so a later restore of this snapshot must take this path again
+    ++objectsVersion_;
+}
+
+void Scene::enterPlayMode() {
+    if (playing_) return;
+    // Edits still pending belong to the edit scene, so they go in the snapshot
+    applyCommands();
+    saveSnapshot(playSnapshot_);
+    playing_ = true;
+}
+
+void Scene::exitPlayMode() {
+    if (!playing_) return;
+    restoreSnapshot(playSnapshot_);
+    playing_ = false;
+}
+
+GameObject* Scene::createGameObject(const std::string& baseName, float x, float y, float z) {
+    GameObject* go = gameObjectPool_.create(registry_, transforms_, names_.acquire(baseName));
+    go->getTransform()->setPosition(x, y, z);
+
+    EntityId entity = go->getEntity();
+    if (entity >= denseIndex_.size()) denseIndex_.resize(entity + 1);
+    denseIndex_[entity] = (uint32_t)gameObjects_.size();
+    gameObjects_.push_back(go);
+    ++objectsVersion_;
+    return go;
+}
+
+EntityHandle Scene::addPyramid(float size, float x, float y, float z, const std::string& baseName) {
+    GameObject* go = createGameObject(baseName, x, y, z);
     
     // Add mesh renderer
     auto* renderer = go->addComponent<MeshRendererComponent>();
-    renderer->mesh = CreatePyramidMesh(size);
-    
-    gameObjects_.push_back(std::move(go));
+    renderer->mesh.reset(CreatePyramidMesh(size));
+    renderer->preset = MeshRendererComponent::Preset::Pyramid;
+    return go->getHandle();
 }
 
-void Scene::addCube(float size, float x, float y, float z, const std::string& baseName) {
-    auto go = std::make_unique<GameObject>(generateUniqueName(baseName));
-    
-    // Set transform
-    auto* transform = go->getTransform();
-    transform->x = x;
-    transform->y = y;
-    transform->z = z;
+EntityHandle Scene::addCube(float size, float x, float y, float z, const std::string& baseName) {
+    GameObject* go = createGameObject(baseName, x, y, z);
     
     // Add mesh renderer
     auto* renderer = go->addComponent<MeshRendererComponent>();
-    renderer->mesh = CreateCubeMesh(size);
-    
-    gameObjects_.push_back(std::move(go));
+    renderer->mesh.reset(CreateCubeMesh(size));
+    renderer->preset = MeshRendererComponent::Preset::Cube;
+    return go->getHandle();
 }
 
-void Scene::addSphere(float diameter, int segments, float x, float y, float z, const std::string& baseName) {
-    auto go = std::make_unique<GameObject>(generateUniqueName(baseName));
-    
-    // Set transform
-    auto* transform = go->getTransform();
-    transform->x = x;
-    transform->y = y;
-    transform->z = z;
+EntityHandle Scene::addSphere(float diameter, int segments, float x, float y, float z, const std::string& baseName) {
+    GameObject* go = createGameObject(baseName, x, y, z);
     
     // Add mesh renderer
     auto* renderer = go->addComponent<MeshRendererComponent>();
-    renderer->mesh = CreateSphereMesh(diameter, segments);
-    
-    gameObjects_.push_back(std::move(go));
+    renderer->mesh.reset(CreateSphereMesh(diameter, segments));
+    renderer->preset = MeshRendererComponent::Preset::Sphere;
+    return go->getHandle();
+}
+
+std::vector<EntityHandle> Scene::spawnBatch(const std::string& baseName, size_t count,
+                                          const SpawnTransform* transforms, std::shared_ptr<Mesh> mesh) {
+    std::vector<EntityId> entities;
+    if (mesh) {
+        registry_.createBatch<TransformComponent, MeshRendererComponent>(count, entities);
+        for (EntityId entity : entities) {
+            registry_.get<MeshRendererComponent>(entity)->mesh = mesh;
+        }
+    } else {
+        registry_.createBatch<TransformComponent>(count, entities);
+    }
+    return adoptBatch(entities, baseName, transforms, TransformStore::INVALID_SLOT);
+}
+
+std::vector<EntityHandle> Scene::instantiate(EntityHandle prototype, size_t count, const SpawnTransform* transforms) {
+    GameObject* source = getGameObject(prototype);
+    if (!source) return {};
+
+    std::vector<EntityId> entities;
+    registry_.cloneBatch(source->getEntity(), count, entities);
+    return adoptBatch(entities, source->getName(), transforms, source->getTransform()->getSlot());
+}
+
+std::vector<EntityHandle> Scene::instantiatePrefab(const std::shared_ptr<Prefab>& prefab, size_t count,
+                                                 const SpawnTransform* transforms) {
+    if (!prefab) return {};
+
+    std::vector<const ComponentInfo*> types = {
+        &getComponentInfo<TransformComponent>(), &getComponentInfo<PrefabInstanceComponent>()
+    };
+    std::shared_ptr<Mesh> mesh = prefab->getMesh();
+    if (mesh) types.push_back(&getComponentInfo<MeshRendererComponent>());
+    if (prefab->hasMaterial) types.push_back(&getComponentInfo<MaterialComponent>());
+    if (prefab->hasLight) types.push_back(&getComponentInfo<LightComponent>());
+
+    std::vector<EntityId> entities;
+    registry_.createBatch(types, count, entities);
+
+    // Every instance only takes references to the prefab's data
+    for (EntityId entity : entities) {
+        registry_.get<PrefabInstanceComponent>(entity)->prefab = prefab;
+        if (mesh) {
+            auto* renderer = registry_.get<MeshRendererComponent>(entity);
+            renderer->mesh = mesh;
+            renderer->preset = prefab->meshPreset;
+        }
+        if (prefab->hasMaterial) registry_.get<MaterialComponent>(entity)->data = prefab->material;
+        if (prefab->hasLight) *registry_.get<LightComponent>(entity) = prefab->light;
+    }
+    return adoptBatch(entities, prefab->name, transforms, TransformStore::INVALID_SLOT);
+}
+
+std::shared_ptr<Prefab> Scene::createPrefab(EntityHandle handle) {
+    GameObject* go = getGameObject(handle);
+    if (!go) return nullptr;
+
+    std::shared_ptr<Prefab> prefab = prefabs_.createFromObject(*go);
+    if (!prefab) return nullptr;
+
+    // Adding a component moves the entity, so fetch the others afterwards
+    go->addComponent<PrefabInstanceComponent>()->prefab = prefab;
+    if (auto* renderer = go->getComponent<MeshRendererComponent>()) {
+        if (auto mesh = prefab->getMesh()) {
+            renderer->mesh = mesh;
+            go->markChanged<MeshRendererComponent>();
+        }
+    }
+    if (auto* material = go->getComponent<MaterialComponent>()) {
+        material->data = prefab->material;
+        go->markChanged<MaterialComponent>();
+    }
+    return prefab;
+}
+
+std::vector<EntityHandle> Scene::adoptBatch(const std::vector<EntityId>& entities, const std::string& baseName,
+                                         const SpawnTransform* transforms, uint32_t prototypeSlot) {
+    size_t count = entities.size();
+    std::vector<std::string> names;
+    names_.acquire(baseName, count, names);
+
+    transforms_.reserve(transforms_.getSlotCount() + count);
+    if (gameObjects_.size() + count > gameObjects_.capacity()) {
+        gameObjects_.reserve(std::max(gameObjects_.size() + count, gameObjects_.capacity() * 2));
+    }
+    if (registry_.getCapacity() > denseIndex_.size()) denseIndex_.resize(registry_.getCapacity());
+
+    // Euler degrees to quaternions for the whole batch at once
+    std::vector<Quat> rotations;
+    if (transforms) {
+        std::vector<Vec3> radians(count);
+        for (size_t i = 0; i < count; ++i) radians[i] = Vec3(transforms[i].rotation) * MathUtils::DEG_TO_RAD;
+        rotations.resize(count);
+        Quat::fromEuler(radians.data(), rotations.data(), count);
+    }
+
+    ++objectsVersion_;
+    std::vector<EntityHandle> handles;
+    handles.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        EntityId entity = entities[i];
+        GameObject* go = gameObjectPool_.create(registry_, entity, names[i]);
+
+        TransformComponent* transform = registry_.get<TransformComponent>(entity);
+        transform->attach(transforms_, entity);
+        uint32_t slot = transform->getSlot();
+        if (transforms) {
+            const SpawnTransform& t = transforms[i];
+            transforms_.posX[slot] = t.position[0]; transforms_.posY[slot] = t.position[1]; transforms_.posZ[slot] = t.position[2];
+            const Quat& q = rotations[i];
+            transforms_.rotX[slot] = q.x; transforms_.rotY[slot] = q.y; transforms_.rotZ[slot] = q.z; transforms_.rotW[slot] = q.w;
+            transforms_.eulerHint[slot] = Vec3(t.rotation);
+            transforms_.scaleX[slot] = t.scale[0]; transforms_.scaleY[slot] = t.scale[1]; transforms_.scaleZ[slot] = t.scale[2];
+        } else if (prototypeSlot != TransformStore::INVALID_SLOT) {
+            transforms_.posX[slot] = transforms_.posX[prototypeSlot];
+            transforms_.posY[slot] = transforms_.posY[prototypeSlot];
+            transforms_.posZ[slot] = transforms_.posZ[prototypeSlot];
+            transforms_.rotX[slot] = transforms_.rotX[prototypeSlot];
+            transforms_.rotY[slot] = transforms_.rotY[prototypeSlot];
+            transforms_.rotZ[slot] = transforms_.rotZ[prototypeSlot];
+            transforms_.rotW[slot] = transforms_.rotW[prototypeSlot];
+            transforms_.eulerHint[slot] = transforms_.eulerHint[prototypeSlot];
+            transforms_.scaleX[slot] = transforms_.scaleX[prototypeSlot];
+            transforms_.scaleY[slot] = transforms_.scaleY[prototypeSlot];
+            transforms_.scaleZ[slot] = transforms_.scaleZ[prototypeSlot];
+        }
+        // allocate() already marked the slot dirty
+
+        denseIndex_[entity] = (uint32_t)gameObjects_.size();
+        gameObjects_.push_back(go);
+        handles.push_back(go->getHandle());
+    }
+    return handles;
 }
 
 GameObject* Scene::addEmptyGameObject(const std::string& baseName, float x, float y, float z) {
-    auto go = std::make_unique<GameObject>(generateUniqueName(baseName));
-    auto* transform = go->getTransform();
-    transform->x = x;
-    transform->y = y;
-    transform->z = z;
-
-    gameObjects_.push_back(std::move(go));
-    selectedIndex_ = static_cast<int>(gameObjects_.size()) - 1;
-    return gameObjects_[selectedIndex_].get();
+    GameObject* go = createGameObject(baseName, x, y, z);
+    selection_.set(go->getHandle());
+    return go;
 }
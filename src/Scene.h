@@ -4,39 +4,223 @@
 #include <vector>
 #include <memory>
 #include <string>
+#include "ecs/EntityRegistry.h"
+#include "ecs/View.h"
+#include "ecs/SystemScheduler.h"
+#include "ecs/CommandBuffer.h"
+#include "TransformStore.h"
+#include "math/AabbTree.h"
+#include "math/SpatialHash.h"
+#include "Pool.h"
+#include "NameRegistry.h"
+#include "Selection.h"
+#include "PrefabLibrary.h"
+#include "GameObject.h"
 
 class Mesh;
-class GameObject;
+class JobSystem;
+struct Frustum;
 
 class Scene {
 public:
     Scene();
     ~Scene();
 
+    // Component storage shared by every GameObject in the scene
+    EntityRegistry& getRegistry() { return registry_; }
     
-    std::vector<std::unique_ptr<GameObject>>& getGameObjects() { return gameObjects_; }
-    const std::vector<std::unique_ptr<GameObject>>& getGameObjects() const { return gameObjects_; }
+    // Iterate objects that have all of Ts, skipping disabled components:
+    //   scene->view<TransformComponent, LightComponent>().each([](GameObject*, auto& t, auto& l) { ... });
+    template<typename... Ts>
+    View<Ts...> view() { return registry_.view<Ts...>(); }
     
-    // Selection
-    int getSelectedIndex() const { return selectedIndex_; }
-    void setSelectedIndex(int idx) { selectedIndex_ = idx; }
-    GameObject* getSelectedGameObject();
+    // SoA transform data and cached world matrices
+    TransformStore& getTransforms() { return transforms_; }
+    
+    // Rebuild world matrices of transforms changed since the last call.
+    // Call once per frame before rendering or picking. Returns the rebuild count.
+    size_t updateTransforms() { return transforms_.updateWorldMatrices(); }
+    
+    // World bounds of every enabled mesh renderer, for ray, frustum, sphere
+    // and box queries. Proxy user data is the entity index (resolve it with
+    // getRegistry().getOwner()). Kept current by the BoundsSystem during
+    // update(); read it between updates, or from systems registered after
+    // the BoundsSystem that declare readsResource(System::BOUNDS_TREE) (the
+    // scheduler orders those after it), not from other running systems.
+    const AabbTree& getBoundsTree() const { return boundsTree_; }
+    AabbTree& getBoundsTree() { return boundsTree_; }
+    
+    // The same bounds in a hashed grid, for radius, nearest-neighbour and
+    // per-cell queries (proximity, light assignment, spawn density). Item
+    // user data is the entity index; same access rules as getBoundsTree(),
+    // with System::SPATIAL_INDEX.
+    const SpatialHash& getSpatialIndex() const { return spatialIndex_; }
+    SpatialHash& getSpatialIndex() { return spatialIndex_; }
+    
+    // Per-frame systems (transforms, light gathering, render list, ...).
+    // update() runs them all; call it once per frame before rendering or picking.
+    // Structural changes recorded in getCommands() are applied before and
+    // after the systems run.
+    SystemScheduler& getSystems() { return systems_; }
+    void update(float deltaTime);
+    
+    // Deferred structural changes. Record here instead of adding/removing
+    // components or objects directly while iterating, or from systems.
+    CommandBuffer& getCommands() { return commands_; }
+    // Play back recorded commands now. Objects made by CommandBuffer::create
+    // are returned through created, indexed by their PendingEntity.
+    // Returns how many commands were applied.
+    size_t applyCommands(std::vector<EntityHandle>* created = nullptr);
+    
+    // Worker pool owned by the Application (null when running without one,
+    // e.g. in benchmarks). Scene, asset and picking code split work with it.
+    void setJobSystem(JobSystem* jobs) { jobs_ = jobs; transforms_.setJobSystem(jobs); }
+    JobSystem* getJobSystem() const { return jobs_; }
+    
+    // Dense list of all objects. Order is not stable: destroying an object
+    // moves the last one into its place.
+    const std::vector<GameObject*>& getGameObjects() const { return gameObjects_; }
+    
+    // Resolve a handle; returns nullptr if the object has been destroyed
+    GameObject* getGameObject(EntityHandle handle) const { return registry_.getOwner(handle); }
+    
+    // Removal is swap-and-pop; children are destroyed with their parent.
+    // Stale handles are ignored.
+    void destroyGameObject(EntityHandle handle);
+    void destroyGameObjects(const std::vector<EntityHandle>& handles);
+    
+    // Hierarchy. A null parent makes the child a root. The child keeps its
+    // local transform, which is now relative to the new parent.
+    // Returns false if either handle is stale or the link would form a cycle.
+    bool setParent(EntityHandle child, EntityHandle parent);
+    EntityHandle getParent(EntityHandle child) const;
+    
+    // Rename an object, keeping the unique-name registry consistent
+    void renameGameObject(EntityHandle handle, const std::string& name);
+    
+    // Saved scene state for play mode. Component data and transforms are
+    // bulk-copied into buffers that are reused by the next save.
+    struct Snapshot {
+        EntityRegistry::Snapshot registry;
+        TransformStore transforms;
+        std::vector<EntityId> objects;   // Entity of each object, in gameObjects_ order
+        std::vector<std::string> names;
+        std::vector<uint32_t> denseIndex;
+        std::vector<EntityHandle> selected;
+        uint64_t objectsVersion = 0;
+    };
+    
+    // Restore brings back every object, component value, transform and the
+    // selection exactly as saved. If no object was created, destroyed or
+    // renamed in between, GameObjects are kept and only data is copied back;
+    // otherwise only the objects that differ are dropped or recreated.
+    // Commands still recorded in getCommands() are not part of a snapshot:
+    // restoring discards them, as they refer to the state being replaced.
+    void saveSnapshot(Snapshot& snapshot) const;
+    void restoreSnapshot(const Snapshot& snapshot);
+    
+    // Play mode: entering applies pending commands and saves a snapshot,
+    // leaving restores it (dropping commands recorded during play)
+    void enterPlayMode();
+    void exitPlayMode();
+    bool isPlaying() const { return playing_; }
+    
+    // Heap allocation counters, to check that spawning scales per slab/chunk
+    // rather than per object
+    struct AllocationStats {
+        size_t gameObjects = 0;
+        size_t gameObjectSlabAllocations = 0; // GameObject pool slabs
+        size_t componentChunkAllocations = 0; // Archetype chunks from the heap
+        size_t liveComponentChunks = 0;
+    };
+    AllocationStats getAllocationStats() const;
+    
+    // Selection. Destroyed objects leave it automatically. The single-object
+    // accessors refer to the primary selection (the last object added).
+    Selection& getSelection() { return selection_; }
+    const Selection& getSelection() const { return selection_; }
+    EntityHandle getSelected() const { return selection_.getPrimary(); }
+    // Replace the selection with one object; a null handle clears it
+    void setSelected(EntityHandle handle) { selection_.set(handle); }
+    GameObject* getSelectedGameObject() const { return getGameObject(selection_.getPrimary()); }
+    // Select every mesh renderer whose world bounds are not outside the
+    // frustum (e.g. a viewport marquee), replacing the selection unless add
+    // is set. Goes through the bounds tree, so call it after update().
+    // Returns how many objects were hit.
+    size_t selectInFrustum(const Frustum& frustum, bool add = false);
+    // Destroy every selected object in one batch
     void deleteSelected();
     
-    // Helpers for clarity
-    void addPyramid(float size = 1.0f, float x = 0.0f, float y = 0.0f, float z = -2.0f, const std::string& baseName = "Pyramid");
-    void addCube(float size = 1.0f, float x = 0.0f, float y = 0.0f, float z = -2.0f, const std::string& baseName = "Cube");
-    void addSphere(float diameter = 1.0f, int segments = 32, float x = 0.0f, float y = 0.0f, float z = -2.0f, const std::string& baseName = "Sphere");
+    // Helpers for clarity; each returns a handle to the new object
+    EntityHandle addPyramid(float size = 1.0f, float x = 0.0f, float y = 0.0f, float z = -2.0f, const std::string& baseName = "Pyramid");
+    EntityHandle addCube(float size = 1.0f, float x = 0.0f, float y = 0.0f, float z = -2.0f, const std::string& baseName = "Cube");
+    EntityHandle addSphere(float diameter = 1.0f, int segments = 32, float x = 0.0f, float y = 0.0f, float z = -2.0f, const std::string& baseName = "Sphere");
     
     // Create an empty GameObject at the given position and select it
     GameObject* addEmptyGameObject(const std::string& baseName = "GameObject", float x = 0.0f, float y = 0.0f, float z = 0.0f);
     
+    // Local transform for batch spawning (rotation in Euler degrees)
+    struct SpawnTransform {
+        float position[3] = { 0.0f, 0.0f, 0.0f };
+        float rotation[3] = { 0.0f, 0.0f, 0.0f };
+        float scale[3] = { 1.0f, 1.0f, 1.0f };
+    };
+    
+    // Batch spawning for large procedural scenes. Storage is reserved once,
+    // names are assigned in bulk and every entity is created directly in its
+    // final archetype. transforms may be null (identity / prototype transform),
+    // otherwise it must hold count entries. Selection is left unchanged.
+    
+    // count objects named after baseName, all drawing the same mesh (may be null)
+    std::vector<EntityHandle> spawnBatch(const std::string& baseName, size_t count,
+                                         const SpawnTransform* transforms = nullptr,
+                                         std::shared_ptr<Mesh> mesh = nullptr);
+    
+    // count copies of prototype's components; meshes are shared, not duplicated
+    std::vector<EntityHandle> instantiate(EntityHandle prototype, size_t count,
+                                          const SpawnTransform* transforms = nullptr);
+    
+    // Prefab assets of the current project
+    PrefabLibrary& getPrefabs() { return prefabs_; }
+    
+    // count instances of a prefab. Instances share the prefab's mesh and
+    // material data until they are edited.
+    std::vector<EntityHandle> instantiatePrefab(const std::shared_ptr<Prefab>& prefab, size_t count,
+                                                const SpawnTransform* transforms = nullptr);
+    
+    // Save an object as a prefab asset and turn it into an instance of it
+    std::shared_ptr<Prefab> createPrefab(EntityHandle handle);
+    
 private:
-    std::vector<std::unique_ptr<GameObject>> gameObjects_;
-    int selectedIndex_ = -1;
+    // Declared first so they outlive the GameObjects that reference them
+    TransformStore transforms_;
+    EntityRegistry registry_;
+    Pool<GameObject> gameObjectPool_; // Destroyed before the registry it references
+    std::vector<GameObject*> gameObjects_;
+    std::vector<uint32_t> denseIndex_; // Entity index -> position in gameObjects_
+    Selection selection_;
+    NameRegistry names_;
+    PrefabLibrary prefabs_;
+    uint64_t objectsVersion_ = 0; // Bumped whenever objects are created, destroyed or renamed
+    Snapshot playSnapshot_;       // Declared after the registry it references
+    bool playing_ = false;
+    JobSystem* jobs_ = nullptr;
+    AabbTree boundsTree_;
+    SpatialHash spatialIndex_;
+    SystemScheduler systems_;
+    CommandBuffer commands_;
+    
+    // Swap-and-pop a single object out of gameObjects_
+    void removeGameObject(EntityHandle handle);
+    
+    // Create a GameObject at a position and append it to the scene
+    GameObject* createGameObject(const std::string& baseName, float x, float y, float z);
+    
+    // Wrap batch-created entities in GameObjects and attach their transforms.
+    // Without explicit transforms, copies prototypeSlot's local transform if valid.
+    std::vector<EntityHandle> adoptBatch(const std::vector<EntityId>& entities, const std::string& baseName,
+                                         const SpawnTransform* transforms, uint32_t prototypeSlot);
     
-    // Generate unique name with numbering if duplicates exist
-    std::string generateUniqueName(const std::string& baseName);
 };
 
 #endif
@@ -0,0 +1,56 @@
+#include "Selection.h"
+#include "ecs/EntityRegistry.h"
+#include <algorithm>
+
+void Selection::setBit(EntityId entity) {
+    size_t word = entity >> 6;
+    if (word >= bits_.size()) bits_.resize(std::max(word + 1, bits_.size() * 2), 0);
+    bits_[word] |= uint64_t(1) << (entity & 63);
+}
+
+void Selection::add(EntityHandle handle) {
+    if (handle.isNull() || contains(handle.index)) return;
+    setBit(handle.index);
+    handles_.push_back(handle);
+}
+
+void Selection::remove(EntityHandle handle) {
+    if (!contains(handle)) return;
+    clearBit(handle.index);
+    // Keep selection order so the primary stays the last one added
+    handles_.erase(std::find_if(handles_.begin(), handles_.end(),
+                                [&](const EntityHandle& h) { return h.index == handle.index; }));
+}
+
+void Selection::toggle(EntityHandle handle) {
+    if (contains(handle)) remove(handle);
+    else add(handle);
+}
+
+void Selection::set(EntityHandle handle) {
+    clear();
+    add(handle);
+}
+
+void Selection::assign(const std::vector<EntityHandle>& handles) {
+    clear();
+    handles_.reserve(handles.size());
+    for (const EntityHandle& handle : handles) add(handle);
+}
+
+void Selection::clear() {
+    // Only the words holding selected bits are touched
+    for (const EntityHandle& handle : handles_) bits_[handle.index >> 6] = 0;
+    handles_.clear();
+}
+
+size_t Selection::removeStale(const EntityRegistry& registry) {
+    size_t kept = 0;
+    for (const EntityHandle& handle : handles_) {
+        if (registry.isAlive(handle)) handles_[kept++] = handle;
+        else clearBit(handle.index);
+    }
+    size_t dropped = handles_.size() - kept;
+    handles_.resize(kept);
+    return dropped;
+}
@@ -40,6 +40,14 @@ void Shader::setInt(const std::string& name, int value) const {
     glUniform1i(glGetUniformLocation(ID, name.c_str()), value);
 }
 
+void Shader::setUVec2(const std::string& name, unsigned int x, unsigned int y) const {
+    glUniform2ui(glGetUniformLocation(ID, name.c_str()), x, y);
+}
+
+void Shader::setIntArray(const std::string& name, const int* values, int count) const {
+    if (count > 0) glUniform1iv(glGetUniformLocation(ID, name.c_str()), count, values);
+}
+
 void Shader::setFloat(const std::string& name, float value) const {
     glUniform1f(glGetUniformLocation(ID, name.c_str()), value);
 }
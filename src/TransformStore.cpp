@@ -0,0 +1,410 @@
+#include "TransformStore.h"
+#include "JobSystem.h"
+#include <algorithm>
+#include <iterator>
+
+namespace {
+    // Below this many matrices to build or propagate, threading costs more than it saves
+    constexpr size_t PARALLEL_PROPAGATE_THRESHOLD = 16384;
+    // Dirty slots per local matrix job (a multiple of the SSE batch of 4)
+    constexpr size_t LOCAL_MATRIX_GRAIN = 2048;
+}
+
+uint32_t TransformStore::allocate(uint32_t owner) {
+    uint32_t slot;
+    if (!freeList_.empty()) {
+        slot = freeList_.back();
+        freeList_.pop_back();
+    } else {
+        slot = (uint32_t)posX.size();
+        posX.push_back(0.0f); posY.push_back(0.0f); posZ.push_back(0.0f);
+        rotX.push_back(0.0f); rotY.push_back(0.0f); rotZ.push_back(0.0f); rotW.push_back(1.0f);
+        scaleX.push_back(1.0f); scaleY.push_back(1.0f); scaleZ.push_back(1.0f);
+        eulerHint.emplace_back();
+        local_.emplace_back();
+        world_.emplace_back();
+        owner_.push_back(0);
+        parent_.push_back(INVALID_SLOT);
+        position_.push_back(0);
+        alive_.push_back(0);
+        dirty_.push_back(0);
+        for (Watch& watch : watches_) watch.state.push_back(0);
+    }
+
+    posX[slot] = posY[slot] = posZ[slot] = 0.0f;
+    rotX[slot] = rotY[slot] = rotZ[slot] = 0.0f;
+    rotW[slot] = 1.0f;
+    scaleX[slot] = scaleY[slot] = scaleZ[slot] = 1.0f;
+    eulerHint[slot] = Vec3();
+    local_[slot] = Mat4::identity();
+    world_[slot] = Mat4::identity();
+    owner_[slot] = owner;
+    parent_[slot] = INVALID_SLOT;
+    alive_[slot] = 1;
+    for (Watch& watch : watches_) watch.state[slot] &= WATCH_LISTED; // A recycled slot may still be listed
+
+    // New slots are roots, so they can be appended without rebuilding the order
+    if (!orderDirty_) {
+        position_[slot] = (uint32_t)nodes_.size();
+        nodes_.push_back({ slot, -1, 1 });
+    }
+    markDirty(slot);
+    return slot;
+}
+
+void TransformStore::reserve(size_t slots) {
+    // Keep geometric growth so many small batches don't reallocate every time
+    auto grow = [slots](auto& v) {
+        if (slots > v.capacity()) v.reserve(std::max(slots, v.capacity() * 2));
+    };
+    grow(posX); grow(posY); grow(posZ);
+    grow(rotX); grow(rotY); grow(rotZ); grow(rotW);
+    grow(scaleX); grow(scaleY); grow(scaleZ);
+    grow(eulerHint);
+    grow(local_);
+    grow(world_);
+    grow(owner_);
+    grow(parent_);
+    grow(position_);
+    grow(alive_);
+    grow(dirty_);
+    for (Watch& watch : watches_) grow(watch.state);
+    grow(dirtyList_);
+    grow(nodes_);
+}
+
+void TransformStore::copyFrom(const TransformStore& other) {
+    posX = other.posX; posY = other.posY; posZ = other.posZ;
+    rotX = other.rotX; rotY = other.rotY; rotZ = other.rotZ; rotW = other.rotW;
+    scaleX = other.scaleX; scaleY = other.scaleY; scaleZ = other.scaleZ;
+    eulerHint = other.eulerHint;
+    local_ = other.local_;
+    world_ = other.world_;
+    owner_ = other.owner_;
+    parent_ = other.parent_;
+    position_ = other.position_;
+    alive_ = other.alive_;
+    dirty_ = other.dirty_;
+    dirtyList_ = other.dirtyList_;
+    freeList_ = other.freeList_;
+    pendingFree_ = other.pendingFree_;
+    nodes_ = other.nodes_;
+    orderDirty_ = other.orderDirty_;
+    for (uint32_t list = 0; list < WATCH_LIST_COUNT; ++list) {
+        watches_[list].state = other.watches_[list].state;
+        watches_[list].slots = other.watches_[list].slots;
+        watches_[list].moved = other.watches_[list].moved;
+    }
+}
+
+void TransformStore::release(uint32_t slot) {
+    // The slot is recycled at the next order rebuild, once no child can still
+    // point at it. Children of a released slot become roots.
+    alive_[slot] = 0;
+    pendingFree_.push_back(slot);
+    orderDirty_ = true;
+}
+
+void TransformStore::setWatched(WatchList list, uint32_t slot, bool watched) {
+    Watch& watch = watches_[list];
+    if (!watched) {
+        watch.state[slot] &= ~WATCHED; // Dropped from the list at the next collect
+        return;
+    }
+    watch.state[slot] |= WATCHED;
+    if (!(watch.state[slot] & WATCH_LISTED)) {
+        watch.state[slot] |= WATCH_LISTED;
+        watch.slots.push_back(slot);
+    }
+}
+
+void TransformStore::clearWatched(WatchList list) {
+    Watch& watch = watches_[list];
+    for (uint32_t slot : watch.slots) watch.state[slot] = 0;
+    for (uint32_t slot : watch.moved) watch.state[slot] = 0;
+    watch.slots.clear();
+    watch.moved.clear();
+}
+
+void TransformStore::takeMovedWatched(WatchList list, std::vector<uint32_t>& out) {
+    Watch& watch = watches_[list];
+    for (uint32_t slot : watch.moved) watch.state[slot] &= ~MOVED;
+    out.swap(watch.moved);
+    watch.moved.clear();
+}
+
+void TransformStore::collectMovedWatched(const std::vector<std::pair<uint32_t, uint32_t>>& ranges, size_t rebuilt) {
+    for (Watch& watch : watches_) {
+        if (watch.slots.empty()) continue;
+
+        // Fewer rebuilt nodes than watched slots (e.g. one object moved while
+        // every mesh is watched): check the rebuilt nodes' flags
+        if (rebuilt < watch.slots.size()) {
+            for (const auto& range : ranges) {
+                for (uint32_t p = range.first; p < range.second; ++p) {
+                    uint32_t slot = nodes_[p].slot;
+                    uint8_t& state = watch.state[slot];
+                    if ((state & (WATCHED | MOVED)) != WATCHED) continue;
+                    state |= MOVED;
+                    watch.moved.push_back(slot);
+                }
+            }
+            continue;
+        }
+
+        // Otherwise binary search per watched slot, so the cost follows the
+        // watched count rather than the number of rebuilt matrices. Slots no
+        // longer watched are dropped from the list on the way.
+        size_t kept = 0;
+        for (uint32_t slot : watch.slots) {
+            uint8_t& state = watch.state[slot];
+            if (!(state & WATCHED) || !alive_[slot]) {
+                state &= ~WATCH_LISTED;
+                continue;
+            }
+            watch.slots[kept++] = slot;
+            if (state & MOVED) continue;
+
+            uint32_t p = position_[slot];
+            auto after = std::upper_bound(ranges.begin(), ranges.end(), p,
+                [](uint32_t value, const std::pair<uint32_t, uint32_t>& range) { return value < range.first; });
+            if (after != ranges.begin() && p < std::prev(after)->second) {
+                state |= MOVED;
+                watch.moved.push_back(slot);
+            }
+        }
+        watch.slots.resize(kept);
+    }
+}
+
+bool TransformStore::setParent(uint32_t slot, uint32_t parent) {
+    if (parent != INVALID_SLOT) {
+        if (!alive_[parent]) return false;
+        // Reject cycles: the new parent must not be inside this slot's subtree
+        for (uint32_t p = parent; p != INVALID_SLOT; p = parent_[p]) {
+            if (p == slot) return false;
+        }
+    }
+    if (parent_[slot] == parent) return true;
+
+    parent_[slot] = parent;
+    orderDirty_ = true;
+    markDirty(slot);
+    return true;
+}
+
+void TransformStore::updateOrder() {
+    if (!orderDirty_) return;
+    orderDirty_ = false;
+
+    const uint32_t slotCount = (uint32_t)posX.size();
+
+    // Orphans of released slots become roots
+    for (uint32_t s = 0; s < slotCount; ++s) {
+        if (alive_[s] && parent_[s] != INVALID_SLOT && !alive_[parent_[s]]) {
+            parent_[s] = INVALID_SLOT;
+            markDirty(s);
+        }
+    }
+    for (uint32_t slot : pendingFree_) freeList_.push_back(slot);
+    pendingFree_.clear();
+
+    // Bucket children by parent (CSR), then walk depth-first with an explicit stack
+    std::vector<uint32_t> childStart(slotCount + 1, 0);
+    for (uint32_t s = 0; s < slotCount; ++s) {
+        if (alive_[s] && parent_[s] != INVALID_SLOT) ++childStart[parent_[s] + 1];
+    }
+    for (uint32_t s = 0; s < slotCount; ++s) childStart[s + 1] += childStart[s];
+    std::vector<uint32_t> children(childStart[slotCount]);
+    std::vector<uint32_t> fill(childStart.begin(), childStart.end() - 1);
+    for (uint32_t s = 0; s < slotCount; ++s) {
+        if (alive_[s] && parent_[s] != INVALID_SLOT) children[fill[parent_[s]]++] = s;
+    }
+
+    nodes_.clear();
+    std::vector<uint32_t> stack;
+    for (uint32_t root = 0; root < slotCount; ++root) {
+        if (!alive_[root] || parent_[root] != INVALID_SLOT) continue;
+        stack.push_back(root);
+        while (!stack.empty()) {
+            uint32_t s = stack.back();
+            stack.pop_back();
+            position_[s] = (uint32_t)nodes_.size();
+            int32_t parentPos = parent_[s] == INVALID_SLOT ? -1 : (int32_t)position_[parent_[s]];
+            nodes_.push_back({ s, parentPos, 1 });
+            // Push in reverse so children come out in slot order
+            for (uint32_t c = childStart[s + 1]; c > childStart[s]; --c) {
+                stack.push_back(children[c - 1]);
+            }
+        }
+    }
+
+    // Children always follow their parent, so one backward pass sums subtree sizes
+    for (size_t p = nodes_.size(); p-- > 0;) {
+        if (nodes_[p].parent >= 0) nodes_[nodes_[p].parent].subtreeSize += nodes_[p].subtreeSize;
+    }
+}
+
+size_t TransformStore::updateWorldMatrices() {
+    updateOrder();
+    if (dirtyList_.empty()) return 0;
+
+    // Released slots may still sit in the dirty list
+    dirtyList_.erase(std::remove_if(dirtyList_.begin(), dirtyList_.end(),
+        [this](uint32_t slot) {
+            if (alive_[slot]) return false;
+            dirty_[slot] = 0;
+            return true;
+        }), dirtyList_.end());
+
+    // Local matrices of the edited slots
+    const uint32_t* slots = dirtyList_.data();
+    size_t count = dirtyList_.size();
+    auto buildLocal = [this, slots](size_t begin, size_t end) {
+        size_t i = begin;
+#ifdef MATH_SSE2
+        for (; i + 4 <= end; i += 4) {
+            buildBatch4(slots + i);
+        }
+#endif
+        buildScalar(slots + i, end - i);
+    };
+    bool parallel = jobs_ && jobs_->getThreadCount() > 1;
+    if (parallel && count >= PARALLEL_PROPAGATE_THRESHOLD) {
+        // Split in groups of four so every job but the last stays on the SSE path
+        size_t groups = (count + 3) / 4;
+        jobs_->parallelFor(groups, [&](size_t begin, size_t end) {
+            buildLocal(begin * 4, std::min(end * 4, count));
+        }, LOCAL_MATRIX_GRAIN / 4);
+    } else {
+        buildLocal(0, count);
+    }
+
+    // Collapse dirty nodes into disjoint subtree ranges of the DFS array
+    std::vector<uint32_t> dirtyPositions;
+    dirtyPositions.reserve(count);
+    for (uint32_t slot : dirtyList_) {
+        dirtyPositions.push_back(position_[slot]);
+        dirty_[slot] = 0;
+    }
+    dirtyList_.clear();
+    std::sort(dirtyPositions.begin(), dirtyPositions.end());
+
+    std::vector<std::pair<uint32_t, uint32_t>> ranges;
+    size_t total = 0;
+    uint32_t coveredEnd = 0;
+    for (uint32_t p : dirtyPositions) {
+        if (p < coveredEnd) continue; // Already inside a dirty ancestor's subtree
+        coveredEnd = p + nodes_[p].subtreeSize;
+        ranges.push_back({ p, coveredEnd });
+        total += coveredEnd - p;
+    }
+    collectMovedWatched(ranges, total);
+
+    if (total < PARALLEL_PROPAGATE_THRESHOLD || !parallel) {
+        for (const auto& range : ranges) propagateRange(range.first, range.second);
+        return total;
+    }
+
+    // Split oversized ranges at their children so the work spreads over threads:
+    // once a node's world matrix is known, each child subtree is independent.
+    // Several tasks per thread let work stealing even out uneven subtrees.
+    size_t target = total / (jobs_->getThreadCount() * 4) + 1;
+    std::vector<std::pair<uint32_t, uint32_t>> tasks;
+    while (!ranges.empty()) {
+        auto range = ranges.back();
+        ranges.pop_back();
+        if (range.second - range.first <= target || nodes_[range.first].subtreeSize == 1) {
+            tasks.push_back(range);
+            continue;
+        }
+        propagateRange(range.first, range.first + 1);
+        for (uint32_t c = range.first + 1; c < range.second; c += nodes_[c].subtreeSize) {
+            ranges.push_back({ c, c + nodes_[c].subtreeSize });
+        }
+    }
+
+    jobs_->parallelFor(tasks.size(), [&](size_t begin, size_t end) {
+        for (size_t t = begin; t < end; ++t) propagateRange(tasks[t].first, tasks[t].second);
+    });
+    return total;
+}
+
+void TransformStore::propagateRange(uint32_t begin, uint32_t end) {
+    // DFS order guarantees a parent's world matrix is final before its children
+    for (uint32_t p = begin; p < end; ++p) {
+        uint32_t s = nodes_[p].slot;
+        uint32_t parent = parent_[s];
+        if (parent == INVALID_SLOT) {
+            world_[s] = local_[s];
+        } else {
+            world_[s] = world_[parent] * local_[s];
+        }
+    }
+}
+
+void TransformStore::buildScalar(const uint32_t* slots, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        uint32_t s = slots[i];
+        local_[s] = Mat4::fromTRS(
+            Vec3(posX[s], posY[s], posZ[s]),
+            Quat(rotX[s], rotY[s], rotZ[s], rotW[s]),
+            Vec3(scaleX[s], scaleY[s], scaleZ[s]));
+    }
+}
+
+void TransformStore::buildBatch4(const uint32_t* slots) {
+#ifdef MATH_SSE2
+    // Same math as Mat4::fromTRS, one object per SIMD lane. Quaternions need
+    // no trig, only products of their components.
+    auto gather = [slots](const std::vector<float>& v) {
+        return _mm_setr_ps(v[slots[0]], v[slots[1]], v[slots[2]], v[slots[3]]);
+    };
+
+    __m128 qx = gather(rotX), qy = gather(rotY), qz = gather(rotZ), qw = gather(rotW);
+    __m128 scX = gather(scaleX), scY = gather(scaleY), scZ = gather(scaleZ);
+    const __m128 one = _mm_set1_ps(1.0f), two = _mm_set1_ps(2.0f);
+
+    __m128 xx = _mm_mul_ps(qx, qx), yy = _mm_mul_ps(qy, qy), zz = _mm_mul_ps(qz, qz);
+    __m128 xy = _mm_mul_ps(qx, qy), xz = _mm_mul_ps(qx, qz), yz = _mm_mul_ps(qy, qz);
+    __m128 wx = _mm_mul_ps(qw, qx), wy = _mm_mul_ps(qw, qy), wz = _mm_mul_ps(qw, qz);
+
+    __m128 c0 = _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(yy, zz))), scX);
+    __m128 c1 = _mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(xy, wz)), scX);
+    __m128 c2 = _mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(xz, wy)), scX);
+    __m128 c3 = _mm_setzero_ps();
+
+    __m128 c4 = _mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(xy, wz)), scY);
+    __m128 c5 = _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, zz))), scY);
+    __m128 c6 = _mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(yz, wx)), scY);
+    __m128 c7 = _mm_setzero_ps();
+
+    __m128 c8 = _mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(xz, wy)), scZ);
+    __m128 c9 = _mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(yz, wx)), scZ);
+    __m128 c10 = _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, yy))), scZ);
+    __m128 c11 = _mm_setzero_ps();
+
+    __m128 c12 = gather(posX), c13 = gather(posY), c14 = gather(posZ);
+    __m128 c15 = _mm_set1_ps(1.0f);
+
+    // Lanes hold one element for four objects; transpose to get per-object columns
+    _MM_TRANSPOSE4_PS(c0, c1, c2, c3);
+    _MM_TRANSPOSE4_PS(c4, c5, c6, c7);
+    _MM_TRANSPOSE4_PS(c8, c9, c10, c11);
+    _MM_TRANSPOSE4_PS(c12, c13, c14, c15);
+
+    const __m128 col0[4] = { c0, c1, c2, c3 };
+    const __m128 col1[4] = { c4, c5, c6, c7 };
+    const __m128 col2[4] = { c8, c9, c10, c11 };
+    const __m128 col3[4] = { c12, c13, c14, c15 };
+    for (int l = 0; l < 4; ++l) {
+        float* out = local_[slots[l]].m;
+        _mm_store_ps(out + 0, col0[l]);
+        _mm_store_ps(out + 4, col1[l]);
+        _mm_store_ps(out + 8, col2[l]);
+        _mm_store_ps(out + 12, col3[l]);
+    }
+#else
+    buildScalar(slots, 4);
+#endif
+}
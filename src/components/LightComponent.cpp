@@ -1,4 +1,5 @@
 #include "components/LightComponent.h"
+#include "GameObject.h"
 #include "imgui.h"
 
 LightComponent::LightComponent() {
@@ -9,18 +10,23 @@ void LightComponent::renderInspectorGUI() {
     // Type selector
     const char* typeNames[] = { "Point", "Directional", "Spot", "Ambient" };
     int currentType = (int)type;
+    bool changed = false;
     if (ImGui::Combo("Type", &currentType, typeNames, 4)) {
         type = (Type)currentType;
+        changed = true;
     }
     
     // Color picker
-    ImGui::ColorEdit3("Color", color);
+    changed |= ImGui::ColorEdit3("Color", color);
     
     // Intensity slider
-    ImGui::SliderFloat("Intensity", &intensity, 0.0f, 10.0f);
+    changed |= ImGui::SliderFloat("Intensity", &intensity, 0.0f, 10.0f);
     
     // Range (only for Point and Spot lights)
     if (type == Type::Point || type == Type::Spot) {
-        ImGui::DragFloat("Range", &range, 0.1f, 0.1f, 100.0f);
+        changed |= ImGui::DragFloat("Range", &range, 0.1f, 0.1f, 100.0f);
     }
+    
+    // Let the scene's light array pick up the edit
+    if (changed && gameObject) gameObject->markChanged<LightComponent>();
 }
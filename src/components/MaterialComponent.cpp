@@ -1,8 +1,15 @@
 #include "components/MaterialComponent.h"
+#include "GameObject.h"
 #include "imgui.h"
 
 void MaterialComponent::renderInspectorGUI() {
-    ImGui::ColorEdit3("Albedo", albedo);
-    ImGui::SliderFloat("Metallic", &metallic, 0.0f, 1.0f);
-    ImGui::SliderFloat("Roughness", &roughness, 0.0f, 1.0f);
+    // Edit a copy so shared data is only detached when a value actually changes
+    MaterialData values = data.get();
+    bool changed = ImGui::ColorEdit3("Albedo", values.albedo);
+    changed |= ImGui::SliderFloat("Metallic", &values.metallic, 0.0f, 1.0f);
+    changed |= ImGui::SliderFloat("Roughness", &values.roughness, 0.0f, 1.0f);
+    if (changed) {
+        data.edit() = values;
+        if (gameObject) gameObject->markChanged<MaterialComponent>();
+    }
 }
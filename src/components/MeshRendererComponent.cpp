@@ -1,19 +1,12 @@
 #include "components/MeshRendererComponent.h"
 #include "Mesh.h"
 #include "Meshes.h"
+#include "GameObject.h"
 #include "imgui.h"
 
 MeshRendererComponent::MeshRendererComponent() {
 }
 
-MeshRendererComponent::~MeshRendererComponent() {
-    // Mesh is owned by this component
-    if (mesh) {
-        delete mesh;
-        mesh = nullptr;
-    }
-}
-
 void MeshRendererComponent::renderInspectorGUI() {
     // Preset selector
     const char* presetNames[] = { "None", "Cube", "Pyramid", "Sphere" };
@@ -31,8 +24,9 @@ void MeshRendererComponent::renderInspectorGUI() {
         ImGui::Text("Vertices: %d", mesh->getVertexCount());
         ImGui::Text("Triangles: %d", mesh->getVertexCount() / 3);
         if (ImGui::Button("Clear Mesh")) {
-            delete mesh; mesh = nullptr;
+            mesh.reset();
             preset = Preset::None;
+            if (gameObject) gameObject->markChanged<MeshRendererComponent>();
         }
     } else {
         ImGui::TextDisabled("No mesh assigned");
@@ -42,21 +36,22 @@ void MeshRendererComponent::renderInspectorGUI() {
 }
 
 void MeshRendererComponent::rebuildMesh() {
-    // Clean up existing mesh if any
-    if (mesh) { delete mesh; mesh = nullptr; }
+    // Drop this object's reference; the mesh is freed once nothing else shares it
+    mesh.reset(createPresetMesh(preset));
+    // Let the scene's bounds pick up the new mesh
+    if (gameObject) gameObject->markChanged<MeshRendererComponent>();
+}
 
+Mesh* MeshRendererComponent::createPresetMesh(Preset preset) {
     switch (preset) {
-        case Preset::None:
-            mesh = nullptr;
-            break;
         case Preset::Cube:
-            mesh = CreateCubeMesh(1.0f);
-            break;
+            return CreateCubeMesh(1.0f);
         case Preset::Pyramid:
-            mesh = CreatePyramidMesh(1.0f);
-            break;
+            return CreatePyramidMesh(1.0f);
         case Preset::Sphere:
-            mesh = CreateSphereMesh(1.0f, 32);
+            return CreateSphereMesh(1.0f, 32);
+        case Preset::None:
             break;
     }
+    return nullptr;
 }
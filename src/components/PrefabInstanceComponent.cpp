@@ -0,0 +1,28 @@
+#include "components/PrefabInstanceComponent.h"
+#include "components/MaterialComponent.h"
+#include "GameObject.h"
+#include "Prefab.h"
+#include "imgui.h"
+
+void PrefabInstanceComponent::renderInspectorGUI() {
+    if (!prefab) {
+        ImGui::TextDisabled("Missing prefab");
+        return;
+    }
+    ImGui::Text("Prefab: %s", prefab->name.c_str());
+
+    // A material that no longer shares the prefab's data has been overridden
+    auto* material = gameObject ? gameObject->getComponent<MaterialComponent>() : nullptr;
+    if (material && prefab->hasMaterial) {
+        if (material->data.sharesWith(prefab->material)) {
+            ImGui::TextDisabled("Material: shared");
+        } else {
+            ImGui::Text("Material: overridden");
+            ImGui::SameLine();
+            if (ImGui::SmallButton("Revert")) {
+                material->data = prefab->material;
+                gameObject->markChanged<MaterialComponent>();
+            }
+        }
+    }
+}
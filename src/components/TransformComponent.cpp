@@ -1,12 +1,118 @@
 #include "components/TransformComponent.h"
+#include "MathUtils.h"
 #include "imgui.h"
+#include <cmath>
 
 TransformComponent::TransformComponent() {
-    // Default values already set in header
+    // Data lives in the TransformStore once attached
+}
+
+TransformComponent::~TransformComponent() {
+    if (store_) {
+        store_->release(slot_);
+    }
+}
+
+TransformComponent::TransformComponent(TransformComponent&& other) noexcept
+    : Component(other)
+    , store_(other.store_)
+    , slot_(other.slot_) {
+    other.store_ = nullptr;
+    other.slot_ = TransformStore::INVALID_SLOT;
+}
+
+void TransformComponent::saveSnapshot(SnapshotData& out) const {
+    out.gameObject = gameObject;
+    out.store = store_;
+    out.slot = slot_;
+    out.enabled = enabled;
+}
+
+void TransformComponent::restoreSnapshot(const SnapshotData& saved) {
+    gameObject = saved.gameObject;
+    store_ = saved.store;
+    slot_ = saved.slot;
+    enabled = saved.enabled;
+}
+
+void TransformComponent::attach(TransformStore& store, uint32_t owner) {
+    store_ = &store;
+    slot_ = store.allocate(owner);
+}
+
+void TransformComponent::setPosition(float x, float y, float z) {
+    store_->posX[slot_] = x;
+    store_->posY[slot_] = y;
+    store_->posZ[slot_] = z;
+    store_->markDirty(slot_);
+}
+
+void TransformComponent::getPosition(float out[3]) const {
+    out[0] = store_->posX[slot_];
+    out[1] = store_->posY[slot_];
+    out[2] = store_->posZ[slot_];
+}
+
+void TransformComponent::setRotation(const Quat& rotation) {
+    Quat q = rotation.normalized();
+    store_->rotX[slot_] = q.x;
+    store_->rotY[slot_] = q.y;
+    store_->rotZ[slot_] = q.z;
+    store_->rotW[slot_] = q.w;
+    store_->markDirty(slot_);
+}
+
+Quat TransformComponent::getRotation() const {
+    return Quat(store_->rotX[slot_], store_->rotY[slot_], store_->rotZ[slot_], store_->rotW[slot_]);
+}
+
+void TransformComponent::setRotation(float x, float y, float z) {
+    Vec3 degrees(x, y, z);
+    setRotation(Quat::fromEuler(degrees * MathUtils::DEG_TO_RAD));
+    store_->eulerHint[slot_] = degrees;
+}
+
+void TransformComponent::getEulerRotation(float out[3]) const {
+    // Keep the angles as typed (e.g. 180 stays 180) unless the rotation was
+    // changed through the quaternion since
+    Quat current = getRotation();
+    Vec3 degrees = store_->eulerHint[slot_];
+    Quat hinted = Quat::fromEuler(degrees * MathUtils::DEG_TO_RAD);
+    float d = hinted.x * current.x + hinted.y * current.y + hinted.z * current.z + hinted.w * current.w;
+    if (std::fabs(d) < 0.999999f) {
+        degrees = current.toEuler() * MathUtils::RAD_TO_DEG;
+    }
+    out[0] = degrees.x;
+    out[1] = degrees.y;
+    out[2] = degrees.z;
+}
+
+void TransformComponent::setScale(float x, float y, float z) {
+    store_->scaleX[slot_] = x;
+    store_->scaleY[slot_] = y;
+    store_->scaleZ[slot_] = z;
+    store_->markDirty(slot_);
+}
+
+void TransformComponent::getScale(float out[3]) const {
+    out[0] = store_->scaleX[slot_];
+    out[1] = store_->scaleY[slot_];
+    out[2] = store_->scaleZ[slot_];
+}
+
+void TransformComponent::getWorldPosition(float out[3]) const {
+    Vec3 position = getWorldMatrix().getTranslation();
+    out[0] = position.x;
+    out[1] = position.y;
+    out[2] = position.z;
 }
 
 void TransformComponent::renderInspectorGUI() {
-    ImGui::DragFloat3("Position", &x, 0.01f);
-    ImGui::DragFloat3("Rotation", &rotX, 1.0f);
-    ImGui::DragFloat3("Scale", &scaleX, 0.01f, 0.01f, 10.0f);
+    float position[3], rotation[3], scale[3];
+    getPosition(position);
+    getEulerRotation(rotation);
+    getScale(scale);
+    if (ImGui::DragFloat3("Position", position, 0.01f)) setPosition(position[0], position[1], position[2]);
+    if (ImGui::DragFloat3("Rotation", rotation, 1.0f)) setRotation(rotation[0], rotation[1], rotation[2]);
+    if (ImGui::DragFloat3("Scale", scale, 0.01f, 0.01f, 10.0f)) setScale(scale[0], scale[1], scale[2]);
 }
@@ -0,0 +1,148 @@
+#include "ecs/Archetype.h"
+#include <algorithm>
+#include <iterator>
+
+namespace {
+    // Columns are aligned at least this much so batch code can use aligned loads
+    constexpr size_t COLUMN_ALIGN = 16;
+
+    size_t alignUp(size_t value, size_t align) {
+        return (value + align - 1) & ~(align - 1);
+    }
+}
+
+Archetype::Archetype(const std::vector<const ComponentInfo*>& types, ChunkAllocator& allocator)
+    : allocator_(&allocator), types_(types) {
+    std::fill(std::begin(columnOfType_), std::end(columnOfType_), (int8_t)-1);
+    for (size_t i = 0; i < types_.size(); ++i) {
+        mask_ |= componentBit(types_[i]->id);
+        columnOfType_[types_[i]->id] = (int8_t)i;
+    }
+
+    // Find the largest row count whose column layout fits in one chunk
+    size_t rowBytes = sizeof(EntityId);
+    for (const ComponentInfo* info : types_) rowBytes += info->size;
+
+    auto layoutSize = [this](uint32_t capacity) {
+        size_t offset = sizeof(EntityId) * capacity;
+        for (const ComponentInfo* info : types_) {
+            offset = alignUp(offset, std::max(info->align, COLUMN_ALIGN));
+            offset += info->size * capacity;
+        }
+        return offset;
+    };
+
+    chunkCapacity_ = static_cast<uint32_t>(std::max<size_t>(1, CHUNK_SIZE / rowBytes));
+    while (chunkCapacity_ > 1 && layoutSize(chunkCapacity_) > CHUNK_SIZE) {
+        --chunkCapacity_;
+    }
+
+    size_t offset = sizeof(EntityId) * chunkCapacity_;
+    for (const ComponentInfo* info : types_) {
+        offset = alignUp(offset, std::max(info->align, COLUMN_ALIGN));
+        columnOffsets_.push_back(offset);
+        offset += info->size * chunkCapacity_;
+    }
+}
+
+Archetype::~Archetype() {
+    // Destroy remaining components, then release chunk memory
+    for (uint32_t row = 0; row < count_; ++row) {
+        for (size_t c = 0; c < types_.size(); ++c) {
+            types_[c]->destroy(getComponent((int)c, row));
+        }
+    }
+    for (unsigned char* chunk : chunks_) {
+        allocator_->free(chunk, getChunkBytes());
+    }
+}
+
+size_t Archetype::getChunkBytes() const {
+    // Only exceeds CHUNK_SIZE when a single row doesn't fit in one chunk
+    size_t bytes = CHUNK_SIZE;
+    if (!types_.empty()) {
+        const ComponentInfo* lastInfo = types_.back();
+        bytes = std::max(bytes, columnOffsets_.back() + lastInfo->size * chunkCapacity_);
+    }
+    return bytes;
+}
+
+unsigned char* Archetype::allocateChunk() {
+    return allocator_->allocate(getChunkBytes());
+}
+
+uint32_t Archetype::allocateRow(EntityId entity) {
+    uint32_t row = count_;
+    if (row / chunkCapacity_ >= chunks_.size()) {
+        chunks_.push_back(allocateChunk());
+    }
+    ++count_;
+    reinterpret_cast<EntityId*>(chunks_[row / chunkCapacity_])[row % chunkCapacity_] = entity;
+    return row;
+}
+
+void Archetype::reserve(uint32_t rows) {
+    size_t needed = (rows + chunkCapacity_ - 1) / chunkCapacity_;
+    while (chunks_.size() < needed) {
+        chunks_.push_back(allocateChunk());
+    }
+}
+
+void Archetype::discardRows() {
+    for (size_t c = 0; c < types_.size(); ++c) {
+        for (uint32_t row = 0; row < count_; ++row) {
+            types_[c]->destroy(getComponent((int)c, row));
+        }
+    }
+    count_ = 0;
+}
+
+void Archetype::setRowCount(uint32_t rows) {
+    reserve(rows);
+    count_ = rows;
+}
+
+EntityId Archetype::removeRow(uint32_t row) {
+    uint32_t last = count_ - 1;
+    EntityId moved = INVALID_ENTITY;
+
+    for (size_t c = 0; c < types_.size(); ++c) {
+        void* dst = getComponent((int)c, row);
+        types_[c]->destroy(dst);
+        if (row != last) {
+            // Swap-and-pop: relocate the last row into the hole
+            void* src = getComponent((int)c, last);
+            types_[c]->moveConstruct(dst, src);
+            types_[c]->destroy(src);
+        }
+    }
+
+    if (row != last) {
+        moved = getEntity(last);
+        reinterpret_cast<EntityId*>(chunks_[row / chunkCapacity_])[row % chunkCapacity_] = moved;
+    }
+    --count_;
+
+    // Release trailing chunks, keeping one spare to avoid thrashing at a boundary
+    size_t needed = (count_ + chunkCapacity_ - 1) / chunkCapacity_;
+    while (chunks_.size() > needed + 1) {
+        allocator_->free(chunks_.back(), getChunkBytes());
+        chunks_.pop_back();
+    }
+    return moved;
+}
+
+void* Archetype::getComponent(int column, uint32_t row) {
+    unsigned char* chunk = chunks_[row / chunkCapacity_];
+    return chunk + columnOffsets_[column] + types_[column]->size * (row % chunkCapacity_);
+}
+
+EntityId Archetype::getEntity(uint32_t row) const {
+    return getChunkEntities(row / chunkCapacity_)[row % chunkCapacity_];
+}
+
+uint32_t Archetype::getChunkRowCount(size_t chunk) const {
+    uint32_t start = (uint32_t)chunk * chunkCapacity_;
+    if (start >= count_) return 0;
+    return std::min(chunkCapacity_, count_ - start);
+}
@@ -0,0 +1,30 @@
+#include "ecs/ChunkAllocator.h"
+#include <new>
+
+ChunkAllocator::~ChunkAllocator() {
+    for (unsigned char* chunk : freeChunks_) {
+        ::operator delete(chunk, std::align_val_t(CHUNK_ALIGN));
+    }
+}
+
+unsigned char* ChunkAllocator::allocate(size_t bytes) {
+    ++liveChunks_;
+    if (bytes <= CHUNK_SIZE && !freeChunks_.empty()) {
+        unsigned char* chunk = freeChunks_.back();
+        freeChunks_.pop_back();
+        return chunk;
+    }
+
+    ++heapAllocations_;
+    size_t size = bytes <= CHUNK_SIZE ? CHUNK_SIZE : bytes;
+    return static_cast<unsigned char*>(::operator new(size, std::align_val_t(CHUNK_ALIGN)));
+}
+
+void ChunkAllocator::free(unsigned char* chunk, size_t bytes) {
+    --liveChunks_;
+    if (bytes <= CHUNK_SIZE) {
+        freeChunks_.push_back(chunk);
+    } else {
+        ::operator delete(chunk, std::align_val_t(CHUNK_ALIGN));
+    }
+}
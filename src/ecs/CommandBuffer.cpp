@@ -0,0 +1,61 @@
+#include "ecs/CommandBuffer.h"
+#include <cassert>
+
+CommandBuffer::PendingEntity CommandBuffer::create(const std::string& baseName, float x, float y, float z) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    uint32_t index = (uint32_t)creations_.size();
+    creations_.push_back({ baseName, { x, y, z } });
+    commands_.push_back({ Kind::Create, EntityHandle(), index, nullptr, 0, nullptr });
+    return { index };
+}
+
+void CommandBuffer::destroy(EntityHandle target) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    commands_.push_back({ Kind::Destroy, target, NO_PENDING, nullptr, 0, nullptr });
+}
+
+void CommandBuffer::remove(EntityHandle target, ComponentTypeId type) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    commands_.push_back({ Kind::Remove, target, NO_PENDING, nullptr, type, nullptr });
+}
+
+bool CommandBuffer::isEmpty() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return commands_.empty();
+}
+
+void CommandBuffer::clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    // Values were moved from during playback (or never used); either way they're still alive
+    for (const Command& command : commands_) {
+        if (command.value) command.info->destroy(command.value);
+    }
+    commands_.clear();
+    creations_.clear();
+
+    // Blocks are kept for the next frame; oversized values are freed
+    largeValues_.clear();
+    currentBlock_ = 0;
+    blockUsed_ = 0;
+}
+
+void* CommandBuffer::allocateValue(size_t size, size_t align) {
+    assert(align <= VALUE_ALIGN && "Over-aligned component");
+    if (size > BLOCK_SIZE) {
+        largeValues_.emplace_back(static_cast<unsigned char*>(::operator new(size, std::align_val_t(VALUE_ALIGN))));
+        return largeValues_.back().get();
+    }
+
+    if (blocks_.empty()) {
+        blocks_.emplace_back(static_cast<unsigned char*>(::operator new(BLOCK_SIZE, std::align_val_t(VALUE_ALIGN))));
+    }
+    size_t offset = (blockUsed_ + align - 1) & ~(align - 1);
+    if (offset + size > BLOCK_SIZE) {
+        if (++currentBlock_ == blocks_.size()) {
+            blocks_.emplace_back(static_cast<unsigned char*>(::operator new(BLOCK_SIZE, std::align_val_t(VALUE_ALIGN))));
+        }
+        offset = 0;
+    }
+    blockUsed_ = offset + size;
+    return blocks_[currentBlock_].get() + offset;
+}
@@ -0,0 +1,479 @@
+#include "ecs/EntityRegistry.h"
+#include "components/Component.h"
+#include <algorithm>
+#include <cstring>
+#include <new>
+
+namespace {
+    constexpr size_t SNAPSHOT_ALIGN = 64;
+
+    size_t alignUp(size_t value, size_t align) {
+        return (value + align - 1) & ~(align - 1);
+    }
+
+    // Bytes per row of a type's snapshot column
+    size_t snapshotStride(const ComponentInfo& info) {
+        return info.snapshotSize ? info.snapshotSize : info.size;
+    }
+}
+
+EntityRegistry::EntityRegistry() {
+    emptyArchetype_ = findOrCreateArchetype({});
+}
+
+EntityRegistry::~EntityRegistry() {
+    // Archetypes destroy whatever components are still alive
+    archetypes_.clear();
+}
+
+EntityId EntityRegistry::allocateId() {
+    if (!freeList_.empty()) {
+        EntityId entity = freeList_.back();
+        freeList_.pop_back();
+        return entity;
+    }
+    records_.emplace_back();
+    return (EntityId)records_.size() - 1;
+}
+
+EntityId EntityRegistry::create(GameObject* owner) {
+    EntityId entity = allocateId();
+    EntityRecord& record = records_[entity];
+    record.archetype = emptyArchetype_;
+    record.row = emptyArchetype_->allocateRow(entity);
+    record.mask = 0;
+    record.owner = owner;
+    return entity;
+}
+
+void EntityRegistry::setOwner(EntityId entity, GameObject* owner) {
+    EntityRecord& record = records_[entity];
+    record.owner = owner;
+    const auto& types = record.archetype->getTypes();
+    for (size_t c = 0; c < types.size(); ++c) {
+        types[c]->asComponent(record.archetype->getComponent((int)c, record.row))->gameObject = owner;
+    }
+}
+
+void EntityRegistry::createBatch(std::vector<const ComponentInfo*> types, size_t count, std::vector<EntityId>& out) {
+    std::sort(types.begin(), types.end(),
+        [](const ComponentInfo* a, const ComponentInfo* b) { return a->id < b->id; });
+    types.erase(std::unique(types.begin(), types.end()), types.end());
+    createBatchIn(findOrCreateArchetype(types), count, out, INVALID_ENTITY);
+}
+
+void EntityRegistry::cloneBatch(EntityId prototype, size_t count, std::vector<EntityId>& out) {
+    createBatchIn(records_[prototype].archetype, count, out, prototype);
+}
+
+void EntityRegistry::createBatchIn(Archetype* archetype, size_t count, std::vector<EntityId>& out, EntityId prototype) {
+    out.clear();
+    out.reserve(count);
+    archetype->reserve(archetype->size() + (uint32_t)count);
+    if (freeList_.size() < count) {
+        size_t needed = records_.size() + count - freeList_.size();
+        if (needed > records_.capacity()) records_.reserve(std::max(needed, records_.capacity() * 2));
+    }
+
+    // Chunks are reserved, so the prototype's row can't move while we copy from it
+    const auto& types = archetype->getTypes();
+    uint32_t prototypeRow = prototype != INVALID_ENTITY ? records_[prototype].row : 0;
+    for (size_t i = 0; i < count; ++i) {
+        EntityId entity = allocateId();
+        uint32_t row = archetype->allocateRow(entity);
+        for (size_t c = 0; c < types.size(); ++c) {
+            void* dst = archetype->getComponent((int)c, row);
+            if (prototype != INVALID_ENTITY && types[c]->copyConstruct) {
+                types[c]->copyConstruct(dst, archetype->getComponent((int)c, prototypeRow));
+            } else {
+                types[c]->defaultConstruct(dst);
+            }
+            types[c]->asComponent(dst)->gameObject = nullptr;
+        }
+
+        EntityRecord& record = records_[entity];
+        record.archetype = archetype;
+        record.row = row;
+        record.mask = archetype->getMask();
+        record.owner = nullptr;
+        out.push_back(entity);
+    }
+    if (count > 0) bumpStructureVersions(archetype->getMask());
+}
+
+void EntityRegistry::destroy(EntityId entity) {
+    EntityRecord& record = records_[entity];
+    if (!record.archetype) return;
+    bumpStructureVersions(record.mask);
+
+    EntityId moved = record.archetype->removeRow(record.row);
+    if (moved != INVALID_ENTITY) {
+        records_[moved].row = record.row;
+    }
+
+    uint32_t generation = record.generation + 1;
+    record = EntityRecord();
+    record.generation = generation;
+    freeList_.push_back(entity);
+}
+
+void EntityRegistry::remove(EntityId entity, Component* component) {
+    if (!component) return;
+
+    EntityRecord& record = records_[entity];
+    Archetype* current = record.archetype;
+    const auto& types = current->getTypes();
+    for (size_t c = 0; c < types.size(); ++c) {
+        if (types[c]->asComponent(current->getComponent((int)c, record.row)) == component) {
+            moveEntity(entity, getRemoveTarget(current, types[c]->id));
+            return;
+        }
+    }
+}
+
+void EntityRegistry::changeComponents(EntityId entity, const std::vector<const ComponentInfo*>& added,
+                                      void* const* values, ComponentMask removed) {
+    EntityRecord& record = records_[entity];
+    Archetype* current = record.archetype;
+
+    std::vector<const ComponentInfo*> types;
+    for (const ComponentInfo* info : current->getTypes()) {
+        if (!(removed & componentBit(info->id))) types.push_back(info);
+    }
+    std::vector<size_t> constructed; // Indices into added that need constructing
+    ComponentMask replaced = 0;      // Removed and re-added: the old value is destroyed first
+    for (size_t i = 0; i < added.size(); ++i) {
+        ComponentMask bit = componentBit(added[i]->id);
+        if (current->hasType(added[i]->id)) {
+            if (!(removed & bit)) continue;
+            replaced |= bit;
+        }
+        types.push_back(added[i]);
+        constructed.push_back(i);
+    }
+    std::sort(types.begin(), types.end(),
+        [](const ComponentInfo* a, const ComponentInfo* b) { return a->id < b->id; });
+
+    // moveEntity carries replaced types over like any shared column
+    Archetype* target = findOrCreateArchetype(types);
+    if (target != current) moveEntity(entity, target);
+    if (replaced) {
+        for (size_t i : constructed) {
+            if (!(replaced & componentBit(added[i]->id))) continue;
+            added[i]->destroy(target->getComponent(target->getColumn(added[i]->id), record.row));
+        }
+        // A whole new value: caches treat it like a remove and add
+        bumpStructureVersions(replaced);
+    }
+
+    for (size_t i : constructed) {
+        void* memory = target->getComponent(target->getColumn(added[i]->id), record.row);
+        if (values && values[i]) {
+            added[i]->moveConstruct(memory, values[i]);
+        } else {
+            added[i]->defaultConstruct(memory);
+        }
+        added[i]->asComponent(memory)->gameObject = record.owner;
+    }
+}
+
+void EntityRegistry::replaceComponent(EntityId entity, const ComponentInfo& info, void* value) {
+    const EntityRecord& record = records_[entity];
+    int column = record.archetype->getColumn(info.id);
+    if (column < 0) return;
+
+    void* memory = record.archetype->getComponent(column, record.row);
+    info.destroy(memory);
+    info.moveConstruct(memory, value);
+    info.asComponent(memory)->gameObject = record.owner;
+    // A whole new value: caches treat it like a remove and add
+    bumpStructureVersions(componentBit(info.id));
+}
+
+Component* EntityRegistry::getComponent(EntityId entity, ComponentTypeId type) {
+    const EntityRecord& record = records_[entity];
+    int column = record.archetype->getColumn(type);
+    if (column < 0) return nullptr;
+    return record.archetype->getTypes()[column]->asComponent(record.archetype->getComponent(column, record.row));
+}
+
+ComponentTypeId EntityRegistry::findComponentType(EntityId entity, const Component* component) const {
+    const EntityRecord& record = records_[entity];
+    const auto& types = record.archetype->getTypes();
+    for (size_t c = 0; c < types.size(); ++c) {
+        if (types[c]->asComponent(record.archetype->getComponent((int)c, record.row)) == component) {
+            return types[c]->id;
+        }
+    }
+    return MAX_COMPONENT_TYPES;
+}
+
+void EntityRegistry::getComponents(EntityId entity, std::vector<Component*>& out) {
+    const EntityRecord& record = records_[entity];
+    const auto& types = record.archetype->getTypes();
+    out.clear();
+    out.reserve(types.size());
+    for (size_t c = 0; c < types.size(); ++c) {
+        out.push_back(types[c]->asComponent(record.archetype->getComponent((int)c, record.row)));
+    }
+}
+
+Archetype* EntityRegistry::findOrCreateArchetype(const std::vector<const ComponentInfo*>& types) {
+    ComponentMask key = 0;
+    for (const ComponentInfo* info : types) key |= componentBit(info->id);
+
+    auto it = archetypeLookup_.find(key);
+    if (it != archetypeLookup_.end()) return it->second;
+
+    archetypes_.push_back(std::make_unique<Archetype>(types, chunkAllocator_));
+    Archetype* archetype = archetypes_.back().get();
+    archetypeLookup_[key] = archetype;
+
+    // Register with every cached query it satisfies
+    for (auto& query : queryCache_) {
+        if ((key & query.first) == query.first) query.second.push_back(archetype);
+    }
+    return archetype;
+}
+
+const std::vector<Archetype*>& EntityRegistry::getMatchingArchetypes(ComponentMask required) {
+    // Map nodes are stable, so the returned list stays valid after unlocking
+    std::lock_guard<std::mutex> lock(queryCacheMutex_);
+    auto it = queryCache_.find(required);
+    if (it != queryCache_.end()) return it->second;
+
+    std::vector<Archetype*>& matches = queryCache_[required];
+    for (const auto& archetype : archetypes_) {
+        if ((archetype->getMask() & required) == required) matches.push_back(archetype.get());
+    }
+    return matches;
+}
+
+Archetype* EntityRegistry::getAddTarget(Archetype* from, const ComponentInfo& info) {
+    if (Archetype* cached = from->addEdges[info.id]) return cached;
+
+    std::vector<const ComponentInfo*> types = from->getTypes();
+    types.push_back(&info);
+    std::sort(types.begin(), types.end(),
+        [](const ComponentInfo* a, const ComponentInfo* b) { return a->id < b->id; });
+
+    Archetype* target = findOrCreateArchetype(types);
+    from->addEdges[info.id] = target;
+    target->removeEdges[info.id] = from;
+    return target;
+}
+
+Archetype* EntityRegistry::getRemoveTarget(Archetype* from, ComponentTypeId id) {
+    if (Archetype* cached = from->removeEdges[id]) return cached;
+
+    std::vector<const ComponentInfo*> types;
+    for (const ComponentInfo* info : from->getTypes()) {
+        if (info->id != id) types.push_back(info);
+    }
+
+    Archetype* target = findOrCreateArchetype(types);
+    from->removeEdges[id] = target;
+    target->addEdges[id] = from;
+    return target;
+}
+
+void EntityRegistry::moveEntity(EntityId entity, Archetype* to) {
+    EntityRecord& record = records_[entity];
+    Archetype* from = record.archetype;
+    uint32_t newRow = to->allocateRow(entity);
+
+    // Relocate shared columns; anything left behind is destroyed by removeRow
+    const auto& fromTypes = from->getTypes();
+    for (size_t c = 0; c < fromTypes.size(); ++c) {
+        int dstColumn = to->getColumn(fromTypes[c]->id);
+        if (dstColumn < 0) continue;
+        fromTypes[c]->moveConstruct(to->getComponent(dstColumn, newRow),
+                                    from->getComponent((int)c, record.row));
+    }
+
+    EntityId moved = from->removeRow(record.row);
+    if (moved != INVALID_ENTITY) {
+        records_[moved].row = record.row;
+    }
+
+    bumpStructureVersions(record.mask ^ to->getMask());
+    record.archetype = to;
+    record.row = newRow;
+    record.mask = to->getMask();
+}
+
+void EntityRegistry::bumpStructureVersions(ComponentMask types) {
+    for (ComponentTypeId type = 0; types != 0; ++type, types >>= 1) {
+        if (types & 1) ++structureVersions_[type];
+    }
+}
+
+void EntityRegistry::setChangeTracking(ComponentTypeId type, bool enabled) {
+    std::lock_guard<std::mutex> lock(changedMutex_);
+    if (enabled) {
+        changeTracking_ |= componentBit(type);
+    } else {
+        changeTracking_ &= ~componentBit(type);
+        changed_[type].clear();
+    }
+}
+
+void EntityRegistry::markChanged(EntityId entity, ComponentTypeId type) {
+    std::lock_guard<std::mutex> lock(changedMutex_);
+    if (changeTracking_ & componentBit(type)) changed_[type].push_back(entity);
+}
+
+void EntityRegistry::takeChanged(ComponentTypeId type, std::vector<EntityId>& out) {
+    std::lock_guard<std::mutex> lock(changedMutex_);
+    out.swap(changed_[type]);
+    changed_[type].clear();
+}
+
+EntityRegistry::Snapshot::~Snapshot() {
+    releaseCopies();
+    if (buffer_) ::operator delete(buffer_, std::align_val_t(SNAPSHOT_ALIGN));
+}
+
+void EntityRegistry::Snapshot::releaseCopies() {
+    for (const ArchetypeState& state : archetypes_) {
+        const auto& types = state.archetype->getTypes();
+        for (size_t c = 0; c < types.size(); ++c) {
+            if (types[c]->snapshotSize) continue; // Plain payloads need no destruction
+            for (uint32_t row = 0; row < state.count; ++row) {
+                types[c]->destroy(buffer_ + state.columnOffsets[c] + types[c]->size * row);
+            }
+        }
+    }
+    archetypes_.clear();
+    used_ = 0;
+}
+
+void EntityRegistry::Snapshot::reserve(size_t bytes) {
+    if (bytes <= capacity_) return;
+    if (buffer_) ::operator delete(buffer_, std::align_val_t(SNAPSHOT_ALIGN));
+    capacity_ = std::max(bytes, capacity_ * 2);
+    buffer_ = static_cast<unsigned char*>(::operator new(capacity_, std::align_val_t(SNAPSHOT_ALIGN)));
+}
+
+void EntityRegistry::saveSnapshot(Snapshot& snapshot) const {
+    snapshot.releaseCopies();
+
+    // Lay out every non-empty archetype as contiguous columns in one buffer
+    size_t offset = 0;
+    for (const auto& archetype : archetypes_) {
+        uint32_t count = archetype->size();
+        if (count == 0) continue;
+
+        Snapshot::ArchetypeState state;
+        state.archetype = archetype.get();
+        state.count = count;
+        state.entityOffset = offset;
+        offset += sizeof(EntityId) * count;
+        for (const ComponentInfo* info : archetype->getTypes()) {
+            size_t align = info->snapshotSize ? info->snapshotAlign : info->align;
+            offset = alignUp(offset, std::max(align, (size_t)16));
+            state.columnOffsets.push_back(offset);
+            offset += snapshotStride(*info) * count;
+        }
+        snapshot.archetypes_.push_back(std::move(state));
+    }
+    snapshot.reserve(offset);
+    snapshot.used_ = offset;
+
+    for (const Snapshot::ArchetypeState& state : snapshot.archetypes_) {
+        Archetype* archetype = state.archetype;
+        const auto& types = archetype->getTypes();
+        uint32_t capacity = archetype->getChunkCapacity();
+        for (size_t chunk = 0; chunk < archetype->getChunkCount(); ++chunk) {
+            uint32_t rows = archetype->getChunkRowCount(chunk);
+            if (rows == 0) break;
+            size_t firstRow = chunk * capacity;
+
+            std::memcpy(snapshot.buffer_ + state.entityOffset + sizeof(EntityId) * firstRow,
+                        archetype->getChunkEntities(chunk), sizeof(EntityId) * rows);
+            for (size_t c = 0; c < types.size(); ++c) {
+                const ComponentInfo* info = types[c];
+                unsigned char* src = static_cast<unsigned char*>(archetype->getChunkColumn(chunk, (int)c));
+                size_t stride = snapshotStride(*info);
+                unsigned char* dst = snapshot.buffer_ + state.columnOffsets[c] + stride * firstRow;
+                if (info->snapshotSize) {
+                    for (uint32_t r = 0; r < rows; ++r) {
+                        info->saveSnapshot(dst + stride * r, src + info->size * r);
+                    }
+                } else {
+                    assert(info->copyConstruct && "Component must be copyable or declare SnapshotData");
+                    for (uint32_t r = 0; r < rows; ++r) {
+                        info->copyConstruct(dst + stride * r, src + info->size * r);
+                    }
+                }
+            }
+        }
+    }
+
+    snapshot.records_ = records_;
+    snapshot.freeList_ = freeList_;
+}
+
+void EntityRegistry::restoreSnapshot(const Snapshot& snapshot) {
+    // Archetypes persist for the registry's lifetime, so the saved pointers are still valid
+    for (const auto& archetype : archetypes_) {
+        archetype->discardRows();
+    }
+
+    for (const Snapshot::ArchetypeState& state : snapshot.archetypes_) {
+        Archetype* archetype = state.archetype;
+        archetype->setRowCount(state.count);
+        const auto& types = archetype->getTypes();
+        uint32_t capacity = archetype->getChunkCapacity();
+        for (size_t chunk = 0; chunk < archetype->getChunkCount(); ++chunk) {
+            uint32_t rows = archetype->getChunkRowCount(chunk);
+            if (rows == 0) break;
+            size_t firstRow = chunk * capacity;
+
+            std::memcpy(archetype->getChunkEntities(chunk),
+                        snapshot.buffer_ + state.entityOffset + sizeof(EntityId) * firstRow,
+                        sizeof(EntityId) * rows);
+            for (size_t c = 0; c < types.size(); ++c) {
+                const ComponentInfo* info = types[c];
+                unsigned char* dst = static_cast<unsigned char*>(archetype->getChunkColumn(chunk, (int)c));
+                size_t stride = snapshotStride(*info);
+                const unsigned char* src = snapshot.buffer_ + state.columnOffsets[c] + stride * firstRow;
+                if (info->snapshotSize) {
+                    for (uint32_t r = 0; r < rows; ++r) {
+                        info->restoreSnapshot(dst + info->size * r, src + stride * r);
+                    }
+                } else {
+                    for (uint32_t r = 0; r < rows; ++r) {
+                        info->copyConstruct(dst + info->size * r, src + stride * r);
+                    }
+                }
+            }
+        }
+    }
+
+    // Generations only move forward: a slot touched since the save (its
+    // generation or liveness differs) gets a generation newer than both, so
+    // handles issued in between can't match what the slot holds afterwards.
+    // Untouched slots keep theirs, and so do the handles saved with them.
+    size_t saved = snapshot.records_.size();
+    if (records_.size() < saved) records_.resize(saved);
+    for (size_t i = 0; i < saved; ++i) {
+        const EntityRecord& before = snapshot.records_[i];
+        uint32_t current = records_[i].generation;
+        bool touched = current != before.generation ||
+                       (records_[i].archetype != nullptr) != (before.archetype != nullptr);
+        records_[i] = before;
+        if (touched) records_[i].generation = std::max(current, before.generation) + 1;
+    }
+    // Slots allocated since the save are freed rather than dropped, so their
+    // generations survive too
+    freeList_ = snapshot.freeList_;
+    for (size_t i = saved; i < records_.size(); ++i) {
+        EntityRecord& record = records_[i];
+        uint32_t generation = record.generation + (record.archetype ? 1 : 0);
+        record = EntityRecord();
+        record.generation = generation;
+        freeList_.push_back((EntityId)i);
+    }
+    bumpStructureVersions(~ComponentMask(0));
+}
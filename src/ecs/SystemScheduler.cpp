@@ -0,0 +1,116 @@
+#include "ecs/SystemScheduler.h"
+#include "JobSystem.h"
+
+namespace {
+    double millisecondsSince(std::chrono::steady_clock::time_point start) {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+}
+
+void SystemScheduler::run(Scene& scene, float deltaTime, JobSystem* jobs) {
+    frameStart_ = std::chrono::steady_clock::now();
+    buildGraph();
+
+    if (!jobs || jobs->getThreadCount() == 1) {
+        // Registration order is a valid topological order
+        for (size_t i = 0; i < nodes_.size(); ++i) runNode(i, scene, deltaTime);
+    } else {
+        // Launch the roots; each finished system launches the successors it unblocks
+        JobCounter frame;
+        for (size_t i = 0; i < nodes_.size(); ++i) {
+            if (predecessors_[i].empty()) launch(i, scene, deltaTime, *jobs, frame);
+        }
+        jobs->wait(frame);
+    }
+
+    frameMs_ = millisecondsSince(frameStart_);
+    findCriticalPath();
+}
+
+void SystemScheduler::buildGraph() {
+    nodes_.clear();
+    for (const auto& system : systems_) {
+        if (system->enabled) nodes_.push_back(system.get());
+    }
+
+    size_t count = nodes_.size();
+    successors_.resize(count);
+    predecessors_.resize(count);
+    for (size_t i = 0; i < count; ++i) {
+        successors_[i].clear();
+        predecessors_[i].clear();
+    }
+    // Earlier systems go first whenever two systems conflict
+    for (size_t j = 0; j < count; ++j) {
+        for (size_t i = 0; i < j; ++i) {
+            if (nodes_[i]->conflictsWith(*nodes_[j])) {
+                successors_[i].push_back(j);
+                predecessors_[j].push_back(i);
+            }
+        }
+    }
+
+    if (pendingCapacity_ < count) {
+        pending_.reset(new std::atomic<uint32_t>[count]);
+        pendingCapacity_ = count;
+    }
+    for (size_t i = 0; i < count; ++i) {
+        pending_[i].store((uint32_t)predecessors_[i].size(), std::memory_order_relaxed);
+    }
+
+    timings_.resize(count);
+    for (size_t i = 0; i < count; ++i) {
+        timings_[i] = { nodes_[i]->getName(), 0.0, 0.0, false };
+    }
+}
+
+void SystemScheduler::launch(size_t node, Scene& scene, float deltaTime, JobSystem& jobs, JobCounter& frame) {
+    auto job = [this, node, &scene, deltaTime, &jobs, &frame]() {
+        runNode(node, scene, deltaTime);
+        // Successors are launched before this job signals the frame counter,
+        // so the frame never reads as finished while work remains
+        for (size_t next : successors_[node]) {
+            if (pending_[next].fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                launch(next, scene, deltaTime, jobs, frame);
+            }
+        }
+    };
+    if (nodes_[node]->isMainThreadOnly()) {
+        jobs.runOnMainThread(job, &frame);
+    } else {
+        jobs.run(job, &frame);
+    }
+}
+
+void SystemScheduler::runNode(size_t node, Scene& scene, float deltaTime) {
+    double start = millisecondsSince(frameStart_);
+    nodes_[node]->update(scene, deltaTime);
+    timings_[node].startMs = start;
+    timings_[node].durationMs = millisecondsSince(frameStart_) - start;
+}
+
+void SystemScheduler::findCriticalPath() {
+    // Longest chain of measured durations through the graph. Nodes are in
+    // topological order, so one forward pass finds every chain's length.
+    size_t count = nodes_.size();
+    criticalPathMs_ = 0.0;
+    if (count == 0) return;
+
+    std::vector<double> finish(count);
+    std::vector<size_t> via(count, count);
+    size_t last = 0;
+    for (size_t j = 0; j < count; ++j) {
+        double begin = 0.0;
+        for (size_t i : predecessors_[j]) {
+            if (finish[i] > begin) {
+                begin = finish[i];
+                via[j] = i;
+            }
+        }
+        finish[j] = begin + timings_[j].durationMs;
+        if (finish[j] > finish[last]) last = j;
+    }
+
+    criticalPathMs_ = finish[last];
+    for (size_t n = last; n != count; n = via[n]) timings_[n].onCriticalPath = true;
+}
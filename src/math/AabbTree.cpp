@@ -0,0 +1,194 @@
+#include "math/AabbTree.h"
+#include <algorithm>
+
+int32_t AabbTree::allocateNode() {
+    int32_t index;
+    if (freeList_ != NULL_NODE) {
+        index = freeList_;
+        freeList_ = nodes_[index].parent;
+    } else {
+        index = (int32_t)nodes_.size();
+        nodes_.emplace_back();
+    }
+    Node& node = nodes_[index];
+    node.parent = node.child1 = node.child2 = NULL_NODE;
+    node.height = 0;
+    node.userData = 0;
+    return index;
+}
+
+void AabbTree::freeNode(int32_t node) {
+    nodes_[node].parent = freeList_;
+    nodes_[node].height = -1;
+    freeList_ = node;
+}
+
+void AabbTree::clear() {
+    nodes_.clear();
+    root_ = freeList_ = NULL_NODE;
+    proxyCount_ = 0;
+}
+
+int32_t AabbTree::createProxy(const Aabb& box, uint32_t userData) {
+    int32_t proxy = allocateNode();
+    nodes_[proxy].box = box.expanded(margin_);
+    nodes_[proxy].userData = userData;
+    insertLeaf(proxy);
+    ++proxyCount_;
+    return proxy;
+}
+
+void AabbTree::destroyProxy(int32_t proxy) {
+    removeLeaf(proxy);
+    freeNode(proxy);
+    --proxyCount_;
+}
+
+bool AabbTree::moveProxy(int32_t proxy, const Aabb& box) {
+    Node& leaf = nodes_[proxy];
+    if (leaf.box.contains(box)) return false;
+
+    // Still inside the parent's box: only the leaf needs the new fat box
+    Aabb fat = box.expanded(margin_);
+    if (leaf.parent != NULL_NODE && nodes_[leaf.parent].box.contains(fat)) {
+        leaf.box = fat;
+        return false;
+    }
+
+    removeLeaf(proxy);
+    nodes_[proxy].box = fat;
+    insertLeaf(proxy);
+    return true;
+}
+
+void AabbTree::insertLeaf(int32_t leaf) {
+    if (root_ == NULL_NODE) {
+        root_ = leaf;
+        nodes_[leaf].parent = NULL_NODE;
+        return;
+    }
+
+    // Descend towards the sibling with the lowest total area increase: the
+    // cost of pairing with a node is its merged area, plus the growth every
+    // ancestor on the way has to absorb
+    Aabb leafBox = nodes_[leaf].box;
+    int32_t index = root_;
+    while (!nodes_[index].isLeaf()) {
+        const Node& node = nodes_[index];
+        float area = node.box.area();
+        float combinedArea = merge(node.box, leafBox).area();
+        float cost = 2.0f * combinedArea;
+        float inheritance = 2.0f * (combinedArea - area);
+
+        auto descendCost = [&](int32_t child) {
+            const Aabb& box = nodes_[child].box;
+            float merged = merge(box, leafBox).area();
+            return (nodes_[child].isLeaf() ? merged : merged - box.area()) + inheritance;
+        };
+        float cost1 = descendCost(node.child1);
+        float cost2 = descendCost(node.child2);
+        if (cost < cost1 && cost < cost2) break;
+        index = cost1 < cost2 ? node.child1 : node.child2;
+    }
+
+    int32_t sibling = index;
+    int32_t oldParent = nodes_[sibling].parent;
+    int32_t newParent = allocateNode();
+    Node& parent = nodes_[newParent];
+    parent.parent = oldParent;
+    parent.box = merge(leafBox, nodes_[sibling].box);
+    parent.height = nodes_[sibling].height + 1;
+    parent.child1 = sibling;
+    parent.child2 = leaf;
+    if (oldParent != NULL_NODE) {
+        if (nodes_[oldParent].child1 == sibling) nodes_[oldParent].child1 = newParent;
+        else nodes_[oldParent].child2 = newParent;
+    } else {
+        root_ = newParent;
+    }
+    nodes_[sibling].parent = newParent;
+    nodes_[leaf].parent = newParent;
+
+    refitUp(nodes_[leaf].parent);
+}
+
+void AabbTree::removeLeaf(int32_t leaf) {
+    if (leaf == root_) {
+        root_ = NULL_NODE;
+        return;
+    }
+
+    // The parent goes and the sibling takes its place
+    int32_t parent = nodes_[leaf].parent;
+    int32_t grandParent = nodes_[parent].parent;
+    int32_t sibling = nodes_[parent].child1 == leaf ? nodes_[parent].child2 : nodes_[parent].child1;
+    freeNode(parent);
+    if (grandParent == NULL_NODE) {
+        root_ = sibling;
+        nodes_[sibling].parent = NULL_NODE;
+        return;
+    }
+    if (nodes_[grandParent].child1 == parent) nodes_[grandParent].child1 = sibling;
+    else nodes_[grandParent].child2 = sibling;
+    nodes_[sibling].parent = grandParent;
+    refitUp(grandParent);
+}
+
+void AabbTree::refitUp(int32_t index) {
+    while (index != NULL_NODE) {
+        index = balance(index);
+        Node& node = nodes_[index];
+        const Node& child1 = nodes_[node.child1];
+        const Node& child2 = nodes_[node.child2];
+        node.height = 1 + std::max(child1.height, child2.height);
+        node.box = merge(child1.box, child2.box);
+        index = node.parent;
+    }
+}
+
+int32_t AabbTree::balance(int32_t iA) {
+    Node* a = &nodes_[iA];
+    if (a->isLeaf() || a->height < 2) return iA;
+
+    int32_t iB = a->child1, iC = a->child2;
+    Node* b = &nodes_[iB];
+    Node* c = &nodes_[iC];
+    int32_t difference = c->height - b->height;
+    if (difference >= -1 && difference <= 1) return iA;
+
+    // Rotate the taller child (up) above a. Of its children, the taller
+    // stays with it and the other replaces it under a.
+    bool rotateC = difference > 1;
+    int32_t iUp = rotateC ? iC : iB;
+    Node* up = rotateC ? c : b;
+    Node* other = rotateC ? b : c;
+    int32_t iF = up->child1, iG = up->child2;
+    Node* f = &nodes_[iF];
+    Node* g = &nodes_[iG];
+
+    up->child1 = iA;
+    up->parent = a->parent;
+    a->parent = iUp;
+    if (up->parent != NULL_NODE) {
+        Node& parent = nodes_[up->parent];
+        if (parent.child1 == iA) parent.child1 = iUp;
+        else parent.child2 = iUp;
+    } else {
+        root_ = iUp;
+    }
+
+    if (f->height < g->height) {
+        std::swap(iF, iG);
+        std::swap(f, g);
+    }
+    // f is the taller grandchild and stays under up; g moves under a
+    up->child2 = iF;
+    if (rotateC) a->child2 = iG;
+    else a->child1 = iG;
+    g->parent = iA;
+    a->box = merge(other->box, g->box);
+    a->height = 1 + std::max(other->height, g->height);
+    up->box = merge(a->box, f->box);
+    up->height = 1 + std::max(a->height, f->height);
+    return iUp;
+}
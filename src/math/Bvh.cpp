@@ -0,0 +1,191 @@
+#include "math/Bvh.h"
+#include "math/Bounds.h"
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+namespace {
+    // Cost of visiting a node relative to testing one triangle
+    constexpr float TRAVERSAL_COST = 1.0f;
+    // Below this depth nodes are split by SAH; past it the triangle range is
+    // halved, which bounds the depth (and the traversal stack) at MAX_DEPTH
+    constexpr uint32_t SAH_DEPTH = 32;
+    constexpr uint32_t MAX_DEPTH = 64;
+
+    struct Bin {
+        Aabb bounds;
+        uint32_t count = 0;
+    };
+
+    struct PendingNode {
+        uint32_t index;
+        uint32_t depth;
+    };
+
+    // Distance along the ray to where it enters the node's box, or INFINITY if it misses
+    inline float entryDistance(const Bvh::Node& node, const Vec3& origin, const Vec3& invDir) {
+        float t1 = (node.boundsMin[0] - origin.x) * invDir.x, t2 = (node.boundsMax[0] - origin.x) * invDir.x;
+        float tmin = std::min(t1, t2), tmax = std::max(t1, t2);
+        t1 = (node.boundsMin[1] - origin.y) * invDir.y; t2 = (node.boundsMax[1] - origin.y) * invDir.y;
+        tmin = std::max(tmin, std::min(t1, t2)); tmax = std::min(tmax, std::max(t1, t2));
+        t1 = (node.boundsMin[2] - origin.z) * invDir.z; t2 = (node.boundsMax[2] - origin.z) * invDir.z;
+        tmin = std::max(tmin, std::min(t1, t2)); tmax = std::min(tmax, std::max(t1, t2));
+        return tmax >= tmin && tmax > 0.0f ? tmin : INFINITY;
+    }
+}
+
+void Bvh::build(const Vec3* vertices, size_t vertexCount) {
+    nodes_.clear();
+    triangles_.clear();
+    triangleIds_.clear();
+    uint32_t count = (uint32_t)(vertexCount / 3);
+    if (count == 0) return;
+
+    std::vector<Aabb> triangleBounds(count);
+    std::vector<Vec3> centroids(count);
+    for (uint32_t i = 0; i < count; ++i) {
+        const Vec3* v = vertices + i * 3;
+        triangleBounds[i].grow(v[0]);
+        triangleBounds[i].grow(v[1]);
+        triangleBounds[i].grow(v[2]);
+        centroids[i] = (v[0] + v[1] + v[2]) * (1.0f / 3.0f);
+    }
+    std::vector<uint32_t> ids(count);
+    std::iota(ids.begin(), ids.end(), 0u);
+
+    nodes_.reserve(2 * (size_t)count - 1);
+    nodes_.push_back(Node{ {}, 0, {}, count });
+    std::vector<PendingNode> pending{ { 0, 1 } };
+    while (!pending.empty()) {
+        PendingNode current = pending.back();
+        pending.pop_back();
+        uint32_t first = nodes_[current.index].first, n = nodes_[current.index].count;
+
+        Aabb bounds, centroidBounds;
+        for (uint32_t k = first; k < first + n; ++k) {
+            bounds.grow(triangleBounds[ids[k]]);
+            centroidBounds.grow(centroids[ids[k]]);
+        }
+        for (int a = 0; a < 3; ++a) {
+            nodes_[current.index].boundsMin[a] = bounds.min[a];
+            nodes_[current.index].boundsMax[a] = bounds.max[a];
+        }
+        if (n == 1) continue;
+
+        // Cheapest split over the centroid bins of each axis, in units of one
+        // triangle test scaled by this node's area. Nodes too big for a leaf
+        // must split even if the leaf would be cheaper.
+        float bestCost = n <= MAX_LEAF_TRIANGLES ? (float)n * bounds.area() : INFINITY;
+        int bestAxis = -1, bestSplit = 0;
+        if (current.depth < SAH_DEPTH) {
+            for (int axis = 0; axis < 3; ++axis) {
+                float lo = centroidBounds.min[axis], extent = centroidBounds.max[axis] - lo;
+                if (extent <= 0.0f) continue;
+                float scale = BINS / extent;
+
+                Bin bins[BINS];
+                for (uint32_t k = first; k < first + n; ++k) {
+                    int b = std::min(BINS - 1, (int)((centroids[ids[k]][axis] - lo) * scale));
+                    bins[b].count++;
+                    bins[b].bounds.grow(triangleBounds[ids[k]]);
+                }
+
+                // Sweep from the left recording each prefix, then from the right
+                float leftArea[BINS - 1];
+                uint32_t leftCount[BINS - 1];
+                Aabb sweep;
+                uint32_t sum = 0;
+                for (int b = 0; b < BINS - 1; ++b) {
+                    sweep.grow(bins[b].bounds);
+                    sum += bins[b].count;
+                    leftArea[b] = sweep.area();
+                    leftCount[b] = sum;
+                }
+                sweep = Aabb();
+                sum = 0;
+                for (int b = BINS - 1; b > 0; --b) {
+                    sweep.grow(bins[b].bounds);
+                    sum += bins[b].count;
+                    if (sum == 0 || leftCount[b - 1] == 0) continue;
+                    float cost = TRAVERSAL_COST * bounds.area()
+                               + (float)leftCount[b - 1] * leftArea[b - 1] + (float)sum * sweep.area();
+                    if (cost < bestCost) {
+                        bestCost = cost;
+                        bestAxis = axis;
+                        bestSplit = b;
+                    }
+                }
+            }
+        }
+
+        uint32_t mid;
+        if (bestAxis >= 0) {
+            float lo = centroidBounds.min[bestAxis];
+            float scale = BINS / (centroidBounds.max[bestAxis] - lo);
+            uint32_t* split = std::partition(ids.data() + first, ids.data() + first + n, [&](uint32_t id) {
+                return std::min(BINS - 1, (int)((centroids[id][bestAxis] - lo) * scale)) < bestSplit;
+            });
+            mid = (uint32_t)(split - ids.data());
+        } else if (n > MAX_LEAF_TRIANGLES) {
+            // Centroids coincide (or the SAH depth is used up): halve the range
+            mid = first + n / 2;
+        } else {
+            continue; // A leaf is cheapest
+        }
+
+        uint32_t left = (uint32_t)nodes_.size();
+        nodes_.push_back(Node{ {}, first, {}, mid - first });
+        nodes_.push_back(Node{ {}, mid, {}, first + n - mid });
+        nodes_[current.index].first = left;
+        nodes_[current.index].count = 0;
+        pending.push_back({ left, current.depth + 1 });
+        pending.push_back({ left + 1, current.depth + 1 });
+    }
+
+    triangles_.reserve(count);
+    for (uint32_t id : ids) triangles_.add(vertices[id * 3], vertices[id * 3 + 1], vertices[id * 3 + 2]);
+    triangleIds_ = std::move(ids);
+}
+
+bool Bvh::raycast(const Ray& ray, RayHit& hit) const {
+    if (nodes_.empty()) return false;
+    Vec3 invDir(1.0f / ray.direction.x, 1.0f / ray.direction.y, 1.0f / ray.direction.z);
+    if (!(entryDistance(nodes_[0], ray.origin, invDir) < hit.t)) return false;
+
+    // Far children wait here with their entry distance, skipped if a nearer hit turns up
+    uint32_t stack[MAX_DEPTH];
+    float stackEntry[MAX_DEPTH];
+    int top = 0;
+    uint32_t index = 0;
+    bool found = false;
+    for (;;) {
+        const Node& node = nodes_[index];
+        if (node.count > 0) {
+            found |= ::raycast(ray, triangles_, node.first, node.first + node.count, hit);
+        } else {
+            // Visit the nearer child first
+            uint32_t nearChild = node.first, farChild = node.first + 1;
+            float nearT = entryDistance(nodes_[nearChild], ray.origin, invDir);
+            float farT = entryDistance(nodes_[farChild], ray.origin, invDir);
+            if (farT < nearT) {
+                std::swap(nearChild, farChild);
+                std::swap(nearT, farT);
+            }
+            if (nearT < hit.t) {
+                if (farT < hit.t) {
+                    stack[top] = farChild;
+                    stackEntry[top++] = farT;
+                }
+                index = nearChild;
+                continue;
+            }
+        }
+
+        while (top > 0 && !(stackEntry[top - 1] < hit.t)) --top;
+        if (top == 0) break;
+        index = stack[--top];
+    }
+
+    if (found) hit.triangle = triangleIds_[hit.triangle];
+    return found;
+}
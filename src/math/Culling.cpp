@@ -0,0 +1,165 @@
+#include "math/Culling.h"
+#include "math/Simd.h"
+#include <cmath>
+
+#ifdef MATH_AVX2
+#include <immintrin.h>
+#endif
+
+// Each object is outside once its centre lies farther than its radius (or
+// its box's projected radius) behind any plane. Indices are compacted without
+// branches: every lane writes its index, and the count only advances over
+// the visible ones, so later lanes overwrite the rest.
+
+namespace {
+    template<bool BOXES>
+    size_t cullScalar(const Frustum& frustum, const BoundsSoA& b, size_t begin, size_t end, uint32_t* visible) {
+        size_t n = 0;
+        for (size_t i = begin; i < end; ++i) {
+            bool outside = false;
+            for (const Plane& plane : frustum.planes) {
+                float d = plane.normal.x * b.centerX[i] + plane.normal.y * b.centerY[i]
+                        + plane.normal.z * b.centerZ[i] + plane.distance;
+                float r = BOXES ? std::fabs(plane.normal.x) * b.extentX[i] + std::fabs(plane.normal.y) * b.extentY[i]
+                                  + std::fabs(plane.normal.z) * b.extentZ[i]
+                                : b.radius[i];
+                outside |= d + r < 0.0f;
+            }
+            visible[n] = (uint32_t)i;
+            n += outside ? 0 : 1;
+        }
+        return n;
+    }
+
+#ifdef MATH_SSE2
+    template<bool BOXES>
+    size_t cullSSE(const Frustum& frustum, const BoundsSoA& b, size_t begin, size_t end, uint32_t* visible) {
+        const __m128 zero = _mm_setzero_ps();
+        size_t n = 0, i = begin;
+        for (; i + 4 <= end; i += 4) {
+            const __m128 cx = _mm_loadu_ps(&b.centerX[i]), cy = _mm_loadu_ps(&b.centerY[i]), cz = _mm_loadu_ps(&b.centerZ[i]);
+            __m128 ex = zero, ey = zero, ez = zero, radius = zero;
+            if (BOXES) {
+                ex = _mm_loadu_ps(&b.extentX[i]); ey = _mm_loadu_ps(&b.extentY[i]); ez = _mm_loadu_ps(&b.extentZ[i]);
+            } else {
+                radius = _mm_loadu_ps(&b.radius[i]);
+            }
+
+            __m128 outside = zero;
+            for (const Plane& plane : frustum.planes) {
+                __m128 d = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(plane.normal.x), cx), _mm_mul_ps(_mm_set1_ps(plane.normal.y), cy)),
+                                      _mm_add_ps(_mm_mul_ps(_mm_set1_ps(plane.normal.z), cz), _mm_set1_ps(plane.distance)));
+                __m128 r = radius;
+                if (BOXES) {
+                    r = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(std::fabs(plane.normal.x)), ex),
+                                              _mm_mul_ps(_mm_set1_ps(std::fabs(plane.normal.y)), ey)),
+                                   _mm_mul_ps(_mm_set1_ps(std::fabs(plane.normal.z)), ez));
+                }
+                outside = _mm_or_ps(outside, _mm_cmplt_ps(_mm_add_ps(d, r), zero));
+            }
+
+            int mask = ~_mm_movemask_ps(outside);
+            for (int l = 0; l < 4; ++l) {
+                visible[n] = (uint32_t)(i + l);
+                n += (mask >> l) & 1;
+            }
+        }
+        return n + cullScalar<BOXES>(frustum, b, i, end, visible + n);
+    }
+#endif
+
+#ifdef MATH_AVX2
+    template<bool BOXES>
+    MATH_TARGET_AVX2 size_t cullAVX2(const Frustum& frustum, const BoundsSoA& b, size_t begin, size_t end, uint32_t* visible) {
+        // Plane coefficients stay in registers across the whole range
+        __m256 nx[Frustum::PLANE_COUNT], ny[Frustum::PLANE_COUNT], nz[Frustum::PLANE_COUNT], nd[Frustum::PLANE_COUNT];
+        __m256 ax[Frustum::PLANE_COUNT], ay[Frustum::PLANE_COUNT], az[Frustum::PLANE_COUNT];
+        for (int p = 0; p < Frustum::PLANE_COUNT; ++p) {
+            const Plane& plane = frustum.planes[p];
+            nx[p] = _mm256_set1_ps(plane.normal.x); ny[p] = _mm256_set1_ps(plane.normal.y);
+            nz[p] = _mm256_set1_ps(plane.normal.z); nd[p] = _mm256_set1_ps(plane.distance);
+            ax[p] = _mm256_set1_ps(std::fabs(plane.normal.x)); ay[p] = _mm256_set1_ps(std::fabs(plane.normal.y));
+            az[p] = _mm256_set1_ps(std::fabs(plane.normal.z));
+        }
+
+        const __m256 zero = _mm256_setzero_ps();
+        size_t n = 0, i = begin;
+        for (; i + 8 <= end; i += 8) {
+            const __m256 cx = _mm256_loadu_ps(&b.centerX[i]), cy = _mm256_loadu_ps(&b.centerY[i]);
+            const __m256 cz = _mm256_loadu_ps(&b.centerZ[i]);
+            __m256 ex = zero, ey = zero, ez = zero, radius = zero;
+            if (BOXES) {
+                ex = _mm256_loadu_ps(&b.extentX[i]); ey = _mm256_loadu_ps(&b.extentY[i]); ez = _mm256_loadu_ps(&b.extentZ[i]);
+            } else {
+                radius = _mm256_loadu_ps(&b.radius[i]);
+            }
+
+            __m256 outside = zero;
+            for (int p = 0; p < Frustum::PLANE_COUNT; ++p) {
+                __m256 d = _mm256_fmadd_ps(nx[p], cx, _mm256_fmadd_ps(ny[p], cy, _mm256_fmadd_ps(nz[p], cz, nd[p])));
+                __m256 r = BOXES ? _mm256_fmadd_ps(ax[p], ex, _mm256_fmadd_ps(ay[p], ey, _mm256_mul_ps(az[p], ez))) : radius;
+                outside = _mm256_or_ps(outside, _mm256_cmp_ps(_mm256_add_ps(d, r), zero, _CMP_LT_OQ));
+            }
+
+            int mask = ~_mm256_movemask_ps(outside);
+            for (int l = 0; l < 8; ++l) {
+                visible[n] = (uint32_t)(i + l);
+                n += (mask >> l) & 1;
+            }
+        }
+        return n + cullScalar<BOXES>(frustum, b, i, end, visible + n);
+    }
+#endif
+
+    template<bool BOXES>
+    size_t cull(const Frustum& frustum, const BoundsSoA& bounds, size_t begin, size_t end, uint32_t* visible) {
+        if (end > bounds.size()) end = bounds.size();
+        if (begin >= end) return 0;
+        switch (getSimdLevel()) {
+#ifdef MATH_AVX2
+        case SimdLevel::AVX2: return cullAVX2<BOXES>(frustum, bounds, begin, end, visible);
+#endif
+#ifdef MATH_SSE2
+        case SimdLevel::SSE2: return cullSSE<BOXES>(frustum, bounds, begin, end, visible);
+#endif
+        default: return cullScalar<BOXES>(frustum, bounds, begin, end, visible);
+        }
+    }
+}
+
+void BoundsSoA::clear() {
+    for (std::vector<float>* v : { &centerX, &centerY, &centerZ, &extentX, &extentY, &extentZ, &radius }) v->clear();
+}
+
+void BoundsSoA::reserve(size_t count) {
+    for (std::vector<float>* v : { &centerX, &centerY, &centerZ, &extentX, &extentY, &extentZ, &radius }) v->reserve(count);
+}
+
+void BoundsSoA::add(const Aabb& box, float sphereRadius) {
+    Vec3 center = box.center(), extents = box.extents();
+    centerX.push_back(center.x); centerY.push_back(center.y); centerZ.push_back(center.z);
+    extentX.push_back(extents.x); extentY.push_back(extents.y); extentZ.push_back(extents.z);
+    radius.push_back(box.empty() ? -1e30f : sphereRadius);
+}
+
+void BoundsSoA::set(size_t index, const Aabb& box, float sphereRadius) {
+    Vec3 center = box.center(), extents = box.extents();
+    centerX[index] = center.x; centerY[index] = center.y; centerZ[index] = center.z;
+    extentX[index] = extents.x; extentY[index] = extents.y; extentZ[index] = extents.z;
+    radius[index] = box.empty() ? -1e30f : sphereRadius;
+}
+
+void BoundsSoA::remove(size_t index) {
+    for (std::vector<float>* v : { &centerX, &centerY, &centerZ, &extentX, &extentY, &extentZ, &radius }) {
+        (*v)[index] = v->back();
+        v->pop_back();
+    }
+}
+
+size_t cullSpheres(const Frustum& frustum, const BoundsSoA& bounds, size_t begin, size_t end, uint32_t* visible) {
+    return cull<false>(frustum, bounds, begin, end, visible);
+}
+
+size_t cullBoxes(const Frustum& frustum, const BoundsSoA& bounds, size_t begin, size_t end, uint32_t* visible) {
+    return cull<true>(frustum, bounds, begin, end, visible);
+}
@@ -0,0 +1,412 @@
+#include "math/Mat4.h"
+
+#ifdef MATH_AVX2
+#include <immintrin.h>
+#endif
+
+namespace {
+    constexpr float SINGULAR_EPSILON = 1e-6f;
+    // Largest deviation from orthonormal columns classify() still calls rigid
+    constexpr float RIGID_EPSILON = 1e-5f;
+
+    // [A t]^-1 = [A^-1  -A^-1 t], given the rows of A^-1
+    void storeAffineInverse(const Vec3& r0, const Vec3& r1, const Vec3& r2, const float* m, float* out) {
+        Vec3 t(m[12], m[13], m[14]);
+        out[0] = r0.x; out[1] = r1.x; out[2] = r2.x; out[3] = 0.0f;
+        out[4] = r0.y; out[5] = r1.y; out[6] = r2.y; out[7] = 0.0f;
+        out[8] = r0.z; out[9] = r1.z; out[10] = r2.z; out[11] = 0.0f;
+        out[12] = -dot(r0, t); out[13] = -dot(r1, t); out[14] = -dot(r2, t); out[15] = 1.0f;
+    }
+
+    // Rows of the inverse 3x3 are cross products of its columns over the determinant
+    bool inverseAffineScalar(const float* m, float* out) {
+        Vec3 c0(m[0], m[1], m[2]), c1(m[4], m[5], m[6]), c2(m[8], m[9], m[10]);
+        Vec3 r0 = cross(c1, c2), r1 = cross(c2, c0), r2 = cross(c0, c1);
+        float det = dot(c0, r0);
+        if (std::fabs(det) < SINGULAR_EPSILON) return false;
+
+        float invDet = 1.0f / det;
+        storeAffineInverse(r0 * invDet, r1 * invDet, r2 * invDet, m, out);
+        return true;
+    }
+
+    // Orthonormal 3x3: the inverse is the transpose, whose rows are the columns
+    void inverseRigidScalar(const float* m, float* out) {
+        storeAffineInverse(Vec3(m[0], m[1], m[2]), Vec3(m[4], m[5], m[6]), Vec3(m[8], m[9], m[10]), m, out);
+    }
+
+    // Cofactors from the twelve 2x2 determinants of the top and bottom two
+    // rows (scalar builds and SimdLevel::Scalar). Like inverseSSE, written
+    // row-major; on column-major data it yields the same layout.
+    bool inverseScalar(const float* m, float* out) {
+        float s0 = m[0] * m[5] - m[4] * m[1];
+        float s1 = m[0] * m[6] - m[4] * m[2];
+        float s2 = m[0] * m[7] - m[4] * m[3];
+        float s3 = m[1] * m[6] - m[5] * m[2];
+        float s4 = m[1] * m[7] - m[5] * m[3];
+        float s5 = m[2] * m[7] - m[6] * m[3];
+        float c5 = m[10] * m[15] - m[14] * m[11];
+        float c4 = m[9] * m[15] - m[13] * m[11];
+        float c3 = m[9] * m[14] - m[13] * m[10];
+        float c2 = m[8] * m[15] - m[12] * m[11];
+        float c1 = m[8] * m[14] - m[12] * m[10];
+        float c0 = m[8] * m[13] - m[12] * m[9];
+
+        float det = s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0;
+        if (std::fabs(det) < SINGULAR_EPSILON) return false;
+
+        float invDet = 1.0f / det;
+        out[0] = (m[5] * c5 - m[6] * c4 + m[7] * c3) * invDet;
+        out[1] = (-m[1] * c5 + m[2] * c4 - m[3] * c3) * invDet;
+        out[2] = (m[13] * s5 - m[14] * s4 + m[15] * s3) * invDet;
+        out[3] = (-m[9] * s5 + m[10] * s4 - m[11] * s3) * invDet;
+        out[4] = (-m[4] * c5 + m[6] * c2 - m[7] * c1) * invDet;
+        out[5] = (m[0] * c5 - m[2] * c2 + m[3] * c1) * invDet;
+        out[6] = (-m[12] * s5 + m[14] * s2 - m[15] * s1) * invDet;
+        out[7] = (m[8] * s5 - m[10] * s2 + m[11] * s1) * invDet;
+        out[8] = (m[4] * c4 - m[5] * c2 + m[7] * c0) * invDet;
+        out[9] = (-m[0] * c4 + m[1] * c2 - m[3] * c0) * invDet;
+        out[10] = (m[12] * s4 - m[13] * s2 + m[15] * s0) * invDet;
+        out[11] = (-m[8] * s4 + m[9] * s2 - m[11] * s0) * invDet;
+        out[12] = (-m[4] * c3 + m[5] * c1 - m[6] * c0) * invDet;
+        out[13] = (m[0] * c3 - m[1] * c1 + m[2] * c0) * invDet;
+        out[14] = (-m[12] * s3 + m[13] * s1 - m[14] * s0) * invDet;
+        out[15] = (m[8] * s3 - m[9] * s1 + m[10] * s0) * invDet;
+        return true;
+    }
+
+#ifdef MATH_SSE2
+#define MATH_SHUFFLE(a, b, x, y, z, w) _mm_shuffle_ps(a, b, _MM_SHUFFLE(w, z, y, x))
+#define MATH_SWIZZLE(v, x, y, z, w) _mm_shuffle_ps(v, v, _MM_SHUFFLE(w, z, y, x))
+
+    // 2x2 blocks packed as (m00, m01, m10, m11)
+    // A * B
+    inline __m128 mat2Mul(__m128 a, __m128 b) {
+        return _mm_add_ps(_mm_mul_ps(a, MATH_SWIZZLE(b, 0, 3, 0, 3)),
+                          _mm_mul_ps(MATH_SWIZZLE(a, 1, 0, 3, 2), MATH_SWIZZLE(b, 2, 1, 2, 1)));
+    }
+    // adj(A) * B
+    inline __m128 mat2AdjMul(__m128 a, __m128 b) {
+        return _mm_sub_ps(_mm_mul_ps(MATH_SWIZZLE(a, 3, 3, 0, 0), b),
+                          _mm_mul_ps(MATH_SWIZZLE(a, 1, 1, 2, 2), MATH_SWIZZLE(b, 2, 3, 0, 1)));
+    }
+    // A * adj(B)
+    inline __m128 mat2MulAdj(__m128 a, __m128 b) {
+        return _mm_sub_ps(_mm_mul_ps(a, MATH_SWIZZLE(b, 3, 0, 3, 0)),
+                          _mm_mul_ps(MATH_SWIZZLE(a, 1, 0, 3, 2), MATH_SWIZZLE(b, 2, 1, 2, 1)));
+    }
+
+    // Block-wise inverse: the matrix is split into four 2x2 blocks
+    // [A B; C D] that each fit one register. The algorithm is written for
+    // row-major data; on column-major data it inverts the transpose, and
+    // the transpose of that inverse is the inverse we want, in the same layout.
+    bool inverseSSE(const float* m, float* out) {
+        __m128 r0 = _mm_load_ps(m + 0), r1 = _mm_load_ps(m + 4);
+        __m128 r2 = _mm_load_ps(m + 8), r3 = _mm_load_ps(m + 12);
+
+        __m128 A = _mm_movelh_ps(r0, r1);
+        __m128 B = _mm_movehl_ps(r1, r0);
+        __m128 C = _mm_movelh_ps(r2, r3);
+        __m128 D = _mm_movehl_ps(r3, r2);
+
+        // (|A|, |B|, |C|, |D|)
+        __m128 detSub = _mm_sub_ps(
+            _mm_mul_ps(MATH_SHUFFLE(r0, r2, 0, 2, 0, 2), MATH_SHUFFLE(r1, r3, 1, 3, 1, 3)),
+            _mm_mul_ps(MATH_SHUFFLE(r0, r2, 1, 3, 1, 3), MATH_SHUFFLE(r1, r3, 0, 2, 0, 2)));
+        __m128 detA = MATH_SWIZZLE(detSub, 0, 0, 0, 0);
+        __m128 detB = MATH_SWIZZLE(detSub, 1, 1, 1, 1);
+        __m128 detC = MATH_SWIZZLE(detSub, 2, 2, 2, 2);
+        __m128 detD = MATH_SWIZZLE(detSub, 3, 3, 3, 3);
+
+        __m128 DC = mat2AdjMul(D, C);
+        __m128 AB = mat2AdjMul(A, B);
+        __m128 X = _mm_sub_ps(_mm_mul_ps(detD, A), mat2Mul(B, DC));
+        __m128 W = _mm_sub_ps(_mm_mul_ps(detA, D), mat2Mul(C, AB));
+        __m128 Y = _mm_sub_ps(_mm_mul_ps(detB, C), mat2MulAdj(D, AB));
+        __m128 Z = _mm_sub_ps(_mm_mul_ps(detC, B), mat2MulAdj(A, DC));
+
+        // |M| = |A||D| + |B||C| - tr(adj(A)B adj(D)C)
+        __m128 tr = _mm_mul_ps(AB, MATH_SWIZZLE(DC, 0, 2, 1, 3));
+        tr = _mm_add_ps(tr, MATH_SWIZZLE(tr, 1, 0, 3, 2));
+        tr = _mm_add_ps(tr, MATH_SWIZZLE(tr, 2, 3, 0, 1));
+        __m128 detM = _mm_sub_ps(_mm_add_ps(_mm_mul_ps(detA, detD), _mm_mul_ps(detB, detC)), tr);
+        if (std::fabs(_mm_cvtss_f32(detM)) < SINGULAR_EPSILON) return false;
+
+        __m128 rDetM = _mm_div_ps(_mm_setr_ps(1.0f, -1.0f, -1.0f, 1.0f), detM);
+        X = _mm_mul_ps(X, rDetM);
+        Y = _mm_mul_ps(Y, rDetM);
+        Z = _mm_mul_ps(Z, rDetM);
+        W = _mm_mul_ps(W, rDetM);
+
+        // Undo the adjugate layout while storing
+        _mm_store_ps(out + 0, MATH_SHUFFLE(X, Y, 3, 1, 3, 1));
+        _mm_store_ps(out + 4, MATH_SHUFFLE(X, Y, 2, 0, 2, 0));
+        _mm_store_ps(out + 8, MATH_SHUFFLE(Z, W, 3, 1, 3, 1));
+        _mm_store_ps(out + 12, MATH_SHUFFLE(Z, W, 2, 0, 2, 0));
+        return true;
+    }
+
+    // a x b in x, y, z; w is 0 when both inputs have finite w
+    inline __m128 cross3(__m128 a, __m128 b) {
+        __m128 r = _mm_sub_ps(_mm_mul_ps(a, MATH_SWIZZLE(b, 1, 2, 0, 3)), _mm_mul_ps(MATH_SWIZZLE(a, 1, 2, 0, 3), b));
+        return MATH_SWIZZLE(r, 1, 2, 0, 3);
+    }
+
+    // Upper 3x3 columns with w cleared
+    inline void loadAffineColumns(const float* m, __m128& c0, __m128& c1, __m128& c2) {
+        const __m128 xyz = _mm_castsi128_ps(_mm_setr_epi32(-1, -1, -1, 0));
+        c0 = _mm_and_ps(_mm_load_ps(m + 0), xyz);
+        c1 = _mm_and_ps(_mm_load_ps(m + 4), xyz);
+        c2 = _mm_and_ps(_mm_load_ps(m + 8), xyz);
+    }
+
+    // Same as storeAffineInverse; rows have w = 0 and become the columns
+    inline void storeAffineInverseSSE(__m128 r0, __m128 r1, __m128 r2, const float* m, float* out) {
+        __m128 r3 = _mm_setr_ps(0.0f, 0.0f, 0.0f, 1.0f);
+        _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+        __m128 t = _mm_add_ps(_mm_mul_ps(r0, _mm_set1_ps(m[12])), _mm_mul_ps(r1, _mm_set1_ps(m[13])));
+        t = _mm_add_ps(t, _mm_mul_ps(r2, _mm_set1_ps(m[14])));
+        _mm_store_ps(out + 0, r0);
+        _mm_store_ps(out + 4, r1);
+        _mm_store_ps(out + 8, r2);
+        _mm_store_ps(out + 12, _mm_sub_ps(r3, t));
+    }
+
+    bool inverseAffineSSE(const float* m, float* out) {
+        __m128 c0, c1, c2;
+        loadAffineColumns(m, c0, c1, c2);
+        __m128 r0 = cross3(c1, c2), r1 = cross3(c2, c0), r2 = cross3(c0, c1);
+
+        __m128 det = _mm_mul_ps(c0, r0);
+        det = _mm_add_ps(det, MATH_SWIZZLE(det, 1, 0, 3, 2));
+        det = _mm_add_ps(det, MATH_SWIZZLE(det, 2, 3, 0, 1));
+        if (std::fabs(_mm_cvtss_f32(det)) < SINGULAR_EPSILON) return false;
+
+        __m128 invDet = _mm_div_ps(_mm_set1_ps(1.0f), det);
+        storeAffineInverseSSE(_mm_mul_ps(r0, invDet), _mm_mul_ps(r1, invDet), _mm_mul_ps(r2, invDet), m, out);
+        return true;
+    }
+
+    void inverseRigidSSE(const float* m, float* out) {
+        __m128 c0, c1, c2;
+        loadAffineColumns(m, c0, c1, c2);
+        storeAffineInverseSSE(c0, c1, c2, m, out);
+    }
+
+#undef MATH_SHUFFLE
+#undef MATH_SWIZZLE
+
+    // Both inputs are loaded before anything is stored, so out may alias
+    // them, and no temporary Mat4 is copied
+    void multiplySSE(const Mat4* a, const Mat4* b, Mat4* out, size_t count) {
+        for (size_t i = 0; i < count; ++i) {
+            __m128 a0 = _mm_load_ps(a[i].m + 0), a1 = _mm_load_ps(a[i].m + 4);
+            __m128 a2 = _mm_load_ps(a[i].m + 8), a3 = _mm_load_ps(a[i].m + 12);
+            __m128 b0 = _mm_load_ps(b[i].m + 0), b1 = _mm_load_ps(b[i].m + 4);
+            __m128 b2 = _mm_load_ps(b[i].m + 8), b3 = _mm_load_ps(b[i].m + 12);
+            __m128 bc[4] = { b0, b1, b2, b3 };
+            for (int c = 0; c < 4; ++c) {
+                __m128 col = _mm_mul_ps(a0, _mm_shuffle_ps(bc[c], bc[c], _MM_SHUFFLE(0, 0, 0, 0)));
+                col = _mm_add_ps(col, _mm_mul_ps(a1, _mm_shuffle_ps(bc[c], bc[c], _MM_SHUFFLE(1, 1, 1, 1))));
+                col = _mm_add_ps(col, _mm_mul_ps(a2, _mm_shuffle_ps(bc[c], bc[c], _MM_SHUFFLE(2, 2, 2, 2))));
+                col = _mm_add_ps(col, _mm_mul_ps(a3, _mm_shuffle_ps(bc[c], bc[c], _MM_SHUFFLE(3, 3, 3, 3))));
+                _mm_store_ps(out[i].m + c * 4, col);
+            }
+        }
+    }
+
+    // Four points per iteration in SoA form, like transformPointsAVX2: three
+    // loads are shuffled into x/y/z, and the results back into three stores
+    void transformPointsSSE(const Mat4& m, const Vec3* in, Vec3* out, size_t count) {
+        const __m128 m0 = _mm_set1_ps(m.m[0]), m1 = _mm_set1_ps(m.m[1]), m2 = _mm_set1_ps(m.m[2]);
+        const __m128 m4 = _mm_set1_ps(m.m[4]), m5 = _mm_set1_ps(m.m[5]), m6 = _mm_set1_ps(m.m[6]);
+        const __m128 m8 = _mm_set1_ps(m.m[8]), m9 = _mm_set1_ps(m.m[9]), m10 = _mm_set1_ps(m.m[10]);
+        const __m128 m12 = _mm_set1_ps(m.m[12]), m13 = _mm_set1_ps(m.m[13]), m14 = _mm_set1_ps(m.m[14]);
+
+        size_t i = 0;
+        for (; i + 4 <= count; i += 4) {
+            // a = x0 y0 z0 x1, b = y1 z1 x2 y2, c = z2 x3 y3 z3
+            const float* src = &in[i].x;
+            __m128 a = _mm_loadu_ps(src + 0), b = _mm_loadu_ps(src + 4), c = _mm_loadu_ps(src + 8);
+            __m128 x = _mm_shuffle_ps(a, _mm_shuffle_ps(b, c, _MM_SHUFFLE(1, 1, 2, 2)), _MM_SHUFFLE(2, 0, 3, 0));
+            __m128 y = _mm_shuffle_ps(_mm_shuffle_ps(a, b, _MM_SHUFFLE(0, 0, 1, 1)),
+                                      _mm_shuffle_ps(b, c, _MM_SHUFFLE(2, 2, 3, 3)), _MM_SHUFFLE(2, 0, 2, 0));
+            __m128 z = _mm_shuffle_ps(_mm_shuffle_ps(a, b, _MM_SHUFFLE(1, 1, 2, 2)),
+                                      _mm_shuffle_ps(c, c, _MM_SHUFFLE(3, 3, 0, 0)), _MM_SHUFFLE(2, 0, 2, 0));
+
+            __m128 ox = _mm_add_ps(_mm_add_ps(_mm_mul_ps(m0, x), _mm_mul_ps(m4, y)), _mm_add_ps(_mm_mul_ps(m8, z), m12));
+            __m128 oy = _mm_add_ps(_mm_add_ps(_mm_mul_ps(m1, x), _mm_mul_ps(m5, y)), _mm_add_ps(_mm_mul_ps(m9, z), m13));
+            __m128 oz = _mm_add_ps(_mm_add_ps(_mm_mul_ps(m2, x), _mm_mul_ps(m6, y)), _mm_add_ps(_mm_mul_ps(m10, z), m14));
+
+            float* dst = &out[i].x;
+            _mm_storeu_ps(dst + 0, _mm_shuffle_ps(_mm_shuffle_ps(ox, oy, _MM_SHUFFLE(0, 0, 0, 0)),
+                                                  _mm_shuffle_ps(oz, ox, _MM_SHUFFLE(1, 1, 0, 0)), _MM_SHUFFLE(2, 0, 2, 0)));
+            _mm_storeu_ps(dst + 4, _mm_shuffle_ps(_mm_shuffle_ps(oy, oz, _MM_SHUFFLE(1, 1, 1, 1)),
+                                                  _mm_shuffle_ps(ox, oy, _MM_SHUFFLE(2, 2, 2, 2)), _MM_SHUFFLE(2, 0, 2, 0)));
+            _mm_storeu_ps(dst + 8, _mm_shuffle_ps(_mm_shuffle_ps(oz, ox, _MM_SHUFFLE(3, 3, 2, 2)),
+                                                  _mm_shuffle_ps(oy, oz, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(2, 0, 2, 0)));
+        }
+        for (; i < count; ++i) out[i] = m.transformPoint(in[i]);
+    }
+#endif
+
+#ifdef MATH_AVX2
+    // Two output columns per 256-bit register
+    MATH_TARGET_AVX2 void multiplyAVX2(const Mat4* a, const Mat4* b, Mat4* out, size_t count) {
+        for (size_t i = 0; i < count; ++i) {
+            const float* am = a[i].m;
+            __m256 a0 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(am + 0));
+            __m256 a1 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(am + 4));
+            __m256 a2 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(am + 8));
+            // Mat4 is only 16-byte aligned, so 256-bit accesses are unaligned
+            __m256 a3 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(am + 12));
+            __m256 b01 = _mm256_loadu_ps(b[i].m + 0);
+            __m256 b23 = _mm256_loadu_ps(b[i].m + 8);
+
+            // Within each 128-bit lane, broadcast element k of that lane's column
+            __m256 r01 = _mm256_mul_ps(a0, _mm256_permute_ps(b01, _MM_SHUFFLE(0, 0, 0, 0)));
+            r01 = _mm256_fmadd_ps(a1, _mm256_permute_ps(b01, _MM_SHUFFLE(1, 1, 1, 1)), r01);
+            r01 = _mm256_fmadd_ps(a2, _mm256_permute_ps(b01, _MM_SHUFFLE(2, 2, 2, 2)), r01);
+            r01 = _mm256_fmadd_ps(a3, _mm256_permute_ps(b01, _MM_SHUFFLE(3, 3, 3, 3)), r01);
+            __m256 r23 = _mm256_mul_ps(a0, _mm256_permute_ps(b23, _MM_SHUFFLE(0, 0, 0, 0)));
+            r23 = _mm256_fmadd_ps(a1, _mm256_permute_ps(b23, _MM_SHUFFLE(1, 1, 1, 1)), r23);
+            r23 = _mm256_fmadd_ps(a2, _mm256_permute_ps(b23, _MM_SHUFFLE(2, 2, 2, 2)), r23);
+            r23 = _mm256_fmadd_ps(a3, _mm256_permute_ps(b23, _MM_SHUFFLE(3, 3, 3, 3)), r23);
+
+            _mm256_storeu_ps(out[i].m + 0, r01);
+            _mm256_storeu_ps(out[i].m + 8, r23);
+        }
+    }
+
+    // Eight points per iteration in SoA form: deinterleave x/y/z, three FMAs
+    // per output row, then interleave back. The 24 floats are moved with
+    // 128-bit loads and shuffles; gathers are slower than that on most CPUs.
+    MATH_TARGET_AVX2 void transformPointsAVX2(const Mat4& m, const Vec3* in, Vec3* out, size_t count) {
+        const __m256 m0 = _mm256_set1_ps(m.m[0]), m1 = _mm256_set1_ps(m.m[1]), m2 = _mm256_set1_ps(m.m[2]);
+        const __m256 m4 = _mm256_set1_ps(m.m[4]), m5 = _mm256_set1_ps(m.m[5]), m6 = _mm256_set1_ps(m.m[6]);
+        const __m256 m8 = _mm256_set1_ps(m.m[8]), m9 = _mm256_set1_ps(m.m[9]), m10 = _mm256_set1_ps(m.m[10]);
+        const __m256 m12 = _mm256_set1_ps(m.m[12]), m13 = _mm256_set1_ps(m.m[13]), m14 = _mm256_set1_ps(m.m[14]);
+
+        size_t i = 0;
+        for (; i + 8 <= count; i += 8) {
+            // Points 0-3 in the low lanes, 4-7 in the high lanes
+            const float* src = &in[i].x;
+            __m256 p03 = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(src + 0)), _mm_loadu_ps(src + 12), 1);
+            __m256 p14 = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(src + 4)), _mm_loadu_ps(src + 16), 1);
+            __m256 p25 = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(src + 8)), _mm_loadu_ps(src + 20), 1);
+            __m256 xy = _mm256_shuffle_ps(p14, p25, _MM_SHUFFLE(2, 1, 3, 2));
+            __m256 yz = _mm256_shuffle_ps(p03, p14, _MM_SHUFFLE(1, 0, 2, 1));
+            __m256 x = _mm256_shuffle_ps(p03, xy, _MM_SHUFFLE(2, 0, 3, 0));
+            __m256 y = _mm256_shuffle_ps(yz, xy, _MM_SHUFFLE(3, 1, 2, 0));
+            __m256 z = _mm256_shuffle_ps(yz, p25, _MM_SHUFFLE(3, 0, 3, 1));
+
+            __m256 ox = _mm256_fmadd_ps(m0, x, _mm256_fmadd_ps(m4, y, _mm256_fmadd_ps(m8, z, m12)));
+            __m256 oy = _mm256_fmadd_ps(m1, x, _mm256_fmadd_ps(m5, y, _mm256_fmadd_ps(m9, z, m13)));
+            __m256 oz = _mm256_fmadd_ps(m2, x, _mm256_fmadd_ps(m6, y, _mm256_fmadd_ps(m10, z, m14)));
+
+            // The same shuffles in reverse
+            __m256 rxy = _mm256_shuffle_ps(ox, oy, _MM_SHUFFLE(2, 0, 2, 0));
+            __m256 ryz = _mm256_shuffle_ps(oy, oz, _MM_SHUFFLE(3, 1, 3, 1));
+            __m256 rzx = _mm256_shuffle_ps(oz, ox, _MM_SHUFFLE(3, 1, 2, 0));
+            __m256 r03 = _mm256_shuffle_ps(rxy, rzx, _MM_SHUFFLE(2, 0, 2, 0));
+            __m256 r14 = _mm256_shuffle_ps(ryz, rxy, _MM_SHUFFLE(3, 1, 2, 0));
+            __m256 r25 = _mm256_shuffle_ps(rzx, ryz, _MM_SHUFFLE(3, 1, 3, 1));
+            float* dst = &out[i].x;
+            _mm_storeu_ps(dst + 0, _mm256_castps256_ps128(r03));
+            _mm_storeu_ps(dst + 4, _mm256_castps256_ps128(r14));
+            _mm_storeu_ps(dst + 8, _mm256_castps256_ps128(r25));
+            _mm_storeu_ps(dst + 12, _mm256_extractf128_ps(r03, 1));
+            _mm_storeu_ps(dst + 16, _mm256_extractf128_ps(r14, 1));
+            _mm_storeu_ps(dst + 20, _mm256_extractf128_ps(r25, 1));
+        }
+        for (; i < count; ++i) out[i] = m.transformPoint(in[i]);
+    }
+#endif
+
+    bool inverseOfKindScalar(const float* m, MatrixKind kind, float* out) {
+        switch (kind) {
+        case MatrixKind::Rigid: inverseRigidScalar(m, out); return true;
+        case MatrixKind::Affine: return inverseAffineScalar(m, out);
+        default: return inverseScalar(m, out);
+        }
+    }
+
+#ifdef MATH_SSE2
+    bool inverseOfKindSSE(const float* m, MatrixKind kind, float* out) {
+        switch (kind) {
+        case MatrixKind::Rigid: inverseRigidSSE(m, out); return true;
+        case MatrixKind::Affine: return inverseAffineSSE(m, out);
+        default: return inverseSSE(m, out);
+        }
+    }
+#endif
+}
+
+MatrixKind Mat4::classify() const {
+    if (m[3] != 0.0f || m[7] != 0.0f || m[11] != 0.0f || m[15] != 1.0f) return MatrixKind::General;
+
+    Vec3 c0(m[0], m[1], m[2]), c1(m[4], m[5], m[6]), c2(m[8], m[9], m[10]);
+    bool orthonormal = std::fabs(dot(c0, c0) - 1.0f) < RIGID_EPSILON
+                    && std::fabs(dot(c1, c1) - 1.0f) < RIGID_EPSILON
+                    && std::fabs(dot(c2, c2) - 1.0f) < RIGID_EPSILON
+                    && std::fabs(dot(c0, c1)) < RIGID_EPSILON
+                    && std::fabs(dot(c0, c2)) < RIGID_EPSILON
+                    && std::fabs(dot(c1, c2)) < RIGID_EPSILON;
+    return orthonormal ? MatrixKind::Rigid : MatrixKind::Affine;
+}
+
+bool Mat4::inverse(Mat4& out) const {
+    // Checking for rigid costs about as much as it saves, so that takes a tag
+    bool affine = m[3] == 0.0f && m[7] == 0.0f && m[11] == 0.0f && m[15] == 1.0f;
+    return inverse(out, affine ? MatrixKind::Affine : MatrixKind::General);
+}
+
+bool Mat4::inverse(Mat4& out, MatrixKind kind) const {
+    // Results go through a temporary so a singular matrix leaves out untouched
+    alignas(16) float result[16];
+#ifdef MATH_SSE2
+    bool ok = getSimdLevel() == SimdLevel::Scalar ? inverseOfKindScalar(m, kind, result)
+                                                  : inverseOfKindSSE(m, kind, result);
+#else
+    bool ok = inverseOfKindScalar(m, kind, result);
+#endif
+    if (!ok) return false;
+    for (int i = 0; i < 16; ++i) out.m[i] = result[i];
+    return true;
+}
+
+void Mat4::multiply(const Mat4* a, const Mat4* b, Mat4* out, size_t count) {
+    switch (getSimdLevel()) {
+#ifdef MATH_AVX2
+    case SimdLevel::AVX2: multiplyAVX2(a, b, out, count); return;
+#endif
+#ifdef MATH_SSE2
+    case SimdLevel::SSE2: multiplySSE(a, b, out, count); return;
+#endif
+    default: break;
+    }
+    // Scalar fallback (also used when a lower level is forced for comparison)
+    for (size_t i = 0; i < count; ++i) {
+        Mat4 r;
+        for (int c = 0; c < 4; ++c) {
+            for (int row = 0; row < 4; ++row) {
+                r.m[c * 4 + row] = a[i].m[row] * b[i].m[c * 4] + a[i].m[4 + row] * b[i].m[c * 4 + 1]
+                                 + a[i].m[8 + row] * b[i].m[c * 4 + 2] + a[i].m[12 + row] * b[i].m[c * 4 + 3];
+            }
+        }
+        out[i] = r;
+    }
+}
+
+void Mat4::transformPoints(const Vec3* in, Vec3* out, size_t count) const {
+    switch (getSimdLevel()) {
+#ifdef MATH_AVX2
+    case SimdLevel::AVX2: transformPointsAVX2(*this, in, out, count); return;
+#endif
+#ifdef MATH_SSE2
+    case SimdLevel::SSE2: transformPointsSSE(*this, in, out, count); return;
+#endif
+    default: break;
+    }
+    for (size_t i = 0; i < count; ++i) out[i] = transformPoint(in[i]);
+}
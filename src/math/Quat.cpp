@@ -0,0 +1,36 @@
+#include "math/Quat.h"
+#include "math/SinCos.h"
+
+void Quat::fromEuler(const Vec3* radians, Quat* out, size_t count) {
+    size_t i = 0;
+#ifdef MATH_SSE2
+    if (getSimdLevel() != SimdLevel::Scalar) {
+        const __m128 half = _mm_set1_ps(-0.5f); // Negated: see fromEuler(const Vec3&)
+        for (; i + 4 <= count; i += 4) {
+            const Vec3* r = radians + i;
+            __m128 ax = _mm_mul_ps(_mm_setr_ps(r[0].x, r[1].x, r[2].x, r[3].x), half);
+            __m128 ay = _mm_mul_ps(_mm_setr_ps(r[0].y, r[1].y, r[2].y, r[3].y), half);
+            __m128 az = _mm_mul_ps(_mm_setr_ps(r[0].z, r[1].z, r[2].z, r[3].z), half);
+            __m128 sx, cx, sy, cy, sz, cz;
+            sinCos4(ax, sx, cx);
+            sinCos4(ay, sy, cy);
+            sinCos4(az, sz, cz);
+
+            __m128 cycz = _mm_mul_ps(cy, cz), sysz = _mm_mul_ps(sy, sz);
+            __m128 sycz = _mm_mul_ps(sy, cz), cysz = _mm_mul_ps(cy, sz);
+            __m128 qx = _mm_add_ps(_mm_mul_ps(sx, cycz), _mm_mul_ps(cx, sysz));
+            __m128 qy = _mm_sub_ps(_mm_mul_ps(cx, sycz), _mm_mul_ps(sx, cysz));
+            __m128 qz = _mm_add_ps(_mm_mul_ps(cx, cysz), _mm_mul_ps(sx, sycz));
+            __m128 qw = _mm_sub_ps(_mm_mul_ps(cx, cycz), _mm_mul_ps(sx, sysz));
+
+            // One lane per quaternion; transpose to get (x, y, z, w) rows
+            _MM_TRANSPOSE4_PS(qx, qy, qz, qw);
+            _mm_store_ps(&out[i + 0].x, qx);
+            _mm_store_ps(&out[i + 1].x, qy);
+            _mm_store_ps(&out[i + 2].x, qz);
+            _mm_store_ps(&out[i + 3].x, qw);
+        }
+    }
+#endif
+    for (; i < count; ++i) out[i] = fromEuler(radians[i]);
+}
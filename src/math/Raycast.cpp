@@ -0,0 +1,330 @@
+#include "math/Raycast.h"
+#include "math/Simd.h"
+
+#ifdef MATH_AVX2
+#include <immintrin.h>
+#endif
+
+namespace {
+    // Rejects rays (nearly) parallel to the triangle and hits at the origin
+    constexpr float EPSILON = 0.0000001f;
+
+    size_t paddedSize(size_t count) {
+        return (count + TriangleSoA::LANES - 1) / TriangleSoA::LANES * TriangleSoA::LANES;
+    }
+
+    bool intersectEdges(const Vec3& origin, const Vec3& direction,
+                        const Vec3& v0, const Vec3& edge1, const Vec3& edge2, float& t) {
+        Vec3 h = cross(direction, edge2);
+        float det = dot(edge1, h);
+        if (det > -EPSILON && det < EPSILON) return false; // Ray parallel to triangle
+
+        float invDet = 1.0f / det;
+        Vec3 s = origin - v0;
+        float u = invDet * dot(s, h);
+        if (u < 0.0f || u > 1.0f) return false;
+
+        Vec3 q = cross(s, edge1);
+        float v = invDet * dot(direction, q);
+        if (v < 0.0f || u + v > 1.0f) return false;
+
+        t = invDet * dot(edge2, q);
+        return t > EPSILON; // Hit in front of ray origin
+    }
+
+    bool raycastScalar(const Ray& ray, const TriangleSoA& tris, size_t begin, size_t end, RayHit& hit) {
+        bool found = false;
+        for (size_t i = begin; i < end; ++i) {
+            float t;
+            if (intersectEdges(ray.origin, ray.direction,
+                               Vec3(tris.v0x[i], tris.v0y[i], tris.v0z[i]),
+                               Vec3(tris.e1x[i], tris.e1y[i], tris.e1z[i]),
+                               Vec3(tris.e2x[i], tris.e2y[i], tris.e2z[i]), t) && t < hit.t) {
+                hit.t = t;
+                hit.triangle = (uint32_t)i;
+                found = true;
+            }
+        }
+        return found;
+    }
+
+    // Per-lane best hits left by a SIMD loop; lanes without a hit hold index -1.
+    // Picks the nearest (lowest index on ties) and returns true if it beats hit.
+    bool reduceLanes(const float* t, const int32_t* index, size_t lanes, RayHit& hit) {
+        bool found = false;
+        for (size_t l = 0; l < lanes; ++l) {
+            if (index[l] < 0) continue;
+            if (t[l] < hit.t || (t[l] == hit.t && found && (uint32_t)index[l] < hit.triangle)) {
+                hit.t = t[l];
+                hit.triangle = (uint32_t)index[l];
+                found = true;
+            }
+        }
+        return found;
+    }
+
+#ifdef MATH_SSE2
+    inline __m128 select(__m128 mask, __m128 a, __m128 b) {
+        return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+    }
+
+    // Möller–Trumbore on four lanes. Returns the lanes that hit with
+    // EPSILON < t < maxT, t written to tOut.
+    inline __m128 intersect4(__m128 ox, __m128 oy, __m128 oz, __m128 dx, __m128 dy, __m128 dz,
+                             __m128 v0x, __m128 v0y, __m128 v0z, __m128 e1x, __m128 e1y, __m128 e1z,
+                             __m128 e2x, __m128 e2y, __m128 e2z, __m128 maxT, __m128& tOut) {
+        const __m128 eps = _mm_set1_ps(EPSILON), zero = _mm_setzero_ps(), one = _mm_set1_ps(1.0f);
+        const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+
+        __m128 hx = _mm_sub_ps(_mm_mul_ps(dy, e2z), _mm_mul_ps(dz, e2y));
+        __m128 hy = _mm_sub_ps(_mm_mul_ps(dz, e2x), _mm_mul_ps(dx, e2z));
+        __m128 hz = _mm_sub_ps(_mm_mul_ps(dx, e2y), _mm_mul_ps(dy, e2x));
+        __m128 det = _mm_add_ps(_mm_add_ps(_mm_mul_ps(e1x, hx), _mm_mul_ps(e1y, hy)), _mm_mul_ps(e1z, hz));
+        __m128 invDet = _mm_div_ps(one, det);
+
+        __m128 sx = _mm_sub_ps(ox, v0x), sy = _mm_sub_ps(oy, v0y), sz = _mm_sub_ps(oz, v0z);
+        __m128 u = _mm_mul_ps(invDet, _mm_add_ps(_mm_add_ps(_mm_mul_ps(sx, hx), _mm_mul_ps(sy, hy)), _mm_mul_ps(sz, hz)));
+
+        __m128 qx = _mm_sub_ps(_mm_mul_ps(sy, e1z), _mm_mul_ps(sz, e1y));
+        __m128 qy = _mm_sub_ps(_mm_mul_ps(sz, e1x), _mm_mul_ps(sx, e1z));
+        __m128 qz = _mm_sub_ps(_mm_mul_ps(sx, e1y), _mm_mul_ps(sy, e1x));
+        __m128 v = _mm_mul_ps(invDet, _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, qx), _mm_mul_ps(dy, qy)), _mm_mul_ps(dz, qz)));
+        __m128 t = _mm_mul_ps(invDet, _mm_add_ps(_mm_add_ps(_mm_mul_ps(e2x, qx), _mm_mul_ps(e2y, qy)), _mm_mul_ps(e2z, qz)));
+
+        __m128 valid = _mm_cmpge_ps(_mm_and_ps(det, absMask), eps);
+        valid = _mm_and_ps(valid, _mm_and_ps(_mm_cmpge_ps(u, zero), _mm_cmple_ps(u, one)));
+        valid = _mm_and_ps(valid, _mm_and_ps(_mm_cmpge_ps(v, zero), _mm_cmple_ps(_mm_add_ps(u, v), one)));
+        valid = _mm_and_ps(valid, _mm_and_ps(_mm_cmpgt_ps(t, eps), _mm_cmplt_ps(t, maxT)));
+        tOut = t;
+        return valid;
+    }
+
+    // Four triangles per step against one ray
+    bool raycastSSE(const Ray& ray, const TriangleSoA& tris, size_t begin, size_t end, RayHit& hit) {
+        const __m128 ox = _mm_set1_ps(ray.origin.x), oy = _mm_set1_ps(ray.origin.y), oz = _mm_set1_ps(ray.origin.z);
+        const __m128 dx = _mm_set1_ps(ray.direction.x), dy = _mm_set1_ps(ray.direction.y), dz = _mm_set1_ps(ray.direction.z);
+        const __m128i beginV = _mm_set1_epi32((int32_t)begin), endV = _mm_set1_epi32((int32_t)end);
+
+        __m128 bestT = _mm_set1_ps(hit.t);
+        __m128i bestIndex = _mm_set1_epi32(-1);
+        // Start on a group boundary and mask lanes outside [begin, end)
+        for (size_t i = begin & ~(size_t)3; i < end; i += 4) {
+            __m128i index = _mm_add_epi32(_mm_set1_epi32((int32_t)i), _mm_setr_epi32(0, 1, 2, 3));
+            __m128 inRange = _mm_castsi128_ps(_mm_andnot_si128(_mm_cmpgt_epi32(beginV, index), _mm_cmpgt_epi32(endV, index)));
+
+            __m128 t;
+            __m128 closer = intersect4(ox, oy, oz, dx, dy, dz,
+                _mm_loadu_ps(&tris.v0x[i]), _mm_loadu_ps(&tris.v0y[i]), _mm_loadu_ps(&tris.v0z[i]),
+                _mm_loadu_ps(&tris.e1x[i]), _mm_loadu_ps(&tris.e1y[i]), _mm_loadu_ps(&tris.e1z[i]),
+                _mm_loadu_ps(&tris.e2x[i]), _mm_loadu_ps(&tris.e2y[i]), _mm_loadu_ps(&tris.e2z[i]),
+                bestT, t);
+            closer = _mm_and_ps(closer, inRange);
+            bestT = select(closer, t, bestT);
+            bestIndex = _mm_castps_si128(select(closer, _mm_castsi128_ps(index), _mm_castsi128_ps(bestIndex)));
+        }
+
+        alignas(16) float t[4];
+        alignas(16) int32_t index[4];
+        _mm_store_ps(t, bestT);
+        _mm_store_si128(reinterpret_cast<__m128i*>(index), bestIndex);
+        return reduceLanes(t, index, 4, hit);
+    }
+
+    // One triangle per step against four rays (two passes for a full packet)
+    void raycastPacketSSE(const RayPacket& rays, const TriangleSoA& tris, size_t begin, size_t end, RayHit* hits) {
+        for (size_t first = 0; first < rays.count; first += 4) {
+            size_t lanes = rays.count - first < 4 ? rays.count - first : 4;
+            alignas(16) float maxT[4] = { 0.0f, 0.0f, 0.0f, 0.0f }; // Unused lanes can't hit
+            for (size_t l = 0; l < lanes; ++l) maxT[l] = hits[first + l].t;
+
+            const __m128 ox = _mm_load_ps(rays.originX + first), oy = _mm_load_ps(rays.originY + first);
+            const __m128 oz = _mm_load_ps(rays.originZ + first);
+            const __m128 dx = _mm_load_ps(rays.directionX + first), dy = _mm_load_ps(rays.directionY + first);
+            const __m128 dz = _mm_load_ps(rays.directionZ + first);
+            __m128 bestT = _mm_load_ps(maxT);
+            __m128i bestIndex = _mm_set1_epi32(-1);
+            for (size_t i = begin; i < end; ++i) {
+                __m128 t;
+                __m128 closer = intersect4(ox, oy, oz, dx, dy, dz,
+                    _mm_set1_ps(tris.v0x[i]), _mm_set1_ps(tris.v0y[i]), _mm_set1_ps(tris.v0z[i]),
+                    _mm_set1_ps(tris.e1x[i]), _mm_set1_ps(tris.e1y[i]), _mm_set1_ps(tris.e1z[i]),
+                    _mm_set1_ps(tris.e2x[i]), _mm_set1_ps(tris.e2y[i]), _mm_set1_ps(tris.e2z[i]),
+                    bestT, t);
+                bestT = select(closer, t, bestT);
+                bestIndex = _mm_castps_si128(select(closer, _mm_castsi128_ps(_mm_set1_epi32((int32_t)i)),
+                                                    _mm_castsi128_ps(bestIndex)));
+            }
+
+            alignas(16) float t[4];
+            alignas(16) int32_t index[4];
+            _mm_store_ps(t, bestT);
+            _mm_store_si128(reinterpret_cast<__m128i*>(index), bestIndex);
+            for (size_t l = 0; l < lanes; ++l) {
+                if (index[l] < 0) continue;
+                hits[first + l].t = t[l];
+                hits[first + l].triangle = (uint32_t)index[l];
+            }
+        }
+    }
+#endif
+
+#ifdef MATH_AVX2
+    MATH_TARGET_AVX2 inline __m256 intersect8(__m256 ox, __m256 oy, __m256 oz, __m256 dx, __m256 dy, __m256 dz,
+                                              __m256 v0x, __m256 v0y, __m256 v0z, __m256 e1x, __m256 e1y, __m256 e1z,
+                                              __m256 e2x, __m256 e2y, __m256 e2z, __m256 maxT, __m256& tOut) {
+        const __m256 eps = _mm256_set1_ps(EPSILON), zero = _mm256_setzero_ps(), one = _mm256_set1_ps(1.0f);
+        const __m256 absMask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7FFFFFFF));
+
+        __m256 hx = _mm256_fmsub_ps(dy, e2z, _mm256_mul_ps(dz, e2y));
+        __m256 hy = _mm256_fmsub_ps(dz, e2x, _mm256_mul_ps(dx, e2z));
+        __m256 hz = _mm256_fmsub_ps(dx, e2y, _mm256_mul_ps(dy, e2x));
+        __m256 det = _mm256_fmadd_ps(e1x, hx, _mm256_fmadd_ps(e1y, hy, _mm256_mul_ps(e1z, hz)));
+        __m256 invDet = _mm256_div_ps(one, det);
+
+        __m256 sx = _mm256_sub_ps(ox, v0x), sy = _mm256_sub_ps(oy, v0y), sz = _mm256_sub_ps(oz, v0z);
+        __m256 u = _mm256_mul_ps(invDet, _mm256_fmadd_ps(sx, hx, _mm256_fmadd_ps(sy, hy, _mm256_mul_ps(sz, hz))));
+
+        __m256 qx = _mm256_fmsub_ps(sy, e1z, _mm256_mul_ps(sz, e1y));
+        __m256 qy = _mm256_fmsub_ps(sz, e1x, _mm256_mul_ps(sx, e1z));
+        __m256 qz = _mm256_fmsub_ps(sx, e1y, _mm256_mul_ps(sy, e1x));
+        __m256 v = _mm256_mul_ps(invDet, _mm256_fmadd_ps(dx, qx, _mm256_fmadd_ps(dy, qy, _mm256_mul_ps(dz, qz))));
+        __m256 t = _mm256_mul_ps(invDet, _mm256_fmadd_ps(e2x, qx, _mm256_fmadd_ps(e2y, qy, _mm256_mul_ps(e2z, qz))));
+
+        __m256 valid = _mm256_cmp_ps(_mm256_and_ps(det, absMask), eps, _CMP_GE_OQ);
+        valid = _mm256_and_ps(valid, _mm256_and_ps(_mm256_cmp_ps(u, zero, _CMP_GE_OQ), _mm256_cmp_ps(u, one, _CMP_LE_OQ)));
+        valid = _mm256_and_ps(valid, _mm256_and_ps(_mm256_cmp_ps(v, zero, _CMP_GE_OQ),
+                                                   _mm256_cmp_ps(_mm256_add_ps(u, v), one, _CMP_LE_OQ)));
+        valid = _mm256_and_ps(valid, _mm256_and_ps(_mm256_cmp_ps(t, eps, _CMP_GT_OQ), _mm256_cmp_ps(t, maxT, _CMP_LT_OQ)));
+        tOut = t;
+        return valid;
+    }
+
+    MATH_TARGET_AVX2 bool raycastAVX2(const Ray& ray, const TriangleSoA& tris, size_t begin, size_t end, RayHit& hit) {
+        const __m256 ox = _mm256_set1_ps(ray.origin.x), oy = _mm256_set1_ps(ray.origin.y), oz = _mm256_set1_ps(ray.origin.z);
+        const __m256 dx = _mm256_set1_ps(ray.direction.x), dy = _mm256_set1_ps(ray.direction.y);
+        const __m256 dz = _mm256_set1_ps(ray.direction.z);
+        const __m256i beginV = _mm256_set1_epi32((int32_t)begin), endV = _mm256_set1_epi32((int32_t)end);
+
+        __m256 bestT = _mm256_set1_ps(hit.t);
+        __m256i bestIndex = _mm256_set1_epi32(-1);
+        for (size_t i = begin & ~(size_t)7; i < end; i += 8) {
+            __m256i index = _mm256_add_epi32(_mm256_set1_epi32((int32_t)i), _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+            __m256 inRange = _mm256_castsi256_ps(_mm256_andnot_si256(_mm256_cmpgt_epi32(beginV, index),
+                                                                     _mm256_cmpgt_epi32(endV, index)));
+
+            __m256 t;
+            __m256 closer = intersect8(ox, oy, oz, dx, dy, dz,
+                _mm256_loadu_ps(&tris.v0x[i]), _mm256_loadu_ps(&tris.v0y[i]), _mm256_loadu_ps(&tris.v0z[i]),
+                _mm256_loadu_ps(&tris.e1x[i]), _mm256_loadu_ps(&tris.e1y[i]), _mm256_loadu_ps(&tris.e1z[i]),
+                _mm256_loadu_ps(&tris.e2x[i]), _mm256_loadu_ps(&tris.e2y[i]), _mm256_loadu_ps(&tris.e2z[i]),
+                bestT, t);
+            closer = _mm256_and_ps(closer, inRange);
+            bestT = _mm256_blendv_ps(bestT, t, closer);
+            bestIndex = _mm256_castps_si256(_mm256_blendv_ps(_mm256_castsi256_ps(bestIndex), _mm256_castsi256_ps(index), closer));
+        }
+
+        alignas(32) float t[8];
+        alignas(32) int32_t index[8];
+        _mm256_store_ps(t, bestT);
+        _mm256_store_si256(reinterpret_cast<__m256i*>(index), bestIndex);
+        return reduceLanes(t, index, 8, hit);
+    }
+
+    MATH_TARGET_AVX2 void raycastPacketAVX2(const RayPacket& rays, const TriangleSoA& tris, size_t begin, size_t end, RayHit* hits) {
+        alignas(32) float maxT[8] = {}; // Unused lanes can't hit
+        for (size_t l = 0; l < rays.count; ++l) maxT[l] = hits[l].t;
+
+        const __m256 ox = _mm256_load_ps(rays.originX), oy = _mm256_load_ps(rays.originY), oz = _mm256_load_ps(rays.originZ);
+        const __m256 dx = _mm256_load_ps(rays.directionX), dy = _mm256_load_ps(rays.directionY);
+        const __m256 dz = _mm256_load_ps(rays.directionZ);
+        __m256 bestT = _mm256_load_ps(maxT);
+        __m256i bestIndex = _mm256_set1_epi32(-1);
+        for (size_t i = begin; i < end; ++i) {
+            __m256 t;
+            __m256 closer = intersect8(ox, oy, oz, dx, dy, dz,
+                _mm256_set1_ps(tris.v0x[i]), _mm256_set1_ps(tris.v0y[i]), _mm256_set1_ps(tris.v0z[i]),
+                _mm256_set1_ps(tris.e1x[i]), _mm256_set1_ps(tris.e1y[i]), _mm256_set1_ps(tris.e1z[i]),
+                _mm256_set1_ps(tris.e2x[i]), _mm256_set1_ps(tris.e2y[i]), _mm256_set1_ps(tris.e2z[i]),
+                bestT, t);
+            bestT = _mm256_blendv_ps(bestT, t, closer);
+            bestIndex = _mm256_castps_si256(_mm256_blendv_ps(_mm256_castsi256_ps(bestIndex),
+                                                             _mm256_castsi256_ps(_mm256_set1_epi32((int32_t)i)), closer));
+        }
+
+        alignas(32) float t[8];
+        alignas(32) int32_t index[8];
+        _mm256_store_ps(t, bestT);
+        _mm256_store_si256(reinterpret_cast<__m256i*>(index), bestIndex);
+        for (size_t l = 0; l < rays.count; ++l) {
+            if (index[l] < 0) continue;
+            hits[l].t = t[l];
+            hits[l].triangle = (uint32_t)index[l];
+        }
+    }
+#endif
+}
+
+void TriangleSoA::clear() {
+    for (std::vector<float>* v : { &v0x, &v0y, &v0z, &e1x, &e1y, &e1z, &e2x, &e2y, &e2z }) v->clear();
+    count_ = 0;
+}
+
+void TriangleSoA::reserve(size_t triangles) {
+    size_t padded = paddedSize(triangles);
+    for (std::vector<float>* v : { &v0x, &v0y, &v0z, &e1x, &e1y, &e1z, &e2x, &e2y, &e2z }) v->reserve(padded);
+}
+
+void TriangleSoA::add(const Vec3& a, const Vec3& b, const Vec3& c) {
+    if (count_ == v0x.size()) {
+        // Next group of LANES, zero-filled: zero edges are never hit
+        for (std::vector<float>* v : { &v0x, &v0y, &v0z, &e1x, &e1y, &e1z, &e2x, &e2y, &e2z }) v->resize(count_ + LANES, 0.0f);
+    }
+    Vec3 edge1 = b - a, edge2 = c - a;
+    v0x[count_] = a.x; v0y[count_] = a.y; v0z[count_] = a.z;
+    e1x[count_] = edge1.x; e1y[count_] = edge1.y; e1z[count_] = edge1.z;
+    e2x[count_] = edge2.x; e2y[count_] = edge2.y; e2z[count_] = edge2.z;
+    ++count_;
+}
+
+void TriangleSoA::assign(const Vec3* vertices, size_t vertexCount) {
+    clear();
+    reserve(vertexCount / 3);
+    for (size_t i = 0; i + 2 < vertexCount; i += 3) add(vertices[i], vertices[i + 1], vertices[i + 2]);
+}
+
+bool intersectTriangle(const Ray& ray, const Vec3& v0, const Vec3& v1, const Vec3& v2, float& t) {
+    return intersectEdges(ray.origin, ray.direction, v0, v1 - v0, v2 - v0, t);
+}
+
+bool raycast(const Ray& ray, const TriangleSoA& triangles, size_t begin, size_t end, RayHit& hit) {
+    if (end > triangles.size()) end = triangles.size();
+    if (begin >= end) return false;
+    switch (getSimdLevel()) {
+#ifdef MATH_AVX2
+    case SimdLevel::AVX2: return raycastAVX2(ray, triangles, begin, end, hit);
+#endif
+#ifdef MATH_SSE2
+    case SimdLevel::SSE2: return raycastSSE(ray, triangles, begin, end, hit);
+#endif
+    default: return raycastScalar(ray, triangles, begin, end, hit);
+    }
+}
+
+void raycast(const RayPacket& rays, const TriangleSoA& triangles, size_t begin, size_t end, RayHit* hits) {
+    if (end > triangles.size()) end = triangles.size();
+    if (begin >= end || rays.count == 0) return;
+    switch (getSimdLevel()) {
+#ifdef MATH_AVX2
+    case SimdLevel::AVX2: raycastPacketAVX2(rays, triangles, begin, end, hits); return;
+#endif
+#ifdef MATH_SSE2
+    case SimdLevel::SSE2: raycastPacketSSE(rays, triangles, begin, end, hits); return;
+#endif
+    default: break;
+    }
+    for (size_t r = 0; r < rays.count; ++r) {
+        Ray ray{ Vec3(rays.originX[r], rays.originY[r], rays.originZ[r]),
+                 Vec3(rays.directionX[r], rays.directionY[r], rays.directionZ[r]) };
+        raycastScalar(ray, triangles, begin, end, hits[r]);
+    }
+}
@@ -0,0 +1,70 @@
+#include "math/Simd.h"
+#include <atomic>
+
+#if defined(MATH_AVX2) && defined(_MSC_VER)
+#include <intrin.h>
+#include <immintrin.h>
+#endif
+
+namespace {
+    SimdLevel detectSimdLevel() {
+#ifdef MATH_AVX2
+#if defined(__GNUC__) || defined(__clang__)
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) return SimdLevel::AVX2;
+#else
+        int info[4];
+        __cpuid(info, 0);
+        if (info[0] >= 7) {
+            __cpuid(info, 1);
+            bool fma = (info[2] & (1 << 12)) != 0;
+            bool osxsave = (info[2] & (1 << 27)) != 0;
+            bool avx = (info[2] & (1 << 28)) != 0;
+            // The OS must save the upper halves of the YMM registers
+            bool ymmEnabled = osxsave && (_xgetbv(0) & 0x6) == 0x6;
+            __cpuidex(info, 7, 0);
+            bool avx2 = (info[1] & (1 << 5)) != 0;
+            if (fma && avx && avx2 && ymmEnabled) return SimdLevel::AVX2;
+        }
+#endif
+#endif
+#ifdef MATH_SSE2
+        return SimdLevel::SSE2;
+#else
+        return SimdLevel::Scalar;
+#endif
+    }
+
+    SimdLevel supportedLevel() {
+        static const SimdLevel level = detectSimdLevel();
+        return level;
+    }
+
+    std::atomic<int> currentLevel{ -1 }; // -1 until first use
+}
+
+SimdLevel getSupportedSimdLevel() {
+    return supportedLevel();
+}
+
+SimdLevel getSimdLevel() {
+    int level = currentLevel.load(std::memory_order_relaxed);
+    if (level < 0) {
+        level = (int)supportedLevel();
+        currentLevel.store(level, std::memory_order_relaxed);
+    }
+    return (SimdLevel)level;
+}
+
+void setSimdLevel(SimdLevel level) {
+    if ((int)level > (int)supportedLevel()) level = supportedLevel();
+    currentLevel.store((int)level, std::memory_order_relaxed);
+}
+
+const char* getSimdLevelName(SimdLevel level) {
+    switch (level) {
+    case SimdLevel::AVX2: return "AVX2+FMA";
+    case SimdLevel::SSE2: return "SSE2";
+    default: return "Scalar";
+    }
+}
@@ -0,0 +1,707 @@
+#include "math/SpatialHash.h"
+#include "math/Simd.h"
+#include <limits>
+
+#ifdef MATH_AVX2
+#include <immintrin.h>
+#endif
+
+namespace {
+    constexpr size_t MIN_TABLE_SIZE = 64;
+    // Empty cells are kept (a moving item often comes back) until there are
+    // more of them than occupied ones, and at least this many
+    constexpr size_t MIN_EMPTY_CELLS_TO_COMPACT = 256;
+
+    // Box distance tests for SpatialHash::collectWithin. Every lane writes
+    // its item and distance and only hits advance the count, so later lanes
+    // overwrite the misses; unused lanes hold inverted boxes that never hit.
+    template<typename Block>
+    uint32_t collectScalar(const Block* const* blocks, size_t count, const Vec3& p, float limit, uint32_t* hits,
+                           float* distances) {
+        uint32_t n = 0;
+        for (size_t b = 0; b < count; ++b) {
+            const Block& block = *blocks[b];
+            for (int l = 0; l < 4; ++l) {
+                float dx = std::max(std::max(block.minX[l] - p.x, p.x - block.maxX[l]), 0.0f);
+                float dy = std::max(std::max(block.minY[l] - p.y, p.y - block.maxY[l]), 0.0f);
+                float dz = std::max(std::max(block.minZ[l] - p.z, p.z - block.maxZ[l]), 0.0f);
+                float d = dx * dx + dy * dy + dz * dz;
+                hits[n] = block.item[l];
+                distances[n] = d;
+                n += d <= limit ? 1 : 0;
+            }
+        }
+        return n;
+    }
+
+#ifdef MATH_SSE2
+    template<typename Block>
+    uint32_t collectSSE(const Block* const* blocks, size_t count, const Vec3& p, float limit, uint32_t* hits,
+                        float* distances) {
+        const __m128 px = _mm_set1_ps(p.x), py = _mm_set1_ps(p.y), pz = _mm_set1_ps(p.z);
+        const __m128 zero = _mm_setzero_ps(), bound = _mm_set1_ps(limit);
+        uint32_t n = 0;
+        for (size_t b = 0; b < count; ++b) {
+            const Block& block = *blocks[b];
+            __m128 dx = _mm_max_ps(_mm_max_ps(_mm_sub_ps(_mm_load_ps(block.minX), px), _mm_sub_ps(px, _mm_load_ps(block.maxX))), zero);
+            __m128 dy = _mm_max_ps(_mm_max_ps(_mm_sub_ps(_mm_load_ps(block.minY), py), _mm_sub_ps(py, _mm_load_ps(block.maxY))), zero);
+            __m128 dz = _mm_max_ps(_mm_max_ps(_mm_sub_ps(_mm_load_ps(block.minZ), pz), _mm_sub_ps(pz, _mm_load_ps(block.maxZ))), zero);
+            __m128 d = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz));
+            int mask = _mm_movemask_ps(_mm_cmple_ps(d, bound));
+            alignas(16) float lanes[4];
+            _mm_store_ps(lanes, d);
+            for (int l = 0; l < 4; ++l) {
+                hits[n] = block.item[l];
+                distances[n] = lanes[l];
+                n += (mask >> l) & 1;
+            }
+        }
+        return n;
+    }
+#endif
+
+#ifdef MATH_AVX2
+    // For each 8-bit hit mask, the lanes of its set bits packed one per
+    // byte, so one permute compacts a pair of blocks
+    struct CompactTable {
+        uint64_t lanes[256];
+        uint8_t count[256];
+        constexpr CompactTable() : lanes(), count() {
+            for (int mask = 0; mask < 256; ++mask) {
+                int n = 0;
+                for (int l = 0; l < 8; ++l) {
+                    if ((mask >> l) & 1) lanes[mask] |= (uint64_t)l << (8 * n++);
+                }
+                count[mask] = (uint8_t)n;
+            }
+        }
+    };
+    constexpr CompactTable COMPACT;
+
+    // Two blocks per test, the second in the upper half. Distances use
+    // fused multiply-adds, so they can differ from the other paths in the
+    // last bit.
+    template<typename Block>
+    MATH_TARGET_AVX2 uint32_t collectAVX2(const Block* const* blocks, size_t count, const Vec3& p, float limit,
+                                          uint32_t* hits, float* distances) {
+        const __m256 px = _mm256_set1_ps(p.x), py = _mm256_set1_ps(p.y), pz = _mm256_set1_ps(p.z);
+        const __m256 zero = _mm256_setzero_ps(), bound = _mm256_set1_ps(limit);
+        uint32_t n = 0;
+        for (size_t b = 0; b < count; b += 2) {
+            const Block& low = *blocks[b];
+            const Block& high = *blocks[b + 1 < count ? b + 1 : b];
+            int valid = b + 1 < count ? 0xFF : 0x0F;
+            __m256 minX = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_load_ps(low.minX)), _mm_load_ps(high.minX), 1);
+            __m256 minY = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_load_ps(low.minY)), _mm_load_ps(high.minY), 1);
+            __m256 minZ = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_load_ps(low.minZ)), _mm_load_ps(high.minZ), 1);
+            __m256 maxX = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_load_ps(low.maxX)), _mm_load_ps(high.maxX), 1);
+            __m256 maxY = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_load_ps(low.maxY)), _mm_load_ps(high.maxY), 1);
+            __m256 maxZ = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_load_ps(low.maxZ)), _mm_load_ps(high.maxZ), 1);
+            __m256 dx = _mm256_max_ps(_mm256_max_ps(_mm256_sub_ps(minX, px), _mm256_sub_ps(px, maxX)), zero);
+            __m256 dy = _mm256_max_ps(_mm256_max_ps(_mm256_sub_ps(minY, py), _mm256_sub_ps(py, maxY)), zero);
+            __m256 dz = _mm256_max_ps(_mm256_max_ps(_mm256_sub_ps(minZ, pz), _mm256_sub_ps(pz, maxZ)), zero);
+            __m256 d = _mm256_fmadd_ps(dx, dx, _mm256_fmadd_ps(dy, dy, _mm256_mul_ps(dz, dz)));
+            int mask = _mm256_movemask_ps(_mm256_cmp_ps(d, bound, _CMP_LE_OQ)) & valid;
+
+            __m256i lanes = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)&COMPACT.lanes[mask]));
+            __m256i items = _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_load_si128((const __m128i*)low.item)),
+                                                    _mm_load_si128((const __m128i*)high.item), 1);
+            _mm256_storeu_si256((__m256i*)(hits + n), _mm256_permutevar8x32_epi32(items, lanes));
+            _mm256_storeu_ps(distances + n, _mm256_permutevar8x32_ps(d, lanes));
+            n += COMPACT.count[mask];
+        }
+        return n;
+    }
+#endif
+}
+
+SpatialHash::SpatialHash(float cellSize)
+    : cellSize_(cellSize), invCellSize_(1.0f / cellSize) {}
+
+void SpatialHash::Block::set(uint32_t lane, const Aabb& box, uint32_t id) {
+    minX[lane] = box.min.x; minY[lane] = box.min.y; minZ[lane] = box.min.z;
+    maxX[lane] = box.max.x; maxY[lane] = box.max.y; maxZ[lane] = box.max.z;
+    item[lane] = id;
+}
+
+void SpatialHash::Block::clear(uint32_t lane) {
+    const float inf = std::numeric_limits<float>::infinity();
+    minX[lane] = minY[lane] = minZ[lane] = inf;
+    maxX[lane] = maxY[lane] = maxZ[lane] = -inf;
+    item[lane] = NULL_ITEM;
+}
+
+void SpatialHash::Block::copyLane(uint32_t lane, const Block& from, uint32_t fromLane) {
+    minX[lane] = from.minX[fromLane]; minY[lane] = from.minY[fromLane]; minZ[lane] = from.minZ[fromLane];
+    maxX[lane] = from.maxX[fromLane]; maxY[lane] = from.maxY[fromLane]; maxZ[lane] = from.maxZ[fromLane];
+    item[lane] = from.item[fromLane];
+}
+
+float SpatialHash::Block::halfExtent(uint32_t lane) const {
+    return std::max(std::max(maxX[lane] - minX[lane], maxY[lane] - minY[lane]), maxZ[lane] - minZ[lane]) * 0.5f;
+}
+
+uint32_t SpatialHash::collectWithin(const Block* const* blocks, size_t count, const Vec3& p, float limit,
+                                    uint32_t* hits, float* distances) {
+    switch (getSimdLevel()) {
+#ifdef MATH_AVX2
+    case SimdLevel::AVX2: return collectAVX2(blocks, count, p, limit, hits, distances);
+#endif
+#ifdef MATH_SSE2
+    case SimdLevel::SSE2: return collectSSE(blocks, count, p, limit, hits, distances);
+#endif
+    default: return collectScalar(blocks, count, p, limit, hits, distances);
+    }
+}
+
+void SpatialHash::clear() {
+    table_.clear();
+    blocks_.clear();
+    for (std::vector<uint32_t>& runs : freeRuns_) runs.clear();
+    large_.clear();
+    largeCount_ = 0;
+    cellOf_.clear();
+    slotOf_.clear();
+    userData_.clear();
+    freeItems_.clear();
+    itemCount_ = cellCount_ = occupiedCells_ = 0;
+    ++version_;
+    maxHalfExtent_ = 0.0f;
+    for (int a = 0; a < 3; ++a) {
+        occupiedMin_[a] = 0;
+        occupiedMax_[a] = -1;
+    }
+}
+
+uint32_t SpatialHash::insert(const Aabb& box, uint32_t userData) {
+    uint32_t item;
+    if (!freeItems_.empty()) {
+        item = freeItems_.back();
+        freeItems_.pop_back();
+        userData_[item] = userData;
+    } else {
+        item = (uint32_t)cellOf_.size();
+        cellOf_.push_back(NULL_CELL);
+        slotOf_.push_back(0);
+        userData_.push_back(userData);
+    }
+    ++itemCount_;
+    ++version_;
+
+    Vec3 extents = box.extents();
+    place(item, box, box.center(), std::max(std::max(extents.x, extents.y), extents.z));
+    return item;
+}
+
+bool SpatialHash::move(uint32_t item, const Aabb& box) {
+    ++version_;
+    Vec3 center = box.center(), extents = box.extents();
+    float halfExtent = std::max(std::max(extents.x, extents.y), extents.z);
+    bool large = halfExtent > cellSize_;
+
+    // Same cell (or still large): rewrite the stored box in place
+    uint32_t cell = cellOf_[item], slot = slotOf_[item];
+    if (cell == LARGE_CELL && large) {
+        large_[slot / LANES].set(slot % LANES, box, item);
+        return false;
+    }
+    if (cell != LARGE_CELL && !large) {
+        const Cell& current = table_[cell];
+        if (current.x == coord(center.x) && current.y == coord(center.y) && current.z == coord(center.z)) {
+            blocks_[current.firstBlock + slot / LANES].set(slot % LANES, box, item);
+            maxHalfExtent_ = std::max(maxHalfExtent_, halfExtent);
+            return false;
+        }
+    }
+
+    unplace(item);
+    place(item, box, center, halfExtent);
+    compact();
+    return true;
+}
+
+void SpatialHash::remove(uint32_t item) {
+    unplace(item);
+    cellOf_[item] = NULL_CELL;
+    freeItems_.push_back(item);
+    --itemCount_;
+    ++version_;
+    compact();
+}
+
+Aabb SpatialHash::getBounds(uint32_t item) const {
+    uint32_t cell = cellOf_[item], slot = slotOf_[item];
+    const Block& block = cell == LARGE_CELL ? large_[slot / LANES] : blocks_[table_[cell].firstBlock + slot / LANES];
+    uint32_t l = slot % LANES;
+    return { Vec3(block.minX[l], block.minY[l], block.minZ[l]), Vec3(block.maxX[l], block.maxY[l], block.maxZ[l]) };
+}
+
+uint32_t SpatialHash::allocateBlocks(uint32_t runClass) {
+    uint32_t first, count = 1u << runClass;
+    if (!freeRuns_[runClass].empty()) {
+        first = freeRuns_[runClass].back();
+        freeRuns_[runClass].pop_back();
+    } else {
+        first = (uint32_t)blocks_.size();
+        blocks_.resize(blocks_.size() + count);
+    }
+    for (uint32_t b = first; b < first + count; ++b) {
+        blocks_[b].count = 0;
+        for (uint32_t l = 0; l < LANES; ++l) blocks_[b].clear(l);
+    }
+    return first;
+}
+
+void SpatialHash::freeBlocks(uint32_t first, uint32_t runClass) {
+    freeRuns_[runClass].push_back(first);
+}
+
+void SpatialHash::place(uint32_t item, const Aabb& box, const Vec3& center, float halfExtent) {
+    if (halfExtent > cellSize_) {
+        if (largeCount_ == large_.size() * LANES) {
+            large_.emplace_back();
+            for (uint32_t l = 0; l < LANES; ++l) large_.back().clear(l);
+        }
+        cellOf_[item] = LARGE_CELL;
+        slotOf_[item] = largeCount_;
+        large_[largeCount_ / LANES].set(largeCount_ % LANES, box, item);
+        ++largeCount_;
+        return;
+    }
+
+    maxHalfExtent_ = std::max(maxHalfExtent_, halfExtent);
+    int32_t x = coord(center.x), y = coord(center.y), z = coord(center.z);
+    uint32_t slot = findOrAddCell(x, y, z);
+    Cell& cell = table_[slot];
+    uint32_t count = cellCount(cell);
+    if (count == 0) {
+        ++occupiedCells_;
+        if (occupiedMin_[0] > occupiedMax_[0]) { // First cell since the last clear/compact
+            occupiedMin_[0] = occupiedMax_[0] = x;
+            occupiedMin_[1] = occupiedMax_[1] = y;
+            occupiedMin_[2] = occupiedMax_[2] = z;
+        }
+        int32_t c[3] = { x, y, z };
+        for (int a = 0; a < 3; ++a) {
+            occupiedMin_[a] = std::min(occupiedMin_[a], c[a]);
+            occupiedMax_[a] = std::max(occupiedMax_[a], c[a]);
+        }
+    }
+    if (count == cell.blockCount() * LANES) {
+        // Full: move to a run twice as long
+        uint32_t first = allocateBlocks(cell.runClass + 1);
+        std::copy(blocks_.begin() + cell.firstBlock, blocks_.begin() + cell.firstBlock + cell.blockCount(),
+                  blocks_.begin() + first);
+        freeBlocks(cell.firstBlock, cell.runClass);
+        cell.firstBlock = first;
+        ++cell.runClass;
+    }
+    cellOf_[item] = slot;
+    slotOf_[item] = count;
+    blocks_[cell.firstBlock + count / LANES].set(count % LANES, box, item);
+    blocks_[cell.firstBlock].count = count + 1;
+}
+
+void SpatialHash::unplace(uint32_t item) {
+    // Move the cell's last item into the freed lane
+    uint32_t cell = cellOf_[item];
+    Block* blocks;
+    uint32_t* count;
+    if (cell == LARGE_CELL) {
+        blocks = large_.data();
+        count = &largeCount_;
+    } else {
+        blocks = &blocks_[table_[cell].firstBlock];
+        count = &blocks->count;
+    }
+    uint32_t slot = slotOf_[item], last = --*count;
+    Block& to = blocks[slot / LANES];
+    const Block& from = blocks[last / LANES];
+    to.copyLane(slot % LANES, from, last % LANES);
+    slotOf_[to.item[slot % LANES]] = slot;
+    blocks[last / LANES].clear(last % LANES);
+    if (cell != LARGE_CELL && *count == 0) --occupiedCells_;
+}
+
+uint32_t SpatialHash::findCell(int32_t x, int32_t y, int32_t z) const {
+    if (table_.empty()) return NULL_CELL;
+    uint32_t mask = (uint32_t)table_.size() - 1;
+    for (uint32_t i = hashCell(x, y, z) & mask;; i = (i + 1) & mask) {
+        const Cell& cell = table_[i];
+        if (cell.isFree()) return NULL_CELL;
+        if (cell.x == x && cell.y == y && cell.z == z) return i;
+    }
+}
+
+uint32_t SpatialHash::findOrAddCell(int32_t x, int32_t y, int32_t z) {
+    uint32_t found = findCell(x, y, z);
+    if (found != NULL_CELL) return found;
+
+    if ((cellCount_ + 1) * 2 > table_.size()) {
+        size_t size = std::max(MIN_TABLE_SIZE, table_.size());
+        while ((cellCount_ + 1) * 2 > size) size *= 2;
+        rehash(size, false);
+    }
+    uint32_t mask = (uint32_t)table_.size() - 1;
+    uint32_t i = hashCell(x, y, z) & mask;
+    while (!table_[i].isFree()) i = (i + 1) & mask;
+    Cell& cell = table_[i];
+    cell.x = x;
+    cell.y = y;
+    cell.z = z;
+    cell.firstBlock = allocateBlocks(0);
+    cell.runClass = 0;
+    ++cellCount_;
+    return i;
+}
+
+void SpatialHash::rehash(size_t size, bool dropEmpty) {
+    std::vector<Cell> cells;
+    cells.reserve(cellCount_);
+    for (const Cell& cell : table_) {
+        if (!cell.isFree() && !(dropEmpty && cellCount(cell) == 0)) cells.push_back(cell);
+    }
+    std::sort(cells.begin(), cells.end(), [](const Cell& a, const Cell& b) {
+        return a.z != b.z ? a.z < b.z : a.y != b.y ? a.y < b.y : a.x < b.x;
+    });
+
+    // Each cell gets the shortest run that holds its items
+    std::vector<Block> old;
+    old.swap(blocks_);
+    for (std::vector<uint32_t>& runs : freeRuns_) runs.clear();
+    auto runClassFor = [](uint32_t count) {
+        uint32_t runClass = 0;
+        while ((LANES << runClass) < count) ++runClass;
+        return runClass;
+    };
+    size_t total = 0;
+    for (const Cell& cell : cells) total += (size_t)1 << runClassFor(old[cell.firstBlock].count);
+    blocks_.reserve(total);
+
+    table_.assign(size, Cell());
+    cellCount_ = 0;
+    uint32_t mask = (uint32_t)size - 1;
+    for (const Cell& cell : cells) {
+        uint32_t i = hashCell(cell.x, cell.y, cell.z) & mask;
+        while (!table_[i].isFree()) i = (i + 1) & mask;
+        uint32_t count = old[cell.firstBlock].count;
+        Cell& moved = table_[i];
+        moved = cell;
+        moved.runClass = runClassFor(count);
+        moved.firstBlock = allocateBlocks(moved.runClass);
+        std::copy(old.begin() + cell.firstBlock, old.begin() + cell.firstBlock + (count + LANES - 1) / LANES,
+                  blocks_.begin() + moved.firstBlock);
+        for (uint32_t s = 0; s < count; ++s) cellOf_[blocks_[moved.firstBlock + s / LANES].item[s % LANES]] = i;
+        ++cellCount_;
+    }
+}
+
+void SpatialHash::compact() {
+    size_t empty = cellCount_ - occupiedCells_;
+    if (empty < MIN_EMPTY_CELLS_TO_COMPACT || empty <= occupiedCells_) return;
+
+    // Recompute the ranges that only ever grew from the cells kept
+    maxHalfExtent_ = 0.0f;
+    for (int a = 0; a < 3; ++a) {
+        occupiedMin_[a] = MAX_COORD;
+        occupiedMax_[a] = -MAX_COORD;
+    }
+    for (const Cell& cell : table_) {
+        uint32_t count = cell.isFree() ? 0 : cellCount(cell);
+        if (count == 0) continue;
+        for (uint32_t s = 0; s < count; ++s) {
+            maxHalfExtent_ = std::max(maxHalfExtent_, blocks_[cell.firstBlock + s / LANES].halfExtent(s % LANES));
+        }
+        int32_t c[3] = { cell.x, cell.y, cell.z };
+        for (int a = 0; a < 3; ++a) {
+            occupiedMin_[a] = std::min(occupiedMin_[a], c[a]);
+            occupiedMax_[a] = std::max(occupiedMax_[a], c[a]);
+        }
+    }
+    size_t size = MIN_TABLE_SIZE;
+    while (occupiedCells_ * 2 > size) size *= 2;
+    rehash(size, true);
+}
+
+bool SpatialHash::cellRange(const Vec3& min, const Vec3& max, int32_t lo[3], int32_t hi[3]) const {
+    if (occupiedCells_ == 0) return false;
+    float pad = maxHalfExtent_;
+    lo[0] = std::max(coord(min.x - pad), occupiedMin_[0]);
+    lo[1] = std::max(coord(min.y - pad), occupiedMin_[1]);
+    lo[2] = std::max(coord(min.z - pad), occupiedMin_[2]);
+    hi[0] = std::min(coord(max.x + pad), occupiedMax_[0]);
+    hi[1] = std::min(coord(max.y + pad), occupiedMax_[1]);
+    hi[2] = std::min(coord(max.z + pad), occupiedMax_[2]);
+    return lo[0] <= hi[0] && lo[1] <= hi[1] && lo[2] <= hi[2];
+}
+
+size_t SpatialHash::countInCell(const Vec3& point) const {
+    uint32_t cell = findCell(coord(point.x), coord(point.y), coord(point.z));
+    return cell == NULL_CELL ? 0 : cellCount(table_[cell]);
+}
+
+size_t SpatialHash::queryNearest(const Vec3& point, size_t k, float maxDistance, Neighbor* out) const {
+    if (k == 0) return 0;
+
+    // out stays sorted; an item must beat the k-th (once there are k) and maxDistance
+    size_t count = 0;
+    float maxDistanceSquared = maxDistance * maxDistance;
+    auto consider = [&](uint32_t item, float d) {
+        if (count == k && d >= out[k - 1].distanceSquared) return;
+        size_t i = count < k ? count++ : k - 1;
+        for (; i > 0 && out[i - 1].distanceSquared > d; --i) out[i] = out[i - 1];
+        out[i] = { item, d };
+    };
+    forEachWithin(large_.data(), largeCount_, point, maxDistanceSquared, consider);
+    if (occupiedCells_ == 0) return count;
+
+    // Search rings of cells at Chebyshev distance s from the point's cell,
+    // starting with the first ring that reaches an occupied cell. Items in
+    // ring s or beyond have their centre at least s - 1 whole cells away
+    // along some axis, so their boxes are at least (s - 1) * cellSize -
+    // maxHalfExtent away.
+    int32_t c[3] = { coord(point.x), coord(point.y), coord(point.z) };
+    int32_t first = 0, last = 0;
+    for (int a = 0; a < 3; ++a) {
+        first = std::max(first, std::max(occupiedMin_[a] - c[a], c[a] - occupiedMax_[a]));
+        last = std::max(last, std::max(occupiedMax_[a] - c[a], c[a] - occupiedMin_[a]));
+    }
+    // Lower bound on the distance from point to anything in a cell: the gap
+    // to the cell padded by the largest half extent, per axis
+    auto gap = [&](int32_t cell, float v) {
+        float lo = (float)cell * cellSize_ - maxHalfExtent_;
+        float g = std::max(std::max(lo - v, v - (lo + cellSize_ + 2.0f * maxHalfExtent_)), 0.0f);
+        return g * g;
+    };
+
+    // A ring's cells that could still matter are collected with their bound
+    // (prefetching their table slot), then visited nearest first until the
+    // bound reaches the k-th distance
+    struct Candidate {
+        float bound;
+        int32_t x, y, z;
+    };
+    constexpr int BATCH = 64;
+    Candidate batch[BATCH];
+    int batchSize = 0;
+    auto visitBatch = [&]() {
+        std::sort(batch, batch + batchSize, [](const Candidate& a, const Candidate& b) { return a.bound < b.bound; });
+        for (int i = 0; i < batchSize; ++i) {
+            const Candidate& candidate = batch[i];
+            if (count == k ? candidate.bound >= out[k - 1].distanceSquared : candidate.bound > maxDistanceSquared) break;
+            uint32_t slot = findCell(candidate.x, candidate.y, candidate.z);
+            if (slot == NULL_CELL) continue;
+            const Cell& cell = table_[slot];
+            float limit = count == k ? std::min(out[k - 1].distanceSquared, maxDistanceSquared) : maxDistanceSquared;
+            const Block* blocks = &blocks_[cell.firstBlock];
+            forEachWithin(blocks, blocks->count, point, limit, consider);
+        }
+        batchSize = 0;
+    };
+    auto addCell = [&](int32_t x, int32_t y, int32_t z, float boundXY, float bound) {
+        float cellBound = boundXY + gap(z, point.z);
+        if (cellBound > bound) return;
+#ifdef MATH_SSE2
+        _mm_prefetch((const char*)&table_[hashCell(x, y, z) & (table_.size() - 1)], _MM_HINT_T0);
+#endif
+        batch[batchSize++] = { cellBound, x, y, z };
+        if (batchSize == BATCH) visitBatch();
+    };
+
+    for (int32_t s = first; s <= last; ++s) {
+        float reached = (float)(s - 1) * cellSize_ - maxHalfExtent_;
+        if (reached > 0.0f && reached * reached > maxDistanceSquared) break;
+        if (count == k && reached > 0.0f && reached * reached >= out[k - 1].distanceSquared) break;
+        float bound = count == k ? std::min(out[k - 1].distanceSquared, maxDistanceSquared) : maxDistanceSquared;
+
+        int32_t lo[3], hi[3];
+        for (int a = 0; a < 3; ++a) {
+            lo[a] = std::max(c[a] - s, occupiedMin_[a]);
+            hi[a] = std::min(c[a] + s, occupiedMax_[a]);
+        }
+        for (int32_t y = lo[1]; y <= hi[1]; ++y) {
+            for (int32_t x = lo[0]; x <= hi[0]; ++x) {
+                float boundXY = gap(x, point.x) + gap(y, point.y);
+                if (boundXY > bound) continue;
+                if (x == c[0] - s || x == c[0] + s || y == c[1] - s || y == c[1] + s) {
+                    for (int32_t z = lo[2]; z <= hi[2]; ++z) addCell(x, y, z, boundXY, bound);
+                } else {
+                    // Inside the ring in x and y: only its two z faces
+                    if (c[2] - s >= lo[2]) addCell(x, y, c[2] - s, boundXY, bound);
+                    if (s > 0 && c[2] + s <= hi[2]) addCell(x, y, c[2] + s, boundXY, bound);
+                }
+            }
+        }
+        visitBatch();
+    }
+    return count;
+}
+
+void SpatialHash::queryNearest(const Vec3* points, size_t count, size_t k, float maxDistance, Neighbor* out,
+                               uint32_t* found) const {
+    if (k == 0) {
+        std::fill(found, found + count, 0u);
+        return;
+    }
+    std::vector<uint32_t> order;
+    std::vector<Vec3> sorted;
+    sortByCell(points, count, order, sorted);
+
+    // A group's points share a cell, so the blocks of the 3x3x3 cells around
+    // it are listed once and each point tests all of them in one pass, the
+    // k-th's distance tightening the limit between chunks. Items beyond a
+    // cap are skipped so most misses are never sorted in; a point with fewer
+    // than k inside it searches again without. Anything outside the 3x3x3 is
+    // at least the point's distance to its faces away, so a point whose k-th
+    // is beyond that runs the single query instead.
+    float maxDistanceSquared = maxDistance * maxDistance;
+    float firstCap = std::min(0.5625f * cellSize_ * cellSize_, maxDistanceSquared); // (0.75 * cellSize)^2
+    std::vector<Neighbor> best(k);
+    std::vector<const Block*> groupBlocks;
+    uint32_t hits[(COLLECT_BLOCKS + 1) * LANES];
+    float distances[(COLLECT_BLOCKS + 1) * LANES];
+    // Groups come in x order along a row, so the columns of cells the next
+    // group shares with this one are kept rather than looked up again
+    struct Column {
+        int32_t x = MAX_COORD;
+        CellSpan cells[9];
+    };
+    Column columns[4];
+    int32_t rowLo[2] = { 0, 0 }, rowHi[2] = { -1, -1 }; // y and z range of the kept columns
+
+    // Results go out in sorted order, then are copied back in one pass:
+    // writing each point's straight to out would scatter over the whole array
+    std::vector<Neighbor> sortedOut(count * k);
+    std::vector<uint32_t> sortedFound(count);
+    forEachGroup(sorted, [&](size_t first, size_t size) {
+        const Vec3& home = sorted[first];
+        int32_t c[3] = { coord(home.x), coord(home.y), coord(home.z) };
+        int32_t lo[3], hi[3];
+        bool gathered = occupiedCells_ > 0;
+        for (int a = 0; a < 3; ++a) {
+            lo[a] = std::max(c[a] - 1, occupiedMin_[a]);
+            hi[a] = std::min(c[a] + 1, occupiedMax_[a]);
+            gathered = gathered && lo[a] <= hi[a];
+        }
+        if (!gathered) {
+            for (size_t j = first; j < first + size; ++j) {
+                sortedFound[j] = (uint32_t)queryNearest(sorted[j], k, maxDistance, &sortedOut[j * k]);
+            }
+            return;
+        }
+
+        if (lo[1] != rowLo[0] || hi[1] != rowHi[0] || lo[2] != rowLo[1] || hi[2] != rowHi[1]) {
+            for (Column& column : columns) column.x = MAX_COORD;
+            rowLo[0] = lo[1]; rowHi[0] = hi[1];
+            rowLo[1] = lo[2]; rowHi[1] = hi[2];
+        }
+        groupBlocks.clear();
+        int columnSize = (hi[1] - lo[1] + 1) * (hi[2] - lo[2] + 1);
+        for (int32_t x = lo[0]; x <= hi[0]; ++x) {
+            Column& column = columns[x & 3];
+            if (column.x != x) {
+                int32_t columnLo[3] = { x, lo[1], lo[2] }, columnHi[3] = { x, hi[1], hi[2] };
+                gatherCells(columnLo, columnHi, column.cells);
+                column.x = x;
+            }
+            for (const CellSpan* cell = column.cells; cell != column.cells + columnSize; ++cell) {
+                for (const Block* block = cell->begin; block != cell->end; ++block) groupBlocks.push_back(block);
+            }
+        }
+
+        for (size_t j = first; j < first + size; ++j) {
+            const Vec3& p = sorted[j];
+            uint32_t n;
+            float cap = firstCap, limit; // limit drops to the k-th's distance once there are k
+            auto consider = [&](uint32_t item, float d) {
+                if (n == k && d >= best[k - 1].distanceSquared) return;
+                size_t i = n < k ? n++ : k - 1;
+                for (; i > 0 && best[i - 1].distanceSquared > d; --i) best[i] = best[i - 1];
+                best[i] = { item, d };
+                if (n == k) limit = std::min(best[k - 1].distanceSquared, cap);
+            };
+            auto search = [&]() {
+                n = 0;
+                limit = cap;
+                forEachWithin(large_.data(), largeCount_, p, limit, consider);
+                for (size_t b = 0; b < groupBlocks.size(); b += COLLECT_BLOCKS) {
+                    size_t listed = std::min(groupBlocks.size() - b, COLLECT_BLOCKS);
+                    uint32_t hitCount = collectWithin(&groupBlocks[b], listed, p, limit, hits, distances);
+                    for (uint32_t i = 0; i < hitCount; ++i) consider(hits[i], distances[i]);
+                }
+            };
+            search();
+            if (n < k && cap < maxDistanceSquared) {
+                // Fewer than k within the cap: search again without it
+                cap = maxDistanceSquared;
+                search();
+            }
+
+            // Nearest distance from p to an item outside the 3x3x3, if any can be
+            float outside = std::numeric_limits<float>::infinity();
+            for (int a = 0; a < 3; ++a) {
+                if (occupiedMin_[a] < lo[a]) outside = std::min(outside, p[a] - (float)lo[a] * cellSize_);
+                if (occupiedMax_[a] > hi[a]) outside = std::min(outside, (float)(hi[a] + 1) * cellSize_ - p[a]);
+            }
+            outside -= maxHalfExtent_;
+            bool complete = outside > 0.0f && (n == k ? limit <= outside * outside : limit < outside * outside);
+            if (complete) {
+                std::copy(best.begin(), best.begin() + n, &sortedOut[j * k]);
+                sortedFound[j] = n;
+            } else {
+                sortedFound[j] = (uint32_t)queryNearest(p, k, maxDistance, &sortedOut[j * k]);
+            }
+        }
+    });
+
+    // rank[i] is where point i went in sorted order; reading from there keeps
+    // the writes to out sequential
+    std::vector<uint32_t> rank(count);
+    for (size_t j = 0; j < count; ++j) rank[order[j]] = (uint32_t)j;
+    for (size_t i = 0; i < count; ++i) {
+        size_t j = rank[i];
+        found[i] = sortedFound[j];
+        std::copy(&sortedOut[j * k], &sortedOut[j * k] + sortedFound[j], out + i * k);
+    }
+}
+
+void SpatialHash::gatherCells(const int32_t lo[3], const int32_t hi[3], CellSpan* cells) const {
+    int32_t sizeX = hi[0] - lo[0] + 1, sizeY = hi[1] - lo[1] + 1, sizeZ = hi[2] - lo[2] + 1;
+    std::fill(cells, cells + (size_t)sizeX * sizeY * sizeZ, CellSpan{ nullptr, nullptr });
+    visitRange(lo, hi, [&](const Cell& cell, const Block* blocks, uint32_t count) {
+        CellSpan& span = cells[((cell.z - lo[2]) * sizeY + (cell.y - lo[1])) * sizeX + (cell.x - lo[0])];
+        span = { blocks, blocks + (count + LANES - 1) / LANES };
+    });
+}
+
+void SpatialHash::sortByCell(const Vec3* points, size_t count, std::vector<uint32_t>& order,
+                             std::vector<Vec3>& sorted) const {
+    // Key on cell coordinates relative to the occupied range, clamped to 10
+    // bits each; points outside it just sort near its edge, which only costs
+    // some locality. Sorted by radix, ten bits a pass.
+    auto field = [](int32_t c, int32_t min) { return (uint32_t)std::min(std::max(c - min + 1, 0), 1023); };
+    std::vector<uint64_t> keys(count), scratch(count);
+    for (size_t i = 0; i < count; ++i) {
+        uint64_t cell = field(coord(points[i].z), occupiedMin_[2]) << 20 | field(coord(points[i].y), occupiedMin_[1]) << 10
+                      | field(coord(points[i].x), occupiedMin_[0]);
+        keys[i] = cell << 32 | i;
+    }
+    for (int shift = 32; shift < 62; shift += 10) {
+        size_t offsets[1024] = {};
+        for (uint64_t key : keys) ++offsets[(key >> shift) & 1023];
+        size_t sum = 0;
+        for (size_t& offset : offsets) {
+            size_t bucket = offset;
+            offset = sum;
+            sum += bucket;
+        }
+        for (uint64_t key : keys) scratch[offsets[(key >> shift) & 1023]++] = key;
+        keys.swap(scratch);
+    }
+    order.resize(count);
+    sorted.resize(count);
+    for (size_t i = 0; i < count; ++i) {
+        order[i] = (uint32_t)keys[i];
+        sorted[i] = points[order[i]];
+    }
+}
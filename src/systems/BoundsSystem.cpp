@@ -0,0 +1,107 @@
+#include "systems/BoundsSystem.h"
+#include "components/TransformComponent.h"
+#include "components/MeshRendererComponent.h"
+#include "math/AabbTree.h"
+#include "math/SpatialHash.h"
+#include "Mesh.h"
+#include "../Scene.h"
+
+BoundsSystem::BoundsSystem() {
+    reads<TransformComponent, MeshRendererComponent>();
+    writesResource(BOUNDS_TREE);
+    writesResource(SPATIAL_INDEX);
+    writesResource(BOUNDS_WATCH_LIST);
+}
+
+void BoundsSystem::update(Scene& scene, float) {
+    refreshed_ = reinserted_ = 0;
+    updated_.clear();
+    EntityRegistry& registry = scene.getRegistry();
+    TransformStore& transforms = scene.getTransforms();
+
+    ComponentTypeId rendererType = getComponentTypeId<MeshRendererComponent>();
+    registry.takeChanged(rendererType, changed_);
+    uint32_t version = registry.getStructureVersion(rendererType);
+    if (!built_ || version != structureVersion_) {
+        registry.setChangeTracking(rendererType, true);
+        rescan(scene); // Also drops pending transform moves
+        ++rescans_;
+        structureVersion_ = version;
+        built_ = true;
+        return;
+    }
+
+    for (EntityId entity : changed_) {
+        if (entity < proxyOf_.size()) refresh(scene, entity);
+    }
+    transforms.takeMovedWatched(TransformStore::BOUNDS_WATCH, moved_);
+    for (uint32_t slot : moved_) {
+        EntityId entity = transforms.getOwner(slot);
+        if (entity < proxyOf_.size() && proxyOf_[entity] != AabbTree::NULL_NODE) refresh(scene, entity);
+    }
+}
+
+void BoundsSystem::rescan(Scene& scene) {
+    EntityRegistry& registry = scene.getRegistry();
+    TransformStore& transforms = scene.getTransforms();
+    AabbTree& tree = scene.getBoundsTree();
+
+    // Proxies are kept across rescans (entities added or removed elsewhere
+    // leave the rest of the tree alone); every renderer is refreshed, which
+    // also covers a snapshot restore rewriting meshes and transforms
+    if (proxyOf_.size() < registry.getCapacity()) {
+        proxyOf_.resize(registry.getCapacity(), AabbTree::NULL_NODE);
+        itemOf_.resize(registry.getCapacity(), SpatialHash::NULL_ITEM);
+        seen_.resize(registry.getCapacity(), 0);
+    }
+    ++scan_;
+    transforms.clearWatched(TransformStore::BOUNDS_WATCH);
+    for (Archetype* archetype : registry.getMatchingArchetypes(componentMask<TransformComponent, MeshRendererComponent>())) {
+        for (uint32_t row = 0; row < archetype->size(); ++row) {
+            EntityId entity = archetype->getEntity(row);
+            seen_[entity] = scan_;
+            transforms.setWatched(TransformStore::BOUNDS_WATCH, registry.get<TransformComponent>(entity)->getSlot(), true);
+            refresh(scene, entity);
+        }
+    }
+
+    // Entities destroyed or stripped of their renderer since the last scan
+    for (EntityId entity = 0; entity < proxyOf_.size(); ++entity) {
+        if (proxyOf_[entity] == AabbTree::NULL_NODE || seen_[entity] == scan_) continue;
+        tree.destroyProxy(proxyOf_[entity]);
+        proxyOf_[entity] = AabbTree::NULL_NODE;
+        scene.getSpatialIndex().remove(itemOf_[entity]);
+    }
+}
+
+void BoundsSystem::refresh(Scene& scene, EntityId entity) {
+    EntityRegistry& registry = scene.getRegistry();
+    AabbTree& tree = scene.getBoundsTree();
+    SpatialHash& grid = scene.getSpatialIndex();
+    const MeshRendererComponent* renderer = registry.get<MeshRendererComponent>(entity);
+    int32_t& proxy = proxyOf_[entity];
+
+    updated_.push_back(entity);
+
+    // Disabled or empty renderers draw nothing and can't be picked
+    if (!renderer || !renderer->enabled || !renderer->mesh) {
+        if (proxy != AabbTree::NULL_NODE) {
+            tree.destroyProxy(proxy);
+            proxy = AabbTree::NULL_NODE;
+            grid.remove(itemOf_[entity]);
+        }
+        return;
+    }
+
+    ++refreshed_;
+    const Mat4& world = registry.get<TransformComponent>(entity)->getWorldMatrix();
+    Aabb box = renderer->mesh->getBounds().transformed(world);
+    if (proxy == AabbTree::NULL_NODE) {
+        proxy = tree.createProxy(box, entity);
+        itemOf_[entity] = grid.insert(box, entity);
+        ++reinserted_;
+    } else {
+        if (tree.moveProxy(proxy, box)) ++reinserted_;
+        grid.move(itemOf_[entity], box);
+    }
+}
@@ -0,0 +1,257 @@
+#include "systems/LightGatherSystem.h"
+#include "components/TransformComponent.h"
+#include "components/LightComponent.h"
+#include "math/SpatialHash.h"
+#include "../Scene.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    constexpr float BASE_AMBIENT = 0.02f;
+}
+
+LightGatherSystem::LightGatherSystem() {
+    reads<TransformComponent, LightComponent>();
+    writesResource(LIGHT_WATCH_LIST);
+}
+
+void LightGatherSystem::update(Scene& scene, float) {
+    refreshed_ = 0;
+    EntityRegistry& registry = scene.getRegistry();
+    TransformStore& transforms = scene.getTransforms();
+
+    ComponentTypeId lightType = getComponentTypeId<LightComponent>();
+    registry.takeChanged(lightType, changed_);
+    uint32_t version = registry.getStructureVersion(lightType);
+    if (!built_ || version != structureVersion_) {
+        registry.setChangeTracking(lightType, true);
+        rebuild(scene); // Also drops pending transform moves
+        structureVersion_ = version;
+        built_ = true;
+    } else {
+        for (EntityId entity : changed_) {
+            if (entity < trackedOf_.size() && trackedOf_[entity] != NO_INDEX) refresh(scene, trackedOf_[entity]);
+        }
+        transforms.takeMovedWatched(TransformStore::LIGHT_WATCH, moved_);
+        for (uint32_t slot : moved_) {
+            if (slot < trackedOfSlot_.size() && trackedOfSlot_[slot] != NO_INDEX) refresh(scene, trackedOfSlot_[slot]);
+        }
+    }
+
+    if (ambientDirty_) {
+        ambient_[0] = ambient_[1] = ambient_[2] = BASE_AMBIENT;
+        for (const Tracked& light : tracked_) {
+            if (light.kind != Kind::Ambient) continue;
+            ambient_[0] += light.ambient[0];
+            ambient_[1] += light.ambient[1];
+            ambient_[2] += light.ambient[2];
+        }
+        ambientDirty_ = false;
+    }
+}
+
+bool LightGatherSystem::takeDirtyRange(size_t& begin, size_t& end) {
+    dirtyEnd_ = std::min(dirtyEnd_, lights_.size()); // Removals may have shrunk the array
+    if (dirtyBegin_ >= dirtyEnd_) return false;
+    begin = dirtyBegin_;
+    end = dirtyEnd_;
+    dirtyBegin_ = dirtyEnd_ = 0;
+    return true;
+}
+
+void LightGatherSystem::rebuild(Scene& scene) {
+    EntityRegistry& registry = scene.getRegistry();
+    TransformStore& transforms = scene.getTransforms();
+
+    transforms.clearWatched(TransformStore::LIGHT_WATCH);
+    tracked_.clear();
+    lights_.clear();
+    lightOwner_.clear();
+    directionalCount_ = 0;
+    ++lightsVersion_;
+    trackedOf_.assign(registry.getCapacity(), NO_INDEX);
+    trackedOfSlot_.assign(transforms.getSlotCount(), NO_INDEX);
+    dirtyBegin_ = dirtyEnd_ = 0;
+    ambientDirty_ = true;
+
+    // Disabled lights are tracked too, so enabling one later is a refresh
+    for (Archetype* archetype : registry.getMatchingArchetypes(componentMask<TransformComponent, LightComponent>())) {
+        for (uint32_t row = 0; row < archetype->size(); ++row) {
+            EntityId entity = archetype->getEntity(row);
+            uint32_t slot = registry.get<TransformComponent>(entity)->getSlot();
+            uint32_t index = (uint32_t)tracked_.size();
+            tracked_.push_back({ entity, slot, NO_INDEX, Kind::None, { 0.0f, 0.0f, 0.0f } });
+            trackedOf_[entity] = index;
+            trackedOfSlot_[slot] = index;
+            transforms.setWatched(TransformStore::LIGHT_WATCH, slot, true);
+            refresh(scene, index);
+        }
+    }
+}
+
+void LightGatherSystem::refresh(Scene& scene, uint32_t trackedIndex) {
+    EntityRegistry& registry = scene.getRegistry();
+    Tracked& tracked = tracked_[trackedIndex];
+    const LightComponent* light = registry.get<LightComponent>(tracked.entity);
+    TransformComponent* transform = registry.get<TransformComponent>(tracked.entity);
+    ++refreshed_;
+
+    Kind kind = Kind::None;
+    if (light->enabled) {
+        switch (light->type) {
+        case LightComponent::Type::Directional: kind = Kind::Directional; break;
+        case LightComponent::Type::Point: kind = Kind::Point; break;
+        case LightComponent::Type::Ambient: kind = Kind::Ambient; break;
+        default: break; // Spot lights aren't shaded yet
+        }
+    }
+
+    // Color with intensity
+    float color[3] = { light->color[0] * light->intensity, light->color[1] * light->intensity, light->color[2] * light->intensity };
+
+    if (tracked.kind == Kind::Ambient || kind == Kind::Ambient) ambientDirty_ = true;
+    tracked.kind = kind;
+    if (kind == Kind::Ambient) {
+        tracked.ambient[0] = color[0]; tracked.ambient[1] = color[1]; tracked.ambient[2] = color[2];
+    }
+    ++lightsVersion_;
+    if (kind != Kind::Directional && kind != Kind::Point) {
+        removeLight(trackedIndex);
+        return;
+    }
+
+    // Directional lights sit before the point lights; switching type moves groups
+    bool directional = kind == Kind::Directional;
+    if (tracked.lightIndex != NO_INDEX && (tracked.lightIndex < directionalCount_) != directional) {
+        removeLight(trackedIndex);
+    }
+    if (tracked.lightIndex == NO_INDEX) addLight(trackedIndex, directional);
+    GpuLight& gpu = lights_[tracked.lightIndex];
+    if (kind == Kind::Directional) {
+        // Shines along the transform's -Z, taken from the world matrix so no
+        // trig is needed and parent rotations apply
+        Vec3 direction = normalize(transform->getWorldMatrix().transformVector(Vec3(0.0f, 0.0f, -1.0f)));
+        gpu.position[0] = direction.x;
+        gpu.position[1] = direction.y;
+        gpu.position[2] = direction.z;
+        gpu.position[3] = TYPE_DIRECTIONAL;
+    } else {
+        // World position so lights parented to moving objects follow them
+        transform->getWorldPosition(gpu.position);
+        gpu.position[3] = TYPE_POINT;
+    }
+    gpu.color[0] = color[0]; gpu.color[1] = color[1]; gpu.color[2] = color[2];
+    gpu.color[3] = light->range;
+    markDirty(tracked.lightIndex);
+}
+
+void LightGatherSystem::addLight(uint32_t trackedIndex, bool directional) {
+    uint32_t index = (uint32_t)lights_.size();
+    lights_.emplace_back();
+    lightOwner_.push_back(trackedIndex);
+    if (directional) {
+        // The first point light moves to the end to make room
+        if (index != directionalCount_) {
+            moveLight((uint32_t)directionalCount_, index);
+            index = (uint32_t)directionalCount_;
+            lightOwner_[index] = trackedIndex;
+        }
+        ++directionalCount_;
+    }
+    tracked_[trackedIndex].lightIndex = index;
+}
+
+void LightGatherSystem::removeLight(uint32_t trackedIndex) {
+    Tracked& tracked = tracked_[trackedIndex];
+    if (tracked.lightIndex == NO_INDEX) return;
+
+    // Swap-and-pop within the light's group keeps the array packed; only the
+    // moved entries are re-uploaded
+    uint32_t index = tracked.lightIndex;
+    uint32_t last = (uint32_t)lights_.size() - 1;
+    if (index < directionalCount_) {
+        uint32_t lastDirectional = (uint32_t)directionalCount_ - 1;
+        if (index != lastDirectional) moveLight(lastDirectional, index);
+        index = lastDirectional;
+        --directionalCount_;
+    }
+    if (index != last) moveLight(last, index);
+    lights_.pop_back();
+    lightOwner_.pop_back();
+    tracked.lightIndex = NO_INDEX;
+}
+
+void LightGatherSystem::moveLight(uint32_t from, uint32_t to) {
+    lights_[to] = lights_[from];
+    lightOwner_[to] = lightOwner_[from];
+    tracked_[lightOwner_[to]].lightIndex = to;
+    markDirty(to);
+}
+
+void LightGatherSystem::markDirty(size_t index) {
+    if (dirtyBegin_ >= dirtyEnd_) {
+        dirtyBegin_ = index;
+        dirtyEnd_ = index + 1;
+    } else {
+        dirtyBegin_ = std::min(dirtyBegin_, index);
+        dirtyEnd_ = std::max(dirtyEnd_, index + 1);
+    }
+}
+
+void LightGatherSystem::assignLights(const SpatialHash& objects) {
+    if (&objects == assignedObjects_ && objects.getVersion() == assignedObjectsVersion_ &&
+        lightsVersion_ == assignedLightsVersion_) {
+        return;
+    }
+    assignedObjects_ = &objects;
+    assignedObjectsVersion_ = objects.getVersion();
+    assignedLightsVersion_ = lightsVersion_;
+
+    ++assignStamp_;
+    objectLights_.clear();
+    objectWeights_.clear();
+
+    // Point lights fall off to zero at their range (see the lit shader), so
+    // only objects within it need them
+    for (size_t i = directionalCount_; i < lights_.size(); ++i) {
+        const GpuLight& light = lights_[i];
+        float range = light.color[3];
+        if (!(range > 0.0f)) continue;
+        Vec3 position(light.position[0], light.position[1], light.position[2]);
+        float brightness = std::max(std::max(light.color[0], light.color[1]), light.color[2]);
+        objects.queryRadius(position, range, [&](uint32_t item) {
+            // Same attenuation as the shader, at the object's nearest point
+            float x = objects.getBounds(item).distanceSquared(position) / (range * range);
+            float window = std::max(1.0f - x * x, 0.0f);
+            addObjectLight(objects.getUserData(item), (int)i, brightness * window * window / (1.0f + x));
+        });
+    }
+}
+
+void LightGatherSystem::addObjectLight(EntityId entity, int light, float weight) {
+    if (entity >= listStamp_.size()) {
+        listStamp_.resize(entity + 1, 0);
+        listOf_.resize(entity + 1, 0);
+    }
+    if (listStamp_[entity] != assignStamp_) {
+        // First light for this object this time
+        listStamp_[entity] = assignStamp_;
+        listOf_[entity] = (uint32_t)objectLights_.size();
+        objectLights_.emplace_back();
+        objectWeights_.resize(objectWeights_.size() + MAX_OBJECT_LIGHTS, INFINITY);
+    }
+
+    ObjectLights& list = objectLights_[listOf_[entity]];
+    float* weights = &objectWeights_[(size_t)listOf_[entity] * MAX_OBJECT_LIGHTS];
+    if (list.count < MAX_OBJECT_LIGHTS) {
+        weights[list.count] = weight;
+        list.lights[list.count++] = light;
+        return;
+    }
+    // Full: replace the dimmest light if this one is brighter
+    int dimmest = (int)(std::min_element(weights, weights + MAX_OBJECT_LIGHTS) - weights);
+    if (weight > weights[dimmest]) {
+        weights[dimmest] = weight;
+        list.lights[dimmest] = light;
+    }
+}
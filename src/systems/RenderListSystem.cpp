@@ -0,0 +1,139 @@
+#include "systems/RenderListSystem.h"
+#include "systems/BoundsSystem.h"
+#include "components/TransformComponent.h"
+#include "components/MeshRendererComponent.h"
+#include "components/MaterialComponent.h"
+#include "JobSystem.h"
+#include "Mesh.h"
+#include "../Scene.h"
+#include <algorithm>
+#include <cstring>
+
+namespace {
+    // Objects per culling job; a multiple of 8 so every chunk but the last stays on the SIMD path
+    constexpr size_t CULL_CHUNK = 4096;
+}
+
+RenderListSystem::RenderListSystem() {
+    reads<TransformComponent, MeshRendererComponent, MaterialComponent>();
+    // Follows the BoundsSystem's refreshed entities
+    readsResource(BOUNDS_TREE);
+}
+
+void RenderListSystem::update(Scene& scene, float) {
+    refreshed_ = 0;
+    EntityRegistry& registry = scene.getRegistry();
+    const BoundsSystem* boundsSystem = scene.getSystems().get<BoundsSystem>();
+
+    ComponentTypeId materialType = getComponentTypeId<MaterialComponent>();
+    registry.takeChanged(materialType, changed_);
+    uint32_t rendererVersion = registry.getStructureVersion(getComponentTypeId<MeshRendererComponent>());
+    uint32_t materialVersion = registry.getStructureVersion(materialType);
+    // Without a running BoundsSystem there is nothing to follow, so every frame rebuilds
+    bool following = boundsSystem && boundsSystem->enabled;
+    if (!built_ || !following || rendererVersion != rendererVersion_ || materialVersion != materialVersion_ ||
+        boundsSystem->getRescanCount() != boundsRescans_) {
+        registry.setChangeTracking(materialType, true);
+        rebuild(scene);
+        rendererVersion_ = rendererVersion;
+        materialVersion_ = materialVersion;
+        boundsRescans_ = following ? boundsSystem->getRescanCount() : 0;
+        built_ = following;
+        return;
+    }
+
+    for (EntityId entity : boundsSystem->getUpdated()) refresh(scene, entity);
+    for (EntityId entity : changed_) {
+        if (entity < itemOf_.size() && itemOf_[entity] != NO_ITEM) loadMaterial(registry, items[itemOf_[entity]]);
+    }
+}
+
+void RenderListSystem::rebuild(Scene& scene) {
+    items.clear();
+    bounds.clear();
+    itemOf_.assign(scene.getRegistry().getCapacity(), NO_ITEM);
+
+    // Linear sweep over archetypes with an enabled mesh renderer
+    scene.view<TransformComponent, MeshRendererComponent>().each(
+        [&](GameObject* go, TransformComponent&, MeshRendererComponent& meshRenderer) {
+        // Skip if no mesh assigned
+        if (meshRenderer.mesh) refresh(scene, go->getEntity());
+    });
+}
+
+void RenderListSystem::refresh(Scene& scene, EntityId entity) {
+    EntityRegistry& registry = scene.getRegistry();
+    const MeshRendererComponent* renderer = registry.get<MeshRendererComponent>(entity);
+    if (entity >= itemOf_.size()) itemOf_.resize(registry.getCapacity(), NO_ITEM);
+    uint32_t& index = itemOf_[entity];
+
+    // Same rule as the BoundsSystem: disabled or empty renderers draw nothing
+    if (!renderer || !renderer->enabled || !renderer->mesh) {
+        if (index != NO_ITEM) removeItem(index);
+        return;
+    }
+
+    ++refreshed_;
+    const Mesh& mesh = *renderer->mesh;
+    uint32_t slot = registry.get<TransformComponent>(entity)->getSlot();
+    const Mat4& world = scene.getTransforms().getWorldMatrix(slot);
+    // The mesh's sphere is centred on its box, so both share the box's world centre
+    Aabb box = mesh.getBounds().transformed(world);
+    float radius = mesh.getBoundingSphere().transformed(world).radius;
+    if (index == NO_ITEM) {
+        index = (uint32_t)items.size();
+        items.push_back({ entity, renderer->mesh.get(), slot, {}, 0.0f, 0.0f });
+        bounds.add(box, radius);
+    } else {
+        items[index].mesh = renderer->mesh.get();
+        items[index].transformSlot = slot;
+        bounds.set(index, box, radius);
+    }
+    loadMaterial(registry, items[index]);
+}
+
+void RenderListSystem::loadMaterial(EntityRegistry& registry, DrawItem& item) {
+    // Default material
+    MaterialData values;
+    MaterialComponent* mat = registry.get<MaterialComponent>(item.entity);
+    if (mat && mat->enabled) values = mat->data.get();
+    item.albedo[0] = values.albedo[0]; item.albedo[1] = values.albedo[1]; item.albedo[2] = values.albedo[2];
+    item.metallic = values.metallic;
+    item.roughness = values.roughness;
+}
+
+void RenderListSystem::removeItem(uint32_t index) {
+    itemOf_[items[index].entity] = NO_ITEM;
+    if (index + 1 != items.size()) {
+        items[index] = items.back();
+        itemOf_[items[index].entity] = index;
+    }
+    items.pop_back();
+    bounds.remove(index);
+}
+
+size_t RenderListSystem::cull(const Frustum& frustum, JobSystem* jobs, std::vector<uint32_t>& visible) {
+    size_t count = items.size();
+    visible.resize(count);
+    if (!jobs || jobs->getThreadCount() <= 1 || count <= CULL_CHUNK) {
+        visible.resize(cullBoxes(frustum, bounds, 0, count, visible.data()));
+        return visible.size();
+    }
+
+    // Each chunk compacts into its own part of visible, then the parts are joined
+    size_t chunks = (count + CULL_CHUNK - 1) / CULL_CHUNK;
+    chunkVisible_.resize(chunks);
+    jobs->parallelFor(chunks, [&](size_t begin, size_t end) {
+        for (size_t c = begin; c < end; ++c) {
+            size_t first = c * CULL_CHUNK;
+            chunkVisible_[c] = cullBoxes(frustum, bounds, first, std::min(first + CULL_CHUNK, count), visible.data() + first);
+        }
+    });
+    size_t total = chunkVisible_[0];
+    for (size_t c = 1; c < chunks; ++c) {
+        std::memmove(visible.data() + total, visible.data() + c * CULL_CHUNK, chunkVisible_[c] * sizeof(uint32_t));
+        total += chunkVisible_[c];
+    }
+    visible.resize(total);
+    return total;
+}
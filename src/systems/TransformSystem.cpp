@@ -0,0 +1,14 @@
+#include "systems/TransformSystem.h"
+#include "components/TransformComponent.h"
+#include "../Scene.h"
+
+TransformSystem::TransformSystem() {
+    writes<TransformComponent>();
+    // Rebuilt slots are reported to the watch lists
+    writesResource(BOUNDS_WATCH_LIST);
+    writesResource(LIGHT_WATCH_LIST);
+}
+
+void TransformSystem::update(Scene& scene, float) {
+    updated_ = scene.updateTransforms();
+}
@@ -20,42 +20,107 @@ void InspectorPanel::render(Scene* scene) {
     }
     
     auto& gameObjects = scene->getGameObjects();
-    ImGui::Text("Objects: %zu", gameObjects.size());
+    const Selection& selection = scene->getSelection();
+    if (selection.size() > 1) ImGui::Text("Objects: %zu (%zu selected)", gameObjects.size(), selection.size());
+    else ImGui::Text("Objects: %zu", gameObjects.size());
     ImGui::Separator();
     
-    // List instances (clickable to select)
-    for (size_t i = 0; i < gameObjects.size(); ++i) {
-        ImGui::PushID((int)i);
-        
-        // Display object name with vertex count
-        char label[128];
-        auto* meshRenderer = gameObjects[i]->getComponent<MeshRendererComponent>();
-        unsigned int vertCount = (meshRenderer && meshRenderer->mesh) ? meshRenderer->mesh->getVertexCount() : 0;
-        snprintf(label, sizeof(label), "%s (%u verts)", 
-                 gameObjects[i]->getName().c_str(), 
-                 vertCount);
-        
-        bool isSelected = (scene->getSelectedIndex() == (int)i);
-        if (ImGui::Selectable(label, isSelected)) {
-            scene->setSelectedIndex((int)i);
-        }
-        
-        // Right-click context menu
-        if (ImGui::BeginPopupContextItem()) {
-            if (ImGui::MenuItem("Rename")) {
-                renamingIndex_ = (int)i;
-                // Copy current name to buffer
-                strncpy(renameBuffer_, gameObjects[i]->getName().c_str(), sizeof(renameBuffer_) - 1);
-                renameBuffer_[sizeof(renameBuffer_) - 1] = '\0';
+    // Tree of instances (clickable to select, Ctrl+click to add or remove,
+    // drag onto another row to parent)
+    // Only the rows that are actually visible are submitted, so large scenes stay cheap
+    buildRows(scene);
+    const auto& nodes = scene->getTransforms().getNodes();
+    EntityRegistry& registry = scene->getRegistry();
+    TransformStore& transforms = scene->getTransforms();
+    EntityHandle reparentChild, reparentTarget;
+    bool reparent = false;
+    
+    ImGuiListClipper clipper;
+    clipper.Begin((int)rows_.size());
+    while (clipper.Step()) {
+        for (int i = clipper.DisplayStart; i < clipper.DisplayEnd; ++i) {
+            const Row& row = rows_[i];
+            const auto& node = nodes[row.node];
+            EntityHandle handle = registry.getHandle(transforms.getOwner(node.slot));
+            GameObject* go = scene->getGameObject(handle);
+            if (!go) continue;
+            ImGui::PushID(i);
+            
+            // Display object name with vertex count
+            char label[128];
+            auto* meshRenderer = go->getComponent<MeshRendererComponent>();
+            unsigned int vertCount = (meshRenderer && meshRenderer->mesh) ? meshRenderer->mesh->getVertexCount() : 0;
+            snprintf(label, sizeof(label), "%s (%u verts)", 
+                     go->getName().c_str(), 
+                     vertCount);
+            
+            // Rows are laid out flat; indentation stands in for tree pushes
+            float indent = row.depth * ImGui::GetStyle().IndentSpacing;
+            if (indent > 0.0f) ImGui::Indent(indent);
+            
+            ImGuiTreeNodeFlags flags = ImGuiTreeNodeFlags_NoTreePushOnOpen | ImGuiTreeNodeFlags_OpenOnArrow |
+                                       ImGuiTreeNodeFlags_SpanAvailWidth;
+            if (node.subtreeSize == 1) flags |= ImGuiTreeNodeFlags_Leaf;
+            if (selection.contains(handle)) flags |= ImGuiTreeNodeFlags_Selected;
+            
+            bool collapsed = collapsed_.count(handleKey(handle)) != 0;
+            ImGui::SetNextItemOpen(!collapsed);
+            bool open = ImGui::TreeNodeEx(label, flags);
+            if (ImGui::IsItemToggledOpen()) {
+                if (open) collapsed_.erase(handleKey(handle));
+                else collapsed_.insert(handleKey(handle));
+            } else if (ImGui::IsItemClicked()) {
+                if (ImGui::GetIO().KeyCtrl) scene->getSelection().toggle(handle);
+                else scene->setSelected(handle);
             }
-            ImGui::EndPopup();
+            
+            if (ImGui::BeginDragDropSource()) {
+                ImGui::SetDragDropPayload("GAMEOBJECT", &handle, sizeof(EntityHandle));
+                ImGui::Text("%s", go->getName().c_str());
+                ImGui::EndDragDropSource();
+            }
+            if (ImGui::BeginDragDropTarget()) {
+                if (const ImGuiPayload* payload = ImGui::AcceptDragDropPayload("GAMEOBJECT")) {
+                    // Applied after the loop so the node array isn't rebuilt mid-iteration
+                    memcpy(&reparentChild, payload->Data, sizeof(EntityHandle));
+                    reparentTarget = handle;
+                    reparent = true;
+                }
+                ImGui::EndDragDropTarget();
+            }
+            
+            // Right-click context menu
+            if (ImGui::BeginPopupContextItem()) {
+                if (ImGui::MenuItem("Rename")) {
+                    renaming_ = handle;
+                    // Copy current name to buffer
+                    strncpy(renameBuffer_, go->getName().c_str(), sizeof(renameBuffer_) - 1);
+                    renameBuffer_[sizeof(renameBuffer_) - 1] = '\0';
+                }
+                if (ImGui::MenuItem("Create Prefab")) {
+                    scene->createPrefab(handle);
+                }
+                if (ImGui::MenuItem("Clear Parent", nullptr, false, node.parent >= 0)) {
+                    reparentChild = handle;
+                    reparentTarget = EntityHandle();
+                    reparent = true;
+                }
+                ImGui::EndPopup();
+            }
+            
+            if (indent > 0.0f) ImGui::Unindent(indent);
+            ImGui::PopID();
         }
-        
-        ImGui::PopID();
+    }
+    
+    if (reparent) {
+        scene->setParent(reparentChild, reparentTarget);
     }
     
     // Rename popup modal
-    if (renamingIndex_ >= 0 && renamingIndex_ < (int)gameObjects.size()) {
+    // The handle goes stale if the object is deleted while the popup is open
+    GameObject* renaming = scene->getGameObject(renaming_);
+    if (renaming) {
         ImGui::OpenPopup("Rename Object");
         if (ImGui::BeginPopupModal("Rename Object", nullptr, ImGuiWindowFlags_AlwaysAutoResize)) {
             ImGui::Text("Enter new name:");
@@ -64,13 +129,13 @@ void InspectorPanel::render(Scene* scene) {
                                                   ImGuiInputTextFlags_EnterReturnsTrue);
             
             if (enterPressed || ImGui::Button("OK")) {
-                gameObjects[renamingIndex_]->setName(renameBuffer_);
-                renamingIndex_ = -1;
+                scene->renameGameObject(renaming_, renameBuffer_);
+                renaming_ = EntityHandle();
                 ImGui::CloseCurrentPopup();
             }
             ImGui::SameLine();
             if (ImGui::Button("Cancel")) {
-                renamingIndex_ = -1;
+                renaming_ = EntityHandle();
                 ImGui::CloseCurrentPopup();
             }
             
@@ -114,3 +179,24 @@ void InspectorPanel::render(Scene* scene) {
     
     ImGui::EndChild();
 }
+
+void InspectorPanel::buildRows(Scene* scene) {
+    const auto& nodes = scene->getTransforms().getNodes();
+    EntityRegistry& registry = scene->getRegistry();
+    TransformStore& transforms = scene->getTransforms();
+    rows_.clear();
+    depth_.resize(nodes.size());
+    
+    for (uint32_t p = 0; p < nodes.size();) {
+        const auto& node = nodes[p];
+        depth_[p] = node.parent < 0 ? 0 : depth_[node.parent] + 1;
+        rows_.push_back({ p, depth_[p] });
+        
+        EntityHandle handle = registry.getHandle(transforms.getOwner(node.slot));
+        if (node.subtreeSize > 1 && collapsed_.count(handleKey(handle))) {
+            p += node.subtreeSize; // Skip the hidden descendants entirely
+        } else {
+            ++p;
+        }
+    }
+}
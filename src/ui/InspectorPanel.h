@@ -1,7 +1,10 @@
 #ifndef INSPECTOR_PANEL_H
 #define INSPECTOR_PANEL_H
 
+#include <cstdint>
+#include <unordered_set>
 #include <vector>
+#include "ecs/Entity.h"
 class Mesh;
 class Scene;
 
@@ -10,7 +13,23 @@ public:
     void render(Scene* scene);
     
 private:
-    int renamingIndex_ = -1;
+    // One visible line of the hierarchy tree
+    struct Row {
+        uint32_t node;  // Position in TransformStore::getNodes()
+        uint32_t depth;
+    };
+    
+    // Flatten the hierarchy into visible rows, skipping collapsed subtrees
+    void buildRows(Scene* scene);
+    
+    static uint64_t handleKey(EntityHandle handle) {
+        return ((uint64_t)handle.generation << 32) | handle.index;
+    }
+    
+    std::vector<Row> rows_;
+    std::vector<uint32_t> depth_;
+    std::unordered_set<uint64_t> collapsed_; // Handles of collapsed tree nodes
+    EntityHandle renaming_;
     char renameBuffer_[128] = "";
 };
 
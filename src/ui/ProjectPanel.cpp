@@ -112,6 +112,13 @@ void ProjectPanel::renderDirectoryTree(const std::string& path, int depth) {
                 ImGui::TextUnformatted(name.c_str());
                 ImGui::EndDragDropSource();
             }
+            // Prefabs are dropped into the viewport to instantiate them
+            if (ext == ".prefab" && ImGui::BeginDragDropSource(ImGuiDragDropFlags_SourceAllowNullID)) {
+                std::string name = entry.path().stem().string();
+                ImGui::SetDragDropPayload("ASSET_PREFAB", name.c_str(), (name.size() + 1) * sizeof(char));
+                ImGui::TextUnformatted(name.c_str());
+                ImGui::EndDragDropSource();
+            }
         }
     }
 }
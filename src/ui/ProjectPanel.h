@@ -8,6 +8,7 @@ public:
     ProjectPanel();
     // Set the root path for the project this panel should display
     void setProjectPath(const std::string& path);
+    const std::string& getProjectPath() const { return projectPath_; }
     void render();
 
 private:
@@ -7,6 +7,7 @@
 #include "components/LightComponent.h"
 #include "components/MaterialComponent.h"
 #include "imgui.h"
+#include <vector>
 
 void PropertiesPanel::render(Scene* scene) {
     ImGui::BeginChild("Properties", ImVec2(0, 0), true);
@@ -30,30 +31,31 @@ void PropertiesPanel::render(Scene* scene) {
     ImGui::PushStyleColor(ImGuiCol_Text, ImVec4(0.8f, 0.9f, 1.0f, 1.0f));
     ImGui::Text("%s", selected->getName().c_str());
     ImGui::PopStyleColor();
+    // Several objects selected: the primary one (the last selected) is edited
+    size_t selectedCount = scene->getSelection().size();
+    if (selectedCount > 1) {
+        ImGui::TextDisabled("%zu objects selected; editing the last one", selectedCount);
+    }
     ImGui::Separator();
     ImGui::Spacing();
 
-    // Handle deferred component removal
-    if (componentToRemove_) {
-        selected->removeComponent(componentToRemove_);
-        componentToRemove_ = nullptr;
-    }
-
     // Render all components
-    auto& components = selected->getComponents();
-    for (auto& component : components) {
-        renderComponent(component.get(), component->canBeRemoved());
+    // Pointers stay valid for this loop: adds and removes are recorded in the
+    // scene's command buffer and applied at the next Scene::update
+    std::vector<Component*> components = selected->getComponents();
+    for (Component* component : components) {
+        renderComponent(scene, selected, component, component->canBeRemoved());
     }
 
     // Add Component button
     ImGui::Spacing();
     ImGui::Separator();
-    renderAddComponentMenu(selected);
+    renderAddComponentMenu(scene, selected);
 
     ImGui::EndChild();
 }
 
-void PropertiesPanel::renderComponent(Component* component, bool canRemove) {
+void PropertiesPanel::renderComponent(Scene* scene, GameObject* gameObject, Component* component, bool canRemove) {
     if (!component) return;
 
     ImGui::PushID(component);
@@ -62,11 +64,25 @@ void PropertiesPanel::renderComponent(Component* component, bool canRemove) {
     bool isOpen = ImGui::CollapsingHeader(component->getTypeName().c_str(), 
         ImGuiTreeNodeFlags_DefaultOpen | ImGuiTreeNodeFlags_AllowOverlap);
     
+    // Enable toggle (disabled components are skipped by scene views)
+    if (canRemove) {
+        ImGui::SameLine(ImGui::GetWindowWidth() - 60);
+        if (ImGui::Checkbox("##enabled", &component->enabled)) {
+            // Caches of this component type (e.g. the light array) need to know
+            scene->getRegistry().markChanged(gameObject->getEntity(),
+                scene->getRegistry().findComponentType(gameObject->getEntity(), component));
+        }
+        if (ImGui::IsItemHovered()) {
+            ImGui::SetTooltip(component->enabled ? "Disable Component" : "Enable Component");
+        }
+    }
+    
     // Remove button (if allowed) on the same line as header
     if (canRemove) {
         ImGui::SameLine(ImGui::GetWindowWidth() - 35);
         if (ImGui::SmallButton("X")) {
-            componentToRemove_ = component;
+            scene->getCommands().remove(gameObject->getHandle(),
+                scene->getRegistry().findComponentType(gameObject->getEntity(), component));
         }
         if (ImGui::IsItemHovered()) {
             ImGui::SetTooltip("Remove Component");
@@ -84,7 +100,7 @@ void PropertiesPanel::renderComponent(Component* component, bool canRemove) {
     ImGui::PopID();
 }
 
-void PropertiesPanel::renderAddComponentMenu(GameObject* gameObject) {
+void PropertiesPanel::renderAddComponentMenu(Scene* scene, GameObject* gameObject) {
     if (!gameObject) return;
 
     ImGui::Spacing();
@@ -99,7 +115,7 @@ void PropertiesPanel::renderAddComponentMenu(GameObject* gameObject) {
         // Mesh Renderer
         if (!gameObject->hasComponent<MeshRendererComponent>()) {
             if (ImGui::Selectable("Mesh Renderer")) {
-                gameObject->addComponent<MeshRendererComponent>();
+                scene->getCommands().add<MeshRendererComponent>(gameObject->getHandle());
                 ImGui::CloseCurrentPopup();
             }
         } else {
@@ -109,7 +125,7 @@ void PropertiesPanel::renderAddComponentMenu(GameObject* gameObject) {
         // Material
         if (!gameObject->hasComponent<MaterialComponent>()) {
             if (ImGui::Selectable("Material")) {
-                gameObject->addComponent<MaterialComponent>();
+                scene->getCommands().add<MaterialComponent>(gameObject->getHandle());
                 ImGui::CloseCurrentPopup();
             }
         } else {
@@ -119,7 +135,7 @@ void PropertiesPanel::renderAddComponentMenu(GameObject* gameObject) {
             // Light
             if (!gameObject->hasComponent<LightComponent>()) {
                 if (ImGui::Selectable("Light")) {
-                    gameObject->addComponent<LightComponent>();
+                    scene->getCommands().add<LightComponent>(gameObject->getHandle());
                     ImGui::CloseCurrentPopup();
                 }
             } else {
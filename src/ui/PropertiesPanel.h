@@ -3,6 +3,7 @@
 
 class Scene;
 class Component;
+class GameObject;
 
 class PropertiesPanel {
 public:
@@ -12,13 +13,11 @@ public:
     
 private:
     // Render a single component with its header
-    void renderComponent(Component* component, bool canRemove);
+    // Removal is recorded in the scene's command buffer
+    void renderComponent(Scene* scene, GameObject* gameObject, Component* component, bool canRemove);
     
     // Show the "Add Component" button and menu
-    void renderAddComponentMenu(class GameObject* gameObject);
-    
-    // Track which component to remove (deferred deletion)
-    Component* componentToRemove_ = nullptr;
+    void renderAddComponentMenu(Scene* scene, GameObject* gameObject);
 };
 
 #endif
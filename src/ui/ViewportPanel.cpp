@@ -1,17 +1,23 @@
 #include "ViewportPanel.h"
 #include "Shader.h"
 #include "Mesh.h"
+#include "math/AabbTree.h"
+#include "math/Bvh.h"
+#include "math/Frustum.h"
 #include "Camera.h"
 #include "Grid.h"
-#include "MathUtils.h"
 #include "../Scene.h"
 #include "GameObject.h"
+#include "JobSystem.h"
 #include "components/TransformComponent.h"
 #include "components/MeshRendererComponent.h"
 #include "components/MaterialComponent.h"
 #include "components/LightComponent.h"
+#include "systems/LightGatherSystem.h"
+#include "systems/RenderListSystem.h"
 #include "imgui.h"
 #include <algorithm>
+#include <chrono>
 #include <iostream>
 #include <cmath>
 #include <string>
@@ -24,13 +30,21 @@ ViewportPanel::ViewportPanel()
 
 ViewportPanel::~ViewportPanel() {
     destroyFBO();
+    for (PendingPick& pick : picks_) {
+        if (pick.fence) glDeleteSync(pick.fence);
+        if (pick.pbo) glDeleteBuffers(1, &pick.pbo);
+    }
+    if (lightTexture_) glDeleteTextures(1, &lightTexture_);
+    if (lightBuffer_) glDeleteBuffers(1, &lightBuffer_);
 }
 
 void ViewportPanel::destroyFBO() {
     if (fbo_) glDeleteFramebuffers(1, &fbo_);
     if (colorTex_) glDeleteTextures(1, &colorTex_);
     if (depthRbo_) glDeleteRenderbuffers(1, &depthRbo_);
-    fbo_ = 0; colorTex_ = 0; depthRbo_ = 0; texW_ = texH_ = 0;
+    if (idTex_) glDeleteTextures(1, &idTex_);
+    fbo_ = 0; colorTex_ = 0; depthRbo_ = 0; idTex_ = 0; texW_ = texH_ = 0;
+    idPicking_ = false;
 }
 
 void ViewportPanel::ensureFBO(int w, int h) {
@@ -53,13 +67,34 @@ void ViewportPanel::ensureFBO(int w, int h) {
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
     glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, colorTex_, 0);
 
+    // Object IDs for picking, written by the scene pass alongside the color
+    glGenTextures(1, &idTex_);
+    glBindTexture(GL_TEXTURE_2D, idTex_);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RG32UI, texW_, texH_, 0, GL_RG_INTEGER, GL_UNSIGNED_INT, nullptr);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, GL_TEXTURE_2D, idTex_, 0);
+    const GLenum drawBuffers[] = { GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1 };
+    glDrawBuffers(2, drawBuffers);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
     glGenRenderbuffers(1, &depthRbo_);
     glBindRenderbuffer(GL_RENDERBUFFER, depthRbo_);
     glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, texW_, texH_);
     glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, depthRbo_);
 
+    // Reads are fenced, so picking by ID needs sync objects (GL 3.2)
+    idPicking_ = GLEW_VERSION_3_2 || GLEW_ARB_sync;
     if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
-        std::cerr << "Viewport FBO incomplete" << std::endl;
+        // Retry without the ID buffer; clicks fall back to ray picking
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, GL_TEXTURE_2D, 0, 0);
+        glDrawBuffers(1, drawBuffers);
+        glDeleteTextures(1, &idTex_);
+        idTex_ = 0;
+        idPicking_ = false;
+        if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+            std::cerr << "Viewport FBO incomplete" << std::endl;
+        }
     }
     glBindFramebuffer(GL_FRAMEBUFFER, 0);
 }
@@ -69,9 +104,8 @@ void ViewportPanel::handleCameraControls() {
 
     ImGuiIO& io = ImGui::GetIO();
 
-    // Mouse drag (any button): rotate/orbit
-    if (ImGui::IsMouseDragging(ImGuiMouseButton_Left) ||
-        ImGui::IsMouseDragging(ImGuiMouseButton_Right) ||
+    // Right or middle mouse drag: rotate/orbit (left drag is the selection marquee)
+    if (ImGui::IsMouseDragging(ImGuiMouseButton_Right) ||
         ImGui::IsMouseDragging(ImGuiMouseButton_Middle)) {
         float deltaX = io.MouseDelta.x * 0.005f;
         float deltaY = io.MouseDelta.y * 0.005f;
@@ -108,271 +142,317 @@ void ViewportPanel::handleCameraControls() {
 
 void ViewportPanel::renderScene(Shader& shader, Scene* scene) {
     // Get camera matrices
-    float view[16];
-    float proj[16];
     float aspect = (float)texW_ / (float)texH_;
-    
-    camera_->getViewMatrix(view);
-    camera_->getProjectionMatrix(proj, aspect);
+    Mat4 view = camera_->getViewMatrix();
+    Mat4 proj = camera_->getProjectionMatrix(aspect);
     
     // Set up rendering state
     glBindFramebuffer(GL_FRAMEBUFFER, fbo_);
     glViewport(0, 0, texW_, texH_);
     glEnable(GL_DEPTH_TEST);
     glDepthFunc(GL_LESS);
-    glClearColor(0.15f, 0.15f, 0.15f, 1.0f);
-    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    // Integer attachments can't be cleared through glClearColor
+    const GLfloat clearColor[] = { 0.15f, 0.15f, 0.15f, 1.0f };
+    glClearBufferfv(GL_COLOR, 0, clearColor);
+    if (idTex_) {
+        const GLuint noObject[] = { 0, 0, 0, 0 };
+        glClearBufferuiv(GL_COLOR, 1, noObject);
+    }
+    glClear(GL_DEPTH_BUFFER_BIT);
 
     shader.use();
     shader.setMat4("uProjection", proj);
     shader.setMat4("uView", view);
 
     // Camera position (for lighting)
-    float eyeX, eyeY, eyeZ;
-    camera_->getEyePosition(eyeX, eyeY, eyeZ);
+    Vec3 eye = camera_->getEyePosition();
 
     // View position
-    shader.setVec3("uViewPos", eyeX, eyeY, eyeZ);
-
-    // Collect lights from scene
-    const int MAX_DIR = 4;
-    const int MAX_POINT = 16;
-    int dirCount = 0, pointCount = 0;
-    float ambient[3] = {0.02f, 0.02f, 0.02f}; // base ambient
-    // Temporary arrays on CPU side
-    struct Vec3 { float x,y,z; };
-    Vec3 dirDirs[MAX_DIR];
-    Vec3 dirColors[MAX_DIR];
-    Vec3 pointPos[MAX_POINT];
-    Vec3 pointColors[MAX_POINT];
-    float pointRange[MAX_POINT];
-
-    auto& objectsForLights = scene->getGameObjects();
-    for (size_t i = 0; i < objectsForLights.size(); ++i) {
-        if (dirCount >= MAX_DIR && pointCount >= MAX_POINT) break;
-        auto* go = objectsForLights[i].get();
-        auto* light = go->getComponent<LightComponent>();
-        if (!light) continue;
-        auto* t = go->getTransform();
-
-        // Color with intensity
-        Vec3 col = { light->color[0] * light->intensity, light->color[1] * light->intensity, light->color[2] * light->intensity };
-
-    if (light->type == LightComponent::Type::Directional && dirCount < MAX_DIR) {
-            // Derive direction from transform rotation (approx yaw/pitch)
-            float yaw = t->rotY * MathUtils::DEG_TO_RAD;
-            float pitch = t->rotX * MathUtils::DEG_TO_RAD;
-            Vec3 dir = { cosf(pitch)*sinf(yaw), -sinf(pitch), -cosf(pitch)*cosf(yaw) };
-            dirDirs[dirCount] = dir;
-            dirColors[dirCount] = col;
-            dirCount++;
-        } else if (light->type == LightComponent::Type::Point && pointCount < MAX_POINT) {
-            pointPos[pointCount] = { t->x, t->y, t->z };
-            pointColors[pointCount] = col;
-            pointRange[pointCount] = light->range;
-            pointCount++;
-        } else if (light->type == LightComponent::Type::Ambient) {
-            ambient[0] += col.x;
-            ambient[1] += col.y;
-            ambient[2] += col.z;
-        }
-    }
+    shader.setVec3("uViewPos", eye);
 
-    // Upload light uniforms
-    shader.setInt("uDirLightCount", dirCount);
-    for (int i = 0; i < dirCount; ++i) {
-        char name[64];
-        snprintf(name, sizeof(name), "uDirLightDirs[%d]", i);
-        shader.setVec3(name, dirDirs[i].x, dirDirs[i].y, dirDirs[i].z);
-        snprintf(name, sizeof(name), "uDirLightColors[%d]", i);
-        shader.setVec3(name, dirColors[i].x, dirColors[i].y, dirColors[i].z);
-    }
-    shader.setInt("uPointLightCount", pointCount);
-    for (int i = 0; i < pointCount; ++i) {
-        char name[64];
-        snprintf(name, sizeof(name), "uPointLightPos[%d]", i);
-        shader.setVec3(name, pointPos[i].x, pointPos[i].y, pointPos[i].z);
-        snprintf(name, sizeof(name), "uPointLightColors[%d]", i);
-        shader.setVec3(name, pointColors[i].x, pointColors[i].y, pointColors[i].z);
-        snprintf(name, sizeof(name), "uPointLightRange[%d]", i);
-        shader.setFloat(name, pointRange[i]);
-    }
-    shader.setVec3("uAmbientColor", ambient[0], ambient[1], ambient[2]);
+    uploadLights(shader, scene);
 
     // Render grid as an infinite-looking plane by recentering under the camera target (pan)
     // Get camera eye and derive target by subtracting orbit vector
     // We approximate the camera target as (panX, panY, panZ) but Camera doesn't expose directly;
     // instead, center the grid on eye projected onto Y=0 and snapped to spacing for stability.
     const float spacing = 1.0f;
-    float gx = floorf(eyeX / spacing) * spacing;
-    float gz = floorf(eyeZ / spacing) * spacing;
-    float gridModel[16];
-    // Large uniform scale to cover far distances visually
-    MathUtils::buildModelMatrix(gx, 0.0f, gz, 0, 0, 0, 1.0f, 1.0f, 1.0f, gridModel);
-    shader.setMat4("uModel", gridModel);
+    float gx = floorf(eye.x / spacing) * spacing;
+    float gz = floorf(eye.z / spacing) * spacing;
+    shader.setMat4("uModel", Mat4::translation(Vec3(gx, 0.0f, gz)));
     // Neutral material for grid (avoid mesh colors tinting it)
     shader.setVec3("uAlbedo", 0.5f, 0.5f, 0.5f);
     shader.setFloat("uMetallic", 0.0f);
     shader.setFloat("uRoughness", 1.0f);
     shader.setVec4("uSelectionTint", 0.0f, 0.0f, 0.0f, 0.0f);
     shader.setFloat("uAmbientStrength", 0.0f); // no ambient on grid
+    shader.setUVec2("uObjectId", 0, 0); // Clicks on the grid select nothing
+    shader.setInt("uObjectLightCount", -1); // Every point light
     grid_->render(shader);
 
-    // Render scene objects
-        auto& gameObjects = scene->getGameObjects();
-        for (size_t i = 0; i < gameObjects.size(); ++i) {
-            auto* go = gameObjects[i].get();
-            auto* transform = go->getTransform();
-            auto* meshRenderer = go->getComponent<MeshRendererComponent>();
-        
-            // Skip if no mesh renderer or no mesh
-            if (!meshRenderer || !meshRenderer->mesh) continue;
-        
-        // Build model matrix from transform
-        float model[16];
-        MathUtils::buildModelMatrix(
-                transform->x, transform->y, transform->z,
-                transform->rotX * MathUtils::DEG_TO_RAD,
-                transform->rotY * MathUtils::DEG_TO_RAD,
-                transform->rotZ * MathUtils::DEG_TO_RAD,
-                transform->scaleX, transform->scaleY, transform->scaleZ,
-            model
-        );
-        
-        shader.setMat4("uModel", model);
-        
+    // Cull the draw list against the view frustum, then draw what is left
+    RenderListSystem* renderList = scene->getSystems().get<RenderListSystem>();
+    auto cullStart = std::chrono::steady_clock::now();
+    renderList->cull(Frustum(proj * view), scene->getJobSystem(), visible_);
+    cullMs_ = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - cullStart).count();
+    drawListSize_ = renderList->items.size();
+
+    // Point lights only shade the objects within their range; the lists are
+    // only rebuilt when lights or object bounds changed
+    LightGatherSystem* lights = scene->getSystems().get<LightGatherSystem>();
+    lights->assignLights(scene->getSpatialIndex());
+
+    const EntityRegistry& registry = scene->getRegistry();
+    const TransformStore& transforms = scene->getTransforms();
+    const Selection& selection = scene->getSelection();
+    for (uint32_t index : visible_) {
+        const RenderListSystem::DrawItem& item = renderList->items[index];
+        // World matrix was rebuilt (only if dirty) by the TransformSystem
+        shader.setMat4("uModel", transforms.getWorldMatrix(item.transformSlot));
+        shader.setUVec2("uObjectId", item.entity + 1, registry.getHandle(item.entity).generation);
+        const LightGatherSystem::ObjectLights& objectLights = lights->getObjectLights(item.entity);
+        shader.setIntArray("uObjectLights", objectLights.lights, objectLights.count);
+        shader.setInt("uObjectLightCount", objectLights.count);
+
         // Material uniforms
-        float albedo[3] = {0.8f, 0.5f, 0.2f};
-        float metallic = 0.0f;
-        float roughness = 0.8f;
-        if (auto* mat = go->getComponent<MaterialComponent>()) {
-            albedo[0] = mat->albedo[0]; albedo[1] = mat->albedo[1]; albedo[2] = mat->albedo[2];
-            metallic = mat->metallic;
-            roughness = mat->roughness;
-        }
-    shader.setVec3("uAlbedo", albedo[0], albedo[1], albedo[2]);
-        shader.setFloat("uMetallic", metallic);
-        shader.setFloat("uRoughness", roughness);
-    shader.setFloat("uAmbientStrength", 1.0f);
+        shader.setVec3("uAlbedo", item.albedo[0], item.albedo[1], item.albedo[2]);
+        shader.setFloat("uMetallic", item.metallic);
+        shader.setFloat("uRoughness", item.roughness);
+        shader.setFloat("uAmbientStrength", 1.0f);
 
         // Selection tint
-        if (scene->getSelectedIndex() == (int)i) {
+        if (selection.contains(item.entity)) {
             shader.setVec4("uSelectionTint", 0.2f, 0.2f, 0.0f, 0.0f);
         } else {
             shader.setVec4("uSelectionTint", 0.0f, 0.0f, 0.0f, 0.0f);
         }
         
-            meshRenderer->mesh->draw();
+        item.mesh->draw();
+        // Have the picking BVH ready before the first click (no-op once started)
+        item.mesh->buildBvhAsync(scene->getJobSystem());
     }
 
     glBindFramebuffer(GL_FRAMEBUFFER, 0);
 }
 
-void ViewportPanel::handleSelection(Scene* scene, bool isImageHovered) {
-    if (!isImageHovered) return;
+void ViewportPanel::uploadLights(Shader& shader, Scene* scene) {
+    // The LightGatherSystem keeps the packed array current; only the entries
+    // it rewrote since the last frame are uploaded
+    LightGatherSystem* lights = scene->getSystems().get<LightGatherSystem>();
+    const std::vector<LightGatherSystem::GpuLight>& packed = lights->getLights();
 
-    printf("[Selection] Click detected on viewport image\n");
+    if (!lightBuffer_) {
+        glGenBuffers(1, &lightBuffer_);
+        glGenTextures(1, &lightTexture_);
+    }
+    size_t begin = 0, end = 0;
+    bool dirty = lights->takeDirtyRange(begin, end);
+    if (packed.size() > lightCapacity_ || lightCapacity_ == 0) {
+        // Grow geometrically and upload everything
+        lightCapacity_ = std::max<size_t>(std::max<size_t>(64, packed.size()), lightCapacity_ * 2);
+        glBindBuffer(GL_TEXTURE_BUFFER, lightBuffer_);
+        glBufferData(GL_TEXTURE_BUFFER, lightCapacity_ * sizeof(LightGatherSystem::GpuLight), nullptr, GL_DYNAMIC_DRAW);
+        if (!packed.empty()) {
+            glBufferSubData(GL_TEXTURE_BUFFER, 0, packed.size() * sizeof(LightGatherSystem::GpuLight), packed.data());
+        }
+        glBindTexture(GL_TEXTURE_BUFFER, lightTexture_);
+        glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, lightBuffer_);
+    } else if (dirty) {
+        glBindBuffer(GL_TEXTURE_BUFFER, lightBuffer_);
+        glBufferSubData(GL_TEXTURE_BUFFER, begin * sizeof(LightGatherSystem::GpuLight),
+                        (end - begin) * sizeof(LightGatherSystem::GpuLight), packed.data() + begin);
+    }
+    glBindBuffer(GL_TEXTURE_BUFFER, 0);
+
+    glActiveTexture(GL_TEXTURE1);
+    glBindTexture(GL_TEXTURE_BUFFER, lightTexture_);
+    glActiveTexture(GL_TEXTURE0);
+    shader.setInt("uLights", 1);
+    shader.setInt("uLightCount", (int)packed.size());
+    shader.setInt("uDirectionalCount", (int)lights->getDirectionalCount());
+    const float* ambient = lights->getAmbient();
+    shader.setVec3("uAmbientColor", ambient[0], ambient[1], ambient[2]);
+}
 
-    // Get mouse position relative to the viewport image
+void ViewportPanel::handleSelection(Scene* scene, bool isImageHovered) {
+    ImGuiIO& io = ImGui::GetIO();
     ImVec2 mousePos = ImGui::GetMousePos();
+    if (ImGui::IsItemClicked(ImGuiMouseButton_Left)) {
+        marquee_ = true;
+        marqueeStart_[0] = mousePos.x;
+        marqueeStart_[1] = mousePos.y;
+    }
+    if (!marquee_) return;
+
+    // Get mouse position relative to the viewport image
     ImVec2 imageMin = ImGui::GetItemRectMin();
     ImVec2 imageMax = ImGui::GetItemRectMax();
+    ImVec2 start(marqueeStart_[0], marqueeStart_[1]);
+    float dx = mousePos.x - start.x, dy = mousePos.y - start.y;
+    bool dragged = dx * dx + dy * dy > io.MouseDragThreshold * io.MouseDragThreshold;
+
+    if (ImGui::IsMouseDown(ImGuiMouseButton_Left)) {
+        if (dragged) {
+            ImDrawList* drawList = ImGui::GetWindowDrawList();
+            drawList->PushClipRect(imageMin, imageMax, true);
+            drawList->AddRectFilled(start, mousePos, IM_COL32(90, 150, 255, 40));
+            drawList->AddRect(start, mousePos, IM_COL32(90, 150, 255, 200));
+            drawList->PopClipRect();
+        }
+        return;
+    }
+
+    // Released: a drag selects what the rectangle covers, otherwise it's a click
+    marquee_ = false;
+    bool add = io.KeyCtrl || io.KeyShift;
+    float width = imageMax.x - imageMin.x, height = imageMax.y - imageMin.y;
+    float u = (mousePos.x - imageMin.x) / width;
+    float v = (mousePos.y - imageMin.y) / height;
+    if (dragged) {
+        selectInRect(scene, (start.x - imageMin.x) / width, (start.y - imageMin.y) / height, u, v, add);
+        return;
+    }
+    if (!isImageHovered) return;
+
+    // The image is shown flipped, so texel rows count up from the bottom
+    int x = std::min(std::max((int)(u * texW_), 0), texW_ - 1);
+    int y = std::min(std::max((int)((1.0f - v) * texH_), 0), texH_ - 1);
+    if (idPicking_ && requestIdPick(x, y, add)) return;
 
     // Convert to normalized device coordinates [-1, 1]
-    float ndcX = ((mousePos.x - imageMin.x) / (imageMax.x - imageMin.x)) * 2.0f - 1.0f;
-    float ndcY = 1.0f - ((mousePos.y - imageMin.y) / (imageMax.y - imageMin.y)) * 2.0f;
+    GameObject* picked = pickWithRay(scene, u * 2.0f - 1.0f, 1.0f - v * 2.0f);
+    if (add) {
+        if (picked) scene->getSelection().toggle(picked->getHandle());
+    } else {
+        scene->setSelected(picked ? picked->getHandle() : EntityHandle());
+    }
+}
+
+void ViewportPanel::selectInRect(Scene* scene, float u0, float v0, float u1, float v1, bool add) {
+    // Rectangle in NDC, clipped to the image (v grows downwards, NDC y upwards)
+    float x0 = std::max(std::min(u0, u1), 0.0f) * 2.0f - 1.0f;
+    float x1 = std::min(std::max(u0, u1), 1.0f) * 2.0f - 1.0f;
+    float y0 = 1.0f - std::min(std::max(v0, v1), 1.0f) * 2.0f;
+    float y1 = 1.0f - std::max(std::min(v0, v1), 0.0f) * 2.0f;
+    if (x1 <= x0 || y1 <= y0) {
+        if (!add) scene->setSelected(EntityHandle());
+        return;
+    }
 
+    // Stretch the rectangle over the whole clip volume; the frustum of the
+    // combined matrix is the part of the view the rectangle covers
+    float aspect = (float)texW_ / (float)texH_;
+    Mat4 view = camera_->getViewMatrix();
+    Mat4 proj = camera_->getProjectionMatrix(aspect);
+    Mat4 region = Mat4::translation(Vec3(-(x0 + x1) / (x1 - x0), -(y0 + y1) / (y1 - y0), 0.0f)) *
+                  Mat4::scale(Vec3(2.0f / (x1 - x0), 2.0f / (y1 - y0), 1.0f));
+
+    auto start = std::chrono::steady_clock::now();
+    scene->selectInFrustum(Frustum(region * proj * view), add);
+    marqueeMs_ = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+GameObject* ViewportPanel::pickWithRay(Scene* scene, float ndcX, float ndcY) {
     // Get camera matrices
-    float view[16], proj[16];
     float aspect = (float)texW_ / (float)texH_;
-    camera_->getViewMatrix(view);
-    camera_->getProjectionMatrix(proj, aspect);
+    Mat4 view = camera_->getViewMatrix();
+    Mat4 proj = camera_->getProjectionMatrix(aspect);
 
     // Ray origin: camera position
-    float rayOriginX, rayOriginY, rayOriginZ;
-    camera_->getEyePosition(rayOriginX, rayOriginY, rayOriginZ);
-    printf("[Selection] Ray origin: %f %f %f\n", rayOriginX, rayOriginY, rayOriginZ);
-
-    // Ray direction: unproject NDC to world
-    // We'll use a simple approach: project NDC to near plane, then transform by inverse view
-    float near = 0.1f;
-    float rayClip[4] = { ndcX, ndcY, -1.0f, 1.0f };
-    float invProj[16], invView[16];
-    MathUtils::invertMatrix(proj, invProj);
-    MathUtils::invertMatrix(view, invView);
-    float rayEye[4];
-    for (int i = 0; i < 4; ++i) {
-        rayEye[i] = invProj[i*4+0] * rayClip[0] + invProj[i*4+1] * rayClip[1] +
-                    invProj[i*4+2] * rayClip[2] + invProj[i*4+3] * rayClip[3];
-    }
-    rayEye[2] = -1.0f; rayEye[3] = 0.0f;
-    float rayWorld[4];
-    for (int i = 0; i < 4; ++i) {
-        rayWorld[i] = invView[i*4+0] * rayEye[0] + invView[i*4+1] * rayEye[1] +
-                      invView[i*4+2] * rayEye[2] + invView[i*4+3] * rayEye[3];
-    }
-    float rayDirX = rayWorld[0];
-    float rayDirY = rayWorld[1];
-    float rayDirZ = rayWorld[2];
-    float rayLen = sqrtf(rayDirX*rayDirX + rayDirY*rayDirY + rayDirZ*rayDirZ);
-    rayDirX /= rayLen; rayDirY /= rayLen; rayDirZ /= rayLen;
-    printf("[Selection] Ray dir: %f %f %f\n", rayDirX, rayDirY, rayDirZ);
-
-    // Ray-triangle intersection for each mesh
-        auto& gameObjects = scene->getGameObjects();
-    int closestIndex = -1;
+    Vec3 rayOrigin = camera_->getEyePosition();
+
+    // Ray direction: unproject NDC to a direction in eye space, then rotate it to world
+    // (the view matrix is a rotation plus translation, so its inverse is a transpose)
+    Mat4 invProj, invView;
+    proj.inverse(invProj, MatrixKind::General);
+    view.inverse(invView, MatrixKind::Rigid);
+    Vec4 rayEye = invProj * Vec4(ndcX, ndcY, -1.0f, 1.0f);
+    Vec3 rayDir = normalize(invView.transformVector(Vec3(rayEye.x, rayEye.y, -1.0f)));
+
+    // Only objects whose world bounds the ray enters are tested, nearest
+    // box first, and boxes beyond the closest hit so far are skipped. Each
+    // mesh's BVH is in object space, so the ray is moved there instead of
+    // the vertices to world space. The direction isn't renormalized, which
+    // keeps hit distances in world units and comparable across objects.
+    JobSystem* jobs = scene->getJobSystem();
+    EntityRegistry& registry = scene->getRegistry();
+    const AabbTree& bounds = scene->getBoundsTree();
+    GameObject* closest = nullptr;
     float closestDist = 1e30f;
-        for (size_t i = 0; i < gameObjects.size(); ++i) {
-            auto* go = gameObjects[i].get();
-            auto* transform = go->getTransform();
-            auto* meshRenderer = go->getComponent<MeshRendererComponent>();
-        
-            // Skip if no mesh renderer or no mesh
-            if (!meshRenderer || !meshRenderer->mesh) continue;
-        
-            const auto& verts = meshRenderer->mesh->getVertices();
-        float model[16];
-        MathUtils::buildModelMatrix(
-                transform->x, transform->y, transform->z,
-                transform->rotX * MathUtils::DEG_TO_RAD,
-                transform->rotY * MathUtils::DEG_TO_RAD,
-                transform->rotZ * MathUtils::DEG_TO_RAD,
-                transform->scaleX, transform->scaleY, transform->scaleZ,
-            model
-        );
-        // Test all triangles
-        for (size_t j = 0; j + 2 < verts.size(); j += 3) {
-            // Transform vertices to world space
-            float v0x = model[0]*verts[j].x + model[4]*verts[j].y + model[8]*verts[j].z + model[12];
-            float v0y = model[1]*verts[j].x + model[5]*verts[j].y + model[9]*verts[j].z + model[13];
-            float v0z = model[2]*verts[j].x + model[6]*verts[j].y + model[10]*verts[j].z + model[14];
-            float v1x = model[0]*verts[j+1].x + model[4]*verts[j+1].y + model[8]*verts[j+1].z + model[12];
-            float v1y = model[1]*verts[j+1].x + model[5]*verts[j+1].y + model[9]*verts[j+1].z + model[13];
-            float v1z = model[2]*verts[j+1].x + model[6]*verts[j+1].y + model[10]*verts[j+1].z + model[14];
-            float v2x = model[0]*verts[j+2].x + model[4]*verts[j+2].y + model[8]*verts[j+2].z + model[12];
-            float v2y = model[1]*verts[j+2].x + model[5]*verts[j+2].y + model[9]*verts[j+2].z + model[13];
-            float v2z = model[2]*verts[j+2].x + model[6]*verts[j+2].y + model[10]*verts[j+2].z + model[14];
-            float t = 0.0f;
-            if (MathUtils::rayTriangleIntersect(
-                rayOriginX, rayOriginY, rayOriginZ,
-                rayDirX, rayDirY, rayDirZ,
-                v0x, v0y, v0z,
-                v1x, v1y, v1z,
-                v2x, v2y, v2z,
-                t)) {
-                printf("[Selection] Hit triangle: mesh %zu tri %zu t=%f\n", i, j/3, t);
-                if (t < closestDist && t > 0.0f) {
-                    closestDist = t;
-                    closestIndex = (int)i;
-                }
-            }
+    bounds.raycast(Ray{ rayOrigin, rayDir }, closestDist, [&](int32_t proxy) {
+        EntityId entity = bounds.getUserData(proxy);
+        const TransformComponent* transform = registry.get<TransformComponent>(entity);
+        MeshRendererComponent* meshRenderer = registry.get<MeshRendererComponent>(entity);
+
+        Mat4 invModel;
+        if (!transform->getInverseWorldMatrix(invModel)) return closestDist; // Zero scale
+        Ray ray{ invModel.transformPoint(rayOrigin), invModel.transformVector(rayDir) };
+
+        RayHit hit;
+        hit.t = closestDist;
+        if (meshRenderer->mesh->waitForBvh(jobs).raycast(ray, hit)) {
+            closestDist = hit.t;
+            closest = registry.getOwner(entity);
         }
+        return closestDist;
+    });
+    return closest;
+}
+
+bool ViewportPanel::requestIdPick(int x, int y, bool toggle) {
+    PendingPick& pick = picks_[pickNext_];
+    if (pick.fence) return false;
+
+    if (!pick.pbo) {
+        glGenBuffers(1, &pick.pbo);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, pick.pbo);
+        glBufferData(GL_PIXEL_PACK_BUFFER, 2 * sizeof(GLuint), nullptr, GL_STREAM_READ);
+    } else {
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, pick.pbo);
     }
-    printf("[Selection] Closest index: %d\n", closestIndex);
-    if (closestIndex == -1) {
-        printf("[Selection] Unselecting all objects\n");
+
+    // With a pack buffer bound the read is queued behind the scene pass and
+    // returns at once; the fence tells when the texel has landed
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, fbo_);
+    glReadBuffer(GL_COLOR_ATTACHMENT1);
+    glReadPixels(x, y, 1, 1, GL_RG_INTEGER, GL_UNSIGNED_INT, nullptr);
+    pick.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    pick.toggle = toggle;
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    pickNext_ = (pickNext_ + 1) % PICK_RING;
+    return true;
+}
+
+void ViewportPanel::resolveIdPicks(Scene* scene) {
+    // Oldest first, so the last click wins; stop at the first read still in flight
+    for (int i = 0; i < PICK_RING; ++i) {
+        PendingPick& pick = picks_[(pickNext_ + i) % PICK_RING];
+        if (!pick.fence) continue;
+        GLenum status = glClientWaitSync(pick.fence, 0, 0);
+        if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED) break;
+        glDeleteSync(pick.fence);
+        pick.fence = nullptr;
+
+        GLuint id[2] = { 0, 0 };
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, pick.pbo);
+        if (const void* data = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, sizeof(id), GL_MAP_READ_BIT)) {
+            id[0] = ((const GLuint*)data)[0];
+            id[1] = ((const GLuint*)data)[1];
+            glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+        }
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+        // IDs are entity indices + 1 with the generation drawn. The object
+        // may be gone by now and its index reused, so only a live handle
+        // with that generation is selected.
+        EntityHandle picked;
+        EntityHandle drawn{ (EntityId)(id[0] - 1), id[1] };
+        if (id[0] != 0 && scene->getRegistry().isAlive(drawn)) picked = drawn;
+        if (!pick.toggle) scene->setSelected(picked);
+        else if (!picked.isNull()) scene->getSelection().toggle(picked);
     }
-    scene->setSelectedIndex(closestIndex);
 }
 
 void ViewportPanel::handleDragDrop(Scene* scene) {
@@ -384,18 +464,75 @@ void ViewportPanel::handleDragDrop(Scene* scene) {
         
         // Spawn at origin, slightly above ground plane
         // TODO: Implement ray-plane intersection for proper 3D placement
+        EntityHandle spawned;
         if (meshName == "Sphere") {
-            scene->addSphere(1.0f, 48, 0.0f, 1.0f, 0.0f, "Sphere");
+            spawned = scene->addSphere(1.0f, 48, 0.0f, 1.0f, 0.0f, "Sphere");
         } else if (meshName == "Pyramid") {
-            scene->addPyramid(1.0f, 0.0f, 1.0f, 0.0f, "Pyramid");
+            spawned = scene->addPyramid(1.0f, 0.0f, 1.0f, 0.0f, "Pyramid");
         } else if (meshName == "Cube") {
-            scene->addCube(1.0f, 0.0f, 1.0f, 0.0f, "Cube");
+            spawned = scene->addCube(1.0f, 0.0f, 1.0f, 0.0f, "Cube");
+        }
+        // Select what was just dropped
+        if (!spawned.isNull()) {
+            scene->setSelected(spawned);
+        }
+    }
+    
+    payload = ImGui::AcceptDragDropPayload("ASSET_PREFAB");
+    if (payload && payload->Data) {
+        std::string prefabName((const char*)payload->Data);
+        if (auto prefab = scene->getPrefabs().find(prefabName)) {
+            Scene::SpawnTransform placement;
+            placement.position[1] = 1.0f;
+            std::vector<EntityHandle> spawned = scene->instantiatePrefab(prefab, 1, &placement);
+            if (!spawned.empty()) scene->setSelected(spawned[0]);
         }
     }
     
     ImGui::EndDragDropTarget();
 }
 
+void ViewportPanel::renderToolbar(Scene* scene) {
+    bool playing = scene->isPlaying();
+    if (ImGui::Button(playing ? "Stop" : "Play")) {
+        auto start = std::chrono::steady_clock::now();
+        if (playing) scene->exitPlayMode();
+        else scene->enterPlayMode();
+        playToggleMs_ = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+    if (playToggleMs_ >= 0.0f) {
+        ImGui::SameLine(0, 8.0f);
+        ImGui::TextDisabled("%s in %.1f ms", scene->isPlaying() ? "Snapshot saved" : "Scene restored", playToggleMs_);
+    }
+
+    // Frustum culling of the last frame
+    ImGui::SameLine(0, 8.0f);
+    ImGui::TextDisabled("Drawn %zu/%zu (%zu culled in %.2f ms)", visible_.size(), drawListSize_,
+                        drawListSize_ - visible_.size(), cullMs_);
+
+    // Selection size, and how long the last marquee took to resolve
+    size_t selectedCount = scene->getSelection().size();
+    if (selectedCount > 0 || marqueeMs_ >= 0.0f) {
+        ImGui::SameLine(0, 8.0f);
+        if (marqueeMs_ >= 0.0f) ImGui::TextDisabled("%zu selected (box %.2f ms)", selectedCount, marqueeMs_);
+        else ImGui::TextDisabled("%zu selected", selectedCount);
+    }
+
+    // Per-system timings of the last frame; the critical path is highlighted
+    ImGui::SameLine(0, 8.0f);
+    if (ImGui::Button("Systems")) ImGui::OpenPopup("SystemTimings");
+    if (ImGui::BeginPopup("SystemTimings")) {
+        const SystemScheduler& systems = scene->getSystems();
+        ImGui::Text("Frame %.3f ms, critical path %.3f ms", systems.getFrameMs(), systems.getCriticalPathMs());
+        ImGui::Separator();
+        for (const SystemScheduler::Timing& timing : systems.getTimings()) {
+            ImVec4 color = timing.onCriticalPath ? ImVec4(1.0f, 0.8f, 0.3f, 1.0f) : ImGui::GetStyle().Colors[ImGuiCol_Text];
+            ImGui::TextColored(color, "%-14s start %7.3f ms  took %7.3f ms", timing.name, timing.startMs, timing.durationMs);
+        }
+        ImGui::EndPopup();
+    }
+}
+
 void ViewportPanel::render(Shader& shader, Scene* scene) {
     ImGui::BeginChild("Viewport", ImVec2(0, 0), true);
     
@@ -404,6 +541,8 @@ void ViewportPanel::render(Shader& shader, Scene* scene) {
         return;
     }
 
+    renderToolbar(scene);
+
     ImVec2 avail = ImGui::GetContentRegionAvail();
     int w = std::max(1, (int)avail.x);
     int h = std::max(1, (int)avail.y);
@@ -412,6 +551,13 @@ void ViewportPanel::render(Shader& shader, Scene* scene) {
     // Handle camera input
     handleCameraControls();
 
+    // Clicks from earlier frames whose ID reads have finished
+    resolveIdPicks(scene);
+
+    // Run the scene's systems: world matrices, lights and the draw list that
+    // rendering and picking read
+    scene->update(ImGui::GetIO().DeltaTime);
+
     // Render the scene to FBO
     renderScene(shader, scene);
 
@@ -421,9 +567,7 @@ void ViewportPanel::render(Shader& shader, Scene* scene) {
 
     // Handle object selection (use image item, not window)
     bool isImageHovered = ImGui::IsItemHovered();
-    if (ImGui::IsItemClicked()) {
-        handleSelection(scene, isImageHovered);
-    }
+    handleSelection(scene, isImageHovered);
 
     // Handle drag-drop for spawning objects
     handleDragDrop(scene);
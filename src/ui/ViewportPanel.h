@@ -2,12 +2,16 @@
 #define VIEWPORT_PANEL_H
 
 #include <GL/glew.h>
+#include <cstddef>
+#include <cstdint>
 #include <memory>
+#include <vector>
 
 class Shader;
 class Scene;
 class Camera;
 class Grid;
+class GameObject;
 
 class ViewportPanel {
 public:
@@ -23,19 +27,63 @@ private:
     void destroyFBO();
     void handleCameraControls();
     void renderScene(Shader& shader, Scene* scene);
+    void uploadLights(Shader& shader, Scene* scene);
+    // Left click picks, left drag draws a marquee; Ctrl or Shift adds to
+    // the selection (a click toggles the object instead)
     void handleSelection(Scene* scene, bool isHovered);
+    // Select what lies inside a rectangle given in image UVs (0..1, y down)
+    void selectInRect(Scene* scene, float u0, float v0, float u1, float v1, bool add);
+    // CPU picking: the ray through an NDC point against the scene's bounds
+    // tree and the hit meshes' BVHs. Used when the ID buffer isn't available.
+    GameObject* pickWithRay(Scene* scene, float ndcX, float ndcY);
+    // Queue a read of the ID buffer at a texel; false if every ring slot is busy
+    bool requestIdPick(int x, int y, bool toggle);
+    // Select what finished ID reads found (once per frame, never waits)
+    void resolveIdPicks(Scene* scene);
     void handleDragDrop(Scene* scene);
+    void renderToolbar(Scene* scene);
 
     // Framebuffer for offscreen rendering
     GLuint fbo_ = 0;
     GLuint colorTex_ = 0;
     GLuint depthRbo_ = 0;
+    GLuint idTex_ = 0;       // RG32UI: entity index + 1 and generation per pixel, 0 where nothing pickable was drawn
+    bool idPicking_ = false; // ID attachment complete and sync objects available
     int texW_ = 0;
     int texH_ = 0;
 
+    // Clicks waiting for their ID buffer texel. Each one is copied into its
+    // own pixel buffer and read once its fence has passed, a frame or two
+    // later, so the CPU never stalls on the GPU.
+    static constexpr int PICK_RING = 3;
+    struct PendingPick {
+        GLuint pbo = 0;
+        GLsync fence = nullptr; // Set while the read is in flight
+        bool toggle = false;    // Ctrl/Shift click: toggle the hit instead of replacing the selection
+    };
+    PendingPick picks_[PICK_RING];
+    int pickNext_ = 0; // Slot the next click uses; the oldest in-flight read when busy
+
+    // Texture buffer holding the packed light array (see LightGatherSystem)
+    GLuint lightBuffer_ = 0;
+    GLuint lightTexture_ = 0;
+    size_t lightCapacity_ = 0; // In lights
+
     // Scene components
     std::unique_ptr<Camera> camera_;
     std::unique_ptr<Grid> grid_;
+
+    // Draw list indices that passed frustum culling this frame, with stats
+    std::vector<uint32_t> visible_;
+    size_t drawListSize_ = 0;
+    float cullMs_ = 0.0f;
+
+    // Marquee drag in progress (screen coordinates of where it started)
+    bool marquee_ = false;
+    float marqueeStart_[2] = { 0.0f, 0.0f };
+    float marqueeMs_ = -1.0f; // Duration of the last marquee query, -1 before the first
+
+    float playToggleMs_ = -1.0f; // Duration of the last play/stop, -1 before the first
 };
 
 #endif